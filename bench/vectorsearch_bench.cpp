@@ -0,0 +1,708 @@
+// bench/vectorsearch_bench.cpp
+// Benchmark driver for VectorStore: ingest rate, single-query and batched
+// QPS, p50/p99 latency and recall@k against exact search, for every
+// requested dimension, index type and query thread count. Results are
+// written one row per measurement as JSON lines (default) or CSV.
+//
+// Datasets are synthetic Gaussian clusters unless --base/--query name
+// fvecs files (e.g. SIFT1M); an ivecs --groundtruth file then replaces the
+// exact-search reference.
+#include "engine/vector_store.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vectorsearch;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char *kUsage =
+    "Usage: vectorsearch_bench [options]\n"
+    "  --dims LIST          synthetic dimensions (default 128)\n"
+    "  --count N            base vectors per dataset (default 100000)\n"
+    "  --queries N          queries per dataset (default 1000)\n"
+    "  --clusters N         synthetic cluster count (default 100)\n"
+    "  --base FILE          base vectors from an fvecs file\n"
+    "  --query FILE         queries from an fvecs file\n"
+    "  --groundtruth FILE   neighbour ids from an ivecs file\n"
+    "  --metric NAME        cosine, euclidean or dot (default euclidean)\n"
+    "  --storage NAME       fp32, fp16 or bf16 rows (default fp32)\n"
+    "  --k N                neighbours per query (default 10)\n"
+    "  --threads LIST       concurrent query threads (default 1)\n"
+    "  --indexes LIST       flat,hnsw,ivf,sq,pq,binary (default all)\n"
+    "  --batch N            queries per searchBatch call (default 64)\n"
+    "  --ef N               HNSW efSearch (default 64)\n"
+    "  --nprobe N           IVF lists probed (default 16)\n"
+    "  --rerank N           SQ/PQ rescoring factor (default 4)\n"
+    "  --binary-rerank N    binary rescoring factor (default 16)\n"
+    "  --format NAME        jsonl or csv (default jsonl)\n"
+    "  --output FILE        write results to FILE instead of stdout\n"
+    "  --seed N             synthetic data seed (default 42)\n";
+
+struct Options {
+  std::vector<size_t> dims = {128};
+  size_t count = 100000;
+  size_t queries = 1000;
+  size_t clusters = 100;
+  std::string baseFile;
+  std::string queryFile;
+  std::string groundTruthFile;
+  Metric metric = Metric::Euclidean;
+  ElementType storage = ElementType::Float32;
+  size_t k = 10;
+  std::vector<size_t> threads = {1};
+  std::vector<std::string> indexes = {"flat", "hnsw", "ivf",
+                                      "sq",   "pq",   "binary"};
+  size_t batch = 64;
+  size_t ef = 64;
+  size_t nprobe = 16;
+  size_t rerank = 4;
+  size_t binaryRerank = 16;
+  std::string format = "jsonl";
+  std::string output;
+  uint32_t seed = 42;
+};
+
+struct Dataset {
+  std::string name;
+  size_t dimension = 0;
+  size_t count = 0;
+  size_t numQueries = 0;
+  std::vector<float> base;    // count x dimension
+  std::vector<float> queries; // numQueries x dimension
+  // Optional reference neighbours (row numbers into base), k per query
+  std::vector<std::vector<uint32_t>> groundTruth;
+};
+
+// One measurement; values are kept as text so both writers can share them
+class Row {
+public:
+  struct Field {
+    std::string key;
+    std::string value;
+    bool quoted; // a string value rather than a number
+  };
+
+  Row &set(const std::string &key, const std::string &value) {
+    fields_.push_back({key, value, true});
+    return *this;
+  }
+
+  Row &set(const std::string &key, double value) {
+    std::ostringstream ss;
+    ss << std::setprecision(6) << value;
+    fields_.push_back({key, ss.str(), false});
+    return *this;
+  }
+
+  Row &append(const Row &other) {
+    fields_.insert(fields_.end(), other.fields_.begin(), other.fields_.end());
+    return *this;
+  }
+
+  const std::vector<Field> &fields() const { return fields_; }
+
+private:
+  std::vector<Field> fields_;
+};
+
+// JSON string literal for `text`: quotes, backslashes and control
+// characters are escaped.
+std::string jsonString(const std::string &text) {
+  std::ostringstream ss;
+  ss << '"';
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      ss << "\\\"";
+      break;
+    case '\\':
+      ss << "\\\\";
+      break;
+    case '\n':
+      ss << "\\n";
+      break;
+    case '\r':
+      ss << "\\r";
+      break;
+    case '\t':
+      ss << "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        ss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+           << static_cast<int>(c) << std::dec << std::setfill(' ');
+      } else {
+        ss << c;
+      }
+    }
+  }
+  ss << '"';
+  return ss.str();
+}
+
+// CSV cell for `text`, quoted (with doubled quotes) only when it holds a
+// separator, quote or line break.
+std::string csvCell(const std::string &text) {
+  if (text.find_first_of(",\"\r\n") == std::string::npos) {
+    return text;
+  }
+  std::string cell = "\"";
+  for (char c : text) {
+    cell += c == '"' ? "\"\"" : std::string(1, c);
+  }
+  return cell + "\"";
+}
+
+class Reporter {
+public:
+  Reporter(std::ostream &out, const std::string &format)
+      : out_(out), csv_(format == "csv") {
+    if (csv_) {
+      for (size_t i = 0; i < kColumns.size(); ++i) {
+        out_ << (i ? "," : "") << kColumns[i];
+      }
+      out_ << "\n";
+    }
+  }
+
+  void write(const Row &row) {
+    if (!csv_) {
+      out_ << "{";
+      for (size_t i = 0; i < row.fields().size(); ++i) {
+        const Row::Field &field = row.fields()[i];
+        out_ << (i ? ", " : "") << jsonString(field.key) << ": "
+             << (field.quoted ? jsonString(field.value) : field.value);
+      }
+      out_ << "}\n";
+    } else {
+      std::map<std::string, std::string> values;
+      for (const Row::Field &field : row.fields()) {
+        values[field.key] = field.quoted ? csvCell(field.value) : field.value;
+      }
+      for (size_t i = 0; i < kColumns.size(); ++i) {
+        out_ << (i ? "," : "") << values[kColumns[i]];
+      }
+      out_ << "\n";
+    }
+    out_.flush();
+  }
+
+private:
+  const std::vector<std::string> kColumns = {
+      "benchmark", "dataset", "index",   "metric",  "storage",
+      "dimension", "count",   "queries", "k",       "threads",
+      "batch",     "seconds", "vectors_per_sec",    "qps",
+      "p50_us",    "p99_us",  "recall"};
+
+  std::ostream &out_;
+  bool csv_;
+};
+
+std::vector<std::string> splitList(const std::string &text) {
+  std::vector<std::string> items;
+  std::stringstream ss(text);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+std::vector<size_t> splitSizes(const std::string &text) {
+  std::vector<size_t> values;
+  for (const std::string &item : splitList(text)) {
+    values.push_back(std::stoul(item));
+  }
+  return values;
+}
+
+Options parseOptions(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string flag = argv[i];
+    if (flag == "--help" || flag == "-h") {
+      std::cout << kUsage;
+      std::exit(0);
+    }
+    if (i + 1 >= argc) {
+      throw std::invalid_argument("Missing value for " + flag);
+    }
+    std::string value = argv[++i];
+    if (flag == "--dims") {
+      options.dims = splitSizes(value);
+    } else if (flag == "--count") {
+      options.count = std::stoul(value);
+    } else if (flag == "--queries") {
+      options.queries = std::stoul(value);
+    } else if (flag == "--clusters") {
+      options.clusters = std::stoul(value);
+    } else if (flag == "--base") {
+      options.baseFile = value;
+    } else if (flag == "--query") {
+      options.queryFile = value;
+    } else if (flag == "--groundtruth") {
+      options.groundTruthFile = value;
+    } else if (flag == "--metric") {
+      if (value == "cosine") {
+        options.metric = Metric::Cosine;
+      } else if (value == "euclidean") {
+        options.metric = Metric::Euclidean;
+      } else if (value == "dot") {
+        options.metric = Metric::DotProduct;
+      } else {
+        throw std::invalid_argument("Unknown metric " + value);
+      }
+    } else if (flag == "--storage") {
+      if (value == "fp32") {
+        options.storage = ElementType::Float32;
+      } else if (value == "fp16") {
+        options.storage = ElementType::Float16;
+      } else if (value == "bf16") {
+        options.storage = ElementType::BFloat16;
+      } else {
+        throw std::invalid_argument("Unknown storage type " + value);
+      }
+    } else if (flag == "--k") {
+      options.k = std::stoul(value);
+    } else if (flag == "--threads") {
+      options.threads = splitSizes(value);
+    } else if (flag == "--indexes") {
+      options.indexes = splitList(value);
+    } else if (flag == "--batch") {
+      options.batch = std::stoul(value);
+    } else if (flag == "--ef") {
+      options.ef = std::stoul(value);
+    } else if (flag == "--nprobe") {
+      options.nprobe = std::stoul(value);
+    } else if (flag == "--rerank") {
+      options.rerank = std::stoul(value);
+    } else if (flag == "--binary-rerank") {
+      options.binaryRerank = std::stoul(value);
+    } else if (flag == "--format") {
+      if (value != "jsonl" && value != "csv") {
+        throw std::invalid_argument("Unknown format " + value);
+      }
+      options.format = value;
+    } else if (flag == "--output") {
+      options.output = value;
+    } else if (flag == "--seed") {
+      options.seed = static_cast<uint32_t>(std::stoul(value));
+    } else {
+      throw std::invalid_argument("Unknown option " + flag);
+    }
+  }
+  if (options.baseFile.empty() != options.queryFile.empty()) {
+    throw std::invalid_argument("--base and --query must be given together");
+  }
+  if (options.k == 0 || options.batch == 0) {
+    throw std::invalid_argument("--k and --batch must be positive");
+  }
+  return options;
+}
+
+const char *metricName(Metric metric) {
+  switch (metric) {
+  case Metric::DotProduct:
+    return "dot";
+  case Metric::Euclidean:
+    return "euclidean";
+  default:
+    return "cosine";
+  }
+}
+
+// Reads the fvecs/ivecs layout: per vector an int32 dimension followed by
+// that many 4-byte values.
+template <typename T>
+std::vector<T> readVecs(const std::string &path, size_t &dimension,
+                        size_t &count, size_t limit) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+
+  std::vector<T> values;
+  dimension = 0;
+  count = 0;
+  int32_t d;
+  while (count < limit &&
+         in.read(reinterpret_cast<char *>(&d), sizeof(d))) {
+    if (d <= 0 || (dimension != 0 && static_cast<size_t>(d) != dimension)) {
+      throw std::runtime_error(path + " has inconsistent dimensions");
+    }
+    dimension = static_cast<size_t>(d);
+    values.resize((count + 1) * dimension);
+    if (!in.read(reinterpret_cast<char *>(values.data() + count * dimension),
+                 static_cast<std::streamsize>(dimension * sizeof(T)))) {
+      throw std::runtime_error(path + " is truncated");
+    }
+    ++count;
+  }
+  return values;
+}
+
+Dataset loadFiles(const Options &options) {
+  Dataset data;
+  data.name = options.baseFile;
+  size_t queryDimension = 0;
+  data.base = readVecs<float>(options.baseFile, data.dimension, data.count,
+                              options.count);
+  data.queries = readVecs<float>(options.queryFile, queryDimension,
+                                 data.numQueries, options.queries);
+  if (queryDimension != data.dimension) {
+    throw std::runtime_error("Query and base dimensions differ");
+  }
+
+  if (!options.groundTruthFile.empty()) {
+    size_t width = 0;
+    size_t rows = 0;
+    std::vector<int32_t> ids = readVecs<int32_t>(
+        options.groundTruthFile, width, rows, data.numQueries);
+    if (rows != data.numQueries || width < options.k) {
+      throw std::runtime_error("Ground truth does not cover the queries");
+    }
+    // Only neighbours inside a --count prefix of the base can be found
+    for (size_t q = 0; q < rows; ++q) {
+      std::vector<uint32_t> truth;
+      for (size_t i = 0; i < width && truth.size() < options.k; ++i) {
+        if (static_cast<size_t>(ids[q * width + i]) < data.count) {
+          truth.push_back(static_cast<uint32_t>(ids[q * width + i]));
+        }
+      }
+      data.groundTruth.push_back(std::move(truth));
+    }
+  }
+  return data;
+}
+
+// Gaussian blobs around random centres; queries are drawn from the same
+// mixture so they land near real data, as they do in practice.
+Dataset syntheticDataset(const Options &options, size_t dimension) {
+  Dataset data;
+  data.name = "synthetic";
+  data.dimension = dimension;
+  data.count = options.count;
+  data.numQueries = options.queries;
+
+  std::mt19937 rng(options.seed + static_cast<uint32_t>(dimension));
+  std::uniform_real_distribution<float> centre(-1.0f, 1.0f);
+  std::normal_distribution<float> noise(0.0f, 0.25f);
+  const size_t clusters = std::max<size_t>(1, options.clusters);
+  std::vector<float> centres(clusters * dimension);
+  for (float &x : centres) {
+    x = centre(rng);
+  }
+
+  auto fill = [&](std::vector<float> &out, size_t rows) {
+    out.resize(rows * dimension);
+    for (size_t i = 0; i < rows; ++i) {
+      const float *c = centres.data() + (rng() % clusters) * dimension;
+      for (size_t d = 0; d < dimension; ++d) {
+        out[i * dimension + d] = c[d] + noise(rng);
+      }
+    }
+  };
+  fill(data.base, data.count);
+  fill(data.queries, data.numQueries);
+  return data;
+}
+
+std::string idOf(size_t row) { return "v" + std::to_string(row); }
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+  rank = std::min(values.size() - 1, rank == 0 ? 0 : rank - 1);
+  std::nth_element(values.begin(), values.begin() + rank, values.end());
+  return values[rank];
+}
+
+double recallOf(const std::vector<VectorStore::SearchResult> &results,
+                const std::set<std::string> &truth) {
+  if (truth.empty()) {
+    return 1.0;
+  }
+  size_t hits = 0;
+  for (const auto &r : results) {
+    hits += truth.count(r.id);
+  }
+  return static_cast<double>(hits) / truth.size();
+}
+
+using SearchFn = std::function<std::vector<VectorStore::SearchResult>(
+    const std::vector<float> &)>;
+
+// Runs every query once across `threads` workers pulling from a shared
+// counter; latency is measured per query, QPS over the whole run.
+Row runQueries(const Dataset &data, const SearchFn &search,
+               const std::vector<std::set<std::string>> &truth,
+               size_t threads) {
+  std::vector<double> latencies(data.numQueries);
+  std::vector<double> recalls(data.numQueries);
+  std::atomic<size_t> next{0};
+
+  auto worker = [&]() {
+    std::vector<float> query(data.dimension);
+    for (size_t q = next++; q < data.numQueries; q = next++) {
+      std::copy(data.queries.begin() + q * data.dimension,
+                data.queries.begin() + (q + 1) * data.dimension,
+                query.begin());
+      auto start = Clock::now();
+      auto results = search(query);
+      latencies[q] = secondsSince(start) * 1e6;
+      recalls[q] = recallOf(results, truth[q]);
+    }
+  };
+
+  auto start = Clock::now();
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  double seconds = secondsSince(start);
+
+  double recall = 0.0;
+  for (double r : recalls) {
+    recall += r;
+  }
+  Row row;
+  row.set("threads", static_cast<double>(threads))
+      .set("seconds", seconds)
+      .set("qps", data.numQueries / seconds)
+      .set("p50_us", percentile(latencies, 0.50))
+      .set("p99_us", percentile(latencies, 0.99))
+      .set("recall", data.numQueries ? recall / data.numQueries : 0.0);
+  return row;
+}
+
+Row describe(const std::string &benchmark, const Dataset &data,
+             const std::string &index, const Options &options) {
+  Row row;
+  row.set("benchmark", benchmark)
+      .set("dataset", data.name)
+      .set("index", index)
+      .set("metric", metricName(options.metric))
+      .set("storage", VectorOps::elementTypeName(options.storage))
+      .set("dimension", static_cast<double>(data.dimension))
+      .set("count", static_cast<double>(data.count))
+      .set("queries", static_cast<double>(data.numQueries))
+      .set("k", static_cast<double>(options.k));
+  return row;
+}
+
+// Builds `index` on the store; returns false for unknown names.
+bool buildIndex(VectorStore &store, const std::string &index,
+                const Options &options, size_t dimension, size_t count) {
+  if (index == "flat") {
+    return true;
+  }
+  if (index == "hnsw") {
+    HnswParams params;
+    params.metric = options.metric;
+    params.efSearch = options.ef;
+    store.enableHnswIndex(params);
+  } else if (index == "ivf") {
+    IvfParams params;
+    params.metric = options.metric;
+    params.numLists = std::max<size_t>(
+        1, std::min<size_t>(count, static_cast<size_t>(std::sqrt(count))));
+    params.nprobe = options.nprobe;
+    store.buildIvfIndex(params);
+  } else if (index == "sq") {
+    store.enableScalarQuantization(65536);
+  } else if (index == "pq") {
+    PqParams params;
+    params.metric = options.metric;
+    params.numSubspaces = dimension % 4 == 0 ? dimension / 4 : dimension;
+    store.enablePqIndex(params);
+  } else if (index == "binary") {
+    store.enableBinaryQuantization(65536);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+SearchFn searchFor(const VectorStore &store, const std::string &index,
+                   const Options &options) {
+  const size_t k = options.k;
+  const Metric metric = options.metric;
+  if (index == "hnsw") {
+    return [&store, k, &options](const std::vector<float> &q) {
+      return store.searchHnsw(q, k, options.ef);
+    };
+  }
+  if (index == "ivf") {
+    return [&store, k, &options](const std::vector<float> &q) {
+      return store.searchIvf(q, k, options.nprobe);
+    };
+  }
+  if (index == "sq") {
+    return [&store, k, metric, &options](const std::vector<float> &q) {
+      return store.searchQuantized(q, k, metric, options.rerank);
+    };
+  }
+  if (index == "pq") {
+    return [&store, k, &options](const std::vector<float> &q) {
+      return store.searchPq(q, k, options.rerank);
+    };
+  }
+  if (index == "binary") {
+    return [&store, k, metric, &options](const std::vector<float> &q) {
+      return store.searchBinary(q, k, metric, options.binaryRerank);
+    };
+  }
+  return [&store, k, metric](const std::vector<float> &q) {
+    return store.search(q, k, metric);
+  };
+}
+
+void runDataset(const Dataset &data, const Options &options,
+                Reporter &reporter) {
+  std::cerr << "dataset " << data.name << ": " << data.count << " x "
+            << data.dimension << ", " << data.numQueries << " queries\n";
+
+  std::vector<std::string> ids(data.count);
+  for (size_t i = 0; i < data.count; ++i) {
+    ids[i] = idOf(i);
+  }
+
+  for (const std::string &index : options.indexes) {
+    VectorStore store(data.dimension, options.metric, options.storage);
+
+    auto start = Clock::now();
+    store.addVectors(data.base.data(), data.count, ids);
+    double seconds = secondsSince(start);
+    reporter.write(describe("ingest", data, index, options)
+                       .set("seconds", seconds)
+                       .set("vectors_per_sec", data.count / seconds));
+
+    // Reference neighbours: the ground-truth file, or exact search
+    std::vector<std::set<std::string>> truth(data.numQueries);
+    for (size_t q = 0; q < data.numQueries; ++q) {
+      if (!data.groundTruth.empty()) {
+        for (uint32_t row : data.groundTruth[q]) {
+          truth[q].insert(idOf(row));
+        }
+        continue;
+      }
+      std::vector<float> query(data.queries.begin() + q * data.dimension,
+                               data.queries.begin() +
+                                   (q + 1) * data.dimension);
+      for (const auto &r : store.search(query, options.k, options.metric)) {
+        truth[q].insert(r.id);
+      }
+    }
+
+    start = Clock::now();
+    if (!buildIndex(store, index, options, data.dimension, data.count)) {
+      std::cerr << "skipping unknown index " << index << "\n";
+      continue;
+    }
+    if (index != "flat") {
+      seconds = secondsSince(start);
+      reporter.write(describe("build", data, index, options)
+                         .set("seconds", seconds)
+                         .set("vectors_per_sec", data.count / seconds));
+    }
+
+    SearchFn search = searchFor(store, index, options);
+    for (size_t threads : options.threads) {
+      reporter.write(describe("search", data, index, options)
+                         .append(runQueries(data, search, truth,
+                                            std::max<size_t>(1, threads))));
+    }
+
+    if (index == "flat") {
+      // Batched exact search: one pass over the store per batch
+      std::vector<double> latencies;
+      double recall = 0.0;
+      start = Clock::now();
+      for (size_t first = 0; first < data.numQueries;
+           first += options.batch) {
+        size_t n = std::min(options.batch, data.numQueries - first);
+        auto batchStart = Clock::now();
+        auto results =
+            store.searchBatch(data.queries.data() + first * data.dimension, n,
+                              options.k, options.metric);
+        latencies.push_back(secondsSince(batchStart) * 1e6);
+        for (size_t i = 0; i < n; ++i) {
+          recall += recallOf(results[i], truth[first + i]);
+        }
+      }
+      seconds = secondsSince(start);
+      reporter.write(describe("batch", data, index, options)
+                         .set("batch", static_cast<double>(options.batch))
+                         .set("seconds", seconds)
+                         .set("qps", data.numQueries / seconds)
+                         .set("p50_us", percentile(latencies, 0.50))
+                         .set("p99_us", percentile(latencies, 0.99))
+                         .set("recall", data.numQueries
+                                            ? recall / data.numQueries
+                                            : 0.0));
+    }
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  try {
+    Options options = parseOptions(argc, argv);
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+      file.open(options.output);
+      if (!file) {
+        throw std::runtime_error("Cannot write " + options.output);
+      }
+    }
+    Reporter reporter(options.output.empty() ? std::cout : file,
+                      options.format);
+
+    std::cerr << "kernels: " << VectorOps::simdLevelName(VectorOps::simdLevel())
+              << ", hardware threads: " << std::thread::hardware_concurrency()
+              << "\n";
+    if (!options.baseFile.empty()) {
+      runDataset(loadFiles(options), options, reporter);
+    } else {
+      for (size_t dimension : options.dims) {
+        runDataset(syntheticDataset(options, dimension), options, reporter);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "error: " << e.what() << "\n\n" << kUsage;
+    return 1;
+  }
+  return 0;
+}
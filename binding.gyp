@@ -0,0 +1,48 @@
+{
+  "targets": [
+    {
+      "target_name": "vectorsearch",
+      "sources": [
+        "bindings/vectorsearch_addon.cpp",
+        "src/ann/binary_quantizer.cpp",
+        "src/ann/hnsw_index.cpp",
+        "src/ann/ivf_index.cpp",
+        "src/ann/kmeans.cpp",
+        "src/ann/product_quantizer.cpp",
+        "src/ann/scalar_quantizer.cpp",
+        "src/ann/vector_ops.cpp",
+        "src/common/binary_io.cpp",
+        "src/common/bitmap.cpp",
+        "src/common/crc32c.cpp",
+        "src/common/histogram.cpp",
+        "src/common/id_table.cpp",
+        "src/common/string_dictionary.cpp",
+        "src/common/thread_pool.cpp",
+        "src/engine/attribute_index.cpp",
+        "src/engine/embedding_arena.cpp",
+        "src/engine/filter.cpp",
+        "src/engine/query_cache.cpp",
+        "src/engine/store_metrics.cpp",
+        "src/engine/vector_store.cpp",
+        "src/engine/vector_store_cursor.cpp",
+        "src/engine/vector_store_snapshot.cpp",
+        "src/storage/mapped_file.cpp",
+        "src/storage/write_ahead_log.cpp"
+      ],
+      "include_dirs": [
+        "<!(node -p \"require('node-addon-api').include_dir\")",
+        "src"
+      ],
+      "defines": ["NAPI_VERSION=8", "NAPI_CPP_EXCEPTIONS"],
+      "cflags!": ["-fno-exceptions"],
+      "cflags_cc!": ["-fno-exceptions", "-fno-rtti"],
+      "cflags_cc": ["-std=c++17", "-O3"],
+      "xcode_settings": {
+        "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+        "GCC_ENABLE_CPP_RTTI": "YES",
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+        "MACOSX_DEPLOYMENT_TARGET": "10.15"
+      }
+    }
+  ]
+}
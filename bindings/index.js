@@ -0,0 +1,21 @@
+'use strict';
+
+// Loads the addon built by `node-gyp rebuild` (see binding.gyp).
+const path = require('path');
+
+function load() {
+  const errors = [];
+  for (const config of ['Release', 'Debug']) {
+    const file =
+        path.join(__dirname, '..', 'build', config, 'vectorsearch.node');
+    try {
+      return require(file);
+    } catch (error) {
+      errors.push(error.message);
+    }
+  }
+  throw new Error('vectorsearch addon is not built; run `npm install` or ' +
+                  '`npx node-gyp rebuild`\n' + errors.join('\n'));
+}
+
+module.exports = load();
@@ -0,0 +1,385 @@
+// bindings/vectorsearch_addon.cpp
+//
+// Node.js binding for VectorStore. Embeddings and queries are passed as
+// Float32Array and read in place: the array is pinned by a reference for the
+// lifetime of the call instead of being copied into a std::vector. Every
+// store operation runs on the libuv thread pool through an AsyncWorker and
+// returns a Promise, so the event loop is never blocked by a scan or an
+// index insert. VectorStore does its own locking, so any number of calls may
+// be in flight on one store.
+#include "engine/vector_store.h"
+#include <napi.h>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using vectorsearch::ElementType;
+using vectorsearch::Metric;
+using vectorsearch::VectorStore;
+
+Metric parseMetric(Napi::Env env, const std::string &name) {
+  if (name == "cosine") {
+    return Metric::Cosine;
+  }
+  if (name == "euclidean") {
+    return Metric::Euclidean;
+  }
+  if (name == "dot") {
+    return Metric::DotProduct;
+  }
+  throw Napi::TypeError::New(env, "Unknown metric " + name);
+}
+
+ElementType parseStorage(Napi::Env env, const std::string &name) {
+  if (name == "fp32") {
+    return ElementType::Float32;
+  }
+  if (name == "fp16") {
+    return ElementType::Float16;
+  }
+  if (name == "bf16") {
+    return ElementType::BFloat16;
+  }
+  throw Napi::TypeError::New(env, "Unknown storage type " + name);
+}
+
+// Argument helpers; each throws a TypeError naming the argument.
+
+Napi::Float32Array float32ArrayArg(const Napi::CallbackInfo &info,
+                                   size_t index, const char *name) {
+  if (info.Length() <= index || !info[index].IsTypedArray() ||
+      info[index].As<Napi::TypedArray>().TypedArrayType() !=
+          napi_float32_array) {
+    throw Napi::TypeError::New(info.Env(),
+                               std::string(name) + " must be a Float32Array");
+  }
+  return info[index].As<Napi::Float32Array>();
+}
+
+size_t sizeArg(const Napi::CallbackInfo &info, size_t index,
+               const char *name) {
+  double value = info.Length() > index && info[index].IsNumber()
+                     ? info[index].As<Napi::Number>().DoubleValue()
+                     : -1.0;
+  if (!(value >= 1.0) || value != std::floor(value)) {
+    throw Napi::TypeError::New(info.Env(), std::string(name) +
+                                               " must be a positive integer");
+  }
+  return static_cast<size_t>(value);
+}
+
+std::string stringArg(const Napi::CallbackInfo &info, size_t index,
+                      const char *name) {
+  if (info.Length() <= index || !info[index].IsString()) {
+    throw Napi::TypeError::New(info.Env(),
+                               std::string(name) + " must be a string");
+  }
+  return info[index].As<Napi::String>().Utf8Value();
+}
+
+std::vector<std::string> stringArrayArg(Napi::Env env, Napi::Value value,
+                                        const char *name) {
+  if (!value.IsArray()) {
+    throw Napi::TypeError::New(env, std::string(name) +
+                                        " must be an array of strings");
+  }
+  Napi::Array array = value.As<Napi::Array>();
+  std::vector<std::string> strings(array.Length());
+  for (uint32_t i = 0; i < array.Length(); ++i) {
+    Napi::Value item = array.Get(i);
+    if (!item.IsString()) {
+      throw Napi::TypeError::New(env, std::string(name) +
+                                          " must be an array of strings");
+    }
+    strings[i] = item.As<Napi::String>().Utf8Value();
+  }
+  return strings;
+}
+
+// Trailing options object; missing or undefined means no options.
+Napi::Object optionsArg(const Napi::CallbackInfo &info, size_t index) {
+  if (info.Length() <= index || info[index].IsUndefined()) {
+    return Napi::Object::New(info.Env());
+  }
+  if (!info[index].IsObject()) {
+    throw Napi::TypeError::New(info.Env(), "options must be an object");
+  }
+  return info[index].As<Napi::Object>();
+}
+
+// options[key] as a string, or `fallback` when it is absent.
+std::string stringOption(Napi::Object options, const char *key,
+                         const std::string &fallback) {
+  Napi::Value value = options.Get(key);
+  if (value.IsUndefined()) {
+    return fallback;
+  }
+  if (!value.IsString()) {
+    throw Napi::TypeError::New(options.Env(),
+                               std::string("options.") + key +
+                                   " must be a string");
+  }
+  return value.As<Napi::String>().Utf8Value();
+}
+
+Napi::Array toArray(Napi::Env env,
+                    const std::vector<VectorStore::SearchResult> &results) {
+  Napi::Array array = Napi::Array::New(env, results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("id", results[i].id);
+    result.Set("score", results[i].score);
+    array.Set(static_cast<uint32_t>(i), result);
+  }
+  return array;
+}
+
+// Runs Execute() on the thread pool and settles a promise with Result() back
+// on the event loop thread. Exceptions thrown by Execute() reject it.
+class PromiseWorker : public Napi::AsyncWorker {
+public:
+  PromiseWorker(Napi::Env env, std::shared_ptr<VectorStore> store)
+      : Napi::AsyncWorker(env, "vectorsearch"), store_(std::move(store)),
+        deferred_(Napi::Promise::Deferred::New(env)) {}
+
+  // Queues the worker, which deletes itself once the promise is settled.
+  Napi::Promise start() {
+    Napi::Promise promise = deferred_.Promise();
+    Queue();
+    return promise;
+  }
+
+protected:
+  virtual Napi::Value Result(Napi::Env env) = 0;
+
+  void OnOK() override { deferred_.Resolve(Result(Env())); }
+
+  void OnError(const Napi::Error &error) override {
+    deferred_.Reject(error.Value());
+  }
+
+  // Shared with the JS object, so the store outlives a collected wrapper
+  std::shared_ptr<VectorStore> store_;
+
+private:
+  Napi::Promise::Deferred deferred_;
+};
+
+class AddWorker : public PromiseWorker {
+public:
+  AddWorker(Napi::Env env, std::shared_ptr<VectorStore> store,
+            Napi::Float32Array embeddings, std::vector<std::string> ids,
+            std::vector<std::string> documentIds,
+            std::vector<std::string> metadata, bool single)
+      : PromiseWorker(env, std::move(store)),
+        embeddings_(Napi::Persistent(embeddings)),
+        data_(embeddings.Data()), ids_(std::move(ids)),
+        document_ids_(std::move(documentIds)), metadata_(std::move(metadata)),
+        single_(single) {}
+
+protected:
+  void Execute() override {
+    added_ = store_->addVectors(data_, ids_.size(), ids_, document_ids_,
+                                metadata_);
+  }
+
+  Napi::Value Result(Napi::Env env) override {
+    if (single_) {
+      return Napi::Boolean::New(env, added_ == 1);
+    }
+    return Napi::Number::New(env, static_cast<double>(added_));
+  }
+
+private:
+  // Keeps the caller's buffer alive while the worker reads it
+  Napi::Reference<Napi::Float32Array> embeddings_;
+  const float *data_;
+  std::vector<std::string> ids_;
+  std::vector<std::string> document_ids_;
+  std::vector<std::string> metadata_;
+  bool single_;
+  size_t added_ = 0;
+};
+
+class SearchWorker : public PromiseWorker {
+public:
+  SearchWorker(Napi::Env env, std::shared_ptr<VectorStore> store,
+               Napi::Float32Array queries, size_t numQueries, size_t k,
+               Metric metric, bool single)
+      : PromiseWorker(env, std::move(store)),
+        queries_(Napi::Persistent(queries)), data_(queries.Data()),
+        num_queries_(numQueries), k_(k), metric_(metric), single_(single) {}
+
+protected:
+  void Execute() override {
+    if (single_) {
+      // The single-query path goes through the query cache and the search
+      // latency histogram, and skips the batch tiling
+      results_.assign(1, store_->search(data_, k_, metric_));
+      return;
+    }
+    results_ = store_->searchBatch(data_, num_queries_, k_, metric_);
+  }
+
+  Napi::Value Result(Napi::Env env) override {
+    if (single_) {
+      return toArray(env, results_[0]);
+    }
+    Napi::Array array = Napi::Array::New(env, results_.size());
+    for (size_t q = 0; q < results_.size(); ++q) {
+      array.Set(static_cast<uint32_t>(q), toArray(env, results_[q]));
+    }
+    return array;
+  }
+
+private:
+  Napi::Reference<Napi::Float32Array> queries_;
+  const float *data_;
+  size_t num_queries_;
+  size_t k_;
+  Metric metric_;
+  bool single_;
+  std::vector<std::vector<VectorStore::SearchResult>> results_;
+};
+
+// JS class:
+//
+//   new VectorStore(dimension, { metric, storage })
+//   add(id, embedding, { documentId, metadata }) -> Promise<boolean>
+//   addBatch(ids, embeddings, { documentIds, metadata }) -> Promise<number>
+//   search(query, k, { metric }) -> Promise<[{ id, score }]>
+//   searchBatch(queries, k, { metric }) -> Promise<[[{ id, score }]]>
+//   size, dimension
+//
+// Metrics are "cosine", "euclidean" or "dot"; storage is "fp32", "fp16" or
+// "bf16". Batches are row-major Float32Arrays of count x dimension. Arrays
+// must not be modified until the returned promise settles.
+class VectorStoreWrap : public Napi::ObjectWrap<VectorStoreWrap> {
+public:
+  static Napi::Function define(Napi::Env env) {
+    return DefineClass(
+        env, "VectorStore",
+        {InstanceMethod("add", &VectorStoreWrap::add),
+         InstanceMethod("addBatch", &VectorStoreWrap::addBatch),
+         InstanceMethod("search", &VectorStoreWrap::search),
+         InstanceMethod("searchBatch", &VectorStoreWrap::searchBatch),
+         InstanceAccessor("size", &VectorStoreWrap::size, nullptr),
+         InstanceAccessor("dimension", &VectorStoreWrap::dimension, nullptr)});
+  }
+
+  explicit VectorStoreWrap(const Napi::CallbackInfo &info)
+      : Napi::ObjectWrap<VectorStoreWrap>(info) {
+    const size_t dimension = sizeArg(info, 0, "dimension");
+    Napi::Object options = optionsArg(info, 1);
+    const std::string metric = stringOption(options, "metric", "");
+    store_ = std::make_shared<VectorStore>(
+        dimension,
+        metric.empty() ? std::nullopt
+                       : std::optional<Metric>(parseMetric(info.Env(), metric)),
+        parseStorage(info.Env(), stringOption(options, "storage", "fp32")));
+  }
+
+private:
+  Napi::Value add(const Napi::CallbackInfo &info) {
+    std::string id = stringArg(info, 0, "id");
+    Napi::Float32Array embedding = float32ArrayArg(info, 1, "embedding");
+    checkLength(info.Env(), embedding, 1, "embedding");
+    Napi::Object options = optionsArg(info, 2);
+    auto *worker = new AddWorker(
+        info.Env(), store_, embedding, {std::move(id)},
+        {stringOption(options, "documentId", "")},
+        {stringOption(options, "metadata", "")}, true);
+    return worker->start();
+  }
+
+  Napi::Value addBatch(const Napi::CallbackInfo &info) {
+    std::vector<std::string> ids = stringArrayArg(info.Env(), info[0], "ids");
+    Napi::Float32Array embeddings = float32ArrayArg(info, 1, "embeddings");
+    checkLength(info.Env(), embeddings, ids.size(), "embeddings");
+    Napi::Object options = optionsArg(info, 2);
+    std::vector<std::string> documentIds;
+    std::vector<std::string> metadata;
+    if (!options.Get("documentIds").IsUndefined()) {
+      documentIds = stringArrayArg(info.Env(), options.Get("documentIds"),
+                                   "options.documentIds");
+    }
+    if (!options.Get("metadata").IsUndefined()) {
+      metadata = stringArrayArg(info.Env(), options.Get("metadata"),
+                                "options.metadata");
+    }
+    // VectorStore::addVectors reports mismatched lengths by throwing, which
+    // rejects the promise
+    auto *worker =
+        new AddWorker(info.Env(), store_, embeddings, std::move(ids),
+                      std::move(documentIds), std::move(metadata), false);
+    return worker->start();
+  }
+
+  Napi::Value search(const Napi::CallbackInfo &info) {
+    Napi::Float32Array query = float32ArrayArg(info, 0, "query");
+    checkLength(info.Env(), query, 1, "query");
+    const size_t k = sizeArg(info, 1, "k");
+    auto *worker = new SearchWorker(info.Env(), store_, query, 1, k,
+                                    metricOption(info, 2), true);
+    return worker->start();
+  }
+
+  Napi::Value searchBatch(const Napi::CallbackInfo &info) {
+    Napi::Float32Array queries = float32ArrayArg(info, 0, "queries");
+    const size_t dimension = store_->getDimension();
+    if (queries.ElementLength() % dimension != 0) {
+      throw Napi::RangeError::New(
+          info.Env(), "queries length must be a multiple of the dimension");
+    }
+    const size_t k = sizeArg(info, 1, "k");
+    auto *worker =
+        new SearchWorker(info.Env(), store_, queries,
+                         queries.ElementLength() / dimension, k,
+                         metricOption(info, 2), false);
+    return worker->start();
+  }
+
+  Napi::Value size(const Napi::CallbackInfo &info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(store_->size()));
+  }
+
+  Napi::Value dimension(const Napi::CallbackInfo &info) {
+    return Napi::Number::New(info.Env(),
+                             static_cast<double>(store_->getDimension()));
+  }
+
+  // Search metric from options.metric, defaulting to the store metric and
+  // then to cosine like VectorStore::search.
+  Metric metricOption(const Napi::CallbackInfo &info, size_t index) const {
+    const std::string name =
+        stringOption(optionsArg(info, index), "metric", "");
+    if (name.empty()) {
+      return store_->getMetric().value_or(Metric::Cosine);
+    }
+    return parseMetric(info.Env(), name);
+  }
+
+  void checkLength(Napi::Env env, const Napi::Float32Array &array,
+                   size_t rows, const char *name) const {
+    if (array.ElementLength() != rows * store_->getDimension()) {
+      throw Napi::RangeError::New(
+          env, std::string(name) + " must hold " +
+                   std::to_string(rows * store_->getDimension()) +
+                   " floats");
+    }
+  }
+
+  std::shared_ptr<VectorStore> store_;
+};
+
+Napi::Object init(Napi::Env env, Napi::Object exports) {
+  exports.Set("VectorStore", VectorStoreWrap::define(env));
+  return exports;
+}
+
+} // anonymous namespace
+
+NODE_API_MODULE(vectorsearch, init)
@@ -0,0 +1,70 @@
+// src/ann/binary_quantizer.cpp
+#include "binary_quantizer.h"
+#include "common/binary_io.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace vectorsearch {
+
+BinaryQuantizer::BinaryQuantizer(size_t dimension)
+    : dimension_(dimension), words_((dimension + 63) / 64),
+      thresholds_(dimension, 0.0f) {}
+
+void BinaryQuantizer::train(const float *data, size_t count, size_t stride) {
+  if (count == 0) {
+    throw std::invalid_argument("Cannot train a quantizer without data");
+  }
+
+  // Accumulate in double so large samples do not lose the mean
+  std::vector<double> sums(dimension_, 0.0);
+  for (size_t i = 0; i < count; ++i) {
+    const float *row = data + i * stride;
+    for (size_t d = 0; d < dimension_; ++d) {
+      sums[d] += row[d];
+    }
+  }
+  for (size_t d = 0; d < dimension_; ++d) {
+    thresholds_[d] = static_cast<float>(sums[d] / static_cast<double>(count));
+  }
+  trained_ = true;
+}
+
+bool BinaryQuantizer::isTrained() const { return trained_; }
+
+void BinaryQuantizer::encode(const float *vector, uint64_t *code) const {
+  for (size_t w = 0; w < words_; ++w) {
+    const size_t begin = w * 64;
+    const size_t end = std::min(dimension_, begin + 64);
+    uint64_t bits = 0;
+    for (size_t d = begin; d < end; ++d) {
+      bits |= static_cast<uint64_t>(vector[d] > thresholds_[d]) << (d - begin);
+    }
+    code[w] = bits;
+  }
+}
+
+size_t BinaryQuantizer::getDimension() const { return dimension_; }
+
+const std::vector<float> &BinaryQuantizer::getThresholds() const {
+  return thresholds_;
+}
+
+void BinaryQuantizer::save(BinaryWriter &out) const {
+  out.write<uint8_t>(trained_ ? 1 : 0);
+  out.writeArray(thresholds_);
+}
+
+std::unique_ptr<BinaryQuantizer> BinaryQuantizer::load(BinaryReader &in) {
+  bool trained = in.read<uint8_t>() != 0;
+  std::vector<float> thresholds = in.readArray<float>();
+  if (thresholds.empty()) {
+    BinaryReader::fail("invalid binary quantizer");
+  }
+
+  auto quantizer = std::make_unique<BinaryQuantizer>(thresholds.size());
+  quantizer->trained_ = trained;
+  quantizer->thresholds_ = std::move(thresholds);
+  return quantizer;
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,55 @@
+// src/ann/binary_quantizer.h
+#pragma once
+
+#include "vector_ops.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vectorsearch {
+
+class BinaryReader;
+class BinaryWriter;
+
+// Sign-bit (1-bit) quantizer. Each dimension is reduced to whether it lies
+// above a trained threshold, the mean of that dimension over the training
+// rows, and the bits are packed 64 to a word: a code is 32x smaller than the
+// fp32 vector. Centering first keeps the bits balanced for embeddings that
+// are not zero-mean.
+//
+// The Hamming distance between two codes estimates the angle between the
+// centered vectors, so it ranks neighbours roughly for every metric but is
+// only meant to pick a shortlist for exact rescoring.
+class BinaryQuantizer {
+public:
+  explicit BinaryQuantizer(size_t dimension);
+
+  // Learns the thresholds from `count` rows spaced `stride` floats apart.
+  void train(const float *data, size_t count, size_t stride);
+
+  bool isTrained() const;
+
+  // Writes codeWords() words for `vector`; padding bits are zero.
+  void encode(const float *vector, uint64_t *code) const;
+
+  size_t codeWords() const { return words_; }
+
+  size_t getDimension() const;
+
+  const std::vector<float> &getThresholds() const;
+
+  void save(BinaryWriter &out) const;
+
+  // Restores a quantizer written by save(). Throws std::runtime_error if the
+  // data is malformed.
+  static std::unique_ptr<BinaryQuantizer> load(BinaryReader &in);
+
+private:
+  size_t dimension_;
+  size_t words_;
+  std::vector<float> thresholds_;
+  bool trained_ = false;
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,836 @@
+// src/ann/hnsw_index.cpp
+#include "hnsw_index.h"
+#include "common/binary_io.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+
+// Per-thread visited marks. Bumping the epoch invalidates every mark without
+// touching the array, so a search costs nothing proportional to index size.
+struct VisitedList {
+  std::vector<uint32_t> marks;
+  uint32_t epoch = 0;
+
+  void reset(size_t capacity) {
+    if (marks.size() < capacity) {
+      marks.resize(capacity, 0);
+    }
+    if (++epoch == 0) {
+      std::fill(marks.begin(), marks.end(), 0);
+      epoch = 1;
+    }
+  }
+
+  bool visit(uint32_t node) {
+    if (marks[node] == epoch) {
+      return false;
+    }
+    marks[node] = epoch;
+    return true;
+  }
+};
+
+VisitedList &visitedList(size_t capacity) {
+  thread_local VisitedList list;
+  list.reset(capacity);
+  return list;
+}
+
+// Per-thread rows for vectors a source converts on load; two, so both ends
+// of a node-to-node distance can be held at once
+float *scratchRow(size_t which, size_t dimension) {
+  thread_local std::vector<float> rows[2];
+  if (rows[which].size() < dimension) {
+    rows[which].resize(dimension);
+  }
+  return rows[which].data();
+}
+
+using Neighbor = vectorsearch::Neighbor;
+
+// Candidates ordered closest-first / farthest-first
+using MinQueue =
+    std::priority_queue<Neighbor, std::vector<Neighbor>, std::greater<>>;
+using MaxQueue = std::priority_queue<Neighbor>;
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+HnswIndex::HnswIndex(size_t dimension, const HnswParams &params,
+                     const VectorSource *source)
+    : dimension_(dimension), params_(params), source_(source),
+      distance_metric_(params.metric == Metric::Cosine &&
+                               (!source || source->unitLength())
+                           ? Metric::DotProduct
+                           : params.metric),
+      distance_(VectorOps::distanceKernel(distance_metric_, dimension)),
+      max_m_(params.M), max_m0_(params.M * 2),
+      level_multiplier_(1.0 / std::log(static_cast<double>(
+                                  std::max<size_t>(params.M, 2)))),
+      rng_(params.seed) {
+  if (dimension == 0) {
+    throw std::invalid_argument("HNSW dimension must be positive");
+  }
+  if (params.M < 2) {
+    throw std::invalid_argument("HNSW parameter M must be at least 2");
+  }
+  grow(std::max<size_t>(params.initialCapacity, 1));
+}
+
+HnswIndex::~HnswIndex() { freeRetained(capacity_); }
+
+void HnswIndex::add(uint32_t label, const float *vector) {
+  std::shared_lock<std::shared_mutex> resizeLock(resize_mutex_);
+  std::unique_lock<std::mutex> globalLock(global_mutex_);
+
+  while (node_count_ == capacity_) {
+    globalLock.unlock();
+    resizeLock.unlock();
+    {
+      std::unique_lock<std::shared_mutex> growLock(resize_mutex_);
+      if (node_count_ == capacity_) {
+        grow(capacity_ * 2);
+      }
+    }
+    resizeLock.lock();
+    globalLock.lock();
+  }
+
+  // Replacing a label retires the old node
+  auto it = label_to_node_.find(label);
+  if (it != label_to_node_.end()) {
+    retain(it->second);
+    deleted_[it->second].store(true, std::memory_order_release);
+    --live_count_;
+  }
+
+  const NodeId node = static_cast<NodeId>(node_count_++);
+  const int level = randomLevel();
+  label_to_node_[label] = node;
+  ++live_count_;
+
+  // The insertion searches use the node's vector as the query; a source
+  // already holds it as the distance kernel expects
+  const float *data = vector;
+  if (!source_) {
+    float *copy = vectors_.data() + static_cast<size_t>(node) * dimension_;
+    std::memcpy(copy, vector, dimension_ * sizeof(float));
+    if (params_.metric == Metric::Cosine) {
+      float norm = std::sqrt(VectorOps::dotProduct(copy, copy, dimension_));
+      if (norm > 0.0f) {
+        for (size_t i = 0; i < dimension_; ++i) {
+          copy[i] /= norm;
+        }
+      }
+    }
+    data = copy;
+  }
+  levels_[node] = level;
+  labels_[node] = label;
+  upper_links_[node].assign(static_cast<size_t>(level) * (max_m_ + 1), 0);
+  linksOf(node, 0)[0] = 0;
+  deleted_[node].store(false, std::memory_order_release);
+
+  if (max_level_ < 0) {
+    entry_point_ = node;
+    max_level_ = level;
+    return;
+  }
+
+  NodeId entry = entry_point_;
+  const int maxLevel = max_level_;
+  // A node that raises the top level becomes the new entry point; keep the
+  // global lock so no other insert races to do the same.
+  if (level <= maxLevel) {
+    globalLock.unlock();
+  }
+
+  if (level < maxLevel) {
+    entry = greedyDescend(data, entry, maxLevel, level + 1);
+  }
+
+  for (int lc = std::min(level, maxLevel); lc >= 0; --lc) {
+    std::vector<Neighbor> candidates =
+        searchLayer(data, entry, params_.efConstruction, lc, false);
+    std::vector<NodeId> neighbors = selectNeighbors(candidates, max_m_);
+    connect(node, neighbors, lc);
+    if (!candidates.empty()) {
+      entry = candidates.front().label;
+    }
+  }
+
+  if (level > maxLevel) {
+    entry_point_ = node;
+    max_level_ = level;
+  }
+}
+
+void HnswIndex::retainVector(uint32_t label) {
+  std::shared_lock<std::shared_mutex> resizeLock(resize_mutex_);
+  std::lock_guard<std::mutex> globalLock(global_mutex_);
+
+  auto it = label_to_node_.find(label);
+  if (it != label_to_node_.end()) {
+    retain(it->second);
+  }
+}
+
+void HnswIndex::reserve(size_t capacity) {
+  std::unique_lock<std::shared_mutex> resizeLock(resize_mutex_);
+  if (capacity > capacity_) {
+    grow(capacity);
+  }
+}
+
+bool HnswIndex::remove(uint32_t label) {
+  std::shared_lock<std::shared_mutex> resizeLock(resize_mutex_);
+  std::lock_guard<std::mutex> globalLock(global_mutex_);
+
+  auto it = label_to_node_.find(label);
+  if (it == label_to_node_.end()) {
+    return false;
+  }
+
+  // The source may hand the label to another vector once it is removed
+  retain(it->second);
+  deleted_[it->second].store(true, std::memory_order_release);
+  label_to_node_.erase(it);
+  --live_count_;
+  return true;
+}
+
+std::vector<Neighbor> HnswIndex::search(const float *query, size_t k,
+                                        size_t efSearch,
+                                        const LabelFilter &filter,
+                                        SearchStats *stats) const {
+  if (k == 0) {
+    return {};
+  }
+
+  std::vector<float> buffer;
+  const float *q = query;
+  prepareQuery(query, buffer, q);
+
+  std::shared_lock<std::shared_mutex> resizeLock(resize_mutex_);
+
+  NodeId entry;
+  int maxLevel;
+  {
+    std::lock_guard<std::mutex> globalLock(global_mutex_);
+    entry = entry_point_;
+    maxLevel = max_level_;
+  }
+  if (maxLevel < 0) {
+    return {};
+  }
+
+  entry = greedyDescend(q, entry, maxLevel, 1, stats);
+
+  size_t ef = std::max(efSearch == 0 ? params_.efSearch : efSearch, k);
+  std::vector<Neighbor> candidates =
+      searchLayer(q, entry, ef, 0, true, filter, stats);
+  if (candidates.size() > k) {
+    candidates.resize(k);
+  }
+  for (Neighbor &n : candidates) {
+    n.label = labels_[n.label];
+  }
+  return candidates;
+}
+
+size_t HnswIndex::size() const {
+  std::lock_guard<std::mutex> globalLock(global_mutex_);
+  return live_count_;
+}
+
+size_t HnswIndex::deletedCount() const {
+  std::lock_guard<std::mutex> globalLock(global_mutex_);
+  return node_count_ - live_count_;
+}
+
+std::unique_ptr<HnswIndex>
+HnswIndex::compacted(const std::vector<uint32_t> &labelMap) const {
+  std::shared_lock<std::shared_mutex> resizeLock(resize_mutex_);
+  std::lock_guard<std::mutex> globalLock(global_mutex_);
+
+  // Live nodes keep their relative order
+  constexpr NodeId kDropped = std::numeric_limits<NodeId>::max();
+  std::vector<NodeId> remap(node_count_, kDropped);
+  std::vector<NodeId> live;
+  live.reserve(live_count_);
+  for (size_t node = 0; node < node_count_; ++node) {
+    if (!deleted_[node].load(std::memory_order_acquire)) {
+      remap[node] = static_cast<NodeId>(live.size());
+      live.push_back(static_cast<NodeId>(node));
+    }
+  }
+
+  HnswParams params = params_;
+  params.initialCapacity = std::max<size_t>(live.size(), 1);
+  auto index = std::make_unique<HnswIndex>(dimension_, params, source_);
+  index->rng_ = rng_;
+
+  // Epoch marks keep the repair walk from revisiting nodes
+  std::vector<uint32_t> marks(node_count_, 0);
+  uint32_t epoch = 0;
+  std::vector<Neighbor> candidates;
+  std::vector<NodeId> frontier;
+  std::vector<NodeId> next;
+
+  for (NodeId id = 0; id < live.size(); ++id) {
+    const NodeId node = live[id];
+    const int level = levels_[node];
+    const uint32_t label =
+        labelMap.empty() ? labels_[node] : labelMap.at(labels_[node]);
+    if (!source_) {
+      std::memcpy(index->vectors_.data() +
+                      static_cast<size_t>(id) * dimension_,
+                  vectorOf(node), dimension_ * sizeof(float));
+    } else if (const float *copy =
+                   retained_[node].load(std::memory_order_acquire)) {
+      // Live but retained: the source no longer holds its vector
+      float *kept = new float[dimension_];
+      std::memcpy(kept, copy, dimension_ * sizeof(float));
+      index->retained_[id].store(kept, std::memory_order_relaxed);
+    }
+    index->levels_[id] = level;
+    index->labels_[id] = label;
+    index->upper_links_[id].assign(static_cast<size_t>(level) * (max_m_ + 1),
+                                   0);
+    index->label_to_node_[label] = id;
+
+    for (int lc = 0; lc <= level; ++lc) {
+      const uint32_t *links = linksOf(node, lc);
+      uint32_t *out = index->linksOf(id, lc);
+      const bool intact =
+          std::all_of(links + 1, links + 1 + links[0], [&](NodeId n) {
+            return remap[n] != kDropped;
+          });
+      if (intact) {
+        out[0] = links[0];
+        for (uint32_t i = 1; i <= links[0]; ++i) {
+          out[i] = remap[links[i]];
+        }
+        continue;
+      }
+
+      // Links to retired nodes are replaced by what lies behind them
+      ++epoch;
+      marks[node] = epoch;
+      candidates.clear();
+      frontier.assign(links + 1, links + 1 + links[0]);
+      for (size_t hop = 0; hop <= kRepairHops && !frontier.empty(); ++hop) {
+        next.clear();
+        for (NodeId n : frontier) {
+          if (marks[n] == epoch) {
+            continue;
+          }
+          marks[n] = epoch;
+          if (remap[n] != kDropped) {
+            candidates.push_back(
+                {distance(vectorOf(node, 0), vectorOf(n, 1)), n});
+          } else if (hop < kRepairHops) {
+            const uint32_t *behind = linksOf(n, lc);
+            next.insert(next.end(), behind + 1, behind + 1 + behind[0]);
+          }
+        }
+        frontier.swap(next);
+      }
+      std::sort(candidates.begin(), candidates.end());
+
+      std::vector<NodeId> selected = selectNeighbors(candidates, maxLinks(lc));
+      out[0] = static_cast<uint32_t>(selected.size());
+      for (size_t i = 0; i < selected.size(); ++i) {
+        out[1 + i] = remap[selected[i]];
+      }
+    }
+  }
+
+  index->node_count_ = live.size();
+  index->live_count_ = live.size();
+  if (!live.empty()) {
+    // Keep the entry point if it survived, else promote the highest node
+    NodeId entry = remap[entry_point_] != kDropped ? remap[entry_point_] : 0;
+    for (NodeId id = 0; id < live.size(); ++id) {
+      if (index->levels_[id] > index->levels_[entry]) {
+        entry = id;
+      }
+    }
+    index->entry_point_ = entry;
+    index->max_level_ = index->levels_[entry];
+  }
+  return index;
+}
+
+size_t HnswIndex::getDimension() const { return dimension_; }
+
+const HnswParams &HnswIndex::getParams() const { return params_; }
+
+void HnswIndex::clear() {
+  std::unique_lock<std::shared_mutex> resizeLock(resize_mutex_);
+  std::lock_guard<std::mutex> globalLock(global_mutex_);
+
+  node_count_ = 0;
+  live_count_ = 0;
+  label_to_node_.clear();
+  entry_point_ = 0;
+  max_level_ = -1;
+  rng_.seed(params_.seed);
+  for (size_t i = 0; i < capacity_; ++i) {
+    upper_links_[i].clear();
+  }
+  freeRetained(capacity_);
+}
+
+void HnswIndex::save(BinaryWriter &out) const {
+  std::unique_lock<std::shared_mutex> resizeLock(resize_mutex_);
+  std::lock_guard<std::mutex> globalLock(global_mutex_);
+
+  out.write<uint64_t>(dimension_);
+  out.write<uint64_t>(params_.M);
+  out.write<uint64_t>(params_.efConstruction);
+  out.write<uint64_t>(params_.efSearch);
+  out.write<uint32_t>(static_cast<uint32_t>(params_.metric));
+  out.write<uint32_t>(params_.seed);
+
+  out.write<uint64_t>(node_count_);
+  out.write<uint32_t>(entry_point_);
+  out.write<int32_t>(max_level_);
+  // A source-backed index writes only its retained copies, after the
+  // nodes they belong to
+  std::vector<uint32_t> retainedNodes;
+  std::vector<float> retained;
+  for (size_t i = 0; source_ && i < node_count_; ++i) {
+    if (const float *copy = retained_[i].load(std::memory_order_relaxed)) {
+      retainedNodes.push_back(static_cast<uint32_t>(i));
+      retained.insert(retained.end(), copy, copy + dimension_);
+    }
+  }
+  out.writeArray(retainedNodes);
+  if (source_) {
+    out.writeArray(retained);
+  } else {
+    out.writeArray(vectors_.data(), node_count_ * dimension_);
+  }
+  out.writeArray(links0_.data(), node_count_ * (max_m0_ + 1));
+  out.writeArray(levels_.data(), node_count_);
+  out.writeArray(labels_.data(), node_count_);
+
+  std::vector<uint8_t> deleted(node_count_);
+  for (size_t i = 0; i < node_count_; ++i) {
+    deleted[i] = deleted_[i].load(std::memory_order_relaxed) ? 1 : 0;
+  }
+  out.writeArray(deleted);
+
+  // Upper layers, concatenated in node order; sizes follow from levels_
+  for (size_t i = 0; i < node_count_; ++i) {
+    out.writeBytes(upper_links_[i].data(),
+                   upper_links_[i].size() * sizeof(uint32_t));
+  }
+}
+
+std::unique_ptr<HnswIndex> HnswIndex::load(BinaryReader &in,
+                                           const VectorSource *source) {
+  size_t dimension = in.read<uint64_t>();
+  HnswParams params;
+  params.M = in.read<uint64_t>();
+  params.efConstruction = in.read<uint64_t>();
+  params.efSearch = in.read<uint64_t>();
+  uint32_t metric = in.read<uint32_t>();
+  if (metric > static_cast<uint32_t>(Metric::Cosine)) {
+    BinaryReader::fail("unknown HNSW metric");
+  }
+  params.metric = static_cast<Metric>(metric);
+  params.seed = in.read<uint32_t>();
+
+  size_t nodeCount = in.read<uint64_t>();
+  NodeId entryPoint = in.read<uint32_t>();
+  int maxLevel = in.read<int32_t>();
+  if (dimension == 0 || params.M < 2 || nodeCount > in.remaining() ||
+      (nodeCount > 0 && entryPoint >= nodeCount) ||
+      (nodeCount == 0) != (maxLevel < 0)) {
+    BinaryReader::fail("invalid HNSW header");
+  }
+
+  params.initialCapacity = std::max<size_t>(nodeCount, 1);
+  auto index = std::make_unique<HnswIndex>(dimension, params, source);
+
+  std::vector<uint32_t> retainedNodes = in.readArray<uint32_t>();
+  std::vector<float> vectors = in.readArray<float>();
+  std::vector<uint32_t> links0 = in.readArray<uint32_t>();
+  std::vector<int> levels = in.readArray<int>();
+  std::vector<uint32_t> labels = in.readArray<uint32_t>();
+  std::vector<uint8_t> deleted = in.readArray<uint8_t>();
+  if ((!source && !retainedNodes.empty()) ||
+      vectors.size() !=
+          (source ? retainedNodes.size() : nodeCount) * dimension ||
+      links0.size() != nodeCount * (index->max_m0_ + 1) ||
+      levels.size() != nodeCount || labels.size() != nodeCount ||
+      deleted.size() != nodeCount) {
+    BinaryReader::fail("HNSW array sizes do not match the node count");
+  }
+
+  if (!source) {
+    std::copy(vectors.begin(), vectors.end(), index->vectors_.begin());
+  }
+  for (size_t i = 0; i < retainedNodes.size(); ++i) {
+    const NodeId node = retainedNodes[i];
+    if (node >= nodeCount ||
+        index->retained_[node].load(std::memory_order_relaxed)) {
+      BinaryReader::fail("invalid retained HNSW vector");
+    }
+    float *copy = new float[dimension];
+    std::copy(vectors.begin() + i * dimension,
+              vectors.begin() + (i + 1) * dimension, copy);
+    index->retained_[node].store(copy, std::memory_order_relaxed);
+  }
+  std::copy(links0.begin(), links0.end(), index->links0_.begin());
+  for (size_t i = 0; i < nodeCount; ++i) {
+    if (levels[i] < 0 || levels[i] > maxLevel) {
+      BinaryReader::fail("HNSW node level out of range");
+    }
+    index->levels_[i] = levels[i];
+    index->labels_[i] = labels[i];
+    index->deleted_[i].store(deleted[i] != 0, std::memory_order_relaxed);
+
+    size_t upper = static_cast<size_t>(levels[i]) * (index->max_m_ + 1);
+    const uint8_t *bytes = in.readBytes(upper * sizeof(uint32_t));
+    index->upper_links_[i].resize(upper);
+    if (upper > 0) {
+      std::memcpy(index->upper_links_[i].data(), bytes,
+                  upper * sizeof(uint32_t));
+    }
+
+    for (int level = 0; level <= levels[i]; ++level) {
+      const uint32_t *links = index->linksOf(static_cast<NodeId>(i), level);
+      if (links[0] > index->maxLinks(level)) {
+        BinaryReader::fail("HNSW neighbour list overflows");
+      }
+      for (uint32_t j = 1; j <= links[0]; ++j) {
+        if (links[j] >= nodeCount) {
+          BinaryReader::fail("HNSW link points past the last node");
+        }
+      }
+    }
+
+    if (!deleted[i]) {
+      index->label_to_node_[labels[i]] = static_cast<NodeId>(i);
+    }
+  }
+
+  index->node_count_ = nodeCount;
+  index->live_count_ = index->label_to_node_.size();
+  index->entry_point_ = entryPoint;
+  index->max_level_ = maxLevel;
+  return index;
+}
+
+float HnswIndex::distance(const float *v1, const float *v2) const {
+  return distance_(v1, v2, dimension_);
+}
+
+const float *HnswIndex::vectorOf(NodeId node, size_t scratch) const {
+  if (source_) {
+    if (const float *copy = retained_[node].load(std::memory_order_acquire)) {
+      return copy;
+    }
+    return source_->load(labels_[node], scratchRow(scratch, dimension_));
+  }
+  return vectors_.data() + static_cast<size_t>(node) * dimension_;
+}
+
+void HnswIndex::prefetchVector(NodeId node) const {
+  if (!source_) {
+    __builtin_prefetch(vectors_.data() +
+                       static_cast<size_t>(node) * dimension_);
+  } else if (const float *copy =
+                 retained_[node].load(std::memory_order_relaxed)) {
+    __builtin_prefetch(copy);
+  } else {
+    source_->prefetch(labels_[node]);
+  }
+}
+
+void HnswIndex::retain(NodeId node) {
+  if (!source_ || retained_[node].load(std::memory_order_relaxed)) {
+    return;
+  }
+  float *copy = new float[dimension_];
+  const float *vector = source_->load(labels_[node], copy);
+  if (vector != copy) {
+    std::memcpy(copy, vector, dimension_ * sizeof(float));
+  }
+  retained_[node].store(copy, std::memory_order_release);
+}
+
+void HnswIndex::freeRetained(size_t count) {
+  for (size_t i = 0; retained_ && i < count; ++i) {
+    delete[] retained_[i].exchange(nullptr, std::memory_order_relaxed);
+  }
+}
+
+uint32_t *HnswIndex::linksOf(NodeId node, int level) {
+  if (level == 0) {
+    return links0_.data() + static_cast<size_t>(node) * (max_m0_ + 1);
+  }
+  return upper_links_[node].data() +
+         static_cast<size_t>(level - 1) * (max_m_ + 1);
+}
+
+const uint32_t *HnswIndex::linksOf(NodeId node, int level) const {
+  return const_cast<HnswIndex *>(this)->linksOf(node, level);
+}
+
+int HnswIndex::randomLevel() {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double r = uniform(rng_);
+  if (r <= 0.0) {
+    r = std::numeric_limits<double>::min();
+  }
+  return static_cast<int>(-std::log(r) * level_multiplier_);
+}
+
+void HnswIndex::grow(size_t capacity) {
+  if (capacity > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("HNSW index is full");
+  }
+
+  if (!source_) {
+    vectors_.resize(capacity * dimension_);
+  }
+  links0_.resize(capacity * (max_m0_ + 1));
+  upper_links_.resize(capacity);
+  levels_.resize(capacity);
+  labels_.resize(capacity);
+
+  // Neither mutexes nor atomics are movable, so these arrays are rebuilt
+  link_mutexes_.reset(new std::mutex[capacity]);
+  std::unique_ptr<std::atomic<bool>[]> deleted(
+      new std::atomic<bool>[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    deleted[i].store(i < capacity_ && deleted_[i].load(),
+                     std::memory_order_relaxed);
+  }
+  deleted_ = std::move(deleted);
+  if (source_) {
+    std::unique_ptr<std::atomic<float *>[]> retained(
+        new std::atomic<float *>[capacity]);
+    for (size_t i = 0; i < capacity; ++i) {
+      retained[i].store(i < capacity_ ? retained_[i].load() : nullptr,
+                        std::memory_order_relaxed);
+    }
+    retained_ = std::move(retained);
+  }
+
+  capacity_ = capacity;
+}
+
+void HnswIndex::prepareQuery(const float *query, std::vector<float> &buffer,
+                             const float *&prepared) const {
+  prepared = query;
+  if (params_.metric != Metric::Cosine) {
+    return;
+  }
+  buffer.assign(query, query + dimension_);
+  float norm = std::sqrt(VectorOps::dotProduct(query, query, dimension_));
+  if (norm > 0.0f) {
+    for (float &x : buffer) {
+      x /= norm;
+    }
+  }
+  prepared = buffer.data();
+}
+
+HnswIndex::NodeId HnswIndex::greedyDescend(const float *query, NodeId entry,
+                                           int fromLevel, int toLevel,
+                                           SearchStats *stats) const {
+  NodeId current = entry;
+  float currentDistance = distance(query, vectorOf(current));
+  std::vector<uint32_t> neighbors;
+  size_t distances = 1;
+  size_t expanded = 0;
+
+  for (int level = fromLevel; level >= toLevel; --level) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      {
+        std::lock_guard<std::mutex> lock(link_mutexes_[current]);
+        const uint32_t *links = linksOf(current, level);
+        neighbors.assign(links + 1, links + 1 + links[0]);
+      }
+      ++expanded;
+      distances += neighbors.size();
+      for (NodeId candidate : neighbors) {
+        float d = distance(query, vectorOf(candidate));
+        if (d < currentDistance) {
+          currentDistance = d;
+          current = candidate;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  if (stats) {
+    stats->distanceComputations += distances;
+    stats->nodesVisited += expanded;
+  }
+  return current;
+}
+
+std::vector<Neighbor> HnswIndex::searchLayer(const float *query, NodeId entry,
+                                             size_t ef, int level,
+                                             bool skipDeleted,
+                                             const LabelFilter &filter,
+                                             SearchStats *stats) const {
+  auto returnable = [&](NodeId node) {
+    return !skipDeleted ||
+           (!deleted_[node].load(std::memory_order_acquire) &&
+            (!filter || filter(labels_[node])));
+  };
+
+  VisitedList &visited = visitedList(capacity_);
+  MinQueue candidates;
+  MaxQueue results;
+
+  float entryDistance = distance(query, vectorOf(entry));
+  size_t distances = 1;
+  size_t expanded = 0;
+  visited.visit(entry);
+  candidates.push({entryDistance, entry});
+  if (returnable(entry)) {
+    results.push({entryDistance, entry});
+  }
+  float lowerBound = results.empty() ? std::numeric_limits<float>::max()
+                                     : results.top().distance;
+
+  std::vector<uint32_t> neighbors;
+  while (!candidates.empty()) {
+    Neighbor current = candidates.top();
+    if (current.distance > lowerBound && results.size() >= ef) {
+      break;
+    }
+    candidates.pop();
+
+    {
+      std::lock_guard<std::mutex> lock(link_mutexes_[current.label]);
+      const uint32_t *links = linksOf(current.label, level);
+      neighbors.assign(links + 1, links + 1 + links[0]);
+    }
+    ++expanded;
+
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+      if (i + 1 < neighbors.size()) {
+        prefetchVector(neighbors[i + 1]);
+      }
+      NodeId neighbor = neighbors[i];
+      if (!visited.visit(neighbor)) {
+        continue;
+      }
+
+      float d = distance(query, vectorOf(neighbor));
+      ++distances;
+      if (results.size() < ef || d < lowerBound) {
+        candidates.push({d, neighbor});
+        if (returnable(neighbor)) {
+          results.push({d, neighbor});
+          if (results.size() > ef) {
+            results.pop();
+          }
+        }
+        if (!results.empty()) {
+          lowerBound = results.top().distance;
+        }
+      }
+    }
+  }
+
+  if (stats) {
+    stats->distanceComputations += distances;
+    stats->nodesVisited += expanded;
+  }
+
+  std::vector<Neighbor> sorted(results.size());
+  for (size_t i = sorted.size(); i-- > 0;) {
+    sorted[i] = results.top();
+    results.pop();
+  }
+  return sorted;
+}
+
+std::vector<HnswIndex::NodeId>
+HnswIndex::selectNeighbors(const std::vector<Neighbor> &candidates,
+                           size_t m) const {
+  std::vector<NodeId> selected;
+  selected.reserve(m);
+
+  for (const Neighbor &candidate : candidates) {
+    if (selected.size() >= m) {
+      break;
+    }
+    bool keep = true;
+    for (NodeId chosen : selected) {
+      if (distance(vectorOf(candidate.label, 0), vectorOf(chosen, 1)) <
+          candidate.distance) {
+        keep = false;
+        break;
+      }
+    }
+    if (keep) {
+      selected.push_back(candidate.label);
+    }
+  }
+
+  return selected;
+}
+
+void HnswIndex::connect(NodeId node, const std::vector<NodeId> &neighbors,
+                        int level) {
+  {
+    std::lock_guard<std::mutex> lock(link_mutexes_[node]);
+    uint32_t *links = linksOf(node, level);
+    links[0] = static_cast<uint32_t>(neighbors.size());
+    std::copy(neighbors.begin(), neighbors.end(), links + 1);
+  }
+
+  const size_t maxCount = maxLinks(level);
+  for (NodeId neighbor : neighbors) {
+    std::lock_guard<std::mutex> lock(link_mutexes_[neighbor]);
+    uint32_t *links = linksOf(neighbor, level);
+    uint32_t count = links[0];
+
+    if (std::find(links + 1, links + 1 + count, node) != links + 1 + count) {
+      continue;
+    }
+    if (count < maxCount) {
+      links[1 + count] = node;
+      links[0] = count + 1;
+      continue;
+    }
+
+    // Full: re-run the heuristic over the existing links plus the new node
+    const float *base = vectorOf(neighbor, 0);
+    std::vector<Neighbor> candidates;
+    candidates.reserve(count + 1);
+    candidates.push_back({distance(base, vectorOf(node, 1)), node});
+    for (uint32_t i = 1; i <= count; ++i) {
+      candidates.push_back(
+          {distance(base, vectorOf(links[i], 1)), links[i]});
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<NodeId> pruned = selectNeighbors(candidates, maxCount);
+    links[0] = static_cast<uint32_t>(pruned.size());
+    std::copy(pruned.begin(), pruned.end(), links + 1);
+  }
+}
+
+} // namespace vectorsearch
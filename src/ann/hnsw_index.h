@@ -0,0 +1,211 @@
+// src/ann/hnsw_index.h
+#pragma once
+
+#include "top_k.h"
+#include "vector_ops.h"
+#include "vector_source.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace vectorsearch {
+
+class BinaryReader;
+class BinaryWriter;
+
+struct HnswParams {
+  // Maximum number of neighbours per node on the upper layers; layer 0 keeps
+  // up to 2 * M.
+  size_t M = 16;
+  // Size of the dynamic candidate list used while inserting.
+  size_t efConstruction = 200;
+  // Default candidate list size for queries; can be overridden per query.
+  size_t efSearch = 50;
+  Metric metric = Metric::Cosine;
+  size_t initialCapacity = 1024;
+  uint32_t seed = 100;
+};
+
+// Hierarchical Navigable Small World graph (Malkov & Yashunin). Vectors are
+// identified by a caller-provided 32-bit label. A standalone index copies
+// them into a private fp32 array (dimension * 4 bytes per node, retired
+// nodes included); one built over a VectorSource reads live nodes' vectors
+// from the source by label and copies only retired nodes' vectors, since the
+// source may reuse their labels while they still route searches.
+// add(), remove() and search() may be called concurrently: node neighbour
+// lists are protected by per-node locks, and only growing the node arrays
+// briefly excludes other operations.
+class HnswIndex {
+public:
+  // Vectors are read from `source` when one is given; it must outlive the
+  // index.
+  explicit HnswIndex(size_t dimension, const HnswParams &params = HnswParams(),
+                     const VectorSource *source = nullptr);
+
+  ~HnswIndex();
+
+  HnswIndex(const HnswIndex &) = delete;
+  HnswIndex &operator=(const HnswIndex &) = delete;
+
+  // Inserts `vector` under `label`. Re-adding an existing label replaces the
+  // previous vector. With a source, `vector` must be what the source holds
+  // for `label`, and the previous vector must have been kept with
+  // retainVector() before the source overwrote it.
+  void add(uint32_t label, const float *vector);
+
+  // With a source, copies the vector the node of `label` reads into the
+  // index, so the node keeps it once the source overwrites the label.
+  // remove() does this itself. No-op without a source or for an unknown
+  // label.
+  void retainVector(uint32_t label);
+
+  // Grows the node arrays to hold at least `capacity` nodes, so a large
+  // batch of inserts does not reallocate repeatedly.
+  void reserve(size_t capacity);
+
+  // Marks the node as deleted: it keeps routing searches but is no longer
+  // returned. Returns false if the label is unknown.
+  bool remove(uint32_t label);
+
+  // Returns up to k nearest labels, closest first. Distances follow
+  // VectorOps::distance for the index metric. `efSearch` of 0 uses the
+  // default from HnswParams; values below k are raised to k. Labels rejected
+  // by `filter` still route the traversal but are never returned. The work
+  // done is added to `stats` if given.
+  std::vector<Neighbor> search(const float *query, size_t k,
+                               size_t efSearch = 0,
+                               const LabelFilter &filter = LabelFilter(),
+                               SearchStats *stats = nullptr) const;
+
+  // Number of live (not deleted) vectors.
+  size_t size() const;
+
+  // Nodes retired by remove() or by re-adding a label. They keep routing
+  // searches and hold memory until the index is compacted.
+  size_t deletedCount() const;
+
+  // Returns a copy without retired nodes. Live nodes that linked to a
+  // retired one get their neighbourhood repaired: the live nodes reachable
+  // through up to kRepairHops retired nodes join the existing links as
+  // candidates, and the neighbour selection heuristic picks the new list.
+  // A non-empty `labelMap` renames every label to labelMap[label]. Must not
+  // overlap add() or remove(); concurrent searches are fine.
+  std::unique_ptr<HnswIndex>
+  compacted(const std::vector<uint32_t> &labelMap = {}) const;
+
+  size_t getDimension() const;
+
+  const HnswParams &getParams() const;
+
+  void clear();
+
+  // Serializes the graph, including deleted nodes still used for routing.
+  // A source-backed index writes only the vectors it retained.
+  void save(BinaryWriter &out) const;
+
+  // Rebuilds an index written by save(); `source` must be given exactly
+  // when the saved index had one. Throws std::runtime_error if the data is
+  // malformed.
+  static std::unique_ptr<HnswIndex>
+  load(BinaryReader &in, const VectorSource *source = nullptr);
+
+private:
+  using NodeId = uint32_t;
+
+  static constexpr size_t kRepairHops = 2;
+
+  float distance(const float *v1, const float *v2) const;
+
+  // Vector of `node`. A source may convert it into one of two per-thread
+  // scratch rows, picked by `scratch`, so the pointer is valid until the
+  // next call with the same `scratch`.
+  const float *vectorOf(NodeId node, size_t scratch = 0) const;
+
+  // Prefetches the row vectorOf(node) will read: the retained copy, the
+  // source's row, or the private copy.
+  void prefetchVector(NodeId node) const;
+
+  // Copies the source's vector for `node` into retained_; the caller holds
+  // resize_mutex_ and global_mutex_.
+  void retain(NodeId node);
+
+  // Frees retained_ for nodes [0, count).
+  void freeRetained(size_t count);
+
+  // Neighbour list of `node` at `level`: element 0 is the count, followed by
+  // up to maxLinks(level) node ids.
+  uint32_t *linksOf(NodeId node, int level);
+  const uint32_t *linksOf(NodeId node, int level) const;
+
+  size_t maxLinks(int level) const { return level == 0 ? max_m0_ : max_m_; }
+
+  int randomLevel();
+
+  void grow(size_t capacity);
+
+  void prepareQuery(const float *query, std::vector<float> &buffer,
+                    const float *&prepared) const;
+
+  NodeId greedyDescend(const float *query, NodeId entry, int fromLevel,
+                       int toLevel, SearchStats *stats = nullptr) const;
+
+  // Best-first search restricted to one layer; returns up to ef candidates
+  // sorted closest first. With skipDeleted, deleted nodes and nodes whose
+  // label `filter` rejects are traversed but not returned.
+  std::vector<Neighbor> searchLayer(const float *query, NodeId entry,
+                                    size_t ef, int level, bool skipDeleted,
+                                    const LabelFilter &filter = LabelFilter(),
+                                    SearchStats *stats = nullptr) const;
+
+  // Neighbour selection heuristic (algorithm 4 of the HNSW paper): keeps a
+  // candidate only if it is closer to the base than to any kept neighbour.
+  std::vector<NodeId> selectNeighbors(const std::vector<Neighbor> &candidates,
+                                      size_t m) const;
+
+  void connect(NodeId node, const std::vector<NodeId> &neighbors, int level);
+
+  size_t dimension_;
+  HnswParams params_;
+  const VectorSource *source_;
+  // Cosine is served as a dot product over normalized vectors, unless a
+  // source holds rows of arbitrary length.
+  Metric distance_metric_;
+  // VectorOps::distance() for distance_metric_, bound to the dimension
+  DistanceKernel distance_;
+  size_t max_m_;
+  size_t max_m0_;
+  double level_multiplier_;
+
+  // Shared by every operation, held exclusively only while growing arrays
+  mutable std::shared_mutex resize_mutex_;
+  // Guards node allocation, the label map, the entry point and the RNG
+  mutable std::mutex global_mutex_;
+  std::unique_ptr<std::mutex[]> link_mutexes_;
+
+  size_t capacity_ = 0;
+  size_t node_count_ = 0;
+  size_t live_count_ = 0;
+  // Normalized for cosine; empty when a source serves the vectors
+  std::vector<float> vectors_;
+  std::vector<uint32_t> links0_;
+  std::vector<std::vector<uint32_t>> upper_links_;
+  std::vector<int> levels_;
+  std::vector<uint32_t> labels_;
+  std::unique_ptr<std::atomic<bool>[]> deleted_;
+  // Source-backed only: per-node copies made by retain(), null while the
+  // node still reads the source
+  std::unique_ptr<std::atomic<float *>[]> retained_;
+  std::unordered_map<uint32_t, NodeId> label_to_node_;
+
+  NodeId entry_point_ = 0;
+  int max_level_ = -1;
+  std::mt19937 rng_;
+};
+
+} // namespace vectorsearch
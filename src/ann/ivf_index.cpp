@@ -0,0 +1,282 @@
+// src/ann/ivf_index.cpp
+#include "ivf_index.h"
+#include "common/binary_io.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vectorsearch {
+
+IvfIndex::IvfIndex(size_t dimension, const IvfParams &params)
+    : dimension_(dimension), params_(params),
+      distance_metric_(params.metric == Metric::Cosine ? Metric::DotProduct
+                                                       : params.metric),
+      distance_(VectorOps::distanceKernel(distance_metric_, dimension)) {
+  if (dimension == 0) {
+    throw std::invalid_argument("IVF dimension must be positive");
+  }
+  if (params.numLists == 0) {
+    throw std::invalid_argument("IVF needs at least one list");
+  }
+}
+
+void IvfIndex::train(const float *data, size_t count, size_t stride) {
+  if (count < params_.numLists) {
+    throw std::invalid_argument("IVF training needs at least " +
+                                std::to_string(params_.numLists) + " vectors");
+  }
+
+  std::vector<float> prepared(count * dimension_);
+  std::vector<float> buffer;
+  for (size_t i = 0; i < count; ++i) {
+    const float *row = nullptr;
+    prepare(data + i * stride, buffer, row);
+    std::copy(row, row + dimension_, prepared.begin() + i * dimension_);
+  }
+
+  KMeans::Result result =
+      KMeans::train(prepared.data(), count, dimension_, dimension_,
+                    params_.numLists, params_.kmeans);
+  centroids_ = std::move(result.centroids);
+  lists_.assign(params_.numLists, InvertedList());
+  locations_.clear();
+  size_ = 0;
+  trained_ = true;
+}
+
+bool IvfIndex::isTrained() const { return trained_; }
+
+void IvfIndex::add(uint32_t label, const float *vector) {
+  if (!trained_) {
+    throw std::logic_error("IVF index must be trained before adding vectors");
+  }
+
+  remove(label);
+
+  std::vector<float> buffer;
+  const float *prepared = nullptr;
+  prepare(vector, buffer, prepared);
+
+  uint32_t listId = closestLists(prepared, 1)[0];
+  InvertedList &list = lists_[listId];
+  if (locations_.size() <= label) {
+    locations_.resize(static_cast<size_t>(label) + 1, {kNoList, 0});
+  }
+  locations_[label] = {listId, static_cast<uint32_t>(list.labels.size())};
+  list.labels.push_back(label);
+  list.vectors.insert(list.vectors.end(), prepared, prepared + dimension_);
+  ++size_;
+}
+
+bool IvfIndex::remove(uint32_t label) {
+  if (label >= locations_.size() || locations_[label].list == kNoList) {
+    return false;
+  }
+
+  // Swap the last entry of the list into the hole to keep it contiguous
+  Location location = locations_[label];
+  InvertedList &list = lists_[location.list];
+  uint32_t last = static_cast<uint32_t>(list.labels.size() - 1);
+  if (location.position != last) {
+    uint32_t moved = list.labels[last];
+    list.labels[location.position] = moved;
+    std::copy(list.vectors.begin() + last * dimension_,
+              list.vectors.begin() + (last + 1) * dimension_,
+              list.vectors.begin() + location.position * dimension_);
+    locations_[moved].position = location.position;
+  }
+  list.labels.pop_back();
+  list.vectors.resize(list.labels.size() * dimension_);
+  locations_[label].list = kNoList;
+  --size_;
+  return true;
+}
+
+std::vector<Neighbor> IvfIndex::search(const float *query, size_t k,
+                                       size_t nprobe,
+                                       const LabelFilter &filter,
+                                       SearchStats *stats) const {
+  if (!trained_ || k == 0 || size_ == 0) {
+    return {};
+  }
+
+  std::vector<float> buffer;
+  const float *q = nullptr;
+  prepare(query, buffer, q);
+
+  if (nprobe == 0) {
+    nprobe = params_.nprobe;
+  }
+  TopK topK(k);
+  const std::vector<uint32_t> probed =
+      closestLists(q, std::min(nprobe, lists_.size()));
+  size_t distances = lists_.size();
+  for (uint32_t listId : probed) {
+    const InvertedList &list = lists_[listId];
+    const float *row = list.vectors.data();
+    for (size_t i = 0; i < list.labels.size(); ++i, row += dimension_) {
+      if (filter && !filter(list.labels[i])) {
+        continue;
+      }
+      topK.push(distance_(q, row, dimension_), list.labels[i]);
+      ++distances;
+    }
+  }
+  if (stats) {
+    stats->distanceComputations += distances;
+    stats->nodesVisited += probed.size();
+  }
+  return topK.takeSorted();
+}
+
+size_t IvfIndex::size() const { return size_; }
+
+size_t IvfIndex::getDimension() const { return dimension_; }
+
+const IvfParams &IvfIndex::getParams() const { return params_; }
+
+std::vector<size_t> IvfIndex::listSizes() const {
+  std::vector<size_t> sizes;
+  sizes.reserve(lists_.size());
+  for (const InvertedList &list : lists_) {
+    sizes.push_back(list.labels.size());
+  }
+  return sizes;
+}
+
+void IvfIndex::clear() {
+  for (InvertedList &list : lists_) {
+    list.vectors.clear();
+    list.labels.clear();
+  }
+  locations_.clear();
+  size_ = 0;
+}
+
+std::unique_ptr<IvfIndex>
+IvfIndex::relabeled(const std::vector<uint32_t> &labelMap) const {
+  auto index = std::make_unique<IvfIndex>(*this);
+  index->locations_.clear();
+  for (uint32_t listId = 0; listId < index->lists_.size(); ++listId) {
+    std::vector<uint32_t> &labels = index->lists_[listId].labels;
+    for (uint32_t position = 0; position < labels.size(); ++position) {
+      const uint32_t label = labelMap.at(labels[position]);
+      labels[position] = label;
+      if (index->locations_.size() <= label) {
+        index->locations_.resize(static_cast<size_t>(label) + 1,
+                                 {kNoList, 0});
+      }
+      index->locations_[label] = {listId, position};
+    }
+  }
+  return index;
+}
+
+void IvfIndex::save(BinaryWriter &out) const {
+  out.write<uint64_t>(dimension_);
+  out.write<uint64_t>(params_.numLists);
+  out.write<uint64_t>(params_.nprobe);
+  out.write<uint32_t>(static_cast<uint32_t>(params_.metric));
+  out.write<uint64_t>(params_.trainingSampleSize);
+  out.write<uint64_t>(params_.kmeans.iterations);
+  out.write<uint32_t>(params_.kmeans.seed);
+  out.write<uint8_t>(trained_ ? 1 : 0);
+
+  out.writeArray(centroids_);
+  for (const InvertedList &list : lists_) {
+    out.writeArray(list.labels);
+    out.writeArray(list.vectors);
+  }
+}
+
+std::unique_ptr<IvfIndex> IvfIndex::load(BinaryReader &in) {
+  size_t dimension = in.read<uint64_t>();
+  IvfParams params;
+  params.numLists = in.read<uint64_t>();
+  params.nprobe = in.read<uint64_t>();
+  uint32_t metric = in.read<uint32_t>();
+  if (metric > static_cast<uint32_t>(Metric::Cosine)) {
+    BinaryReader::fail("unknown IVF metric");
+  }
+  params.metric = static_cast<Metric>(metric);
+  params.trainingSampleSize = in.read<uint64_t>();
+  params.kmeans.iterations = in.read<uint64_t>();
+  params.kmeans.seed = in.read<uint32_t>();
+  bool trained = in.read<uint8_t>() != 0;
+  if (dimension == 0 || params.numLists == 0 ||
+      params.numLists > in.remaining()) {
+    BinaryReader::fail("invalid IVF header");
+  }
+
+  auto index = std::make_unique<IvfIndex>(dimension, params);
+  index->centroids_ = in.readArray<float>();
+  if (!trained) {
+    if (!index->centroids_.empty()) {
+      BinaryReader::fail("untrained IVF index has centroids");
+    }
+    return index;
+  }
+  if (index->centroids_.size() != params.numLists * dimension) {
+    BinaryReader::fail("IVF centroid count does not match the list count");
+  }
+
+  index->lists_.resize(params.numLists);
+  for (uint32_t listId = 0; listId < params.numLists; ++listId) {
+    InvertedList &list = index->lists_[listId];
+    list.labels = in.readArray<uint32_t>();
+    list.vectors = in.readArray<float>();
+    if (list.vectors.size() != list.labels.size() * dimension) {
+      BinaryReader::fail("IVF list vectors do not match its labels");
+    }
+    for (uint32_t position = 0; position < list.labels.size(); ++position) {
+      uint32_t label = list.labels[position];
+      if (index->locations_.size() <= label) {
+        index->locations_.resize(static_cast<size_t>(label) + 1,
+                                 {kNoList, 0});
+      }
+      if (index->locations_[label].list != kNoList) {
+        BinaryReader::fail("IVF label stored twice");
+      }
+      index->locations_[label] = {listId, position};
+    }
+    index->size_ += list.labels.size();
+  }
+  index->trained_ = true;
+  return index;
+}
+
+void IvfIndex::prepare(const float *vector, std::vector<float> &buffer,
+                       const float *&prepared) const {
+  prepared = vector;
+  if (params_.metric != Metric::Cosine) {
+    return;
+  }
+  buffer.assign(vector, vector + dimension_);
+  float norm = std::sqrt(VectorOps::dotProduct(vector, vector, dimension_));
+  if (norm > 0.0f) {
+    for (float &x : buffer) {
+      x /= norm;
+    }
+  }
+  prepared = buffer.data();
+}
+
+std::vector<uint32_t> IvfIndex::closestLists(const float *query,
+                                             size_t count) const {
+  // Probing ranks centroids by the index metric, so inner-product lists are
+  // chosen by the largest centroid dot product
+  TopK topK(count);
+  for (size_t c = 0; c < lists_.size(); ++c) {
+    topK.push(distance_(query, centroids_.data() + c * dimension_, dimension_),
+              static_cast<uint32_t>(c));
+  }
+
+  std::vector<uint32_t> lists;
+  lists.reserve(count);
+  for (const Neighbor &n : topK.takeSorted()) {
+    lists.push_back(n.label);
+  }
+  return lists;
+}
+
+} // namespace vectorsearch
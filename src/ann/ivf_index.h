@@ -0,0 +1,120 @@
+// src/ann/ivf_index.h
+#pragma once
+
+#include "kmeans.h"
+#include "top_k.h"
+#include "vector_ops.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vectorsearch {
+
+class BinaryReader;
+class BinaryWriter;
+
+struct IvfParams {
+  // Number of k-means partitions (inverted lists).
+  size_t numLists = 256;
+  // Default number of lists scanned per query; can be overridden per query.
+  size_t nprobe = 8;
+  Metric metric = Metric::Cosine;
+  // Rows sampled from the store for centroid training (0 = all)
+  size_t trainingSampleSize = 65536;
+  KMeansParams kmeans;
+};
+
+// Inverted-file index: k-means centroids partition the vectors, every vector
+// is stored in the list of its nearest centroid, and a query scans only the
+// nprobe lists whose centroids are closest to it.
+//
+// Each list keeps its vectors in one contiguous row-major buffer next to a
+// parallel label array, so probing a list is a sequential scan. Vectors are
+// identified by caller-provided 32-bit labels and copied into the index;
+// cosine is served as a dot product over normalized copies. The index is not
+// internally synchronized.
+class IvfIndex {
+public:
+  IvfIndex(size_t dimension, const IvfParams &params = IvfParams());
+
+  // Trains the centroids on `count` rows spaced `stride` floats apart. Needs
+  // at least numLists rows. Retraining drops every stored vector.
+  void train(const float *data, size_t count, size_t stride);
+
+  bool isTrained() const;
+
+  // Appends `vector` to the list of its nearest centroid. Re-adding an
+  // existing label replaces the previous vector. Requires a trained index.
+  void add(uint32_t label, const float *vector);
+
+  // Returns false if the label is unknown.
+  bool remove(uint32_t label);
+
+  // Returns up to k nearest labels, closest first. Distances follow
+  // VectorOps::distance for the index metric. `nprobe` of 0 uses the
+  // default from IvfParams. Labels rejected by `filter` are skipped while
+  // the probed lists are scanned. The work done is added to `stats` if
+  // given.
+  std::vector<Neighbor> search(const float *query, size_t k,
+                               size_t nprobe = 0,
+                               const LabelFilter &filter = LabelFilter(),
+                               SearchStats *stats = nullptr) const;
+
+  size_t size() const;
+
+  size_t getDimension() const;
+
+  const IvfParams &getParams() const;
+
+  // Number of vectors in each list, for balance diagnostics.
+  std::vector<size_t> listSizes() const;
+
+  // Drops every stored vector but keeps the trained centroids.
+  void clear();
+
+  // Returns a copy with every label renamed to labelMap[label].
+  std::unique_ptr<IvfIndex>
+  relabeled(const std::vector<uint32_t> &labelMap) const;
+
+  void save(BinaryWriter &out) const;
+
+  // Rebuilds an index written by save(). Throws std::runtime_error if the
+  // data is malformed.
+  static std::unique_ptr<IvfIndex> load(BinaryReader &in);
+
+private:
+  struct InvertedList {
+    std::vector<float> vectors; // size() x dimension, row-major
+    std::vector<uint32_t> labels;
+  };
+
+  struct Location {
+    uint32_t list;
+    uint32_t position;
+  };
+
+  static constexpr uint32_t kNoList = UINT32_MAX;
+
+  void prepare(const float *vector, std::vector<float> &buffer,
+               const float *&prepared) const;
+
+  // Indices of the `count` centroids closest to an already prepared query.
+  std::vector<uint32_t> closestLists(const float *query, size_t count) const;
+
+  size_t dimension_;
+  IvfParams params_;
+  // Cosine is served as a dot product over normalized copies.
+  Metric distance_metric_;
+  // VectorOps::distance() for distance_metric_, bound to the dimension
+  DistanceKernel distance_;
+
+  std::vector<float> centroids_; // numLists x dimension
+  std::vector<InvertedList> lists_;
+  // Indexed by label; list is kNoList for labels not in the index
+  std::vector<Location> locations_;
+  size_t size_ = 0;
+  bool trained_ = false;
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,196 @@
+// src/ann/kmeans.cpp
+#include "kmeans.h"
+#include "common/thread_pool.h"
+#include "vector_ops.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// Rows scored per call to the blocked kernel during assignment
+constexpr size_t kAssignBlockRows = 256;
+// Below this many rows per worker, handing work to the pool outweighs it
+constexpr size_t kMinRowsPerThread = 1024;
+
+size_t workerCount(size_t count, size_t numThreads,
+                   vectorsearch::ThreadPool &pool) {
+  if (numThreads == 0) {
+    numThreads = pool.concurrency();
+  }
+  return std::max<size_t>(
+      1, std::min(numThreads,
+                  (count + kMinRowsPerThread - 1) / kMinRowsPerThread));
+}
+
+// Runs fn(begin, end, worker) over `workers` contiguous row ranges on
+// `pool`.
+template <typename Fn>
+void forEachRange(vectorsearch::ThreadPool &pool, size_t count,
+                  size_t workers, const Fn &fn) {
+  if (workers <= 1) {
+    fn(0, count, 0);
+    return;
+  }
+  pool.parallelFor(count, workers, fn);
+}
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+KMeans::Result KMeans::train(const float *data, size_t count, size_t stride,
+                             size_t dimension, size_t k,
+                             const KMeansParams &params) {
+  if (k == 0 || k > count) {
+    throw std::invalid_argument("k-means needs 0 < k <= number of points");
+  }
+
+  Result result;
+  result.centroids.resize(k * dimension);
+  result.assignments.assign(count, 0);
+
+  // Initialise from k distinct random points
+  std::mt19937 rng(params.seed);
+  std::vector<size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  for (size_t i = 0; i < k; ++i) {
+    std::uniform_int_distribution<size_t> pick(i, count - 1);
+    std::swap(order[i], order[pick(rng)]);
+    const float *row = data + order[i] * stride;
+    std::copy(row, row + dimension, result.centroids.begin() + i * dimension);
+  }
+
+  // Each worker accumulates its rows into private sums, reduced into the
+  // first worker's buffers afterwards
+  const std::shared_ptr<ThreadPool> pool =
+      params.pool ? params.pool : ThreadPool::shared();
+  const size_t workers = workerCount(count, params.numThreads, *pool);
+  std::vector<std::vector<double>> partialSums(
+      workers, std::vector<double>(k * dimension));
+  std::vector<std::vector<size_t>> partialSizes(workers,
+                                                std::vector<size_t>(k));
+  std::vector<double> &sums = partialSums[0];
+  std::vector<size_t> &sizes = partialSizes[0];
+  for (size_t iteration = 0; iteration < params.iterations; ++iteration) {
+    assign(data, count, stride, result.centroids.data(), k, dimension,
+           result.assignments.data(), nullptr, workers, pool.get());
+
+    forEachRange(*pool, count, workers,
+                 [&](size_t begin, size_t end, size_t t) {
+      std::vector<double> &localSums = partialSums[t];
+      std::vector<size_t> &localSizes = partialSizes[t];
+      std::fill(localSums.begin(), localSums.end(), 0.0);
+      std::fill(localSizes.begin(), localSizes.end(), 0);
+      for (size_t i = begin; i < end; ++i) {
+        uint32_t c = result.assignments[i];
+        const float *row = data + i * stride;
+        double *sum = localSums.data() + c * dimension;
+        for (size_t d = 0; d < dimension; ++d) {
+          sum[d] += row[d];
+        }
+        ++localSizes[c];
+      }
+    });
+    for (size_t t = 1; t < workers; ++t) {
+      for (size_t i = 0; i < sums.size(); ++i) {
+        sums[i] += partialSums[t][i];
+      }
+      for (size_t c = 0; c < k; ++c) {
+        sizes[c] += partialSizes[t][c];
+      }
+    }
+
+    for (size_t c = 0; c < k; ++c) {
+      float *centroid = result.centroids.data() + c * dimension;
+      if (sizes[c] > 0) {
+        for (size_t d = 0; d < dimension; ++d) {
+          centroid[d] = static_cast<float>(sums[c * dimension + d] / sizes[c]);
+        }
+        continue;
+      }
+
+      // Empty cluster: split the largest one by stealing its centroid with a
+      // small symmetric perturbation
+      size_t largest = static_cast<size_t>(
+          std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+      float *source = result.centroids.data() + largest * dimension;
+      for (size_t d = 0; d < dimension; ++d) {
+        float delta = (d % 2 == 0 ? 1e-4f : -1e-4f) * (1.0f + source[d]);
+        centroid[d] = source[d] + delta;
+        source[d] -= delta;
+      }
+      sizes[c] = sizes[largest] / 2;
+      sizes[largest] -= sizes[c];
+    }
+  }
+
+  assign(data, count, stride, result.centroids.data(), k, dimension,
+         result.assignments.data(), nullptr, workers, pool.get());
+  return result;
+}
+
+uint32_t KMeans::nearestCentroid(const float *vector, const float *centroids,
+                                 size_t k, size_t dimension) {
+  uint32_t best = 0;
+  float bestDistance = std::numeric_limits<float>::max();
+  for (size_t c = 0; c < k; ++c) {
+    float d = VectorOps::squaredEuclideanDistance(
+        vector, centroids + c * dimension, dimension);
+    if (d < bestDistance) {
+      bestDistance = d;
+      best = static_cast<uint32_t>(c);
+    }
+  }
+  return best;
+}
+
+void KMeans::assign(const float *data, size_t count, size_t stride,
+                    const float *centroids, size_t k, size_t dimension,
+                    uint32_t *assignments, float *distances,
+                    size_t numThreads, ThreadPool *pool) {
+  std::shared_ptr<ThreadPool> shared;
+  if (!pool) {
+    shared = ThreadPool::shared();
+    pool = shared.get();
+  }
+  std::vector<float> centroidNorms(k);
+  for (size_t c = 0; c < k; ++c) {
+    const float *centroid = centroids + c * dimension;
+    centroidNorms[c] = VectorOps::dotProduct(centroid, centroid, dimension);
+  }
+
+  const size_t workers = workerCount(count, numThreads, *pool);
+  forEachRange(*pool, count, workers, [&](size_t first, size_t last, size_t) {
+    std::vector<float> scores(kAssignBlockRows * k);
+    for (size_t begin = first; begin < last; begin += kAssignBlockRows) {
+      size_t rows = std::min(kAssignBlockRows, last - begin);
+      VectorOps::dotProductBlock(data + begin * stride, rows, stride,
+                                 centroids, k, dimension, dimension,
+                                 scores.data());
+
+      for (size_t r = 0; r < rows; ++r) {
+        const float *rowScores = scores.data() + r * k;
+        uint32_t best = 0;
+        float bestDistance = std::numeric_limits<float>::max();
+        for (size_t c = 0; c < k; ++c) {
+          float d = centroidNorms[c] - 2.0f * rowScores[c];
+          if (d < bestDistance) {
+            bestDistance = d;
+            best = static_cast<uint32_t>(c);
+          }
+        }
+        assignments[begin + r] = best;
+        if (distances) {
+          const float *row = data + (begin + r) * stride;
+          distances[begin + r] = std::max(
+              0.0f, bestDistance + VectorOps::dotProduct(row, row, dimension));
+        }
+      }
+    }
+  });
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,55 @@
+// src/ann/kmeans.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vectorsearch {
+
+class ThreadPool;
+
+struct KMeansParams {
+  size_t iterations = 20;
+  uint32_t seed = 1234;
+  // Parallel ranges for the assignment and update steps (0 = the pool's
+  // concurrency).
+  size_t numThreads = 0;
+  // Pool the ranges run on; nullptr means ThreadPool::shared().
+  std::shared_ptr<ThreadPool> pool;
+};
+
+// Lloyd's k-means under squared euclidean distance, shared by the product
+// quantizer and other partitioning indexes.
+class KMeans final {
+public:
+  struct Result {
+    std::vector<float> centroids; // k x dimension, row-major
+    std::vector<uint32_t> assignments;
+  };
+
+  KMeans() = delete;
+
+  // Clusters `count` rows spaced `stride` floats apart. k must not exceed
+  // count.
+  static Result train(const float *data, size_t count, size_t stride,
+                      size_t dimension, size_t k,
+                      const KMeansParams &params = KMeansParams());
+
+  // Index of the centroid closest to `vector`.
+  static uint32_t nearestCentroid(const float *vector, const float *centroids,
+                                  size_t k, size_t dimension);
+
+  // Assigns every row to its nearest centroid, scoring rows against all
+  // centroids with the blocked dot-product kernel
+  // (||x - c||^2 = ||x||^2 - 2 x.c + ||c||^2, the first term is constant).
+  // Rows are split into `numThreads` ranges on `pool`, or on the shared
+  // pool when it is null (0 = the pool's concurrency).
+  static void assign(const float *data, size_t count, size_t stride,
+                     const float *centroids, size_t k, size_t dimension,
+                     uint32_t *assignments, float *distances = nullptr,
+                     size_t numThreads = 1, ThreadPool *pool = nullptr);
+};
+
+} // namespace vectorsearch
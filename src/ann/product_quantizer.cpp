@@ -0,0 +1,173 @@
+// src/ann/product_quantizer.cpp
+#include "product_quantizer.h"
+#include "common/binary_io.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vectorsearch {
+
+ProductQuantizer::ProductQuantizer(size_t dimension, const PqParams &params)
+    : dimension_(dimension), params_(params),
+      num_subspaces_(params.numSubspaces),
+      subspace_dimension_(params.numSubspaces == 0
+                              ? 0
+                              : dimension / params.numSubspaces) {
+  if (num_subspaces_ == 0 || dimension % num_subspaces_ != 0) {
+    throw std::invalid_argument(
+        "PQ subspace count (" + std::to_string(num_subspaces_) +
+        ") must divide the dimension (" + std::to_string(dimension) + ")");
+  }
+}
+
+void ProductQuantizer::train(const float *data, size_t count, size_t stride) {
+  if (count < kCodebookSize) {
+    throw std::invalid_argument("PQ training needs at least " +
+                                std::to_string(kCodebookSize) + " vectors");
+  }
+
+  // Normalize (cosine) and gather each subspace into its own contiguous
+  // matrix so k-means streams through it
+  std::vector<float> prepared(count * dimension_);
+  std::vector<float> buffer;
+  for (size_t i = 0; i < count; ++i) {
+    const float *row = nullptr;
+    prepare(data + i * stride, buffer, row);
+    std::copy(row, row + dimension_, prepared.begin() + i * dimension_);
+  }
+
+  codebooks_.resize(num_subspaces_ * kCodebookSize * subspace_dimension_);
+  std::vector<float> subspace(count * subspace_dimension_);
+  for (size_t m = 0; m < num_subspaces_; ++m) {
+    for (size_t i = 0; i < count; ++i) {
+      const float *source =
+          prepared.data() + i * dimension_ + m * subspace_dimension_;
+      std::copy(source, source + subspace_dimension_,
+                subspace.begin() + i * subspace_dimension_);
+    }
+
+    KMeansParams kmeans = params_.kmeans;
+    kmeans.seed += static_cast<uint32_t>(m);
+    KMeans::Result result =
+        KMeans::train(subspace.data(), count, subspace_dimension_,
+                      subspace_dimension_, kCodebookSize, kmeans);
+    std::copy(result.centroids.begin(), result.centroids.end(),
+              codebooks_.begin() + m * kCodebookSize * subspace_dimension_);
+  }
+
+  trained_ = true;
+}
+
+bool ProductQuantizer::isTrained() const { return trained_; }
+
+void ProductQuantizer::encode(const float *vector, uint8_t *codes) const {
+  std::vector<float> buffer;
+  const float *prepared = nullptr;
+  prepare(vector, buffer, prepared);
+
+  for (size_t m = 0; m < num_subspaces_; ++m) {
+    codes[m] = static_cast<uint8_t>(KMeans::nearestCentroid(
+        prepared + m * subspace_dimension_,
+        codebooks_.data() + m * kCodebookSize * subspace_dimension_,
+        kCodebookSize, subspace_dimension_));
+  }
+}
+
+void ProductQuantizer::decode(const uint8_t *codes, float *vector) const {
+  for (size_t m = 0; m < num_subspaces_; ++m) {
+    const float *centroid =
+        codebooks_.data() +
+        (m * kCodebookSize + codes[m]) * subspace_dimension_;
+    std::copy(centroid, centroid + subspace_dimension_,
+              vector + m * subspace_dimension_);
+  }
+}
+
+void ProductQuantizer::computeDistanceTable(const float *query,
+                                            float *table) const {
+  std::vector<float> buffer;
+  const float *prepared = nullptr;
+  prepare(query, buffer, prepared);
+
+  for (size_t m = 0; m < num_subspaces_; ++m) {
+    const float *subQuery = prepared + m * subspace_dimension_;
+    const float *codebook =
+        codebooks_.data() + m * kCodebookSize * subspace_dimension_;
+    float *row = table + m * kCodebookSize;
+
+    if (params_.metric == Metric::Euclidean) {
+      for (size_t c = 0; c < kCodebookSize; ++c) {
+        row[c] = VectorOps::squaredEuclideanDistance(
+            subQuery, codebook + c * subspace_dimension_, subspace_dimension_);
+      }
+    } else {
+      // Dot product and cosine (normalized inputs) are both negated sums of
+      // per-subspace dot products
+      VectorOps::dotProductBlock(subQuery, 1, subspace_dimension_, codebook,
+                                 kCodebookSize, subspace_dimension_,
+                                 subspace_dimension_, row);
+      for (size_t c = 0; c < kCodebookSize; ++c) {
+        row[c] = -row[c];
+      }
+    }
+  }
+}
+
+size_t ProductQuantizer::getDimension() const { return dimension_; }
+
+const PqParams &ProductQuantizer::getParams() const { return params_; }
+
+void ProductQuantizer::save(BinaryWriter &out) const {
+  out.write<uint64_t>(dimension_);
+  out.write<uint64_t>(params_.numSubspaces);
+  out.write<uint32_t>(static_cast<uint32_t>(params_.metric));
+  out.write<uint64_t>(params_.trainingSampleSize);
+  out.write<uint64_t>(params_.kmeans.iterations);
+  out.write<uint32_t>(params_.kmeans.seed);
+  out.write<uint8_t>(trained_ ? 1 : 0);
+  out.writeArray(codebooks_);
+}
+
+std::unique_ptr<ProductQuantizer> ProductQuantizer::load(BinaryReader &in) {
+  size_t dimension = in.read<uint64_t>();
+  PqParams params;
+  params.numSubspaces = in.read<uint64_t>();
+  uint32_t metric = in.read<uint32_t>();
+  if (metric > static_cast<uint32_t>(Metric::Cosine)) {
+    BinaryReader::fail("unknown PQ metric");
+  }
+  params.metric = static_cast<Metric>(metric);
+  params.trainingSampleSize = in.read<uint64_t>();
+  params.kmeans.iterations = in.read<uint64_t>();
+  params.kmeans.seed = in.read<uint32_t>();
+  bool trained = in.read<uint8_t>() != 0;
+  if (params.numSubspaces == 0 || dimension % params.numSubspaces != 0) {
+    BinaryReader::fail("invalid PQ subspace count");
+  }
+
+  auto pq = std::make_unique<ProductQuantizer>(dimension, params);
+  pq->codebooks_ = in.readArray<float>();
+  if (trained && pq->codebooks_.size() != kCodebookSize * dimension) {
+    BinaryReader::fail("PQ codebook size does not match the dimension");
+  }
+  pq->trained_ = trained;
+  return pq;
+}
+
+void ProductQuantizer::prepare(const float *vector, std::vector<float> &buffer,
+                               const float *&prepared) const {
+  prepared = vector;
+  if (params_.metric != Metric::Cosine) {
+    return;
+  }
+  buffer.assign(vector, vector + dimension_);
+  float norm = std::sqrt(VectorOps::dotProduct(vector, vector, dimension_));
+  if (norm > 0.0f) {
+    for (float &x : buffer) {
+      x /= norm;
+    }
+  }
+  prepared = buffer.data();
+}
+
+} // namespace vectorsearch
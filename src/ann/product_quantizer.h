@@ -0,0 +1,103 @@
+// src/ann/product_quantizer.h
+#pragma once
+
+#include "kmeans.h"
+#include "vector_ops.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vectorsearch {
+
+class BinaryReader;
+class BinaryWriter;
+
+struct PqParams {
+  // Number of sub-quantizers; each vector is encoded to this many bytes.
+  // Must divide the dimension.
+  size_t numSubspaces = 8;
+  Metric metric = Metric::Cosine;
+  // Rows sampled from the store for codebook training (0 = all)
+  size_t trainingSampleSize = 65536;
+  KMeansParams kmeans;
+};
+
+// Product quantizer: splits vectors into numSubspaces contiguous
+// sub-vectors and replaces each by the index of its nearest centroid in a
+// 256-entry codebook trained with k-means.
+//
+// Search uses asymmetric distance computation (ADC): the float query is
+// compared once against every codebook entry to build a numSubspaces x 256
+// lookup table, after which the distance to any encoded vector is a sum of
+// numSubspaces table lookups. With up to 32 subspaces the table fits in a
+// 32 KiB L1 data cache.
+//
+// For the cosine metric vectors and queries are normalized before encoding,
+// so distances approximate negated cosine similarity.
+class ProductQuantizer {
+public:
+  static constexpr size_t kCodebookSize = 256;
+
+  ProductQuantizer(size_t dimension, const PqParams &params);
+
+  // Trains the codebooks on `count` rows spaced `stride` floats apart. Needs
+  // at least kCodebookSize rows.
+  void train(const float *data, size_t count, size_t stride);
+
+  bool isTrained() const;
+
+  // Writes codeSize() bytes for `vector`.
+  void encode(const float *vector, uint8_t *codes) const;
+
+  void decode(const uint8_t *codes, float *vector) const;
+
+  // Fills `table` (codeSize() * kCodebookSize floats) with the per-subspace
+  // distance contributions for `query`.
+  void computeDistanceTable(const float *query, float *table) const;
+
+  // Approximate VectorOps::distance for the quantizer metric.
+  float adcDistance(const float *table, const uint8_t *codes) const {
+    float d0 = 0.0f;
+    float d1 = 0.0f;
+    float d2 = 0.0f;
+    float d3 = 0.0f;
+    size_t m = 0;
+    for (; m + 4 <= num_subspaces_; m += 4) {
+      d0 += table[m * kCodebookSize + codes[m]];
+      d1 += table[(m + 1) * kCodebookSize + codes[m + 1]];
+      d2 += table[(m + 2) * kCodebookSize + codes[m + 2]];
+      d3 += table[(m + 3) * kCodebookSize + codes[m + 3]];
+    }
+    for (; m < num_subspaces_; ++m) {
+      d0 += table[m * kCodebookSize + codes[m]];
+    }
+    return (d0 + d1) + (d2 + d3);
+  }
+
+  size_t codeSize() const { return num_subspaces_; }
+
+  size_t getDimension() const;
+
+  const PqParams &getParams() const;
+
+  void save(BinaryWriter &out) const;
+
+  // Restores a quantizer written by save(). Throws std::runtime_error if the
+  // data is malformed.
+  static std::unique_ptr<ProductQuantizer> load(BinaryReader &in);
+
+private:
+  void prepare(const float *vector, std::vector<float> &buffer,
+               const float *&prepared) const;
+
+  size_t dimension_;
+  PqParams params_;
+  size_t num_subspaces_;
+  size_t subspace_dimension_;
+  // numSubspaces x kCodebookSize x subspace_dimension_
+  std::vector<float> codebooks_;
+  bool trained_ = false;
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,125 @@
+// src/ann/scalar_quantizer.cpp
+#include "scalar_quantizer.h"
+#include "common/binary_io.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr float kMaxCode = 127.0f;
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+ScalarQuantizer::ScalarQuantizer(size_t dimension)
+    : dimension_(dimension), offsets_(dimension, 0.0f) {}
+
+void ScalarQuantizer::train(const float *data, size_t count, size_t stride) {
+  if (count == 0) {
+    throw std::invalid_argument("Cannot train a quantizer without data");
+  }
+
+  // The mean rather than the midpoint of the range, so a few extreme values
+  // do not pull the offset away from where most of the data sits
+  std::vector<double> sum(dimension_, 0.0);
+  for (size_t i = 0; i < count; ++i) {
+    const float *row = data + i * stride;
+    for (size_t d = 0; d < dimension_; ++d) {
+      sum[d] += row[d];
+    }
+  }
+  for (size_t d = 0; d < dimension_; ++d) {
+    offsets_[d] = static_cast<float>(sum[d] / count);
+  }
+  offset_norm_ = VectorOps::dotProduct(offsets_.data(), offsets_.data(),
+                                       dimension_);
+  trained_ = true;
+}
+
+bool ScalarQuantizer::isTrained() const { return trained_; }
+
+ScalarQuantizer::RowFactors ScalarQuantizer::encode(const float *vector,
+                                                    int8_t *codes) const {
+  float widest = 0.0f;
+  for (size_t d = 0; d < dimension_; ++d) {
+    widest = std::max(widest, std::fabs(vector[d] - offsets_[d]));
+  }
+  const float scale = widest / kMaxCode;
+  const float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+  float offsetDot = 0.0f;
+  for (size_t d = 0; d < dimension_; ++d) {
+    float code = std::nearbyint((vector[d] - offsets_[d]) * inverse);
+    code = std::min(kMaxCode, std::max(-kMaxCode, code));
+    codes[d] = static_cast<int8_t>(code);
+    offsetDot += offsets_[d] * code;
+  }
+  return {scale, scale * offsetDot};
+}
+
+void ScalarQuantizer::decode(const int8_t *codes, const RowFactors &factors,
+                             float *vector) const {
+  for (size_t d = 0; d < dimension_; ++d) {
+    vector[d] = offsets_[d] + factors.scale * codes[d];
+  }
+}
+
+ScalarQuantizer::Query ScalarQuantizer::prepareQuery(const float *query) const {
+  Query prepared;
+  prepared.codes.resize(dimension_);
+  RowFactors factors = encode(query, prepared.codes.data());
+  prepared.scale = factors.scale;
+  prepared.constantDot = offset_norm_ + factors.offsetDot;
+  prepared.norm = std::sqrt(VectorOps::dotProduct(query, query, dimension_));
+  return prepared;
+}
+
+float ScalarQuantizer::distance(Metric metric, const Query &query,
+                                const int8_t *codes, const RowFactors &factors,
+                                float norm) const {
+  // (o + sq*cq) . (o + sx*cx) = o.o + sq*(o.cq) + sx*(o.cx) + sq*sx*(cq.cx)
+  float dot = query.constantDot + factors.offsetDot +
+              query.scale * factors.scale *
+                  static_cast<float>(VectorOps::dotProductInt8(
+                      query.codes.data(), codes, dimension_));
+  if (metric == Metric::DotProduct) {
+    return -dot;
+  }
+  if (metric == Metric::Euclidean) {
+    return std::max(0.0f, query.norm * query.norm + norm * norm - 2.0f * dot);
+  }
+
+  float denominator = query.norm * norm;
+  return denominator == 0.0f ? 0.0f : -dot / denominator;
+}
+
+size_t ScalarQuantizer::getDimension() const { return dimension_; }
+
+void ScalarQuantizer::save(BinaryWriter &out) const {
+  out.write<uint8_t>(trained_ ? 1 : 0);
+  out.writeArray(offsets_);
+}
+
+std::unique_ptr<ScalarQuantizer> ScalarQuantizer::load(BinaryReader &in) {
+  bool trained = in.read<uint8_t>() != 0;
+  std::vector<float> offsets = in.readArray<float>();
+  if (offsets.empty()) {
+    BinaryReader::fail("invalid scalar quantizer");
+  }
+
+  auto quantizer = std::make_unique<ScalarQuantizer>(offsets.size());
+  quantizer->trained_ = trained;
+  quantizer->offsets_ = std::move(offsets);
+  quantizer->offset_norm_ =
+      VectorOps::dotProduct(quantizer->offsets_.data(),
+                            quantizer->offsets_.data(), quantizer->dimension_);
+  return quantizer;
+}
+
+const std::vector<float> &ScalarQuantizer::getOffsets() const {
+  return offsets_;
+}
+
+} // namespace vectorsearch
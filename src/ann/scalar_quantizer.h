@@ -0,0 +1,78 @@
+// src/ann/scalar_quantizer.h
+#pragma once
+
+#include "vector_ops.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vectorsearch {
+
+class BinaryReader;
+class BinaryWriter;
+
+// Int8 scalar quantizer. Each dimension gets its own trained offset (the
+// mean of its training values) and each encoded vector its own step size, so
+// that x[i] ~= offset[i] + scale_x * code[i] with codes in [-127, 127].
+//
+// A per-vector step keeps a few extreme values (outlier dimensions are common
+// in embedding models) from collapsing every other vector onto a handful of
+// levels, and the dot product still expands into one int8 dot product plus
+// per-vector terms: (o + sq*cq) . (o + sx*cx) = o.o + sq*(o.cq) + sx*(o.cx) +
+// sq*sx*(cq.cx). L2 and cosine are derived from it and the exact norms.
+class ScalarQuantizer {
+public:
+  // Per-vector terms returned by encode(), stored alongside the codes
+  struct RowFactors {
+    float scale;     // step size of this vector's codes
+    float offsetDot; // scale * (offset . codes)
+  };
+
+  // Query-side state computed once per search
+  struct Query {
+    std::vector<int8_t> codes;
+    float scale;
+    float constantDot; // offset . offset + scale * (offset . codes)
+    float norm;        // exact norm of the float query
+  };
+
+  explicit ScalarQuantizer(size_t dimension);
+
+  // Learns the offsets from `count` rows spaced `stride` floats apart.
+  void train(const float *data, size_t count, size_t stride);
+
+  bool isTrained() const;
+
+  // Writes dimension() codes for `vector` and returns its per-vector terms.
+  RowFactors encode(const float *vector, int8_t *codes) const;
+
+  void decode(const int8_t *codes, const RowFactors &factors,
+              float *vector) const;
+
+  Query prepareQuery(const float *query) const;
+
+  // Approximate VectorOps::distance between the query and an encoded vector.
+  // `factors` is the value returned by encode() and `norm` the exact norm of
+  // the original vector (used for Euclidean and cosine).
+  float distance(Metric metric, const Query &query, const int8_t *codes,
+                 const RowFactors &factors, float norm) const;
+
+  size_t getDimension() const;
+
+  const std::vector<float> &getOffsets() const;
+
+  void save(BinaryWriter &out) const;
+
+  // Restores a quantizer written by save(). Throws std::runtime_error if the
+  // data is malformed.
+  static std::unique_ptr<ScalarQuantizer> load(BinaryReader &in);
+
+private:
+  size_t dimension_;
+  float offset_norm_ = 0.0f; // offset . offset
+  std::vector<float> offsets_;
+  bool trained_ = false;
+};
+
+} // namespace vectorsearch
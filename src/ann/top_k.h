@@ -0,0 +1,83 @@
+// src/ann/top_k.h
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace vectorsearch {
+
+// Candidate produced by a search path; smaller distance means closer.
+struct Neighbor {
+  float distance;
+  uint32_t label;
+
+  bool operator<(const Neighbor &other) const {
+    return distance < other.distance ||
+           (distance == other.distance && label < other.label);
+  }
+
+  bool operator>(const Neighbor &other) const { return other < *this; }
+};
+
+// Optional predicate restricting which labels a search may return; an
+// empty function accepts every label.
+using LabelFilter = std::function<bool(uint32_t label)>;
+
+// Work done by one index search, for instrumentation. Searches add to the
+// fields, so one instance can accumulate over several calls.
+struct SearchStats {
+  // Query-to-vector (or query-to-centroid) distances evaluated
+  size_t distanceComputations = 0;
+  // Graph nodes expanded (HNSW) or inverted lists scanned (IVF)
+  size_t nodesVisited = 0;
+};
+
+// Bounded max-heap keeping the k closest neighbours seen so far.
+class TopK {
+public:
+  explicit TopK(size_t k) : k_(k) { heap_.reserve(k); }
+
+  bool full() const { return heap_.size() >= k_; }
+
+  size_t size() const { return heap_.size(); }
+
+  // Distance a new candidate has to beat to be kept.
+  float worstDistance() const { return heap_.front().distance; }
+
+  void push(float distance, uint32_t label) {
+    if (k_ == 0) {
+      return;
+    }
+    if (!full()) {
+      heap_.push_back({distance, label});
+      std::push_heap(heap_.begin(), heap_.end());
+    } else if (distance < heap_.front().distance) {
+      std::pop_heap(heap_.begin(), heap_.end());
+      heap_.back() = {distance, label};
+      std::push_heap(heap_.begin(), heap_.end());
+    }
+  }
+
+  void merge(const TopK &other) {
+    for (const Neighbor &n : other.heap_) {
+      push(n.distance, n.label);
+    }
+  }
+
+  // Drains the heap into a list sorted from closest to farthest.
+  std::vector<Neighbor> takeSorted() {
+    std::sort_heap(heap_.begin(), heap_.end());
+    std::vector<Neighbor> result;
+    result.swap(heap_);
+    return result;
+  }
+
+private:
+  size_t k_;
+  std::vector<Neighbor> heap_;
+};
+
+} // namespace vectorsearch
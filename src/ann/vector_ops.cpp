@@ -1,8 +1,21 @@
 // src/ann/vector_ops.cpp
 #include "vector_ops.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define VECTORSEARCH_X86_KERNELS 1
+// GCC 12's AVX-512 headers trip -Wuninitialized on _mm*_undefined_*().
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
 namespace {
 
 bool isSameDimension(const std::vector<float> &v1,
@@ -17,75 +30,1370 @@ void checkSameDimension(const std::vector<float> &v1,
   }
 }
 
-} // anonymous namespace
+// One entry per SIMD level; the active table is swapped atomically.
+struct Kernels {
+  vectorsearch::SimdLevel level;
+  float (*dot)(const float *, const float *, size_t);
+  float (*squaredL2)(const float *, const float *, size_t);
+  // Single pass computing the dot product and both squared norms.
+  void (*cosineTerms)(const float *, const float *, size_t, float *, float *,
+                      float *);
+  // Dot products of a block of queries against a block of rows.
+  void (*dotBlock)(const float *, size_t, size_t, const float *, size_t,
+                   size_t, size_t, float *);
+  int32_t (*dotInt8)(const int8_t *, const int8_t *, size_t);
+  // Half-precision rows; bf16 encoding is cheap enough to stay scalar.
+  float (*dotF16)(const float *, const uint16_t *, size_t);
+  float (*dotBF16)(const float *, const uint16_t *, size_t);
+  void (*toF16)(const float *, uint16_t *, size_t);
+  void (*fromF16)(const uint16_t *, float *, size_t);
+  void (*fromBF16)(const uint16_t *, float *, size_t);
+  // Hamming distances from one binary code to `count` consecutive codes.
+  void (*hammingScan)(const uint64_t *, const uint64_t *, size_t, size_t,
+                      uint32_t *);
+};
 
-namespace vectorsearch {
+// Scalar kernels
 
-float VectorOps::dotProduct(const std::vector<float> &v1,
-                            const std::vector<float> &v2) {
-  checkSameDimension(v1, v2);
+float dotScalar(const float *a, const float *b, size_t n) {
+  float result = 0.0f;
+  for (size_t i = 0; i < n; ++i) {
+    result += a[i] * b[i];
+  }
+  return result;
+}
+
+float squaredL2Scalar(const float *a, const float *b, size_t n) {
+  float sum = 0.0f;
+  for (size_t i = 0; i < n; ++i) {
+    float diff = a[i] - b[i];
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+void cosineTermsScalar(const float *a, const float *b, size_t n, float *dot,
+                       float *normA, float *normB) {
+  float d = 0.0f;
+  float na = 0.0f;
+  float nb = 0.0f;
+  for (size_t i = 0; i < n; ++i) {
+    d += a[i] * b[i];
+    na += a[i] * a[i];
+    nb += b[i] * b[i];
+  }
+  *dot = d;
+  *normA = na;
+  *normB = nb;
+}
+
+void dotBlockScalar(const float *queries, size_t numQueries,
+                    size_t queryStride, const float *rows, size_t numRows,
+                    size_t rowStride, size_t n, float *scores) {
+  for (size_t q = 0; q < numQueries; ++q) {
+    for (size_t r = 0; r < numRows; ++r) {
+      scores[q * numRows + r] =
+          dotScalar(queries + q * queryStride, rows + r * rowStride, n);
+    }
+  }
+}
+
+int32_t dotInt8Scalar(const int8_t *a, const int8_t *b, size_t n) {
+  int32_t result = 0;
+  for (size_t i = 0; i < n; ++i) {
+    result += static_cast<int32_t>(a[i]) * b[i];
+  }
+  return result;
+}
+
+void hammingScanScalar(const uint64_t *query, const uint64_t *codes,
+                       size_t words, size_t count, uint32_t *distances) {
+  for (size_t r = 0; r < count; ++r, codes += words) {
+    uint32_t distance = 0;
+    for (size_t w = 0; w < words; ++w) {
+      distance += static_cast<uint32_t>(__builtin_popcountll(query[w] ^
+                                                             codes[w]));
+    }
+    distances[r] = distance;
+  }
+}
+
+// Half-precision conversions. fp16 follows IEEE binary16 with
+// round-to-nearest-even, matching what F16C produces; bf16 keeps the top 16
+// bits of the float32 after rounding.
+
+uint16_t floatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+  const uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+  if (magnitude >= 0x7F800000u) { // Infinity or NaN (kept quiet)
+    return sign | 0x7C00u |
+           (magnitude > 0x7F800000u ? 0x200u | ((magnitude >> 13) & 0x3FFu)
+                                    : 0u);
+  }
+  if (magnitude >= 0x477FF000u) { // Rounds past 65504
+    return sign | 0x7C00u;
+  }
+  if (magnitude < 0x38800000u) { // Below 2^-14: subnormal or zero
+    float m;
+    std::memcpy(&m, &magnitude, sizeof(m));
+    // Scaling by 2^24 is exact; nearbyint rounds to nearest even
+    return sign | static_cast<uint16_t>(std::nearbyint(m * 16777216.0f));
+  }
+  // Rebias the exponent and round the mantissa from 23 to 10 bits
+  const uint32_t rounded = magnitude + 0xFFFu + ((magnitude >> 13) & 1u);
+  return sign | static_cast<uint16_t>((rounded - 0x38000000u) >> 13);
+}
+
+float halfToFloat(uint16_t half) {
+  const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1Fu;
+  const uint32_t mantissa = half & 0x3FFu;
+
+  uint32_t bits;
+  if (exponent == 0) {
+    float value = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits |= sign;
+  } else if (exponent == 0x1F) {
+    bits = sign | 0x7F800000u | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+uint16_t floatToBFloat16(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+    return static_cast<uint16_t>((bits >> 16) | 0x40u);
+  }
+  bits += 0x7FFFu + ((bits >> 16) & 1u);
+  return static_cast<uint16_t>(bits >> 16);
+}
 
+inline float bfloat16ToFloat(uint16_t value) {
+  const uint32_t bits = static_cast<uint32_t>(value) << 16;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+float dotF16Scalar(const float *a, const uint16_t *b, size_t n) {
   float result = 0.0f;
-  for (size_t i = 0; i < v1.size(); ++i) {
-    result += v1[i] * v2[i];
+  for (size_t i = 0; i < n; ++i) {
+    result += a[i] * halfToFloat(b[i]);
   }
+  return result;
+}
 
+float dotBF16Scalar(const float *a, const uint16_t *b, size_t n) {
+  float result = 0.0f;
+  for (size_t i = 0; i < n; ++i) {
+    result += a[i] * bfloat16ToFloat(b[i]);
+  }
   return result;
 }
 
-float VectorOps::euclideanDistance(const std::vector<float> &v1,
-                                   const std::vector<float> &v2) {
-  checkSameDimension(v1, v2);
+void toF16Scalar(const float *src, uint16_t *dst, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = floatToHalf(src[i]);
+  }
+}
 
-  float sum = 0.0f;
-  for (size_t i = 0; i < v1.size(); ++i) {
-    float diff = v1[i] - v2[i];
+void fromF16Scalar(const uint16_t *src, float *dst, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = halfToFloat(src[i]);
+  }
+}
+
+void fromBF16Scalar(const uint16_t *src, float *dst, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = bfloat16ToFloat(src[i]);
+  }
+}
+
+constexpr Kernels kScalarKernels = {
+    vectorsearch::SimdLevel::Scalar, dotScalar,      squaredL2Scalar,
+    cosineTermsScalar,               dotBlockScalar, dotInt8Scalar,
+    dotF16Scalar,                    dotBF16Scalar,  toF16Scalar,
+    fromF16Scalar,                   fromBF16Scalar, hammingScanScalar};
+
+#ifdef VECTORSEARCH_X86_KERNELS
+
+// AVX2 + FMA kernels: four independent 8-wide accumulators hide the FMA
+// latency, the remainder is handled by a scalar tail.
+
+__attribute__((target("avx2,fma"))) inline float hsum256(__m256 v) {
+  __m128 lo = _mm256_castps256_ps128(v);
+  __m128 hi = _mm256_extractf128_ps(v, 1);
+  lo = _mm_add_ps(lo, hi);
+  __m128 shuf = _mm_movehdup_ps(lo);
+  __m128 sums = _mm_add_ps(lo, shuf);
+  shuf = _mm_movehl_ps(shuf, sums);
+  sums = _mm_add_ss(sums, shuf);
+  return _mm_cvtss_f32(sums);
+}
+
+__attribute__((target("avx2,fma"))) float dotAvx2(const float *a,
+                                                  const float *b, size_t n) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  __m256 acc2 = _mm256_setzero_ps();
+  __m256 acc3 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+                           _mm256_loadu_ps(b + i + 8), acc1);
+    acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16),
+                           _mm256_loadu_ps(b + i + 16), acc2);
+    acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24),
+                           _mm256_loadu_ps(b + i + 24), acc3);
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+  }
+  float result =
+      hsum256(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+  for (; i < n; ++i) {
+    result += a[i] * b[i];
+  }
+  return result;
+}
+
+__attribute__((target("avx2,fma"))) float
+squaredL2Avx2(const float *a, const float *b, size_t n) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    __m256 d1 =
+        _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+    acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+    acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    acc0 = _mm256_fmadd_ps(d, d, acc0);
+  }
+  float sum = hsum256(_mm256_add_ps(acc0, acc1));
+  for (; i < n; ++i) {
+    float diff = a[i] - b[i];
     sum += diff * diff;
   }
+  return sum;
+}
 
-  return std::sqrt(sum);
+__attribute__((target("avx2,fma"))) void
+cosineTermsAvx2(const float *a, const float *b, size_t n, float *dot,
+                float *normA, float *normB) {
+  __m256 accDot = _mm256_setzero_ps();
+  __m256 accA = _mm256_setzero_ps();
+  __m256 accB = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 va = _mm256_loadu_ps(a + i);
+    __m256 vb = _mm256_loadu_ps(b + i);
+    accDot = _mm256_fmadd_ps(va, vb, accDot);
+    accA = _mm256_fmadd_ps(va, va, accA);
+    accB = _mm256_fmadd_ps(vb, vb, accB);
+  }
+  float d = hsum256(accDot);
+  float na = hsum256(accA);
+  float nb = hsum256(accB);
+  for (; i < n; ++i) {
+    d += a[i] * b[i];
+    na += a[i] * a[i];
+    nb += b[i] * b[i];
+  }
+  *dot = d;
+  *normA = na;
+  *normB = nb;
 }
 
-float VectorOps::cosineSimilarity(const std::vector<float> &v1,
-                                  const std::vector<float> &v2) {
-  checkSameDimension(v1, v2);
+// Register-blocked micro-kernel: a 4x2 tile of queries x rows keeps eight
+// accumulators live, so each loaded row chunk feeds four FMAs and each query
+// chunk two, instead of one load per FMA in the single-vector kernel.
+__attribute__((target("avx2,fma"))) void
+dotBlockAvx2(const float *queries, size_t numQueries, size_t queryStride,
+             const float *rows, size_t numRows, size_t rowStride, size_t n,
+             float *scores) {
+  constexpr size_t QB = 4;
+  constexpr size_t RB = 2;
+  const size_t simdEnd = n / 8 * 8;
 
-  float dot = dotProduct(v1, v2);
-  float norm1 = 0.0f;
-  float norm2 = 0.0f;
+  size_t q = 0;
+  for (; q + QB <= numQueries; q += QB) {
+    const float *qp[QB];
+    for (size_t a = 0; a < QB; ++a) {
+      qp[a] = queries + (q + a) * queryStride;
+    }
+
+    size_t r = 0;
+    for (; r + RB <= numRows; r += RB) {
+      const float *rp[RB] = {rows + r * rowStride, rows + (r + 1) * rowStride};
+      __m256 acc[QB][RB];
+#pragma GCC unroll 4
+      for (size_t a = 0; a < QB; ++a) {
+#pragma GCC unroll 2
+        for (size_t b = 0; b < RB; ++b) {
+          acc[a][b] = _mm256_setzero_ps();
+        }
+      }
 
-  for (size_t i = 0; i < v1.size(); ++i) {
-    norm1 += v1[i] * v1[i];
-    norm2 += v2[i] * v2[i];
+      for (size_t i = 0; i < simdEnd; i += 8) {
+        __m256 x0 = _mm256_loadu_ps(rp[0] + i);
+        __m256 x1 = _mm256_loadu_ps(rp[1] + i);
+#pragma GCC unroll 4
+        for (size_t a = 0; a < QB; ++a) {
+          __m256 qv = _mm256_loadu_ps(qp[a] + i);
+          acc[a][0] = _mm256_fmadd_ps(qv, x0, acc[a][0]);
+          acc[a][1] = _mm256_fmadd_ps(qv, x1, acc[a][1]);
+        }
+      }
+
+      for (size_t a = 0; a < QB; ++a) {
+        for (size_t b = 0; b < RB; ++b) {
+          float sum = hsum256(acc[a][b]);
+          for (size_t i = simdEnd; i < n; ++i) {
+            sum += qp[a][i] * rp[b][i];
+          }
+          scores[(q + a) * numRows + r + b] = sum;
+        }
+      }
+    }
+    for (; r < numRows; ++r) {
+      for (size_t a = 0; a < QB; ++a) {
+        scores[(q + a) * numRows + r] = dotAvx2(qp[a], rows + r * rowStride, n);
+      }
+    }
   }
 
+  for (; q < numQueries; ++q) {
+    for (size_t r = 0; r < numRows; ++r) {
+      scores[q * numRows + r] =
+          dotAvx2(queries + q * queryStride, rows + r * rowStride, n);
+    }
+  }
+}
+
+// The int8 kernel widens to int16 and uses madd, which multiplies and sums
+// adjacent pairs into int32 lanes without any risk of saturation.
+
+__attribute__((target("avx2"))) inline int32_t hsum256Epi32(__m256i v) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v),
+                              _mm256_extracti128_si256(v, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+  return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2"))) int32_t dotInt8Avx2(const int8_t *a,
+                                                    const int8_t *b,
+                                                    size_t n) {
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i va = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+    __m256i vb = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+  }
+  int32_t result = hsum256Epi32(acc);
+  for (; i < n; ++i) {
+    result += static_cast<int32_t>(a[i]) * b[i];
+  }
+  return result;
+}
+
+// Half-precision rows: F16C widens eight fp16 values per instruction, and a
+// bf16 value is a float32 with the low 16 bits cleared, so widening is a
+// zero-extend plus shift. The conversion feeds the FMA directly, so rows are
+// never materialized as fp32 in memory.
+
+__attribute__((target("avx2,fma,f16c"))) inline __m256
+loadF16Avx2(const uint16_t *p) {
+  return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+
+__attribute__((target("avx2,fma"))) inline __m256
+loadBF16Avx2(const uint16_t *p) {
+  return _mm256_castsi256_ps(_mm256_slli_epi32(
+      _mm256_cvtepu16_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(p))),
+      16));
+}
+
+__attribute__((target("avx2,fma,f16c"))) float
+dotF16Avx2(const float *a, const uint16_t *b, size_t n) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), loadF16Avx2(b + i), acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), loadF16Avx2(b + i + 8),
+                           acc1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), loadF16Avx2(b + i), acc0);
+  }
+  float result = hsum256(_mm256_add_ps(acc0, acc1));
+  for (; i < n; ++i) {
+    result += a[i] * halfToFloat(b[i]);
+  }
+  return result;
+}
+
+__attribute__((target("avx2,fma"))) float
+dotBF16Avx2(const float *a, const uint16_t *b, size_t n) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), loadBF16Avx2(b + i), acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+                           loadBF16Avx2(b + i + 8), acc1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), loadBF16Avx2(b + i), acc0);
+  }
+  float result = hsum256(_mm256_add_ps(acc0, acc1));
+  for (; i < n; ++i) {
+    result += a[i] * bfloat16ToFloat(b[i]);
+  }
+  return result;
+}
+
+__attribute__((target("avx2,f16c"))) void
+toF16Avx2(const float *src, uint16_t *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                     _MM_FROUND_TO_NEAREST_INT));
+  }
+  for (; i < n; ++i) {
+    dst[i] = floatToHalf(src[i]);
+  }
+}
+
+__attribute__((target("avx2,fma,f16c"))) void
+fromF16Avx2(const uint16_t *src, float *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, loadF16Avx2(src + i));
+  }
+  for (; i < n; ++i) {
+    dst[i] = halfToFloat(src[i]);
+  }
+}
+
+__attribute__((target("avx2,fma"))) void
+fromBF16Avx2(const uint16_t *src, float *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, loadBF16Avx2(src + i));
+  }
+  for (; i < n; ++i) {
+    dst[i] = bfloat16ToFloat(src[i]);
+  }
+}
+
+// Binary codes are short (a 768-d vector is 12 words), so the scalar POPCNT
+// instruction with independent per-word counts beats a pshufb popcount.
+__attribute__((target("popcnt"))) void
+hammingScanPopcnt(const uint64_t *query, const uint64_t *codes, size_t words,
+                  size_t count, uint32_t *distances) {
+  for (size_t r = 0; r < count; ++r, codes += words) {
+    uint64_t c0 = 0;
+    uint64_t c1 = 0;
+    uint64_t c2 = 0;
+    uint64_t c3 = 0;
+    size_t w = 0;
+    for (; w + 4 <= words; w += 4) {
+      c0 += _mm_popcnt_u64(query[w] ^ codes[w]);
+      c1 += _mm_popcnt_u64(query[w + 1] ^ codes[w + 1]);
+      c2 += _mm_popcnt_u64(query[w + 2] ^ codes[w + 2]);
+      c3 += _mm_popcnt_u64(query[w + 3] ^ codes[w + 3]);
+    }
+    for (; w < words; ++w) {
+      c0 += _mm_popcnt_u64(query[w] ^ codes[w]);
+    }
+    distances[r] = static_cast<uint32_t>((c0 + c1) + (c2 + c3));
+  }
+}
+
+constexpr Kernels kAvx2Kernels = {
+    vectorsearch::SimdLevel::AVX2, dotAvx2,      squaredL2Avx2,
+    cosineTermsAvx2,               dotBlockAvx2, dotInt8Avx2,
+    dotF16Avx2,                    dotBF16Avx2,  toF16Avx2,
+    fromF16Avx2,                   fromBF16Avx2, hammingScanPopcnt};
+
+// AVX-512 kernels: 16-wide accumulators and a masked load for the tail, so
+// there is no scalar remainder loop.
+
+__attribute__((target("avx512f"))) inline float hsum512(__m512 v) {
+  __m512 sums = _mm512_add_ps(v, _mm512_shuffle_f32x4(v, v, 0x4E));
+  sums = _mm512_add_ps(sums, _mm512_shuffle_f32x4(sums, sums, 0xB1));
+  __m128 x = _mm512_castps512_ps128(sums);
+  x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+  x = _mm_add_ss(x, _mm_movehdup_ps(x));
+  return _mm_cvtss_f32(x);
+}
+
+__attribute__((target("avx512f"))) float dotAvx512(const float *a,
+                                                   const float *b, size_t n) {
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16),
+                           _mm512_loadu_ps(b + i + 16), acc1);
+  }
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+  }
+  if (i < n) {
+    __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+    acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                           _mm512_maskz_loadu_ps(mask, b + i), acc1);
+  }
+  return hsum512(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f"))) float
+squaredL2Avx512(const float *a, const float *b, size_t n) {
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    __m512 d1 =
+        _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+    acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+    acc1 = _mm512_fmadd_ps(d1, d1, acc1);
+  }
+  for (; i + 16 <= n; i += 16) {
+    __m512 d = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    acc0 = _mm512_fmadd_ps(d, d, acc0);
+  }
+  if (i < n) {
+    __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+    __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                             _mm512_maskz_loadu_ps(mask, b + i));
+    acc1 = _mm512_fmadd_ps(d, d, acc1);
+  }
+  return hsum512(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f"))) void
+cosineTermsAvx512(const float *a, const float *b, size_t n, float *dot,
+                  float *normA, float *normB) {
+  __m512 accDot = _mm512_setzero_ps();
+  __m512 accA = _mm512_setzero_ps();
+  __m512 accB = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 va = _mm512_loadu_ps(a + i);
+    __m512 vb = _mm512_loadu_ps(b + i);
+    accDot = _mm512_fmadd_ps(va, vb, accDot);
+    accA = _mm512_fmadd_ps(va, va, accA);
+    accB = _mm512_fmadd_ps(vb, vb, accB);
+  }
+  if (i < n) {
+    __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+    __m512 va = _mm512_maskz_loadu_ps(mask, a + i);
+    __m512 vb = _mm512_maskz_loadu_ps(mask, b + i);
+    accDot = _mm512_fmadd_ps(va, vb, accDot);
+    accA = _mm512_fmadd_ps(va, va, accA);
+    accB = _mm512_fmadd_ps(vb, vb, accB);
+  }
+  *dot = hsum512(accDot);
+  *normA = hsum512(accA);
+  *normB = hsum512(accB);
+}
+
+// 4x4 tile of queries x rows: sixteen accumulators plus eight loads fit in
+// the 32 zmm registers, giving two FMAs per load.
+__attribute__((target("avx512f"))) void
+dotBlockAvx512(const float *queries, size_t numQueries, size_t queryStride,
+               const float *rows, size_t numRows, size_t rowStride, size_t n,
+               float *scores) {
+  constexpr size_t QB = 4;
+  constexpr size_t RB = 4;
+  const size_t simdEnd = n / 16 * 16;
+  const __mmask16 tailMask = static_cast<__mmask16>((1u << (n - simdEnd)) - 1);
+
+  size_t q = 0;
+  for (; q + QB <= numQueries; q += QB) {
+    const float *qp[QB];
+    for (size_t a = 0; a < QB; ++a) {
+      qp[a] = queries + (q + a) * queryStride;
+    }
+
+    size_t r = 0;
+    for (; r + RB <= numRows; r += RB) {
+      const float *rp[RB];
+      for (size_t b = 0; b < RB; ++b) {
+        rp[b] = rows + (r + b) * rowStride;
+      }
+      __m512 acc[QB][RB];
+#pragma GCC unroll 4
+      for (size_t a = 0; a < QB; ++a) {
+#pragma GCC unroll 4
+        for (size_t b = 0; b < RB; ++b) {
+          acc[a][b] = _mm512_setzero_ps();
+        }
+      }
+
+      for (size_t i = 0; i < simdEnd; i += 16) {
+        __m512 x[RB];
+#pragma GCC unroll 4
+        for (size_t b = 0; b < RB; ++b) {
+          x[b] = _mm512_loadu_ps(rp[b] + i);
+        }
+#pragma GCC unroll 4
+        for (size_t a = 0; a < QB; ++a) {
+          __m512 qv = _mm512_loadu_ps(qp[a] + i);
+#pragma GCC unroll 4
+          for (size_t b = 0; b < RB; ++b) {
+            acc[a][b] = _mm512_fmadd_ps(qv, x[b], acc[a][b]);
+          }
+        }
+      }
+      if (simdEnd < n) {
+        __m512 x[RB];
+#pragma GCC unroll 4
+        for (size_t b = 0; b < RB; ++b) {
+          x[b] = _mm512_maskz_loadu_ps(tailMask, rp[b] + simdEnd);
+        }
+#pragma GCC unroll 4
+        for (size_t a = 0; a < QB; ++a) {
+          __m512 qv = _mm512_maskz_loadu_ps(tailMask, qp[a] + simdEnd);
+#pragma GCC unroll 4
+          for (size_t b = 0; b < RB; ++b) {
+            acc[a][b] = _mm512_fmadd_ps(qv, x[b], acc[a][b]);
+          }
+        }
+      }
+
+      for (size_t a = 0; a < QB; ++a) {
+        for (size_t b = 0; b < RB; ++b) {
+          scores[(q + a) * numRows + r + b] = hsum512(acc[a][b]);
+        }
+      }
+    }
+    for (; r < numRows; ++r) {
+      for (size_t a = 0; a < QB; ++a) {
+        scores[(q + a) * numRows + r] =
+            dotAvx512(qp[a], rows + r * rowStride, n);
+      }
+    }
+  }
+
+  for (; q < numQueries; ++q) {
+    for (size_t r = 0; r < numRows; ++r) {
+      scores[q * numRows + r] =
+          dotAvx512(queries + q * queryStride, rows + r * rowStride, n);
+    }
+  }
+}
+
+__attribute__((target("avx512f,avx512bw"))) int32_t
+dotInt8Avx512(const int8_t *a, const int8_t *b, size_t n) {
+  __m512i acc = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m512i va = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)));
+    __m512i vb = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+    acc = _mm512_add_epi32(acc, _mm512_madd_epi16(va, vb));
+  }
+  int32_t result = _mm512_reduce_add_epi32(acc);
+  for (; i < n; ++i) {
+    result += static_cast<int32_t>(a[i]) * b[i];
+  }
+  return result;
+}
+
+// Half-precision rows, 16 lanes at a time. The fp16 widening is part of
+// AVX-512F; tails use a masked 16-bit load.
+
+__attribute__((target("avx512f,avx512bw,avx512vl"))) inline __m256i
+loadHalfTailAvx512(const uint16_t *p, size_t count) {
+  return _mm256_maskz_loadu_epi16(static_cast<__mmask16>((1u << count) - 1), p);
+}
+
+__attribute__((target("avx512f"))) inline __m512
+widenBF16Avx512(__m256i bits) {
+  return _mm512_castsi512_ps(
+      _mm512_slli_epi32(_mm512_cvtepu16_epi32(bits), 16));
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vl"))) float
+dotF16Avx512(const float *a, const uint16_t *b, size_t n) {
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    acc0 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(a + i),
+        _mm512_cvtph_ps(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))),
+        acc0);
+    acc1 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(a + i + 16),
+        _mm512_cvtph_ps(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 16))),
+        acc1);
+  }
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(a + i),
+        _mm512_cvtph_ps(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))),
+        acc0);
+  }
+  if (i < n) {
+    __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+    acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                           _mm512_cvtph_ps(loadHalfTailAvx512(b + i, n - i)),
+                           acc1);
+  }
+  return hsum512(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vl"))) float
+dotBF16Avx512(const float *a, const uint16_t *b, size_t n) {
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    acc0 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(a + i),
+        widenBF16Avx512(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))),
+        acc0);
+    acc1 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(a + i + 16),
+        widenBF16Avx512(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 16))),
+        acc1);
+  }
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(a + i),
+        widenBF16Avx512(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))),
+        acc0);
+  }
+  if (i < n) {
+    __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+    acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                           widenBF16Avx512(loadHalfTailAvx512(b + i, n - i)),
+                           acc1);
+  }
+  return hsum512(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f"))) void
+toF16Avx512(const float *src, uint16_t *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst + i),
+        _mm512_cvtps_ph(_mm512_loadu_ps(src + i),
+                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  for (; i < n; ++i) {
+    dst[i] = floatToHalf(src[i]);
+  }
+}
+
+__attribute__((target("avx512f"))) void
+fromF16Avx512(const uint16_t *src, float *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm512_storeu_ps(dst + i,
+                     _mm512_cvtph_ps(_mm256_loadu_si256(
+                         reinterpret_cast<const __m256i *>(src + i))));
+  }
+  for (; i < n; ++i) {
+    dst[i] = halfToFloat(src[i]);
+  }
+}
+
+__attribute__((target("avx512f"))) void
+fromBF16Avx512(const uint16_t *src, float *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm512_storeu_ps(dst + i, widenBF16Avx512(_mm256_loadu_si256(
+                                  reinterpret_cast<const __m256i *>(src + i))));
+  }
+  for (; i < n; ++i) {
+    dst[i] = bfloat16ToFloat(src[i]);
+  }
+}
+
+constexpr Kernels kAvx512Kernels = {
+    vectorsearch::SimdLevel::AVX512, dotAvx512,      squaredL2Avx512,
+    cosineTermsAvx512,               dotBlockAvx512, dotInt8Avx512,
+    dotF16Avx512,                    dotBF16Avx512,  toF16Avx512,
+    fromF16Avx512,                   fromBF16Avx512, hammingScanPopcnt};
+
+// VPOPCNTDQ is not part of the AVX-512 baseline (Ice Lake and Zen 4 have it,
+// Skylake-X does not), so it gets its own table selected at run time.
+__attribute__((target("avx512f,avx512vpopcntdq"))) void
+hammingScanAvx512(const uint64_t *query, const uint64_t *codes, size_t words,
+                  size_t count, uint32_t *distances) {
+  for (size_t r = 0; r < count; ++r, codes += words) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t w = 0;
+    for (; w + 8 <= words; w += 8) {
+      const __m512i diff = _mm512_xor_si512(_mm512_loadu_si512(query + w),
+                                            _mm512_loadu_si512(codes + w));
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(diff));
+    }
+    if (w < words) {
+      const __mmask8 mask = static_cast<__mmask8>((1u << (words - w)) - 1);
+      const __m512i diff =
+          _mm512_xor_si512(_mm512_maskz_loadu_epi64(mask, query + w),
+                           _mm512_maskz_loadu_epi64(mask, codes + w));
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(diff));
+    }
+    distances[r] = static_cast<uint32_t>(_mm512_reduce_add_epi64(acc));
+  }
+}
+
+constexpr Kernels withHammingScan(Kernels table,
+                                  void (*scan)(const uint64_t *,
+                                               const uint64_t *, size_t,
+                                               size_t, uint32_t *)) {
+  table.hammingScan = scan;
+  return table;
+}
+
+constexpr Kernels kAvx512PopcntKernels =
+    withHammingScan(kAvx512Kernels, hammingScanAvx512);
+
+// Dimension-specialized kernels. The trip count is a template parameter and
+// every specialized dimension is a multiple of the unrolled step, so the loop
+// is fully unrolled with no tail and no length checks. Row policies widen
+// one vector of stored elements to fp32, so one template covers fp32, fp16
+// and bf16 rows.
+
+struct Float32RowAvx512 {
+  static constexpr size_t kStep = 16;
+  __attribute__((target("avx512f"))) static __m512 load(const void *row,
+                                                         size_t i) {
+    return _mm512_loadu_ps(static_cast<const float *>(row) + i);
+  }
+};
+
+struct Float16RowAvx512 {
+  static constexpr size_t kStep = 16;
+  __attribute__((target("avx512f"))) static __m512 load(const void *row,
+                                                         size_t i) {
+    return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(
+        static_cast<const uint16_t *>(row) + i)));
+  }
+};
+
+struct BFloat16RowAvx512 {
+  static constexpr size_t kStep = 16;
+  __attribute__((target("avx512f"))) static __m512 load(const void *row,
+                                                         size_t i) {
+    return widenBF16Avx512(_mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(static_cast<const uint16_t *>(row) +
+                                          i)));
+  }
+};
+
+template <size_t N, typename Row>
+__attribute__((target("avx512f"))) float
+dotFixedAvx512(const float *a, const void *row, size_t) {
+  static_assert(N % 64 == 0, "dimension must be a multiple of 64");
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  __m512 acc2 = _mm512_setzero_ps();
+  __m512 acc3 = _mm512_setzero_ps();
+#pragma GCC unroll 64
+  for (size_t i = 0; i < N; i += 64) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), Row::load(row, i), acc0);
+    acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), Row::load(row, i + 16),
+                           acc1);
+    acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 32), Row::load(row, i + 32),
+                           acc2);
+    acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 48), Row::load(row, i + 48),
+                           acc3);
+  }
+  return hsum512(
+      _mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)));
+}
+
+template <size_t N>
+__attribute__((target("avx512f"))) float
+negDotFixedAvx512(const float *a, const float *b, size_t n) {
+  return -dotFixedAvx512<N, Float32RowAvx512>(a, b, n);
+}
+
+template <size_t N>
+__attribute__((target("avx512f"))) float
+squaredL2FixedAvx512(const float *a, const float *b, size_t) {
+  static_assert(N % 32 == 0, "dimension must be a multiple of 32");
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+#pragma GCC unroll 128
+  for (size_t i = 0; i < N; i += 32) {
+    __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    __m512 d1 =
+        _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+    acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+    acc1 = _mm512_fmadd_ps(d1, d1, acc1);
+  }
+  return hsum512(_mm512_add_ps(acc0, acc1));
+}
+
+struct Float32RowAvx2 {
+  __attribute__((target("avx2,fma"))) static __m256 load(const void *row,
+                                                         size_t i) {
+    return _mm256_loadu_ps(static_cast<const float *>(row) + i);
+  }
+};
+
+struct Float16RowAvx2 {
+  __attribute__((target("avx2,fma,f16c"))) static __m256 load(const void *row,
+                                                              size_t i) {
+    return loadF16Avx2(static_cast<const uint16_t *>(row) + i);
+  }
+};
+
+struct BFloat16RowAvx2 {
+  __attribute__((target("avx2,fma"))) static __m256 load(const void *row,
+                                                         size_t i) {
+    return loadBF16Avx2(static_cast<const uint16_t *>(row) + i);
+  }
+};
+
+template <size_t N, typename Row>
+__attribute__((target("avx2,fma,f16c"))) float
+dotFixedAvx2(const float *a, const void *row, size_t) {
+  static_assert(N % 32 == 0, "dimension must be a multiple of 32");
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  __m256 acc2 = _mm256_setzero_ps();
+  __m256 acc3 = _mm256_setzero_ps();
+#pragma GCC unroll 128
+  for (size_t i = 0; i < N; i += 32) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), Row::load(row, i), acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), Row::load(row, i + 8),
+                           acc1);
+    acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), Row::load(row, i + 16),
+                           acc2);
+    acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), Row::load(row, i + 24),
+                           acc3);
+  }
+  return hsum256(
+      _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+}
+
+template <size_t N>
+__attribute__((target("avx2,fma,f16c"))) float
+negDotFixedAvx2(const float *a, const float *b, size_t n) {
+  return -dotFixedAvx2<N, Float32RowAvx2>(a, b, n);
+}
+
+template <size_t N>
+__attribute__((target("avx2,fma"))) float
+squaredL2FixedAvx2(const float *a, const float *b, size_t) {
+  static_assert(N % 16 == 0, "dimension must be a multiple of 16");
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+#pragma GCC unroll 256
+  for (size_t i = 0; i < N; i += 16) {
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    __m256 d1 =
+        _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+    acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+    acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+  }
+  return hsum256(_mm256_add_ps(acc0, acc1));
+}
+
+#endif // VECTORSEARCH_X86_KERNELS
+
+// Kernels handed out by VectorOps::distanceKernel() and rowDotKernel() for
+// one dimension.
+struct FixedKernels {
+  vectorsearch::DistanceKernel negDot;
+  vectorsearch::DistanceKernel squaredL2;
+  vectorsearch::RowDotKernel dotFloat32;
+  vectorsearch::RowDotKernel dotFloat16;
+  vectorsearch::RowDotKernel dotBFloat16;
+};
+
+#ifdef VECTORSEARCH_X86_KERNELS
+
+template <size_t N>
+constexpr FixedKernels kFixedAvx512 = {
+    negDotFixedAvx512<N>, squaredL2FixedAvx512<N>,
+    dotFixedAvx512<N, Float32RowAvx512>, dotFixedAvx512<N, Float16RowAvx512>,
+    dotFixedAvx512<N, BFloat16RowAvx512>};
+
+template <size_t N>
+constexpr FixedKernels kFixedAvx2 = {
+    negDotFixedAvx2<N>, squaredL2FixedAvx2<N>, dotFixedAvx2<N, Float32RowAvx2>,
+    dotFixedAvx2<N, Float16RowAvx2>, dotFixedAvx2<N, BFloat16RowAvx2>};
+
+#endif // VECTORSEARCH_X86_KERNELS
+
+template <size_t N>
+const FixedKernels *fixedKernelsAt(vectorsearch::SimdLevel level) {
+  switch (level) {
+#ifdef VECTORSEARCH_X86_KERNELS
+  case vectorsearch::SimdLevel::AVX512:
+    return &kFixedAvx512<N>;
+  case vectorsearch::SimdLevel::AVX2:
+    return &kFixedAvx2<N>;
+#endif
+  default:
+    return nullptr;
+  }
+}
+
+// Specialized kernels for `dimension` at `level`, or nullptr; must match
+// VectorOps::kSpecializedDimensions.
+const FixedKernels *fixedKernelsFor(vectorsearch::SimdLevel level,
+                                    size_t dimension) {
+  switch (dimension) {
+  case 128:
+    return fixedKernelsAt<128>(level);
+  case 384:
+    return fixedKernelsAt<384>(level);
+  case 768:
+    return fixedKernelsAt<768>(level);
+  case 1024:
+    return fixedKernelsAt<1024>(level);
+  case 1536:
+    return fixedKernelsAt<1536>(level);
+  case 3072:
+    return fixedKernelsAt<3072>(level);
+  default:
+    return nullptr;
+  }
+}
+
+const Kernels *kernelsFor(vectorsearch::SimdLevel level) {
+  switch (level) {
+#ifdef VECTORSEARCH_X86_KERNELS
+  case vectorsearch::SimdLevel::AVX512:
+    return __builtin_cpu_supports("avx512vpopcntdq") ? &kAvx512PopcntKernels
+                                                     : &kAvx512Kernels;
+  case vectorsearch::SimdLevel::AVX2:
+    return &kAvx2Kernels;
+#endif
+  default:
+    return &kScalarKernels;
+  }
+}
+
+bool cpuSupports(vectorsearch::SimdLevel level) {
+  switch (level) {
+  case vectorsearch::SimdLevel::Scalar:
+    return true;
+#ifdef VECTORSEARCH_X86_KERNELS
+  case vectorsearch::SimdLevel::AVX2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+           __builtin_cpu_supports("f16c") && __builtin_cpu_supports("popcnt");
+  case vectorsearch::SimdLevel::AVX512:
+    return __builtin_cpu_supports("avx512f") &&
+           __builtin_cpu_supports("avx512bw") &&
+           __builtin_cpu_supports("avx512vl") &&
+           __builtin_cpu_supports("popcnt");
+#endif
+  default:
+    return false;
+  }
+}
+
+vectorsearch::SimdLevel detectSimdLevel() {
+  if (cpuSupports(vectorsearch::SimdLevel::AVX512)) {
+    return vectorsearch::SimdLevel::AVX512;
+  }
+  if (cpuSupports(vectorsearch::SimdLevel::AVX2)) {
+    return vectorsearch::SimdLevel::AVX2;
+  }
+  return vectorsearch::SimdLevel::Scalar;
+}
+
+// Starts out as the scalar table (constant-initialized, so it is valid even
+// if another static initializer calls into VectorOps first) and is upgraded
+// to the best supported level during static initialization.
+std::atomic<const Kernels *> activeKernels{&kScalarKernels};
+
+[[maybe_unused]] const bool kernelsInitialized = [] {
+  activeKernels.store(kernelsFor(detectSimdLevel()), std::memory_order_release);
+  return true;
+}();
+
+inline const Kernels &kernels() {
+  return *activeKernels.load(std::memory_order_acquire);
+}
+
+// Generic fallbacks for VectorOps::distanceKernel() and rowDotKernel(),
+// dispatching through the active table on every call.
+
+float negDotGeneric(const float *a, const float *b, size_t n) {
+  return -kernels().dot(a, b, n);
+}
+
+float squaredL2Generic(const float *a, const float *b, size_t n) {
+  return kernels().squaredL2(a, b, n);
+}
+
+float negCosineGeneric(const float *a, const float *b, size_t n) {
+  return -vectorsearch::VectorOps::cosineSimilarity(a, b, n);
+}
+
+float dotFloat32Generic(const float *query, const void *row, size_t n) {
+  return kernels().dot(query, static_cast<const float *>(row), n);
+}
+
+float dotFloat16Generic(const float *query, const void *row, size_t n) {
+  return kernels().dotF16(query, static_cast<const uint16_t *>(row), n);
+}
+
+float dotBFloat16Generic(const float *query, const void *row, size_t n) {
+  return kernels().dotBF16(query, static_cast<const uint16_t *>(row), n);
+}
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+float VectorOps::dotProduct(const float *v1, const float *v2,
+                            size_t dimension) {
+  return kernels().dot(v1, v2, dimension);
+}
+
+float VectorOps::squaredEuclideanDistance(const float *v1, const float *v2,
+                                          size_t dimension) {
+  return kernels().squaredL2(v1, v2, dimension);
+}
+
+float VectorOps::euclideanDistance(const float *v1, const float *v2,
+                                   size_t dimension) {
+  return std::sqrt(kernels().squaredL2(v1, v2, dimension));
+}
+
+float VectorOps::cosineSimilarity(const float *v1, const float *v2,
+                                  size_t dimension) {
+  float dot = 0.0f;
+  float norm1 = 0.0f;
+  float norm2 = 0.0f;
+  kernels().cosineTerms(v1, v2, dimension, &dot, &norm1, &norm2);
+
   if (norm1 == 0.0f || norm2 == 0.0f) { // Avoid division by zero
     return 0.0f;
   }
 
-  norm1 = std::sqrt(norm1);
-  norm2 = std::sqrt(norm2);
+  return dot / (std::sqrt(norm1) * std::sqrt(norm2));
+}
+
+void VectorOps::normalize(float *v, size_t dimension) {
+  float norm = std::sqrt(dotProduct(v, v, dimension));
+  if (norm == 0.0f) {
+    return;
+  }
 
-  return dot / (norm1 * norm2);
+  const float scale = 1.0f / norm;
+  for (size_t i = 0; i < dimension; ++i) {
+    v[i] *= scale;
+  }
 }
 
-std::vector<float> VectorOps::normalize(const std::vector<float> &v) {
-  float norm = 0.0f;
-  for (float val : v) {
-    norm += val * val;
+int32_t VectorOps::dotProductInt8(const int8_t *v1, const int8_t *v2,
+                                  size_t dimension) {
+  return kernels().dotInt8(v1, v2, dimension);
+}
+
+uint32_t VectorOps::hammingDistance(const uint64_t *v1, const uint64_t *v2,
+                                    size_t words) {
+  uint32_t distance;
+  kernels().hammingScan(v1, v2, words, 1, &distance);
+  return distance;
+}
+
+void VectorOps::hammingDistances(const uint64_t *query, const uint64_t *codes,
+                                 size_t words, size_t count,
+                                 uint32_t *distances) {
+  kernels().hammingScan(query, codes, words, count, distances);
+}
+
+void VectorOps::toFloat16(const float *src, uint16_t *dst, size_t count) {
+  kernels().toF16(src, dst, count);
+}
+
+void VectorOps::fromFloat16(const uint16_t *src, float *dst, size_t count) {
+  kernels().fromF16(src, dst, count);
+}
+
+void VectorOps::toBFloat16(const float *src, uint16_t *dst, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = floatToBFloat16(src[i]);
   }
-  norm = std::sqrt(norm);
+}
+
+void VectorOps::fromBFloat16(const uint16_t *src, float *dst, size_t count) {
+  kernels().fromBF16(src, dst, count);
+}
+
+float VectorOps::dotProductFloat16(const float *query, const uint16_t *row,
+                                   size_t dimension) {
+  return kernels().dotF16(query, row, dimension);
+}
+
+float VectorOps::dotProductBFloat16(const float *query, const uint16_t *row,
+                                    size_t dimension) {
+  return kernels().dotBF16(query, row, dimension);
+}
+
+void VectorOps::dotProductBlock(const float *queries, size_t numQueries,
+                                size_t queryStride, const float *rows,
+                                size_t numRows, size_t rowStride,
+                                size_t dimension, float *scores) {
+  kernels().dotBlock(queries, numQueries, queryStride, rows, numRows,
+                     rowStride, dimension, scores);
+}
 
-  if (norm == 0.0f) { // Avoid division by zero
-    return std::vector<float>(v.size(), 0.0f);
+float VectorOps::distance(Metric metric, const float *v1, const float *v2,
+                          size_t dimension) {
+  switch (metric) {
+  case Metric::DotProduct:
+    return -kernels().dot(v1, v2, dimension);
+  case Metric::Euclidean:
+    return kernels().squaredL2(v1, v2, dimension);
+  case Metric::Cosine:
+    return -cosineSimilarity(v1, v2, dimension);
   }
+  throw std::invalid_argument("Unknown metric");
+}
+
+DistanceKernel VectorOps::distanceKernel(Metric metric, size_t dimension) {
+  const FixedKernels *fixed = fixedKernelsFor(kernels().level, dimension);
+  switch (metric) {
+  case Metric::DotProduct:
+    return fixed ? fixed->negDot : negDotGeneric;
+  case Metric::Euclidean:
+    return fixed ? fixed->squaredL2 : squaredL2Generic;
+  case Metric::Cosine:
+    return negCosineGeneric;
+  }
+  throw std::invalid_argument("Unknown metric");
+}
 
-  std::vector<float> result(v.size());
-  for (size_t i = 0; i < v.size(); ++i) {
-    result[i] = v[i] / norm;
+RowDotKernel VectorOps::rowDotKernel(ElementType type, size_t dimension) {
+  const FixedKernels *fixed = fixedKernelsFor(kernels().level, dimension);
+  switch (type) {
+  case ElementType::Float16:
+    return fixed ? fixed->dotFloat16 : dotFloat16Generic;
+  case ElementType::BFloat16:
+    return fixed ? fixed->dotBFloat16 : dotBFloat16Generic;
+  default:
+    return fixed ? fixed->dotFloat32 : dotFloat32Generic;
   }
+}
+
+bool VectorOps::hasSpecializedKernels(size_t dimension) {
+  return fixedKernelsFor(kernels().level, dimension) != nullptr;
+}
+
+float VectorOps::distanceToScore(Metric metric, float distance) {
+  switch (metric) {
+  case Metric::Euclidean:
+    return std::sqrt(std::max(distance, 0.0f));
+  default:
+    return -distance;
+  }
+}
+
+float VectorOps::dotProduct(const std::vector<float> &v1,
+                            const std::vector<float> &v2) {
+  checkSameDimension(v1, v2);
+  return dotProduct(v1.data(), v2.data(), v1.size());
+}
+
+float VectorOps::euclideanDistance(const std::vector<float> &v1,
+                                   const std::vector<float> &v2) {
+  checkSameDimension(v1, v2);
+  return euclideanDistance(v1.data(), v2.data(), v1.size());
+}
+
+float VectorOps::cosineSimilarity(const std::vector<float> &v1,
+                                  const std::vector<float> &v2) {
+  checkSameDimension(v1, v2);
+  return cosineSimilarity(v1.data(), v2.data(), v1.size());
+}
 
+std::vector<float> VectorOps::normalize(const std::vector<float> &v) {
+  std::vector<float> result(v);
+  normalize(result.data(), result.size());
   return result;
 }
 
-} // namespace vectorsearch
\ No newline at end of file
+bool VectorOps::isSameDimension(const std::vector<float> &v1,
+                                const std::vector<float> &v2) {
+  return ::isSameDimension(v1, v2);
+}
+
+SimdLevel VectorOps::simdLevel() { return kernels().level; }
+
+bool VectorOps::isSimdLevelSupported(SimdLevel level) {
+  return kernelsFor(level)->level == level && cpuSupports(level);
+}
+
+bool VectorOps::setSimdLevel(SimdLevel level) {
+  if (!isSimdLevelSupported(level)) {
+    return false;
+  }
+  activeKernels.store(kernelsFor(level), std::memory_order_release);
+  return true;
+}
+
+const char *VectorOps::simdLevelName(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::AVX2:
+    return "avx2";
+  case SimdLevel::AVX512:
+    return "avx512";
+  default:
+    return "scalar";
+  }
+}
+
+size_t VectorOps::elementSize(ElementType type) {
+  return type == ElementType::Float32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+const char *VectorOps::elementTypeName(ElementType type) {
+  switch (type) {
+  case ElementType::Float16:
+    return "fp16";
+  case ElementType::BFloat16:
+    return "bf16";
+  default:
+    return "fp32";
+  }
+}
+
+} // namespace vectorsearch
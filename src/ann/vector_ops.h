@@ -2,14 +2,123 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace vectorsearch {
 
+// Instruction set used by the pointer-based distance kernels. The best level
+// supported by the CPU is selected once at startup.
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+// Similarity metrics understood by the search paths.
+enum class Metric { DotProduct, Euclidean, Cosine };
+
+// Storage type of embedding rows. Half-precision rows hold the raw 16-bit
+// patterns: IEEE binary16 for Float16, the upper half of a float32 for
+// BFloat16. Queries and all arithmetic stay in fp32.
+enum class ElementType { Float32, Float16, BFloat16 };
+
+// Distance between two fp32 vectors, as VectorOps::distance() for one metric.
+using DistanceKernel = float (*)(const float *, const float *, size_t);
+
+// Dot product of an fp32 query with a row of one ElementType.
+using RowDotKernel = float (*)(const float *query, const void *row,
+                               size_t dimension);
+
 class VectorOps final {
 public:
   VectorOps() = delete;
 
+  // Raw pointer + length kernels. Callers are responsible for passing buffers
+  // of at least `dimension` floats; no dimension checks are performed so that
+  // rows of contiguous storage can be scored without copying.
+  static float dotProduct(const float *v1, const float *v2, size_t dimension);
+
+  static float squaredEuclideanDistance(const float *v1, const float *v2,
+                                        size_t dimension);
+
+  static float euclideanDistance(const float *v1, const float *v2,
+                                 size_t dimension);
+
+  static float cosineSimilarity(const float *v1, const float *v2,
+                                size_t dimension);
+
+  // Scales `v` to unit length in place; a zero vector is left unchanged.
+  static void normalize(float *v, size_t dimension);
+
+  // Int8 kernel for scalar-quantized codes in [-127, 127]; int32
+  // accumulation is exact for any dimension below 33k.
+  static int32_t dotProductInt8(const int8_t *v1, const int8_t *v2,
+                                size_t dimension);
+
+  // Binary-code kernels: codes are bit vectors packed into `words` 64-bit
+  // words. Uses POPCNT at the AVX2 and AVX-512 levels and VPOPCNTDQ where
+  // the CPU has it.
+  static uint32_t hammingDistance(const uint64_t *v1, const uint64_t *v2,
+                                  size_t words);
+
+  // Distances from `query` to `count` codes stored back to back in `codes`,
+  // written to `distances`.
+  static void hammingDistances(const uint64_t *query, const uint64_t *codes,
+                               size_t words, size_t count,
+                               uint32_t *distances);
+
+  // Conversions between fp32 and half-precision bit patterns. Encoding
+  // rounds to nearest even; values beyond the fp16 range become infinity.
+  static void toFloat16(const float *src, uint16_t *dst, size_t count);
+
+  static void fromFloat16(const uint16_t *src, float *dst, size_t count);
+
+  static void toBFloat16(const float *src, uint16_t *dst, size_t count);
+
+  static void fromBFloat16(const uint16_t *src, float *dst, size_t count);
+
+  // Dot product of an fp32 query with a half-precision row, widening the row
+  // to fp32 in registers and accumulating in fp32.
+  static float dotProductFloat16(const float *query, const uint16_t *row,
+                                 size_t dimension);
+
+  static float dotProductBFloat16(const float *query, const uint16_t *row,
+                                  size_t dimension);
+
+  // Dot products of every query against every row, written row-major to
+  // `scores` (numQueries x numRows). Strides are in floats. Work is tiled so
+  // each loaded row chunk is reused across several queries from registers.
+  static void dotProductBlock(const float *queries, size_t numQueries,
+                              size_t queryStride, const float *rows,
+                              size_t numRows, size_t rowStride,
+                              size_t dimension, float *scores);
+
+  // Metric-generic distance where smaller always means closer: negated dot
+  // product, squared euclidean distance or negated cosine similarity.
+  static float distance(Metric metric, const float *v1, const float *v2,
+                        size_t dimension);
+
+  // Kernels bound to one metric or element type and dimension, for callers
+  // whose dimension is fixed (stores and indexes pick them once at
+  // construction). For kSpecializedDimensions at the AVX2 and AVX-512
+  // levels they are template instantiations with a compile-time trip count,
+  // fully unrolled with no tail loop, and ignore their dimension argument;
+  // otherwise they dispatch to the generic kernels. A specialized kernel keeps
+  // the SIMD level that was active when it was chosen.
+  static constexpr size_t kSpecializedDimensions[] = {128,  384,  768,
+                                                      1024, 1536, 3072};
+
+  static DistanceKernel distanceKernel(Metric metric, size_t dimension);
+
+  static RowDotKernel rowDotKernel(ElementType type, size_t dimension);
+
+  // Whether the kernels above are specialized for `dimension` at the
+  // current SIMD level.
+  static bool hasSpecializedKernels(size_t dimension);
+
+  // Converts a value returned by distance() back to the metric's natural
+  // score (dot product, euclidean distance or cosine similarity).
+  static float distanceToScore(Metric metric, float distance);
+
+  // std::vector wrappers; these throw std::invalid_argument on mismatched
+  // dimensions.
   static float dotProduct(const std::vector<float> &v1,
                           const std::vector<float> &v2);
 
@@ -23,6 +132,21 @@ public:
 
   static bool isSameDimension(const std::vector<float> &v1,
                               const std::vector<float> &v2);
+
+  // Kernel dispatch
+  static SimdLevel simdLevel();
+
+  static bool isSimdLevelSupported(SimdLevel level);
+
+  // Forces a specific kernel set (mainly for tests and benchmarks). Returns
+  // false and leaves the current selection untouched if the CPU lacks support.
+  static bool setSimdLevel(SimdLevel level);
+
+  static const char *simdLevelName(SimdLevel level);
+
+  static size_t elementSize(ElementType type);
+
+  static const char *elementTypeName(ElementType type);
 };
 
-} // namespace vectorsearch
\ No newline at end of file
+} // namespace vectorsearch
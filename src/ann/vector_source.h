@@ -0,0 +1,29 @@
+// src/ann/vector_source.h
+#pragma once
+
+#include <cstdint>
+
+namespace vectorsearch {
+
+// Vectors owned outside an index and read back by label. An index built
+// over a source keeps only its labels and graph or lists, and scores
+// candidates against the source's rows instead of a private fp32 copy. The
+// source must outlive the index and keep every label the index holds
+// readable.
+class VectorSource {
+public:
+  virtual ~VectorSource() = default;
+
+  // The vector stored under `label`, either read in place or converted into
+  // `buffer`, which must hold dimension floats.
+  virtual const float *load(uint32_t label, float *buffer) const = 0;
+
+  // True if every vector has unit length, so cosine can be scored as a dot
+  // product without normalizing rows.
+  virtual bool unitLength() const = 0;
+
+  // Hints that `label` is about to be loaded. The default does nothing.
+  virtual void prefetch(uint32_t label) const { (void)label; }
+};
+
+} // namespace vectorsearch
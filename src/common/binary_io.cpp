@@ -0,0 +1,102 @@
+// src/common/binary_io.cpp
+#include "binary_io.h"
+#include "crc32c.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace vectorsearch {
+
+BinaryWriter::BinaryWriter(std::ostream &out) : out_(out) {}
+
+void BinaryWriter::writeBytes(const void *data, size_t size) {
+  if (size == 0) {
+    return;
+  }
+  out_.write(static_cast<const char *>(data),
+             static_cast<std::streamsize>(size));
+  if (!out_) {
+    throw std::runtime_error("Failed to write snapshot data");
+  }
+  crc_ = crc32c(data, size, crc_);
+  offset_ += size;
+}
+
+void BinaryWriter::writeString(const std::string &value) {
+  writeArray(value.data(), value.size());
+}
+
+void BinaryWriter::writeStrings(const std::string *values, size_t count) {
+  std::vector<uint64_t> offsets(count + 1, 0);
+  for (size_t i = 0; i < count; ++i) {
+    offsets[i + 1] = offsets[i] + values[i].size();
+  }
+  writeArray(offsets);
+  for (size_t i = 0; i < count; ++i) {
+    writeBytes(values[i].data(), values[i].size());
+  }
+}
+
+void BinaryWriter::align(size_t alignment) {
+  static const char zeros[64] = {};
+  size_t padding = (alignment - offset_ % alignment) % alignment;
+  while (padding > 0) {
+    size_t chunk = std::min(padding, sizeof(zeros));
+    writeBytes(zeros, chunk);
+    padding -= chunk;
+  }
+}
+
+BinaryReader::BinaryReader(const uint8_t *data, size_t size)
+    : data_(data), size_(size) {}
+
+const uint8_t *BinaryReader::readBytes(size_t size) {
+  if (size > size_ - offset_) {
+    fail("unexpected end of data");
+  }
+  const uint8_t *p = data_ + offset_;
+  offset_ += size;
+  return p;
+}
+
+std::string BinaryReader::readString() {
+  uint64_t size = read<uint64_t>();
+  checkCount(size, 1);
+  const char *p = reinterpret_cast<const char *>(readBytes(size));
+  return std::string(p, size);
+}
+
+std::vector<std::string> BinaryReader::readStrings() {
+  std::vector<uint64_t> offsets = readArray<uint64_t>();
+  if (offsets.empty() || offsets.front() != 0) {
+    fail("malformed string table");
+  }
+  for (size_t i = 1; i < offsets.size(); ++i) {
+    if (offsets[i] < offsets[i - 1]) {
+      fail("malformed string table");
+    }
+  }
+
+  const char *blob =
+      reinterpret_cast<const char *>(readBytes(offsets.back()));
+  std::vector<std::string> values(offsets.size() - 1);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i].assign(blob + offsets[i], offsets[i + 1] - offsets[i]);
+  }
+  return values;
+}
+
+void BinaryReader::align(size_t alignment) {
+  readBytes((alignment - offset_ % alignment) % alignment);
+}
+
+void BinaryReader::fail(const std::string &what) {
+  throw std::runtime_error("Corrupt snapshot: " + what);
+}
+
+void BinaryReader::checkCount(uint64_t count, size_t elementSize) const {
+  if (count > (size_ - offset_) / elementSize) {
+    fail("array runs past the end of the data");
+  }
+}
+
+} // namespace vectorsearch
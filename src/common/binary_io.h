@@ -0,0 +1,111 @@
+// src/common/binary_io.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace vectorsearch {
+
+// Sequential writer for snapshot files. Values are written in native byte
+// order; the writer tracks the byte offset (for alignment padding) and a
+// running CRC-32C of everything it has written.
+class BinaryWriter {
+public:
+  explicit BinaryWriter(std::ostream &out);
+
+  void writeBytes(const void *data, size_t size);
+
+  template <typename T> void write(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "BinaryWriter::write needs a trivially copyable type");
+    writeBytes(&value, sizeof(T));
+  }
+
+  // Writes a uint64 element count followed by the raw elements.
+  template <typename T> void writeArray(const T *values, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "BinaryWriter::writeArray needs a trivially copyable type");
+    write<uint64_t>(count);
+    writeBytes(values, count * sizeof(T));
+  }
+
+  template <typename T> void writeArray(const std::vector<T> &values) {
+    writeArray(values.data(), values.size());
+  }
+
+  void writeString(const std::string &value);
+
+  // Writes `count` strings as an offset table plus one contiguous blob.
+  void writeStrings(const std::string *values, size_t count);
+
+  // Pads with zero bytes up to the next multiple of `alignment`.
+  void align(size_t alignment);
+
+  uint64_t offset() const { return offset_; }
+
+  uint32_t checksum() const { return crc_; }
+
+private:
+  std::ostream &out_;
+  uint64_t offset_ = 0;
+  uint32_t crc_ = 0;
+};
+
+// Bounds-checked reader over an in-memory byte range, typically a mapped
+// snapshot file. Any read past the end throws std::runtime_error, so a
+// truncated or corrupt file can never be read out of bounds.
+class BinaryReader {
+public:
+  BinaryReader(const uint8_t *data, size_t size);
+
+  // Returns a pointer to the next `size` bytes and advances past them.
+  const uint8_t *readBytes(size_t size);
+
+  template <typename T> T read() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "BinaryReader::read needs a trivially copyable type");
+    T value;
+    std::memcpy(&value, readBytes(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  template <typename T> std::vector<T> readArray() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "BinaryReader::readArray needs a trivially copyable type");
+    uint64_t count = read<uint64_t>();
+    checkCount(count, sizeof(T));
+    std::vector<T> values(count);
+    if (count > 0) {
+      std::memcpy(values.data(), readBytes(count * sizeof(T)),
+                  count * sizeof(T));
+    }
+    return values;
+  }
+
+  std::string readString();
+
+  std::vector<std::string> readStrings();
+
+  void align(size_t alignment);
+
+  size_t offset() const { return offset_; }
+
+  size_t remaining() const { return size_ - offset_; }
+
+  // Throws std::runtime_error tagged as snapshot corruption.
+  [[noreturn]] static void fail(const std::string &what);
+
+private:
+  void checkCount(uint64_t count, size_t elementSize) const;
+
+  const uint8_t *data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+
+} // namespace vectorsearch
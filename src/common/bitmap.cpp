@@ -0,0 +1,298 @@
+// src/common/bitmap.cpp
+#include "bitmap.h"
+#include <algorithm>
+#include <iterator>
+
+namespace vectorsearch {
+
+bool Bitmap::Container::contains(uint16_t low) const {
+  if (isBitset()) {
+    return (bits[low >> 6] >> (low & 63)) & 1;
+  }
+  return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool Bitmap::add(uint32_t value) {
+  const uint16_t key = static_cast<uint16_t>(value >> 16);
+  const uint16_t low = static_cast<uint16_t>(value);
+
+  auto it = lowerBound(key);
+  if (it == containers_.end() || it->key != key) {
+    it = containers_.insert(it, Container());
+    it->key = key;
+  }
+
+  Container &c = *it;
+  if (c.isBitset()) {
+    uint64_t &word = c.bits[low >> 6];
+    const uint64_t mask = uint64_t(1) << (low & 63);
+    if (word & mask) {
+      return false;
+    }
+    word |= mask;
+    ++c.count;
+    return true;
+  }
+
+  auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+  if (pos != c.array.end() && *pos == low) {
+    return false;
+  }
+  c.array.insert(pos, low);
+  ++c.count;
+  if (c.count > kMaxArraySize) {
+    toBitset(c);
+  }
+  return true;
+}
+
+bool Bitmap::remove(uint32_t value) {
+  const uint16_t key = static_cast<uint16_t>(value >> 16);
+  const uint16_t low = static_cast<uint16_t>(value);
+
+  auto it = lowerBound(key);
+  if (it == containers_.end() || it->key != key) {
+    return false;
+  }
+
+  Container &c = *it;
+  if (c.isBitset()) {
+    uint64_t &word = c.bits[low >> 6];
+    const uint64_t mask = uint64_t(1) << (low & 63);
+    if (!(word & mask)) {
+      return false;
+    }
+    word &= ~mask;
+    if (--c.count <= kMaxArraySize) {
+      reshape(c);
+    }
+  } else {
+    auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos == c.array.end() || *pos != low) {
+      return false;
+    }
+    c.array.erase(pos);
+    --c.count;
+  }
+
+  if (c.count == 0) {
+    containers_.erase(it);
+  }
+  return true;
+}
+
+bool Bitmap::contains(uint32_t value) const {
+  const uint16_t key = static_cast<uint16_t>(value >> 16);
+  auto it = lowerBound(key);
+  return it != containers_.end() && it->key == key &&
+         it->contains(static_cast<uint16_t>(value));
+}
+
+size_t Bitmap::cardinality() const {
+  size_t total = 0;
+  for (const Container &c : containers_) {
+    total += c.count;
+  }
+  return total;
+}
+
+Bitmap &Bitmap::operator|=(const Bitmap &other) {
+  std::vector<Container> merged;
+  merged.reserve(containers_.size() + other.containers_.size());
+
+  auto a = containers_.begin();
+  auto b = other.containers_.begin();
+  while (a != containers_.end() || b != other.containers_.end()) {
+    if (b == other.containers_.end() ||
+        (a != containers_.end() && a->key < b->key)) {
+      merged.push_back(std::move(*a++));
+      continue;
+    }
+    if (a == containers_.end() || b->key < a->key) {
+      merged.push_back(*b++);
+      continue;
+    }
+
+    Container c = std::move(*a++);
+    const Container &o = *b++;
+    if (!c.isBitset() && !o.isBitset() &&
+        c.count + o.count <= kMaxArraySize) {
+      std::vector<uint16_t> values;
+      values.reserve(c.count + o.count);
+      std::set_union(c.array.begin(), c.array.end(), o.array.begin(),
+                     o.array.end(), std::back_inserter(values));
+      c.array = std::move(values);
+      c.count = static_cast<uint32_t>(c.array.size());
+    } else {
+      toBitset(c);
+      if (o.isBitset()) {
+        for (size_t w = 0; w < kBitsetWords; ++w) {
+          c.bits[w] |= o.bits[w];
+        }
+      } else {
+        for (uint16_t low : o.array) {
+          c.bits[low >> 6] |= uint64_t(1) << (low & 63);
+        }
+      }
+      reshape(c);
+    }
+    merged.push_back(std::move(c));
+  }
+
+  containers_ = std::move(merged);
+  return *this;
+}
+
+Bitmap &Bitmap::operator&=(const Bitmap &other) {
+  std::vector<Container> kept;
+
+  auto b = other.containers_.begin();
+  for (Container &c : containers_) {
+    while (b != other.containers_.end() && b->key < c.key) {
+      ++b;
+    }
+    if (b == other.containers_.end()) {
+      break;
+    }
+    if (b->key != c.key) {
+      continue;
+    }
+
+    const Container &o = *b;
+    if (c.isBitset() && o.isBitset()) {
+      for (size_t w = 0; w < kBitsetWords; ++w) {
+        c.bits[w] &= o.bits[w];
+      }
+      reshape(c);
+    } else if (c.isBitset()) {
+      // The result is no larger than the other (array) side
+      std::vector<uint16_t> values;
+      for (uint16_t low : o.array) {
+        if (c.contains(low)) {
+          values.push_back(low);
+        }
+      }
+      c.bits.clear();
+      c.array = std::move(values);
+      c.count = static_cast<uint32_t>(c.array.size());
+    } else {
+      c.array.erase(std::remove_if(c.array.begin(), c.array.end(),
+                                   [&o](uint16_t low) {
+                                     return !o.contains(low);
+                                   }),
+                    c.array.end());
+      c.count = static_cast<uint32_t>(c.array.size());
+    }
+
+    if (c.count > 0) {
+      kept.push_back(std::move(c));
+    }
+  }
+
+  containers_ = std::move(kept);
+  return *this;
+}
+
+Bitmap &Bitmap::operator-=(const Bitmap &other) {
+  std::vector<Container> kept;
+  kept.reserve(containers_.size());
+
+  auto b = other.containers_.begin();
+  for (Container &c : containers_) {
+    while (b != other.containers_.end() && b->key < c.key) {
+      ++b;
+    }
+    if (b != other.containers_.end() && b->key == c.key) {
+      const Container &o = *b;
+      if (c.isBitset()) {
+        if (o.isBitset()) {
+          for (size_t w = 0; w < kBitsetWords; ++w) {
+            c.bits[w] &= ~o.bits[w];
+          }
+        } else {
+          for (uint16_t low : o.array) {
+            c.bits[low >> 6] &= ~(uint64_t(1) << (low & 63));
+          }
+        }
+        reshape(c);
+      } else {
+        c.array.erase(std::remove_if(c.array.begin(), c.array.end(),
+                                     [&o](uint16_t low) {
+                                       return o.contains(low);
+                                     }),
+                      c.array.end());
+        c.count = static_cast<uint32_t>(c.array.size());
+      }
+    }
+
+    if (c.count > 0) {
+      kept.push_back(std::move(c));
+    }
+  }
+
+  containers_ = std::move(kept);
+  return *this;
+}
+
+bool Bitmap::operator==(const Bitmap &other) const {
+  return toVector() == other.toVector();
+}
+
+std::vector<uint32_t> Bitmap::toVector() const {
+  std::vector<uint32_t> values;
+  values.reserve(cardinality());
+  forEach([&values](uint32_t value) { values.push_back(value); });
+  return values;
+}
+
+std::vector<Bitmap::Container>::iterator Bitmap::lowerBound(uint16_t key) {
+  return std::lower_bound(
+      containers_.begin(), containers_.end(), key,
+      [](const Container &c, uint16_t k) { return c.key < k; });
+}
+
+std::vector<Bitmap::Container>::const_iterator
+Bitmap::lowerBound(uint16_t key) const {
+  return std::lower_bound(
+      containers_.begin(), containers_.end(), key,
+      [](const Container &c, uint16_t k) { return c.key < k; });
+}
+
+void Bitmap::toBitset(Container &c) {
+  if (c.isBitset()) {
+    return;
+  }
+  c.bits.assign(kBitsetWords, 0);
+  for (uint16_t low : c.array) {
+    c.bits[low >> 6] |= uint64_t(1) << (low & 63);
+  }
+  c.array.clear();
+  c.array.shrink_to_fit();
+}
+
+void Bitmap::reshape(Container &c) {
+  if (!c.isBitset()) {
+    return;
+  }
+
+  uint32_t count = 0;
+  for (uint64_t word : c.bits) {
+    count += static_cast<uint32_t>(__builtin_popcountll(word));
+  }
+  c.count = count;
+  if (count > kMaxArraySize) {
+    return;
+  }
+
+  c.array.clear();
+  c.array.reserve(count);
+  for (size_t w = 0; w < kBitsetWords; ++w) {
+    for (uint64_t word = c.bits[w]; word != 0; word &= word - 1) {
+      c.array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+    }
+  }
+  c.bits.clear();
+  c.bits.shrink_to_fit();
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,86 @@
+// src/common/bitmap.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vectorsearch {
+
+// Compressed set of 32-bit integers in the style of Roaring bitmaps. Values
+// are grouped by their high 16 bits into containers. A container holding at
+// most kMaxArraySize values is a sorted array of the low 16 bits (two bytes
+// per value); a denser one is a 65536-bit bitset (one bit per possible
+// value). Set operations work container by container.
+class Bitmap {
+public:
+  // Adds `value`; returns false if it was already present.
+  bool add(uint32_t value);
+
+  // Returns false if `value` was not present.
+  bool remove(uint32_t value);
+
+  bool contains(uint32_t value) const;
+
+  size_t cardinality() const;
+
+  bool empty() const { return containers_.empty(); }
+
+  void clear() { containers_.clear(); }
+
+  Bitmap &operator|=(const Bitmap &other);
+
+  Bitmap &operator&=(const Bitmap &other);
+
+  // Removes every value that is in `other`.
+  Bitmap &operator-=(const Bitmap &other);
+
+  bool operator==(const Bitmap &other) const;
+
+  // Calls fn(value) for every value, in increasing order.
+  template <typename Fn> void forEach(Fn &&fn) const {
+    for (const Container &c : containers_) {
+      const uint32_t high = static_cast<uint32_t>(c.key) << 16;
+      if (!c.isBitset()) {
+        for (uint16_t low : c.array) {
+          fn(high | low);
+        }
+        continue;
+      }
+      for (size_t w = 0; w < kBitsetWords; ++w) {
+        for (uint64_t word = c.bits[w]; word != 0; word &= word - 1) {
+          fn(high | static_cast<uint32_t>(w * 64 + __builtin_ctzll(word)));
+        }
+      }
+    }
+  }
+
+  std::vector<uint32_t> toVector() const;
+
+private:
+  static constexpr size_t kMaxArraySize = 4096;
+  static constexpr size_t kBitsetWords = 65536 / 64;
+
+  struct Container {
+    uint16_t key = 0;
+    uint32_t count = 0;
+    std::vector<uint16_t> array; // sorted, while count <= kMaxArraySize
+    std::vector<uint64_t> bits;  // kBitsetWords words otherwise
+
+    bool isBitset() const { return !bits.empty(); }
+    bool contains(uint16_t low) const;
+  };
+
+  std::vector<Container>::iterator lowerBound(uint16_t key);
+  std::vector<Container>::const_iterator lowerBound(uint16_t key) const;
+
+  static void toBitset(Container &c);
+
+  // Recounts a bitset container and switches it to the representation that
+  // fits its new size.
+  static void reshape(Container &c);
+
+  std::vector<Container> containers_; // sorted by key
+};
+
+} // namespace vectorsearch
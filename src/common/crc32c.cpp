@@ -0,0 +1,68 @@
+// src/common/crc32c.cpp
+#include "crc32c.h"
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define VECTORSEARCH_HAVE_SSE42_CRC 1
+#endif
+
+namespace {
+
+constexpr uint32_t kPolynomial = 0x82F63B78u; // reflected Castagnoli
+
+std::array<uint32_t, 256> makeTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1u) ? kPolynomial : 0u);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+uint32_t crcScalar(const uint8_t *p, size_t size, uint32_t crc) {
+  static const std::array<uint32_t, 256> table = makeTable();
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ p[i]) & 0xFFu] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#ifdef VECTORSEARCH_HAVE_SSE42_CRC
+__attribute__((target("sse4.2"))) uint32_t
+crcHardware(const uint8_t *p, size_t size, uint32_t crc) {
+  uint64_t crc64 = crc;
+  for (; size >= 8; size -= 8, p += 8) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  uint32_t crc32 = static_cast<uint32_t>(crc64);
+  for (; size > 0; --size, ++p) {
+    crc32 = _mm_crc32_u8(crc32, *p);
+  }
+  return crc32;
+}
+#endif
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+uint32_t crc32c(const void *data, size_t size, uint32_t crc) {
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  crc = ~crc;
+#ifdef VECTORSEARCH_HAVE_SSE42_CRC
+  static const bool hasSse42 = __builtin_cpu_supports("sse4.2");
+  if (hasSse42) {
+    return ~crcHardware(p, size, crc);
+  }
+#endif
+  return ~crcScalar(p, size, crc);
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,14 @@
+// src/common/crc32c.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vectorsearch {
+
+// CRC-32C (Castagnoli) of `size` bytes, continuing from a previous `crc` so
+// large inputs can be checksummed in pieces. Uses the SSE4.2 crc32
+// instruction when the CPU has it.
+uint32_t crc32c(const void *data, size_t size, uint32_t crc = 0);
+
+} // namespace vectorsearch
@@ -0,0 +1,98 @@
+// src/common/histogram.cpp
+#include "histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vectorsearch {
+
+double HistogramSnapshot::mean() const {
+  return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+}
+
+uint64_t HistogramSnapshot::percentile(double p) const {
+  if (count == 0) {
+    return 0;
+  }
+  p = std::min(std::max(p, 0.0), 1.0);
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(count))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return Histogram::bucketUpperBound(i);
+    }
+  }
+  return Histogram::bucketUpperBound(buckets.size() - 1);
+}
+
+uint64_t HistogramSnapshot::countAtMost(uint64_t value) const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    if (Histogram::bucketUpperBound(i) > value) {
+      break;
+    }
+    total += buckets[i];
+  }
+  return total;
+}
+
+Histogram::Histogram() : shards_(std::make_unique<Shard[]>(kShards)) {
+  reset();
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+  HistogramSnapshot result;
+  result.buckets.assign(kBucketCount, 0);
+  for (size_t s = 0; s < kShards; ++s) {
+    const Shard &shard = shards_[s];
+    result.count += shard.count.load(std::memory_order_relaxed);
+    result.sum += shard.sum.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+  return result;
+}
+
+void Histogram::reset() {
+  for (size_t s = 0; s < kShards; ++s) {
+    Shard &shard = shards_[s];
+    shard.count.store(0, std::memory_order_relaxed);
+    shard.sum.store(0, std::memory_order_relaxed);
+    for (auto &bucket : shard.buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+uint64_t Histogram::bucketLowerBound(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const size_t shift = (index - kSubBuckets) / kSubBuckets;
+  const uint64_t sub = (index - kSubBuckets) % kSubBuckets;
+  return (kSubBuckets + sub) << shift;
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  if (index >= kBucketCount - 1) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  const size_t shift = (index - kSubBuckets) / kSubBuckets;
+  return bucketLowerBound(index) + (uint64_t(1) << shift) - 1;
+}
+
+size_t Histogram::shardIndex() {
+  // Threads are dealt shards round-robin on first use
+  static std::atomic<size_t> nextShard{0};
+  thread_local const size_t shard =
+      nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+  return shard;
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,113 @@
+// src/common/histogram.h
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vectorsearch {
+
+// Point-in-time copy of a Histogram.
+struct HistogramSnapshot {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  // Per-bucket counts; bucket i holds values in
+  // [Histogram::bucketLowerBound(i), Histogram::bucketUpperBound(i)].
+  std::vector<uint64_t> buckets;
+
+  double mean() const;
+
+  // Upper bound of the bucket holding the p-quantile (p in [0, 1]), so the
+  // result overestimates by at most the bucket width; 0 when empty.
+  uint64_t percentile(double p) const;
+
+  // Number of recorded values <= `value`, to the resolution of the buckets.
+  uint64_t countAtMost(uint64_t value) const;
+};
+
+// Concurrent histogram of non-negative integers (latencies in nanoseconds,
+// counts per query) in the style of HdrHistogram: values below
+// kSubBuckets are counted exactly, larger ones fall into log-linear buckets
+// of kSubBuckets per power of two, bounding the relative error at
+// 1 / kSubBuckets. Values past 2^kMaxExponent land in the last bucket.
+//
+// record() is lock-free and cheap enough to leave on in production: each
+// thread is pinned to one of kShards cache-line aligned shards, so
+// concurrent writers rarely touch the same line, and readers sum the
+// shards in snapshot().
+class Histogram {
+public:
+  static constexpr size_t kSubBucketBits = 3;
+  static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+  static constexpr size_t kMaxExponent = 44;
+  static constexpr size_t kBucketCount =
+      kSubBuckets + (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+  static constexpr size_t kShards = 8;
+
+  Histogram();
+
+  void record(uint64_t value) {
+    Shard &shard = shards_[shardIndex()];
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  HistogramSnapshot snapshot() const;
+
+  void reset();
+
+  static size_t bucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+    const size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(value));
+    if (exponent > kMaxExponent) {
+      return kBucketCount - 1;
+    }
+    const size_t shift = exponent - kSubBucketBits;
+    return kSubBuckets + shift * kSubBuckets +
+           static_cast<size_t>((value >> shift) & (kSubBuckets - 1));
+  }
+
+  static uint64_t bucketLowerBound(size_t index);
+  static uint64_t bucketUpperBound(size_t index);
+
+private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets;
+  };
+
+  static size_t shardIndex();
+
+  std::unique_ptr<Shard[]> shards_;
+};
+
+// Records the nanoseconds between construction and destruction.
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Histogram &histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  ~ScopedTimer() {
+    histogram_.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_)
+            .count()));
+  }
+
+private:
+  Histogram &histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace vectorsearch
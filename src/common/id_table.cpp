@@ -0,0 +1,128 @@
+// src/common/id_table.cpp
+#include "id_table.h"
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace vectorsearch {
+
+namespace {
+
+constexpr size_t kMinBuckets = 16;
+
+} // anonymous namespace
+
+uint32_t IdTable::hashKey(std::string_view key) {
+  // Fold the 64-bit hash so both halves pick the bucket
+  const uint64_t hash = std::hash<std::string_view>()(key);
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+uint32_t IdTable::find(std::string_view key,
+                       const std::vector<std::string> &keys) const {
+  if (size_ == 0) {
+    return kNotFound;
+  }
+  const uint32_t hash = hashKey(key);
+  const size_t mask = buckets_.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    const Bucket &bucket = buckets_[i];
+    if (bucket.slot == kNotFound) {
+      return kNotFound;
+    }
+    if (bucket.hash == hash && keys[bucket.slot] == key) {
+      return bucket.slot;
+    }
+  }
+}
+
+void IdTable::insert(uint32_t slot, const std::vector<std::string> &keys) {
+  if ((size_ + 1) * 8 > buckets_.size() * 7) {
+    rehash(std::max(kMinBuckets, buckets_.size() * 2));
+  }
+  const uint32_t hash = hashKey(keys[slot]);
+  const size_t mask = buckets_.size() - 1;
+  size_t i = hash & mask;
+  while (buckets_[i].slot != kNotFound) {
+    i = (i + 1) & mask;
+  }
+  buckets_[i] = Bucket{hash, slot};
+  ++size_;
+}
+
+size_t IdTable::locate(uint32_t hash, uint32_t slot) const {
+  const size_t mask = buckets_.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    if (buckets_[i].slot == slot) {
+      return i;
+    }
+    if (buckets_[i].slot == kNotFound) {
+      return buckets_.size();
+    }
+  }
+}
+
+bool IdTable::erase(uint32_t slot, const std::vector<std::string> &keys) {
+  if (size_ == 0) {
+    return false;
+  }
+  size_t hole = locate(hashKey(keys[slot]), slot);
+  if (hole == buckets_.size()) {
+    return false;
+  }
+
+  // Shift later members of the probe run back so lookups never stop early
+  // at the hole
+  const size_t mask = buckets_.size() - 1;
+  for (size_t i = (hole + 1) & mask; buckets_[i].slot != kNotFound;
+       i = (i + 1) & mask) {
+    const size_t home = buckets_[i].hash & mask;
+    // Movable unless its home lies cyclically in (hole, i]
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      buckets_[hole] = buckets_[i];
+      hole = i;
+    }
+  }
+  buckets_[hole].slot = kNotFound;
+  --size_;
+  return true;
+}
+
+void IdTable::reserve(size_t count) {
+  size_t bucketCount = kMinBuckets;
+  while (bucketCount * 7 < count * 8) {
+    bucketCount *= 2;
+  }
+  if (bucketCount > buckets_.size()) {
+    rehash(bucketCount);
+  }
+}
+
+void IdTable::rehash(size_t bucketCount) {
+  std::vector<Bucket> old(bucketCount, Bucket{0, kNotFound});
+  old.swap(buckets_);
+  const size_t mask = bucketCount - 1;
+  for (const Bucket &bucket : old) {
+    if (bucket.slot == kNotFound) {
+      continue;
+    }
+    size_t i = bucket.hash & mask;
+    while (buckets_[i].slot != kNotFound) {
+      i = (i + 1) & mask;
+    }
+    buckets_[i] = bucket;
+  }
+}
+
+void IdTable::clear() {
+  buckets_.clear();
+  buckets_.shrink_to_fit();
+  size_ = 0;
+}
+
+void IdTable::swap(IdTable &other) {
+  buckets_.swap(other.buckets_);
+  std::swap(size_, other.size_);
+}
+
+} // namespace vectorsearch
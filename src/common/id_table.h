@@ -0,0 +1,64 @@
+// src/common/id_table.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vectorsearch {
+
+// Hash table from string keys to dense uint32 slots that stores no strings.
+// The caller keeps the keys in a slot-indexed table (keys[slot]) and passes
+// it to every call; a bucket is just the slot and 32 bits of its key's hash,
+// so a table costs 8 bytes per bucket instead of a heap node and a second
+// copy of every key. Open addressing with linear probing and backward-shift
+// deletion, so there are no tombstones, at a load factor of at most 7/8.
+// Not internally synchronized.
+class IdTable {
+public:
+  static constexpr uint32_t kNotFound = UINT32_MAX;
+
+  // Slot of `key`, or kNotFound.
+  uint32_t find(std::string_view key,
+                const std::vector<std::string> &keys) const;
+
+  // Maps keys[slot] to `slot`. The key must not be present yet.
+  void insert(uint32_t slot, const std::vector<std::string> &keys);
+
+  // Removes `slot`; keys[slot] must still hold its key. Returns false if it
+  // was not present.
+  bool erase(uint32_t slot, const std::vector<std::string> &keys);
+
+  // Sizes the table for `count` keys without further growth.
+  void reserve(size_t count);
+
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  void clear();
+
+  void swap(IdTable &other);
+
+  size_t memoryBytes() const { return buckets_.capacity() * sizeof(Bucket); }
+
+private:
+  struct Bucket {
+    uint32_t hash;
+    uint32_t slot; // kNotFound when empty
+  };
+
+  static uint32_t hashKey(std::string_view key);
+
+  // Bucket holding `slot`, or buckets_.size()
+  size_t locate(uint32_t hash, uint32_t slot) const;
+
+  void rehash(size_t bucketCount);
+
+  std::vector<Bucket> buckets_;
+  size_t size_ = 0;
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,104 @@
+// src/common/string_dictionary.cpp
+#include "string_dictionary.h"
+#include <stdexcept>
+#include <utility>
+
+namespace vectorsearch {
+
+StringDictionary::StringDictionary() { clear(); }
+
+uint32_t StringDictionary::intern(std::string_view value) {
+  if (value.empty()) {
+    return kEmpty;
+  }
+  uint32_t code = index_.find(value, strings_);
+  if (code != IdTable::kNotFound) {
+    ++references_[code];
+    return code;
+  }
+
+  if (!free_codes_.empty()) {
+    code = free_codes_.back();
+    free_codes_.pop_back();
+    strings_[code].assign(value.data(), value.size());
+    references_[code] = 1;
+  } else {
+    code = static_cast<uint32_t>(strings_.size());
+    strings_.emplace_back(value);
+    references_.push_back(1);
+  }
+  index_.insert(code, strings_);
+  return code;
+}
+
+void StringDictionary::release(uint32_t code) {
+  if (code == kEmpty || --references_[code] > 0) {
+    return;
+  }
+  index_.erase(code, strings_);
+  // Free the characters, not just the length
+  std::string().swap(strings_[code]);
+  free_codes_.push_back(code);
+}
+
+uint32_t StringDictionary::find(std::string_view value) const {
+  return value.empty() ? kEmpty : index_.find(value, strings_);
+}
+
+void StringDictionary::clear() {
+  strings_.assign(1, std::string());
+  references_.assign(1, 0);
+  free_codes_.clear();
+  index_.clear();
+}
+
+void StringDictionary::restore(std::vector<std::string> strings,
+                               const std::vector<uint32_t> &codes) {
+  if (strings.empty() || !strings[0].empty()) {
+    throw std::invalid_argument("String dictionary must start with \"\"");
+  }
+  std::vector<uint32_t> references(strings.size(), 0);
+  for (uint32_t code : codes) {
+    if (code >= strings.size()) {
+      throw std::invalid_argument("String code " + std::to_string(code) +
+                                  " is out of range");
+    }
+    ++references[code];
+  }
+
+  clear();
+  strings_ = std::move(strings);
+  references_ = std::move(references);
+  references_[kEmpty] = 0;
+  index_.reserve(strings_.size());
+  // Walk down so the lowest free code is reused first
+  for (size_t code = strings_.size(); code-- > 1;) {
+    if (references_[code] == 0) {
+      std::string().swap(strings_[code]);
+      free_codes_.push_back(static_cast<uint32_t>(code));
+      continue;
+    }
+    if (strings_[code].empty() ||
+        index_.find(strings_[code], strings_) != IdTable::kNotFound) {
+      throw std::invalid_argument("Empty or repeated dictionary string: " +
+                                  strings_[code]);
+    }
+    index_.insert(static_cast<uint32_t>(code), strings_);
+  }
+}
+
+size_t StringDictionary::memoryBytes() const {
+  size_t bytes = strings_.capacity() * sizeof(std::string) +
+                 references_.capacity() * sizeof(uint32_t) +
+                 free_codes_.capacity() * sizeof(uint32_t) +
+                 index_.memoryBytes();
+  for (const std::string &value : strings_) {
+    // Short strings live inside the std::string object
+    if (value.capacity() > sizeof(std::string)) {
+      bytes += value.capacity();
+    }
+  }
+  return bytes;
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,59 @@
+// src/common/string_dictionary.h
+#pragma once
+
+#include "id_table.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vectorsearch {
+
+// Reference-counted interned strings addressed by dense uint32 codes, so
+// values repeated across many rows (document ids of the chunks of one
+// document) are stored once and a row holds a 4-byte code. Code 0 is the
+// empty string and is never counted. A string is freed once its last
+// reference is released and its code is reused. Not internally
+// synchronized.
+class StringDictionary {
+public:
+  static constexpr uint32_t kEmpty = 0;
+
+  StringDictionary();
+
+  // Code for `value`, adding a reference to it.
+  uint32_t intern(std::string_view value);
+
+  // Drops one reference taken by intern().
+  void release(uint32_t code);
+
+  const std::string &get(uint32_t code) const { return strings_[code]; }
+
+  // Code for `value`, or IdTable::kNotFound if it is not interned.
+  uint32_t find(std::string_view value) const;
+
+  // Number of distinct non-empty strings.
+  size_t size() const { return index_.size(); }
+
+  void clear();
+
+  // Code-indexed table with empty strings at free codes, for snapshots.
+  const std::vector<std::string> &strings() const { return strings_; }
+
+  // Restores a table written from strings(), with one reference per entry
+  // of `codes`. Throws std::invalid_argument on a code past the table, a
+  // repeated non-empty string, or a non-empty code 0.
+  void restore(std::vector<std::string> strings,
+               const std::vector<uint32_t> &codes);
+
+  size_t memoryBytes() const;
+
+private:
+  std::vector<std::string> strings_;
+  std::vector<uint32_t> references_;
+  std::vector<uint32_t> free_codes_;
+  IdTable index_;
+};
+
+} // namespace vectorsearch
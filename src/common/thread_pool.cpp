@@ -0,0 +1,215 @@
+// src/common/thread_pool.cpp
+#include "thread_pool.h"
+#include <algorithm>
+#include <exception>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// The pool and worker index of the current thread, so tasks posted from
+// inside a pool go to the poster's own deque
+thread_local const vectorsearch::ThreadPool *currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+void pinToCpu(size_t index) {
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return;
+  }
+  const size_t cpus = static_cast<size_t>(CPU_COUNT(&allowed));
+  if (cpus == 0) {
+    return;
+  }
+  size_t target = index % cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+      cpu_set_t one;
+      CPU_ZERO(&one);
+      CPU_SET(cpu, &one);
+      // Best effort: an unpinned worker still works
+      pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+      return;
+    }
+  }
+#else
+  (void)index;
+#endif
+}
+
+std::mutex sharedMutex;
+std::shared_ptr<vectorsearch::ThreadPool> sharedPool;
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+ThreadPool::ThreadPool(const ThreadPoolOptions &options) {
+  size_t threads = options.numThreads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers_.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Started only once every deque exists, since workers steal from all
+  for (size_t i = 0; i < threads; ++i) {
+    workers_[i]->thread =
+        std::thread(&ThreadPool::workerLoop, this, i, options.pinThreads);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wakeup_.notify_all();
+  for (auto &worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void ThreadPool::post(Task task) {
+  const size_t target =
+      currentPool == this
+          ? currentWorker
+          : next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                workers_.size();
+  {
+    std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+    workers_[target]->tasks.push_back(std::move(task));
+  }
+  pending_.fetch_add(1, std::memory_order_release);
+  // Taking the mutex orders this wakeup after a sleeper's predicate check
+  { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+  wakeup_.notify_one();
+}
+
+bool ThreadPool::runOne(size_t self) {
+  Task task;
+  {
+    Worker &own = *workers_[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+  for (size_t i = 1; !task && i < workers_.size(); ++i) {
+    Worker &victim = *workers_[(self + i) % workers_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+  if (!task) {
+    return false;
+  }
+  pending_.fetch_sub(1, std::memory_order_relaxed);
+  task();
+  return true;
+}
+
+void ThreadPool::workerLoop(size_t index, bool pin) {
+  currentPool = this;
+  currentWorker = index;
+  if (pin) {
+    pinToCpu(index);
+  }
+
+  for (;;) {
+    if (runOne(index)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wakeup_.wait(lock, [this]() {
+      return stop_ || pending_.load(std::memory_order_acquire) > 0;
+    });
+    if (stop_ && pending_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+void ThreadPool::parallelFor(
+    size_t count, size_t chunks,
+    const std::function<void(size_t, size_t, size_t)> &fn) {
+  if (count == 0) {
+    return;
+  }
+  chunks = std::max<size_t>(1, std::min(chunks, count));
+  if (chunks == 1) {
+    fn(0, count, 0);
+    return;
+  }
+
+  // Helpers that start after every chunk is claimed find nothing to do and
+  // never touch `fn`; the state outlives this call for their sake
+  struct State {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+  auto state = std::make_shared<State>();
+  auto claimChunks = [state, &fn, count, chunks]() {
+    for (size_t c; (c = state->next.fetch_add(1)) < chunks;) {
+      if (!state->failed.load(std::memory_order_relaxed)) {
+        try {
+          fn(c * count / chunks, (c + 1) * count / chunks, c);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (!state->error) {
+            state->error = std::current_exception();
+          }
+          state->failed = true;
+        }
+      }
+      if (state->done.fetch_add(1) + 1 == chunks) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->finished.notify_all();
+      }
+    }
+  };
+
+  const size_t helpers = std::min(chunks - 1, workers_.size());
+  for (size_t i = 0; i < helpers; ++i) {
+    post(claimChunks);
+  }
+  claimChunks();
+
+  // Only chunks already running on other threads remain
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished.wait(lock, [&]() { return state->done.load() == chunks; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::shared() {
+  std::lock_guard<std::mutex> lock(sharedMutex);
+  if (!sharedPool) {
+    sharedPool = std::make_shared<ThreadPool>();
+  }
+  return sharedPool;
+}
+
+void ThreadPool::configureShared(const ThreadPoolOptions &options) {
+  // Declared before the guard, so an old pool nothing else holds is joined
+  // after the lock is released
+  auto pool = std::make_shared<ThreadPool>(options);
+  std::lock_guard<std::mutex> lock(sharedMutex);
+  sharedPool.swap(pool);
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,105 @@
+// src/common/thread_pool.h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vectorsearch {
+
+struct ThreadPoolOptions {
+  // Worker threads (0 = one per hardware thread).
+  size_t numThreads = 0;
+  // Pins worker i to the i-th CPU (modulo the count) the process may run
+  // on. Only supported on Linux; ignored elsewhere.
+  bool pinThreads = false;
+};
+
+// Work-stealing thread pool shared by scans, batch queries, index builds and
+// k-means, so no search or build starts threads of its own. Each worker owns
+// a deque: tasks posted from inside the pool go to the back of the poster's
+// deque and are taken LIFO for cache locality, tasks from outside are dealt
+// round-robin, and a worker whose deque is empty steals from the front of
+// the others'.
+class ThreadPool {
+public:
+  explicit ThreadPool(const ThreadPoolOptions &options = ThreadPoolOptions());
+
+  // Runs the tasks still queued, then joins the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Number of worker threads.
+  size_t size() const { return workers_.size(); }
+
+  // Threads that work on a parallelFor(): the workers plus the caller.
+  size_t concurrency() const { return workers_.size() + 1; }
+
+  // Runs `fn` on a worker; the future yields its result or rethrows its
+  // exception. A pool task must not block on such a future (the task it
+  // waits for may be queued behind it); use parallelFor() instead.
+  template <typename Fn>
+  std::future<std::invoke_result_t<std::decay_t<Fn>>> submit(Fn &&fn) {
+    using Result = std::invoke_result_t<std::decay_t<Fn>>;
+    auto task =
+        std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+    std::future<Result> future = task->get_future();
+    post([task]() { (*task)(); });
+    return future;
+  }
+
+  // Splits [0, count) into `chunks` contiguous ranges of near-equal size and
+  // runs fn(begin, end, chunk) for each, returning once all have finished.
+  // Chunks are claimed dynamically by the caller and up to size() workers,
+  // so this is safe to call from a pool task and completes even when every
+  // worker is busy. After an exception the unstarted chunks are skipped and
+  // the first exception is rethrown.
+  void parallelFor(size_t count, size_t chunks,
+                   const std::function<void(size_t, size_t, size_t)> &fn);
+
+  // Process-wide pool used by stores and k-means, created with default
+  // options on first use.
+  static std::shared_ptr<ThreadPool> shared();
+
+  // Replaces the shared pool. Stores created earlier keep the pool they
+  // were given (see VectorStore::setThreadPool()).
+  static void configureShared(const ThreadPoolOptions &options);
+
+private:
+  using Task = std::function<void()>;
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::thread thread;
+  };
+
+  void post(Task task);
+
+  // Runs one task from worker `self`'s deque, or stolen from another;
+  // returns false if every deque was empty.
+  bool runOne(size_t self);
+
+  void workerLoop(size_t index, bool pin);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // Queued tasks not yet taken; idle workers sleep while it is zero
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> next_worker_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wakeup_;
+  bool stop_ = false; // guarded by sleep_mutex_
+};
+
+} // namespace vectorsearch
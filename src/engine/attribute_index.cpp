@@ -0,0 +1,508 @@
+// src/engine/attribute_index.cpp
+#include "attribute_index.h"
+#include <cstdlib>
+
+namespace {
+
+using vectorsearch::AttributeValue;
+
+// Nesting accepted inside skipped values before the metadata is rejected
+constexpr int kMaxDepth = 64;
+
+// Minimal JSON reader for the attribute subset: one object whose members
+// are scalars or arrays of scalars. Every method returns false on malformed
+// input, leaving the position unspecified.
+class JsonReader {
+public:
+  explicit JsonReader(const std::string &text) : text_(text) {}
+
+  bool readObject(std::vector<vectorsearch::AttributeIndex::Attribute> &out) {
+    skipSpace();
+    if (!consume('{')) {
+      return false;
+    }
+    skipSpace();
+    if (consume('}')) {
+      return atEnd();
+    }
+
+    while (true) {
+      std::string key;
+      skipSpace();
+      if (!readString(key)) {
+        return false;
+      }
+      skipSpace();
+      if (!consume(':')) {
+        return false;
+      }
+      skipSpace();
+
+      if (peek() == '[') {
+        ++pos_;
+        skipSpace();
+        if (!consume(']')) {
+          do {
+            skipSpace();
+            if (!readMember(key, out, 1)) {
+              return false;
+            }
+            skipSpace();
+          } while (consume(','));
+          if (!consume(']')) {
+            return false;
+          }
+        }
+      } else if (!readMember(key, out, 0)) {
+        return false;
+      }
+
+      skipSpace();
+      if (consume('}')) {
+        return atEnd();
+      }
+      if (!consume(',')) {
+        return false;
+      }
+    }
+  }
+
+private:
+  // A scalar becomes an attribute named `key`; anything else is skipped.
+  bool readMember(const std::string &key,
+                  std::vector<vectorsearch::AttributeIndex::Attribute> &out,
+                  int depth) {
+    char c = peek();
+    if (c == '"') {
+      std::string value;
+      if (!readString(value)) {
+        return false;
+      }
+      out.emplace_back(key, AttributeValue(std::move(value)));
+      return true;
+    }
+    if (c == 't' || c == 'f') {
+      bool value = c == 't';
+      if (!readLiteral(value ? "true" : "false")) {
+        return false;
+      }
+      out.emplace_back(key, AttributeValue(value));
+      return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      double value;
+      if (!readNumber(value)) {
+        return false;
+      }
+      out.emplace_back(key, AttributeValue(value));
+      return true;
+    }
+    return skipValue(depth);
+  }
+
+  bool skipValue(int depth) {
+    if (depth > kMaxDepth) {
+      return false;
+    }
+    char c = peek();
+    if (c == '"') {
+      std::string ignored;
+      return readString(ignored);
+    }
+    if (c == 'n') {
+      return readLiteral("null");
+    }
+    if (c == 't') {
+      return readLiteral("true");
+    }
+    if (c == 'f') {
+      return readLiteral("false");
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      double ignored;
+      return readNumber(ignored);
+    }
+    if (c != '[' && c != '{') {
+      return false;
+    }
+
+    const bool isObject = c == '{';
+    const char close = isObject ? '}' : ']';
+    ++pos_;
+    skipSpace();
+    if (consume(close)) {
+      return true;
+    }
+    do {
+      skipSpace();
+      if (isObject) {
+        std::string key;
+        if (!readString(key)) {
+          return false;
+        }
+        skipSpace();
+        if (!consume(':')) {
+          return false;
+        }
+        skipSpace();
+      }
+      if (!skipValue(depth + 1)) {
+        return false;
+      }
+      skipSpace();
+    } while (consume(','));
+    return consume(close);
+  }
+
+  bool readString(std::string &out) {
+    if (!consume('"')) {
+      return false;
+    }
+    while (pos_ < text_.size()) {
+      char c = text_[pos_++];
+      if (c == '"') {
+        return true;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (pos_ >= text_.size()) {
+        return false;
+      }
+      switch (text_[pos_++]) {
+      case '"':
+        out += '"';
+        break;
+      case '\\':
+        out += '\\';
+        break;
+      case '/':
+        out += '/';
+        break;
+      case 'b':
+        out += '\b';
+        break;
+      case 'f':
+        out += '\f';
+        break;
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'u': {
+        uint32_t code;
+        if (!readHex4(code)) {
+          return false;
+        }
+        if (code >= 0xD800 && code <= 0xDBFF) {
+          uint32_t low;
+          if (!consume('\\') || !consume('u') || !readHex4(low) ||
+              low < 0xDC00 || low > 0xDFFF) {
+            return false;
+          }
+          code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        appendUtf8(code, out);
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+    return false;
+  }
+
+  bool readNumber(double &out) {
+    const size_t start = pos_;
+    consume('-');
+    if (consume('0')) {
+      // No leading zeros
+    } else if (!readDigits()) {
+      return false;
+    }
+    if (consume('.') && !readDigits()) {
+      return false;
+    }
+    if (consume('e') || consume('E')) {
+      if (!consume('+')) {
+        consume('-');
+      }
+      if (!readDigits()) {
+        return false;
+      }
+    }
+    out = std::strtod(text_.substr(start, pos_ - start).c_str(), nullptr);
+    return true;
+  }
+
+  bool readDigits() {
+    const size_t start = pos_;
+    while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+      ++pos_;
+    }
+    return pos_ > start;
+  }
+
+  bool readHex4(uint32_t &out) {
+    if (text_.size() - pos_ < 4) {
+      return false;
+    }
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+      char c = text_[pos_++];
+      out <<= 4;
+      if (c >= '0' && c <= '9') {
+        out |= static_cast<uint32_t>(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        out |= static_cast<uint32_t>(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        out |= static_cast<uint32_t>(c - 'A' + 10);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void appendUtf8(uint32_t code, std::string &out) {
+    if (code < 0x80) {
+      out += static_cast<char>(code);
+    } else if (code < 0x800) {
+      out += static_cast<char>(0xC0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      out += static_cast<char>(0xE0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+  }
+
+  bool readLiteral(const char *literal) {
+    for (; *literal; ++literal) {
+      if (!consume(*literal)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  char peek() const { return pos_ < text_.size() ? text_[pos_] : '\0'; }
+
+  bool consume(char c) {
+    if (peek() != c || pos_ >= text_.size()) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  void skipSpace() {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+            text_[pos_] == '\n' || text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  bool atEnd() {
+    skipSpace();
+    return pos_ == text_.size();
+  }
+
+  const std::string &text_;
+  size_t pos_ = 0;
+};
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+void AttributeIndex::add(uint32_t slot, const std::string &document_id,
+                         const std::string &metadata) {
+  all_.add(slot);
+  documents_[document_id].add(slot);
+
+  for (const Attribute &attribute : parse(metadata)) {
+    Column &column = columns_[attribute.first];
+    const AttributeValue &value = attribute.second;
+    switch (value.type()) {
+    case AttributeValue::Type::Bool:
+      (value.asBool() ? column.trues : column.falses).add(slot);
+      break;
+    case AttributeValue::Type::Number:
+      column.numbers[value.asNumber()].add(slot);
+      break;
+    case AttributeValue::Type::String:
+      column.strings[value.asString()].add(slot);
+      break;
+    }
+  }
+}
+
+void AttributeIndex::remove(uint32_t slot, const std::string &document_id,
+                            const std::string &metadata) {
+  all_.remove(slot);
+
+  // Empty bitmaps are dropped so retired values do not pile up
+  auto document = documents_.find(document_id);
+  if (document != documents_.end()) {
+    document->second.remove(slot);
+    if (document->second.empty()) {
+      documents_.erase(document);
+    }
+  }
+
+  for (const Attribute &attribute : parse(metadata)) {
+    auto columnIt = columns_.find(attribute.first);
+    if (columnIt == columns_.end()) {
+      continue;
+    }
+    Column &column = columnIt->second;
+    const AttributeValue &value = attribute.second;
+    switch (value.type()) {
+    case AttributeValue::Type::Bool:
+      (value.asBool() ? column.trues : column.falses).remove(slot);
+      break;
+    case AttributeValue::Type::Number: {
+      auto it = column.numbers.find(value.asNumber());
+      if (it != column.numbers.end()) {
+        it->second.remove(slot);
+        if (it->second.empty()) {
+          column.numbers.erase(it);
+        }
+      }
+      break;
+    }
+    case AttributeValue::Type::String: {
+      auto it = column.strings.find(value.asString());
+      if (it != column.strings.end()) {
+        it->second.remove(slot);
+        if (it->second.empty()) {
+          column.strings.erase(it);
+        }
+      }
+      break;
+    }
+    }
+    if (column.strings.empty() && column.numbers.empty() &&
+        column.trues.empty() && column.falses.empty()) {
+      columns_.erase(columnIt);
+    }
+  }
+}
+
+void AttributeIndex::clear() {
+  columns_.clear();
+  documents_.clear();
+  all_.clear();
+}
+
+Bitmap AttributeIndex::evaluate(const Filter &filter) const {
+  Bitmap result;
+  switch (filter.kind()) {
+  case Filter::Kind::Equals:
+  case Filter::Kind::In:
+    for (const AttributeValue &value : filter.values()) {
+      result |= lookup(filter.field(), value);
+    }
+    break;
+
+  case Filter::Kind::Range: {
+    auto column = columns_.find(filter.field());
+    if (column == columns_.end() || !(filter.min() <= filter.max())) {
+      break;
+    }
+    const auto &numbers = column->second.numbers;
+    for (auto it = numbers.lower_bound(filter.min());
+         it != numbers.end() && it->first <= filter.max(); ++it) {
+      result |= it->second;
+    }
+    break;
+  }
+
+  case Filter::Kind::DocumentIn:
+    for (const std::string &id : filter.documentIds()) {
+      auto it = documents_.find(id);
+      if (it != documents_.end()) {
+        result |= it->second;
+      }
+    }
+    break;
+
+  case Filter::Kind::AllOf:
+    result = all_;
+    for (const Filter &child : filter.children()) {
+      if (result.empty()) {
+        break;
+      }
+      result &= evaluate(child);
+    }
+    break;
+
+  case Filter::Kind::AnyOf:
+    for (const Filter &child : filter.children()) {
+      result |= evaluate(child);
+    }
+    break;
+
+  case Filter::Kind::Not:
+    result = all_;
+    for (const Filter &child : filter.children()) {
+      result -= evaluate(child);
+    }
+    break;
+  }
+  return result;
+}
+
+std::vector<AttributeIndex::Attribute>
+AttributeIndex::parse(const std::string &metadata) {
+  std::vector<Attribute> attributes;
+  // Cheap rejection of the common case of plain-text metadata
+  size_t first = metadata.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos || metadata[first] != '{') {
+    return attributes;
+  }
+  JsonReader reader(metadata);
+  if (!reader.readObject(attributes)) {
+    attributes.clear();
+  }
+  return attributes;
+}
+
+Bitmap AttributeIndex::lookup(const std::string &field,
+                              const AttributeValue &value) const {
+  auto column = columns_.find(field);
+  if (column == columns_.end()) {
+    return Bitmap();
+  }
+  const Column &c = column->second;
+  switch (value.type()) {
+  case AttributeValue::Type::Bool:
+    return value.asBool() ? c.trues : c.falses;
+  case AttributeValue::Type::Number: {
+    auto it = c.numbers.find(value.asNumber());
+    return it == c.numbers.end() ? Bitmap() : it->second;
+  }
+  default: {
+    auto it = c.strings.find(value.asString());
+    return it == c.strings.end() ? Bitmap() : it->second;
+  }
+  }
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,57 @@
+// src/engine/attribute_index.h
+#pragma once
+
+#include "common/bitmap.h"
+#include "filter.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vectorsearch {
+
+// Inverted index from document ids and metadata attributes to the slots that
+// carry them, one bitmap per distinct value. Attributes are parsed from
+// metadata written as a flat JSON object; each field becomes a column split
+// by type, with numbers kept ordered so range filters merge a contiguous run
+// of bitmaps. Metadata that is not a JSON object is simply not indexed. Not
+// internally synchronized.
+class AttributeIndex {
+public:
+  using Attribute = std::pair<std::string, AttributeValue>;
+
+  void add(uint32_t slot, const std::string &document_id,
+           const std::string &metadata);
+
+  // Must be given the strings `slot` was added with.
+  void remove(uint32_t slot, const std::string &document_id,
+               const std::string &metadata);
+
+  void clear();
+
+  // Slots matching `filter`.
+  Bitmap evaluate(const Filter &filter) const;
+
+  // Scalar members of a JSON object, with arrays of scalars flattened into
+  // one attribute per element. Nested objects and nulls are skipped. Returns
+  // nothing if `metadata` is not a well-formed JSON object.
+  static std::vector<Attribute> parse(const std::string &metadata);
+
+private:
+  struct Column {
+    std::unordered_map<std::string, Bitmap> strings;
+    std::map<double, Bitmap> numbers;
+    Bitmap trues;
+    Bitmap falses;
+  };
+
+  Bitmap lookup(const std::string &field, const AttributeValue &value) const;
+
+  std::unordered_map<std::string, Column> columns_;
+  std::unordered_map<std::string, Bitmap> documents_;
+  Bitmap all_;
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,172 @@
+// src/engine/embedding_arena.cpp
+#include "embedding_arena.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr size_t kInitialCapacity = 64;
+
+uint8_t *allocateAligned(size_t bytes) {
+  return static_cast<uint8_t *>(::operator new(
+      bytes, std::align_val_t(vectorsearch::EmbeddingArena::kAlignment)));
+}
+
+void freeAligned(uint8_t *p) {
+  ::operator delete(p,
+                    std::align_val_t(vectorsearch::EmbeddingArena::kAlignment));
+}
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+EmbeddingArena::EmbeddingArena(size_t dimension, ElementType elementType)
+    : dimension_(dimension), element_type_(elementType),
+      element_size_(VectorOps::elementSize(elementType)),
+      row_dot_(VectorOps::rowDotKernel(elementType, dimension)) {
+  const size_t perAlignment = kAlignment / element_size_;
+  stride_ = (dimension + perAlignment - 1) / perAlignment * perAlignment;
+}
+
+EmbeddingArena::~EmbeddingArena() {
+  if (data_ && !external_owner_) {
+    freeAligned(data_);
+  }
+}
+
+uint32_t EmbeddingArena::allocateRow() {
+  if (!free_slots_.empty()) {
+    uint32_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    return slot;
+  }
+
+  if (row_count_ >= std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("Embedding arena is full");
+  }
+
+  if (row_count_ == capacity_) {
+    reserve(std::max(kInitialCapacity, capacity_ * 2));
+  }
+
+  uint32_t slot = static_cast<uint32_t>(row_count_++);
+  // Keep the padding lanes zeroed so aligned full-width loads are harmless
+  std::memset(rowData(slot), 0, rowBytes());
+  return slot;
+}
+
+void EmbeddingArena::releaseRow(uint32_t slot) { free_slots_.push_back(slot); }
+
+void EmbeddingArena::store(uint32_t slot, const float *values) {
+  switch (element_type_) {
+  case ElementType::Float16:
+    VectorOps::toFloat16(values, static_cast<uint16_t *>(rowData(slot)),
+                         dimension_);
+    break;
+  case ElementType::BFloat16:
+    VectorOps::toBFloat16(values, static_cast<uint16_t *>(rowData(slot)),
+                          dimension_);
+    break;
+  default:
+    std::memcpy(rowData(slot), values, dimension_ * sizeof(float));
+  }
+}
+
+const float *EmbeddingArena::load(uint32_t slot, float *buffer) const {
+  switch (element_type_) {
+  case ElementType::Float16:
+    VectorOps::fromFloat16(static_cast<const uint16_t *>(rowData(slot)),
+                           buffer, dimension_);
+    return buffer;
+  case ElementType::BFloat16:
+    VectorOps::fromBFloat16(static_cast<const uint16_t *>(rowData(slot)),
+                            buffer, dimension_);
+    return buffer;
+  default:
+    return row(slot);
+  }
+}
+
+void EmbeddingArena::loadBlock(uint32_t slot, size_t rows,
+                               float *buffer) const {
+  const size_t count = rows * stride_;
+  switch (element_type_) {
+  case ElementType::Float16:
+    VectorOps::fromFloat16(static_cast<const uint16_t *>(rowData(slot)),
+                           buffer, count);
+    break;
+  case ElementType::BFloat16:
+    VectorOps::fromBFloat16(static_cast<const uint16_t *>(rowData(slot)),
+                            buffer, count);
+    break;
+  default:
+    std::memcpy(buffer, rowData(slot), count * sizeof(float));
+  }
+}
+
+void EmbeddingArena::reserve(size_t rows) {
+  if (rows <= capacity_) {
+    return;
+  }
+
+  uint8_t *data = allocateAligned(rows * rowBytes());
+  if (data_) {
+    std::memcpy(data, data_, row_count_ * rowBytes());
+    if (external_owner_) {
+      external_owner_.reset();
+    } else {
+      freeAligned(data_);
+    }
+  }
+  data_ = data;
+  capacity_ = rows;
+}
+
+void EmbeddingArena::clear() {
+  // Adopted rows are never reused: drop them so the snapshot can be unmapped
+  if (external_owner_) {
+    external_owner_.reset();
+    data_ = nullptr;
+    capacity_ = 0;
+  }
+  row_count_ = 0;
+  free_slots_.clear();
+}
+
+void EmbeddingArena::swap(EmbeddingArena &other) {
+  if (other.dimension_ != dimension_ ||
+      other.element_type_ != element_type_) {
+    throw std::invalid_argument(
+        "Cannot swap arenas of different dimension or element type");
+  }
+  std::swap(row_count_, other.row_count_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(data_, other.data_);
+  std::swap(external_owner_, other.external_owner_);
+  std::swap(free_slots_, other.free_slots_);
+}
+
+void EmbeddingArena::adopt(std::shared_ptr<void> owner, void *data,
+                           size_t rows, std::vector<uint32_t> freeSlots) {
+  if (reinterpret_cast<uintptr_t>(data) % kAlignment != 0) {
+    throw std::invalid_argument("Adopted embedding rows must be " +
+                                std::to_string(kAlignment) +
+                                "-byte aligned");
+  }
+
+  if (data_ && !external_owner_) {
+    freeAligned(data_);
+  }
+  data_ = static_cast<uint8_t *>(data);
+  external_owner_ = std::move(owner);
+  row_count_ = rows;
+  capacity_ = rows;
+  free_slots_ = std::move(freeSlots);
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,119 @@
+// src/engine/embedding_arena.h
+#pragma once
+
+#include "ann/vector_ops.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vectorsearch {
+
+// Row-major matrix backing the embeddings of a VectorStore. Rows are
+// addressed by a dense slot index; every row starts on a 64-byte boundary so
+// scans can stream through the buffer with aligned SIMD loads. Released slots
+// are kept on a free list and handed out again by allocateRow().
+//
+// Elements are float32 or a half-precision type (see ElementType). Writes go
+// through store(), which converts from fp32; half-precision rows are read
+// back with load() or scored in place with dot().
+class EmbeddingArena {
+public:
+  static constexpr size_t kAlignment = 64;
+
+  explicit EmbeddingArena(size_t dimension,
+                          ElementType elementType = ElementType::Float32);
+
+  ~EmbeddingArena();
+
+  EmbeddingArena(const EmbeddingArena &) = delete;
+  EmbeddingArena &operator=(const EmbeddingArena &) = delete;
+
+  // Returns a slot for a new row, reusing a released one when possible.
+  uint32_t allocateRow();
+
+  void releaseRow(uint32_t slot);
+
+  void *rowData(uint32_t slot) { return data_ + slot * rowBytes(); }
+
+  const void *rowData(uint32_t slot) const { return data_ + slot * rowBytes(); }
+
+  // fp32 view of a row; only meaningful for Float32 arenas.
+  float *row(uint32_t slot) { return static_cast<float *>(rowData(slot)); }
+
+  const float *row(uint32_t slot) const {
+    return static_cast<const float *>(rowData(slot));
+  }
+
+  // Converts `values` (dimension floats) to the element type and writes
+  // them to `slot`.
+  void store(uint32_t slot, const float *values);
+
+  // Row `slot` as fp32: the row itself in a Float32 arena, otherwise decoded
+  // into `buffer`, which must hold dimension floats.
+  const float *load(uint32_t slot, float *buffer) const;
+
+  // Decodes `rows` consecutive rows starting at `slot` into `buffer`,
+  // keeping the stride (padding included).
+  void loadBlock(uint32_t slot, size_t rows, float *buffer) const;
+
+  // Dot product of an fp32 query with row `slot`, read in its stored type.
+  // The kernel is picked once for the element type and dimension, so scans
+  // pay no per-row dispatch.
+  float dot(const float *query, uint32_t slot) const {
+    return row_dot_(query, rowData(slot), dimension_);
+  }
+
+  const void *data() const { return data_; }
+
+  ElementType elementType() const { return element_type_; }
+
+  // Elements between the start of consecutive rows (dimension rounded up to
+  // the alignment).
+  size_t stride() const { return stride_; }
+
+  size_t rowBytes() const { return stride_ * element_size_; }
+
+  size_t getDimension() const { return dimension_; }
+
+  // Number of slots handed out so far, including released ones; valid slots
+  // are always below this bound.
+  size_t rowCount() const { return row_count_; }
+
+  size_t capacity() const { return capacity_; }
+
+  // Released slots waiting to be reused.
+  size_t freeRowCount() const { return free_slots_.size(); }
+
+  void reserve(size_t rows);
+
+  // Drops every row. Heap storage is kept for reuse; adopted storage is
+  // released along with its owner.
+  void clear();
+
+  // Exchanges contents with an arena of the same dimension and element type.
+  void swap(EmbeddingArena &other);
+
+  // Serves `rows` rows directly from `data`, which must use this arena's
+  // stride and alignment and stays valid while `owner` is alive (a mapped
+  // snapshot). The rows are only copied to the heap when the arena next
+  // grows, at which point `owner` is released. Slots in `freeSlots` are
+  // handed out again before new rows are appended.
+  void adopt(std::shared_ptr<void> owner, void *data, size_t rows,
+             std::vector<uint32_t> freeSlots);
+
+private:
+  size_t dimension_;
+  ElementType element_type_;
+  size_t element_size_;
+  size_t stride_;
+  RowDotKernel row_dot_;
+  size_t row_count_ = 0;
+  size_t capacity_ = 0;
+  uint8_t *data_ = nullptr;
+  // Keeps adopted external storage alive; null when data_ is heap-owned
+  std::shared_ptr<void> external_owner_;
+  std::vector<uint32_t> free_slots_;
+};
+
+} // namespace vectorsearch
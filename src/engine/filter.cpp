@@ -0,0 +1,67 @@
+// src/engine/filter.cpp
+#include "filter.h"
+
+namespace vectorsearch {
+
+bool AttributeValue::operator==(const AttributeValue &other) const {
+  if (type_ != other.type_) {
+    return false;
+  }
+  switch (type_) {
+  case Type::Bool:
+    return boolean_ == other.boolean_;
+  case Type::Number:
+    return number_ == other.number_;
+  default:
+    return string_ == other.string_;
+  }
+}
+
+Filter Filter::equals(const std::string &field, AttributeValue value) {
+  Filter filter(Kind::Equals);
+  filter.field_ = field;
+  filter.values_.push_back(std::move(value));
+  return filter;
+}
+
+Filter Filter::in(const std::string &field,
+                  std::vector<AttributeValue> values) {
+  Filter filter(Kind::In);
+  filter.field_ = field;
+  filter.values_ = std::move(values);
+  return filter;
+}
+
+Filter Filter::range(const std::string &field, double min, double max) {
+  Filter filter(Kind::Range);
+  filter.field_ = field;
+  filter.min_ = min;
+  filter.max_ = max;
+  return filter;
+}
+
+Filter Filter::documentIn(std::vector<std::string> documentIds) {
+  Filter filter(Kind::DocumentIn);
+  filter.document_ids_ = std::move(documentIds);
+  return filter;
+}
+
+Filter Filter::allOf(std::vector<Filter> filters) {
+  Filter filter(Kind::AllOf);
+  filter.children_ = std::move(filters);
+  return filter;
+}
+
+Filter Filter::anyOf(std::vector<Filter> filters) {
+  Filter filter(Kind::AnyOf);
+  filter.children_ = std::move(filters);
+  return filter;
+}
+
+Filter Filter::negate(Filter filter) {
+  Filter result(Kind::Not);
+  result.children_.push_back(std::move(filter));
+  return result;
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,83 @@
+// src/engine/filter.h
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vectorsearch {
+
+// Typed value of a metadata attribute. JSON numbers are held as doubles.
+class AttributeValue {
+public:
+  enum class Type { Bool, Number, String };
+
+  AttributeValue(bool value) : type_(Type::Bool), boolean_(value) {}
+  AttributeValue(int value) : type_(Type::Number), number_(value) {}
+  AttributeValue(double value) : type_(Type::Number), number_(value) {}
+  AttributeValue(const char *value) : type_(Type::String), string_(value) {}
+  AttributeValue(std::string value)
+      : type_(Type::String), string_(std::move(value)) {}
+
+  Type type() const { return type_; }
+  bool asBool() const { return boolean_; }
+  double asNumber() const { return number_; }
+  const std::string &asString() const { return string_; }
+
+  bool operator==(const AttributeValue &other) const;
+
+private:
+  Type type_;
+  bool boolean_ = false;
+  double number_ = 0.0;
+  std::string string_;
+};
+
+// Predicate over the document id and metadata attributes of stored vectors,
+// built from the factory functions below and passed to the filtered search
+// overloads of VectorStore. Attributes come from metadata written as a flat
+// JSON object, e.g. {"tenant": "acme", "year": 2024, "tags": ["a", "b"]};
+// an array makes the vector match any of its elements.
+class Filter {
+public:
+  enum class Kind { Equals, In, Range, DocumentIn, AllOf, AnyOf, Not };
+
+  static Filter equals(const std::string &field, AttributeValue value);
+
+  static Filter in(const std::string &field,
+                   std::vector<AttributeValue> values);
+
+  // Numeric attributes within [min, max].
+  static Filter range(const std::string &field, double min, double max);
+
+  static Filter documentIn(std::vector<std::string> documentIds);
+
+  // Conjunction; an empty list matches every vector.
+  static Filter allOf(std::vector<Filter> filters);
+
+  // Disjunction; an empty list matches nothing.
+  static Filter anyOf(std::vector<Filter> filters);
+
+  static Filter negate(Filter filter);
+
+  Kind kind() const { return kind_; }
+  const std::string &field() const { return field_; }
+  const std::vector<AttributeValue> &values() const { return values_; }
+  const std::vector<std::string> &documentIds() const { return document_ids_; }
+  double min() const { return min_; }
+  double max() const { return max_; }
+  const std::vector<Filter> &children() const { return children_; }
+
+private:
+  explicit Filter(Kind kind) : kind_(kind) {}
+
+  Kind kind_;
+  std::string field_;
+  std::vector<AttributeValue> values_;
+  std::vector<std::string> document_ids_;
+  double min_ = 0.0;
+  double max_ = 0.0;
+  std::vector<Filter> children_;
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,222 @@
+// src/engine/query_cache.cpp
+#include "query_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace vectorsearch {
+
+namespace {
+
+constexpr size_t kMaxShards = 16;
+
+// Rough per-entry cost of the list node, hash table node and bucket
+constexpr size_t kEntryOverhead = 96;
+
+template <typename T> void appendRaw(std::string &key, T value) {
+  key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void appendString(std::string &key, const std::string &value) {
+  appendRaw<uint32_t>(key, static_cast<uint32_t>(value.size()));
+  key.append(value);
+}
+
+void appendValue(std::string &key, const AttributeValue &value) {
+  appendRaw<uint8_t>(key, static_cast<uint8_t>(value.type()));
+  switch (value.type()) {
+  case AttributeValue::Type::Bool:
+    appendRaw<uint8_t>(key, value.asBool() ? 1 : 0);
+    break;
+  case AttributeValue::Type::Number:
+    appendRaw<double>(key, value.asNumber());
+    break;
+  case AttributeValue::Type::String:
+    appendString(key, value.asString());
+    break;
+  }
+}
+
+// Self-delimiting encoding of the filter tree: equal filters encode equally
+// (operands are not reordered, so equivalent filters written differently
+// simply use separate entries).
+void appendFilter(std::string &key, const Filter &filter) {
+  appendRaw<uint8_t>(key, static_cast<uint8_t>(filter.kind()));
+  appendString(key, filter.field());
+  appendRaw<uint32_t>(key, static_cast<uint32_t>(filter.values().size()));
+  for (const AttributeValue &value : filter.values()) {
+    appendValue(key, value);
+  }
+  appendRaw<uint32_t>(key,
+                      static_cast<uint32_t>(filter.documentIds().size()));
+  for (const std::string &documentId : filter.documentIds()) {
+    appendString(key, documentId);
+  }
+  appendRaw<double>(key, filter.min());
+  appendRaw<double>(key, filter.max());
+  appendRaw<uint32_t>(key, static_cast<uint32_t>(filter.children().size()));
+  for (const Filter &child : filter.children()) {
+    appendFilter(key, child);
+  }
+}
+
+size_t entryBytes(const std::string &key,
+                  const std::vector<SearchResult> &results) {
+  size_t bytes = kEntryOverhead + key.capacity() +
+                 results.capacity() * sizeof(SearchResult);
+  for (const SearchResult &result : results) {
+    // Short ids live inside the string object
+    if (result.id.capacity() > sizeof(std::string)) {
+      bytes += result.id.capacity();
+    }
+  }
+  return bytes;
+}
+
+} // anonymous namespace
+
+double QueryCacheStats::hitRate() const {
+  const uint64_t lookups = hits + misses;
+  return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+}
+
+QueryCache::QueryCache(const QueryCacheOptions &options) : options_(options) {
+  if (options.maxEntries == 0 || options.maxBytes == 0) {
+    throw std::invalid_argument("Query cache bounds must be positive");
+  }
+  if (options.mantissaBits > 23) {
+    throw std::invalid_argument("mantissaBits must be at most 23");
+  }
+  // Small caches use fewer shards so the per-shard bounds stay meaningful
+  shard_count_ = std::min(kMaxShards, options.maxEntries);
+  shard_max_entries_ = (options.maxEntries + shard_count_ - 1) / shard_count_;
+  shard_max_bytes_ = std::max<size_t>(options.maxBytes / shard_count_, 1);
+  shards_ = std::make_unique<Shard[]>(shard_count_);
+}
+
+std::string QueryCache::makeKey(uint32_t operation, int metric, size_t k,
+                                size_t parameter, const float *query,
+                                size_t dimension,
+                                const Filter *filter) const {
+  std::string key;
+  key.reserve(32 + dimension * sizeof(uint32_t));
+  appendRaw<uint32_t>(key, operation);
+  appendRaw<int32_t>(key, metric);
+  appendRaw<uint64_t>(key, k);
+  appendRaw<uint64_t>(key, parameter);
+
+  // Round each component to mantissaBits, then drop the low bits
+  const unsigned dropped = 23 - options_.mantissaBits;
+  const uint32_t mask = ~((uint32_t(1) << dropped) - 1);
+  const uint32_t half = dropped == 0 ? 0 : uint32_t(1) << (dropped - 1);
+  for (size_t i = 0; i < dimension; ++i) {
+    uint32_t bits;
+    std::memcpy(&bits, &query[i], sizeof(bits));
+    if ((bits & 0x7FFFFFFFu) == 0) {
+      bits = 0; // -0 and +0 share a key
+    } else if ((bits & 0x7F800000u) != 0x7F800000u) {
+      bits = (bits + half) & mask;
+    }
+    appendRaw<uint32_t>(key, bits);
+  }
+
+  appendRaw<uint8_t>(key, filter ? 1 : 0);
+  if (filter) {
+    appendFilter(key, *filter);
+  }
+  return key;
+}
+
+QueryCache::Shard &QueryCache::shardFor(const std::string &key) const {
+  return shards_[std::hash<std::string>()(key) % shard_count_];
+}
+
+void QueryCache::erase(Shard &shard, std::list<Entry>::iterator entry) {
+  shard.bytes -= entry->bytes;
+  shard.index.erase(std::string_view(entry->key));
+  shard.entries.erase(entry);
+}
+
+bool QueryCache::lookup(const std::string &key, uint64_t version,
+                        std::vector<SearchResult> &results) {
+  Shard &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto found = shard.index.find(std::string_view(key));
+  if (found == shard.index.end()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (found->second->version != version) {
+    // A caller that read the version just before a write may still be
+    // looking up; only entries older than the caller are dead
+    if (found->second->version < version) {
+      erase(shard, found->second);
+      invalidations_.fetch_add(1, std::memory_order_relaxed);
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+  results = found->second->results;
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void QueryCache::insert(std::string key, uint64_t version,
+                        std::vector<SearchResult> results) {
+  const size_t bytes = entryBytes(key, results);
+  if (bytes > shard_max_bytes_) {
+    return;
+  }
+
+  Shard &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto found = shard.index.find(std::string_view(key));
+  if (found != shard.index.end()) {
+    // A concurrent miss for the same query got here first; keep the newer
+    if (found->second->version >= version) {
+      return;
+    }
+    erase(shard, found->second);
+  }
+  while (!shard.entries.empty() &&
+         (shard.entries.size() >= shard_max_entries_ ||
+          shard.bytes + bytes > shard_max_bytes_)) {
+    erase(shard, std::prev(shard.entries.end()));
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  shard.entries.push_front(Entry{std::move(key), version, std::move(results),
+                                 bytes});
+  shard.index.emplace(std::string_view(shard.entries.front().key),
+                      shard.entries.begin());
+  shard.bytes += bytes;
+}
+
+void QueryCache::clear() {
+  for (size_t i = 0; i < shard_count_; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    shards_[i].index.clear();
+    shards_[i].entries.clear();
+    shards_[i].bytes = 0;
+  }
+}
+
+QueryCacheStats QueryCache::stats() const {
+  QueryCacheStats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < shard_count_; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    stats.entries += shards_[i].entries.size();
+    stats.bytes += shards_[i].bytes;
+  }
+  return stats;
+}
+
+} // namespace vectorsearch
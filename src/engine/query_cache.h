@@ -0,0 +1,108 @@
+// src/engine/query_cache.h
+#pragma once
+
+#include "filter.h"
+#include "search_result.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vectorsearch {
+
+struct QueryCacheOptions {
+  // Cached result lists are evicted least recently used first once either
+  // bound is reached.
+  size_t maxEntries = 4096;
+  size_t maxBytes = size_t(16) << 20;
+  // Query components keep this many mantissa bits (0-23) in the key, so
+  // queries agreeing to roughly 2^-mantissaBits relative precision share an
+  // entry; 23 only matches bit-identical queries.
+  unsigned mantissaBits = 10;
+};
+
+struct QueryCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // Entries dropped to stay within the bounds
+  uint64_t evictions = 0;
+  // Lookups that found an entry from an older store version; also misses
+  uint64_t invalidations = 0;
+  size_t entries = 0;
+  // Approximate memory held by keys, results and bookkeeping
+  size_t bytes = 0;
+
+  // hits / (hits + misses), or 0 before the first lookup.
+  double hitRate() const;
+};
+
+// Size-bounded LRU cache of search results, keyed on the exact search
+// parameters and a quantized copy of the query. Every entry is tagged with
+// the store version it was computed at; a lookup at any other version is a
+// miss and drops the entry, so a store that bumps its version on every
+// mutation never serves stale results. Entries are spread over independently
+// locked shards, so concurrent lookups rarely contend.
+class QueryCache {
+public:
+  explicit QueryCache(const QueryCacheOptions &options = QueryCacheOptions());
+
+  // Builds the key for one search. `operation` and `parameter` identify the
+  // search path and its tuning knob (efSearch, nprobe, ...); `metric` is -1
+  // for searches ranked by an index's own metric. `filter` may be null.
+  std::string makeKey(uint32_t operation, int metric, size_t k,
+                      size_t parameter, const float *query, size_t dimension,
+                      const Filter *filter) const;
+
+  // Copies the entry for `key` into `results` if it was stored at `version`.
+  bool lookup(const std::string &key, uint64_t version,
+              std::vector<SearchResult> &results);
+
+  void insert(std::string key, uint64_t version,
+              std::vector<SearchResult> results);
+
+  void clear();
+
+  QueryCacheStats stats() const;
+
+  const QueryCacheOptions &options() const { return options_; }
+
+private:
+  struct Entry {
+    std::string key;
+    uint64_t version;
+    std::vector<SearchResult> results;
+    size_t bytes;
+  };
+
+  // Most recently used entries first; the index points into the list, whose
+  // nodes (and so keys) never move.
+  struct Shard {
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+  };
+
+  Shard &shardFor(const std::string &key) const;
+
+  void erase(Shard &shard, std::list<Entry>::iterator entry);
+
+  QueryCacheOptions options_;
+  size_t shard_count_;
+  size_t shard_max_entries_;
+  size_t shard_max_bytes_;
+  std::unique_ptr<Shard[]> shards_;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> invalidations_{0};
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,16 @@
+// src/engine/search_result.h
+#pragma once
+
+#include <string>
+
+namespace vectorsearch {
+
+// One hit of a top-k search (VectorStore::SearchResult). `score` is the
+// dot product, euclidean distance or cosine similarity depending on the
+// metric.
+struct SearchResult {
+  std::string id;
+  float score;
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,185 @@
+// src/engine/store_metrics.cpp
+#include "store_metrics.h"
+#include <sstream>
+#include <vector>
+
+namespace vectorsearch {
+
+namespace {
+
+// Bucket boundaries exposed to Prometheus, in nanoseconds for durations
+const std::vector<uint64_t> kDurationBounds = {
+    1000,      2500,      5000,       10000,      25000,      50000,
+    100000,    250000,    500000,     1000000,    2500000,    5000000,
+    10000000,  25000000,  50000000,   100000000,  250000000,  500000000,
+    1000000000, 2500000000, 5000000000, 10000000000};
+
+const std::vector<uint64_t> kCountBounds = {1,      10,      100,     1000,
+                                            10000,  100000,  1000000,
+                                            10000000};
+
+void writeHeader(std::ostream &out, const std::string &name,
+                 const std::string &help, const char *type) {
+  out << "# HELP " << name << " " << help << "\n";
+  out << "# TYPE " << name << " " << type << "\n";
+}
+
+// One labelled series of a histogram family. With `seconds` the
+// nanosecond values are converted to the Prometheus base unit.
+void writeHistogram(std::ostream &out, const std::string &name,
+                    const std::string &label,
+                    const HistogramSnapshot &histogram,
+                    const std::vector<uint64_t> &bounds, bool seconds) {
+  const std::string prefix = label.empty() ? "{" : "{" + label + ",";
+  const double scale = seconds ? 1e-9 : 1.0;
+  for (uint64_t bound : bounds) {
+    out << name << "_bucket" << prefix << "le=\"" << bound * scale
+        << "\"} " << histogram.countAtMost(bound) << "\n";
+  }
+  out << name << "_bucket" << prefix << "le=\"+Inf\"} " << histogram.count
+      << "\n";
+  const std::string labels = label.empty() ? "" : "{" + label + "}";
+  out << name << "_sum" << labels << " " << histogram.sum * scale << "\n";
+  out << name << "_count" << labels << " " << histogram.count << "\n";
+}
+
+} // anonymous namespace
+
+const char *storeOperationName(StoreOperation operation) {
+  switch (operation) {
+  case StoreOperation::Add:
+    return "add";
+  case StoreOperation::AddBatch:
+    return "add_batch";
+  case StoreOperation::Update:
+    return "update";
+  case StoreOperation::Delete:
+    return "delete";
+  case StoreOperation::Get:
+    return "get";
+  case StoreOperation::Search:
+    return "search";
+  case StoreOperation::SearchBatch:
+    return "search_batch";
+  case StoreOperation::SearchHnsw:
+    return "search_hnsw";
+  case StoreOperation::SearchIvf:
+    return "search_ivf";
+  case StoreOperation::SearchQuantized:
+    return "search_quantized";
+  case StoreOperation::SearchPq:
+    return "search_pq";
+  case StoreOperation::SearchBinary:
+    return "search_binary";
+  case StoreOperation::SaveSnapshot:
+    return "save_snapshot";
+  case StoreOperation::LoadSnapshot:
+    return "load_snapshot";
+  case StoreOperation::Checkpoint:
+    return "checkpoint";
+  case StoreOperation::Compact:
+    return "compact";
+  case StoreOperation::WalSync:
+    return "wal_sync";
+  }
+  return "unknown";
+}
+
+const char *storeLockName(StoreLock lock) {
+  switch (lock) {
+  case StoreLock::Writer:
+    return "writer";
+  case StoreLock::Exclusive:
+    return "exclusive";
+  case StoreLock::Shared:
+    return "shared";
+  }
+  return "unknown";
+}
+
+std::string StoreMetricsSnapshot::toPrometheus() const {
+  std::ostringstream out;
+  out.precision(9);
+
+  const std::string operationName = "vectorsearch_operation_duration_seconds";
+  writeHeader(out, operationName, "Latency of VectorStore operations.",
+              "histogram");
+  for (size_t i = 0; i < kStoreOperationCount; ++i) {
+    writeHistogram(
+        out, operationName,
+        std::string("operation=\"") +
+            storeOperationName(static_cast<StoreOperation>(i)) + "\"",
+        latency[i], kDurationBounds, true);
+  }
+
+  const std::string lockName = "vectorsearch_lock_wait_seconds";
+  writeHeader(out, lockName, "Time spent acquiring VectorStore locks.",
+              "histogram");
+  for (size_t i = 0; i < kStoreLockCount; ++i) {
+    writeHistogram(out, lockName,
+                   std::string("lock=\"") +
+                       storeLockName(static_cast<StoreLock>(i)) + "\"",
+                   lockWait[i], kDurationBounds, true);
+  }
+
+  const std::string distanceName = "vectorsearch_search_distance_computations";
+  writeHeader(out, distanceName, "Distance computations per search query.",
+              "histogram");
+  writeHistogram(out, distanceName, "", distanceComputations, kCountBounds,
+                 false);
+
+  const std::string visitedName = "vectorsearch_search_nodes_visited";
+  writeHeader(out, visitedName,
+              "HNSW nodes expanded or IVF lists scanned per index query.",
+              "histogram");
+  writeHistogram(out, visitedName, "", nodesVisited, kCountBounds, false);
+
+  writeHeader(out, "vectorsearch_vectors", "Live vectors in the store.",
+              "gauge");
+  out << "vectorsearch_vectors " << vectors << "\n";
+
+  writeHeader(out, "vectorsearch_query_cache_hits_total",
+              "Searches answered from the query cache.", "counter");
+  out << "vectorsearch_query_cache_hits_total " << queryCache.hits << "\n";
+  writeHeader(out, "vectorsearch_query_cache_misses_total",
+              "Cached searches that had to run.", "counter");
+  out << "vectorsearch_query_cache_misses_total " << queryCache.misses
+      << "\n";
+  writeHeader(out, "vectorsearch_query_cache_evictions_total",
+              "Query cache entries evicted to stay within bounds.", "counter");
+  out << "vectorsearch_query_cache_evictions_total " << queryCache.evictions
+      << "\n";
+  writeHeader(out, "vectorsearch_query_cache_entries",
+              "Result lists held by the query cache.", "gauge");
+  out << "vectorsearch_query_cache_entries " << queryCache.entries << "\n";
+  writeHeader(out, "vectorsearch_query_cache_bytes",
+              "Approximate memory held by the query cache.", "gauge");
+  out << "vectorsearch_query_cache_bytes " << queryCache.bytes << "\n";
+  return out.str();
+}
+
+StoreMetricsSnapshot StoreMetrics::snapshot() const {
+  StoreMetricsSnapshot result;
+  for (size_t i = 0; i < kStoreOperationCount; ++i) {
+    result.latency[i] = latency_[i].snapshot();
+  }
+  for (size_t i = 0; i < kStoreLockCount; ++i) {
+    result.lockWait[i] = lock_wait_[i].snapshot();
+  }
+  result.distanceComputations = distance_computations_.snapshot();
+  result.nodesVisited = nodes_visited_.snapshot();
+  return result;
+}
+
+void StoreMetrics::reset() {
+  for (Histogram &histogram : latency_) {
+    histogram.reset();
+  }
+  for (Histogram &histogram : lock_wait_) {
+    histogram.reset();
+  }
+  distance_computations_.reset();
+  nodes_visited_.reset();
+}
+
+} // namespace vectorsearch
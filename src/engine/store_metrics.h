@@ -0,0 +1,124 @@
+// src/engine/store_metrics.h
+#pragma once
+
+#include "ann/top_k.h"
+#include "common/histogram.h"
+#include "query_cache.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace vectorsearch {
+
+enum class StoreOperation {
+  Add,
+  AddBatch,
+  Update,
+  Delete,
+  Get,
+  Search,
+  SearchBatch,
+  SearchHnsw,
+  SearchIvf,
+  SearchQuantized,
+  SearchPq,
+  SearchBinary,
+  SaveSnapshot,
+  LoadSnapshot,
+  Checkpoint,
+  Compact,
+  // Time a mutation spent waiting for its write-ahead log record to sync
+  WalSync,
+};
+constexpr size_t kStoreOperationCount = 17;
+
+// Locks a VectorStore operation can wait on: the writer mutex serializing
+// mutations, and the table lock taken exclusively by writers and shared by
+// readers.
+enum class StoreLock { Writer, Exclusive, Shared };
+constexpr size_t kStoreLockCount = 3;
+
+const char *storeOperationName(StoreOperation operation);
+const char *storeLockName(StoreLock lock);
+
+// Point-in-time copy of a store's metrics. Durations are in nanoseconds.
+struct StoreMetricsSnapshot {
+  std::array<HistogramSnapshot, kStoreOperationCount> latency;
+  // Time spent acquiring each lock; uncontended acquisitions record 0
+  std::array<HistogramSnapshot, kStoreLockCount> lockWait;
+  // Per search query, over every search path
+  HistogramSnapshot distanceComputations;
+  // Per HNSW or IVF query (see SearchStats)
+  HistogramSnapshot nodesVisited;
+  size_t vectors = 0;
+  // All zero while the store has no query cache
+  QueryCacheStats queryCache;
+
+  const HistogramSnapshot &operator[](StoreOperation operation) const {
+    return latency[static_cast<size_t>(operation)];
+  }
+
+  const HistogramSnapshot &operator[](StoreLock lock) const {
+    return lockWait[static_cast<size_t>(lock)];
+  }
+
+  // Prometheus text exposition format (version 0.0.4): one histogram
+  // family per measurement, labelled by operation or lock, with fixed
+  // bucket boundaries derived from the finer internal buckets.
+  std::string toPrometheus() const;
+};
+
+// Always-on instrumentation for VectorStore: latency histograms per
+// operation, lock wait histograms and per-query search work. Every record
+// is a few relaxed atomic increments on a per-thread shard (see Histogram),
+// and an uncontended lock acquisition is not timed at all.
+class StoreMetrics {
+public:
+  Histogram &latency(StoreOperation operation) {
+    return latency_[static_cast<size_t>(operation)];
+  }
+
+  // Acquires `mutex` through a Lock (std::unique_lock, std::shared_lock)
+  // and records how long that took.
+  template <typename Lock>
+  Lock acquire(typename Lock::mutex_type &mutex, StoreLock which) {
+    Histogram &wait = lock_wait_[static_cast<size_t>(which)];
+    Lock lock(mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+      wait.record(0);
+      return lock;
+    }
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    wait.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count()));
+    return lock;
+  }
+
+  void recordDistances(size_t distances) {
+    distance_computations_.record(distances);
+  }
+
+  // Work done by one index search
+  void recordSearch(const SearchStats &stats) {
+    distance_computations_.record(stats.distanceComputations);
+    nodes_visited_.record(stats.nodesVisited);
+  }
+
+  StoreMetricsSnapshot snapshot() const;
+
+  void reset();
+
+private:
+  std::array<Histogram, kStoreOperationCount> latency_;
+  std::array<Histogram, kStoreLockCount> lock_wait_;
+  Histogram distance_computations_;
+  Histogram nodes_visited_;
+};
+
+} // namespace vectorsearch
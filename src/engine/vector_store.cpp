@@ -1,124 +1,1692 @@
 // src/engine/vector_store.cpp
 #include "vector_store.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+
+// Below this many rows per chunk, handing work to the thread pool costs more
+// than it saves, so small stores are scanned on the calling thread.
+constexpr size_t kMinRowsPerScanThread = 8192;
+
+// Bytes of stored vectors scored per block in batch search; sized to stay
+// resident in L2 while every query in the batch is run against it.
+constexpr size_t kBatchBlockBytes = 128 * 1024;
+
+// An HNSW insert costs a graph search, so far fewer of them than scanned
+// rows justify a chunk. Insert costs vary, so builds are cut into several
+// chunks per thread for the pool to balance.
+constexpr size_t kMinInsertsPerThread = 256;
+constexpr size_t kInsertChunksPerThread = 4;
+
+// Filtered index searches switch to an exact scan of the matching rows when
+// at most this fraction of the store (or this many rows) match. Below that a
+// graph walk or list probe visits mostly rejected vectors, and the scan is
+// both cheaper and exact.
+constexpr double kFilteredScanFraction = 0.05;
+constexpr size_t kMinFilteredScanRows = 2048;
+
+} // anonymous namespace
 
 namespace vectorsearch {
 
-VectorStore::VectorStore(size_t dimension) : dimension_(dimension) {}
+VectorStore::VectorStore(size_t dimension)
+    : dimension_(dimension), embeddings_(dimension) {}
 
-VectorStore::~VectorStore() = default;
+VectorStore::VectorStore(size_t dimension, Metric metric)
+    : dimension_(dimension), metric_(metric), embeddings_(dimension) {}
+
+VectorStore::VectorStore(size_t dimension, std::optional<Metric> metric,
+                         ElementType elementType)
+    : dimension_(dimension), metric_(metric),
+      embeddings_(dimension, elementType) {}
+
+VectorStore::~VectorStore() { disableBackgroundCompaction(); }
 
 bool VectorStore::addVector(const std::string &id,
                             const std::vector<float> &embedding,
                             const std::string &document_id,
                             const std::string &metadata) {
+  ScopedTimer timer(metrics_.latency(StoreOperation::Add));
+
   // Check if the embedding has the correct dimension
-  if (embedding.size() != dimension_) {
-    throw std::invalid_argument(
-        "Embedding dimension (" + std::to_string(embedding.size()) +
-        ") doesn't match store dimension (" + std::to_string(dimension_) + ")");
-  }
+  checkDimension(embedding.size());
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_lock<std::mutex> writeLock = lockWriter();
 
-  // Check if the ID already exists
-  if (vectors_.find(id) != vectors_.end()) {
+  // Check if the ID already exists; only writers change slots_, so the
+  // write lock is enough to read it
+  if (slots_.find(id, ids_) != IdTable::kNotFound) {
     return false;
   }
 
-  // Create the vector record
-  auto record = std::make_shared<VectorRecord>();
-  record->id = id;
-  record->embedding = embedding;
-  record->document_id = document_id;
-  record->metadata = metadata;
+  const uint64_t lsn = logMutation(WriteAheadLog::Op::Add, id, embedding,
+                                   document_id, metadata);
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+
+  // Claim a row in the arena and fill the side tables
+  uint32_t slot = embeddings_.allocateRow();
+  hideFromCursors(slot);
+  storeRow(slot, embedding.data());
+
+  if (slot >= ids_.size()) {
+    ids_.resize(slot + 1);
+    document_codes_.resize(slot + 1);
+    metadata_.resize(slot + 1);
+    occupied_.resize(slot + 1);
+  }
+  ids_[slot] = id;
+  document_codes_[slot] = documents_.intern(document_id);
+  metadata_[slot] = metadata;
+  occupied_[slot] = 1;
+  attributes_.add(slot, document_id, metadata);
+
+  slots_.insert(slot, ids_);
+  live_count_.fetch_add(1, std::memory_order_relaxed);
+
+  if (quantizer_) {
+    encodeSlot(slot);
+  }
+  if (pq_) {
+    encodePqSlot(slot);
+  }
+  if (binary_quantizer_) {
+    encodeBinarySlot(slot);
+  }
+  std::vector<float> buffer = rowBuffer();
+  if (ivf_) {
+    ivf_->add(slot, embeddings_.load(slot, buffer.data()));
+  }
+  lock.unlock();
+
+  // HNSW insertion is the slow part of a write and the graph synchronizes
+  // itself, so readers are not held up while it runs
+  if (hnsw_) {
+    hnsw_->add(slot, embeddings_.load(slot, buffer.data()));
+  }
+  bumpVersion();
+  writeLock.unlock();
 
-  // Store the vector
-  vectors_[id] = record;
+  waitForLog(lsn);
   return true;
 }
 
+size_t VectorStore::addVectors(const float *embeddings, size_t count,
+                               const std::vector<std::string> &ids,
+                               const std::vector<std::string> &document_ids,
+                               const std::vector<std::string> &metadata) {
+  ScopedTimer timer(metrics_.latency(StoreOperation::AddBatch));
+
+  if (ids.size() != count ||
+      (!document_ids.empty() && document_ids.size() != count) ||
+      (!metadata.empty() && metadata.size() != count)) {
+    throw std::invalid_argument(
+        "addVectors needs one id, document id and metadata entry per vector");
+  }
+  const std::string none;
+  auto documentIdOf = [&](size_t i) -> const std::string & {
+    return document_ids.empty() ? none : document_ids[i];
+  };
+  auto metadataOf = [&](size_t i) -> const std::string & {
+    return metadata.empty() ? none : metadata[i];
+  };
+
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+
+  // Same rule as addVector: an id that is already taken is not overwritten
+  std::vector<size_t> accepted;
+  accepted.reserve(count);
+  {
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      if (slots_.find(ids[i], ids_) == IdTable::kNotFound &&
+          seen.insert(ids[i]).second) {
+        accepted.push_back(i);
+      }
+    }
+  }
+  if (accepted.empty()) {
+    return 0;
+  }
+
+  uint64_t lsn = 0;
+  if (wal_) {
+    for (size_t i : accepted) {
+      const float *embedding = embeddings + i * dimension_;
+      lsn = logMutation(WriteAheadLog::Op::Add, ids[i],
+                        std::vector<float>(embedding, embedding + dimension_),
+                        documentIdOf(i), metadataOf(i));
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+
+  // Grow every table once for the whole batch; released slots are reused
+  // first, so only the remainder needs new rows
+  const size_t newRows =
+      accepted.size() -
+      std::min(accepted.size(), embeddings_.freeRowCount());
+  const size_t rows = embeddings_.rowCount() + newRows;
+  embeddings_.reserve(rows);
+  if (rows > ids_.size()) {
+    ids_.resize(rows);
+    document_codes_.resize(rows);
+    metadata_.resize(rows);
+    occupied_.resize(rows);
+  }
+  slots_.reserve(slots_.size() + accepted.size());
+
+  std::vector<uint32_t> added(accepted.size());
+  for (size_t n = 0; n < accepted.size(); ++n) {
+    const size_t i = accepted[n];
+    uint32_t slot = embeddings_.allocateRow();
+    hideFromCursors(slot);
+    storeRow(slot, embeddings + i * dimension_);
+    ids_[slot] = ids[i];
+    document_codes_[slot] = documents_.intern(documentIdOf(i));
+    metadata_[slot] = metadataOf(i);
+    occupied_[slot] = 1;
+    attributes_.add(slot, documentIdOf(i), metadata_[slot]);
+    slots_.insert(slot, ids_);
+    added[n] = slot;
+  }
+  live_count_.fetch_add(added.size(), std::memory_order_relaxed);
+
+  if (quantizer_ || pq_ || binary_quantizer_) {
+    reserveCodes();
+    forEachRowRange(added.size(), scanWorkerCount(added.size()),
+                    [&](size_t begin, size_t end, size_t) {
+                      for (size_t n = begin; n < end; ++n) {
+                        if (quantizer_) {
+                          encodeSlot(added[n]);
+                        }
+                        if (pq_) {
+                          encodePqSlot(added[n]);
+                        }
+                        if (binary_quantizer_) {
+                          encodeBinarySlot(added[n]);
+                        }
+                      }
+                    });
+  }
+  if (ivf_) {
+    std::vector<float> buffer = rowBuffer();
+    for (uint32_t slot : added) {
+      ivf_->add(slot, embeddings_.load(slot, buffer.data()));
+    }
+  }
+  lock.unlock();
+
+  if (hnsw_) {
+    hnsw_->reserve(hnsw_->size() + added.size());
+    insertIntoHnsw(*hnsw_, added);
+  }
+  bumpVersion();
+  writeLock.unlock();
+
+  waitForLog(lsn);
+  return added.size();
+}
+
 bool VectorStore::updateVector(const std::string &id,
                                const std::vector<float> &embedding,
                                const std::string &document_id,
                                const std::string &metadata) {
+  ScopedTimer timer(metrics_.latency(StoreOperation::Update));
+
   // Check if the embedding has the correct dimension
-  if (!embedding.empty() && (embedding.size() != dimension_)) {
-    throw std::invalid_argument(
-        "Embedding dimension (" + std::to_string(embedding.size()) +
-        ") doesn't match store dimension (" + std::to_string(dimension_) + ")");
+  if (!embedding.empty()) {
+    checkDimension(embedding.size());
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_lock<std::mutex> writeLock = lockWriter();
 
   // Check if the ID exists
-  auto it = vectors_.find(id);
-  if (it == vectors_.end()) {
+  const uint32_t slot = slots_.find(id, ids_);
+  if (slot == IdTable::kNotFound) {
     return false;
   }
 
+  const uint64_t lsn = logMutation(WriteAheadLog::Op::Update, id, embedding,
+                                   document_id, metadata);
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  preserveForCursors(slot);
+
   // Update the vector record
+  std::vector<float> buffer = rowBuffer();
   if (!embedding.empty()) {
-    it->second->embedding = embedding;
+    // The graph node being replaced reads this row; it keeps routing by
+    // the old vector once the new one is written in place
+    if (hnsw_) {
+      hnsw_->retainVector(slot);
+    }
+    storeRow(slot, embedding.data());
+    if (quantizer_) {
+      encodeSlot(slot);
+    }
+    if (pq_) {
+      encodePqSlot(slot);
+    }
+    if (binary_quantizer_) {
+      encodeBinarySlot(slot);
+    }
+    if (ivf_) {
+      ivf_->add(slot, embeddings_.load(slot, buffer.data()));
+    }
   }
-  if (!document_id.empty()) {
-    it->second->document_id = document_id;
+  if (!document_id.empty() || !metadata.empty()) {
+    attributes_.remove(slot, documents_.get(document_codes_[slot]),
+                       metadata_[slot]);
+    if (!document_id.empty()) {
+      // Interned before the release, so an unchanged id keeps its string
+      const uint32_t code = documents_.intern(document_id);
+      documents_.release(document_codes_[slot]);
+      document_codes_[slot] = code;
+    }
+    if (!metadata.empty()) {
+      metadata_[slot] = metadata;
+    }
+    attributes_.add(slot, documents_.get(document_codes_[slot]),
+                    metadata_[slot]);
   }
-  if (!metadata.empty()) {
-    it->second->metadata = metadata;
+  lock.unlock();
+
+  if (hnsw_ && !embedding.empty()) {
+    hnsw_->add(slot, embeddings_.load(slot, buffer.data()));
   }
+  bumpVersion();
+  writeLock.unlock();
 
+  waitForLog(lsn);
   return true;
 }
 
 std::shared_ptr<VectorStore::VectorRecord>
 VectorStore::getVector(const std::string &id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  ScopedTimer timer(metrics_.latency(StoreOperation::Get));
+
+  std::shared_lock<std::shared_mutex> lock = lockShared();
 
-  auto it = vectors_.find(id);
-  if (it == vectors_.end()) {
+  const uint32_t slot = slots_.find(id, ids_);
+  if (slot == IdTable::kNotFound) {
     return nullptr;
   }
 
-  return it->second;
+  return makeRecord(slot);
 }
 
 bool VectorStore::deleteVector(const std::string &id) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  ScopedTimer timer(metrics_.latency(StoreOperation::Delete));
+
+  std::unique_lock<std::mutex> writeLock = lockWriter();
 
-  auto it = vectors_.find(id);
-  if (it == vectors_.end()) {
+  const uint32_t slot = slots_.find(id, ids_);
+  if (slot == IdTable::kNotFound) {
     return false;
   }
 
-  vectors_.erase(it);
+  const uint64_t lsn = logMutation(WriteAheadLog::Op::Delete, id, {},
+                                   std::string(), std::string());
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  preserveForCursors(slot);
+
+  // Drop the side-table strings now; the row goes back on the free list
+  attributes_.remove(slot, documents_.get(document_codes_[slot]),
+                     metadata_[slot]);
+  slots_.erase(slot, ids_);
+  ids_[slot].clear();
+  documents_.release(document_codes_[slot]);
+  document_codes_[slot] = StringDictionary::kEmpty;
+  metadata_[slot].clear();
+  occupied_[slot] = 0;
+  embeddings_.releaseRow(slot);
+
+  if (hnsw_) {
+    hnsw_->remove(slot);
+  }
+  if (ivf_) {
+    ivf_->remove(slot);
+  }
+
+  live_count_.fetch_sub(1, std::memory_order_relaxed);
+
+  lock.unlock();
+  bumpVersion();
+  writeLock.unlock();
+  waitForLog(lsn);
   return true;
 }
 
-std::vector<std::shared_ptr<VectorStore::VectorRecord>>
-VectorStore::getAllVectors() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+std::vector<VectorStore::SearchResult>
+VectorStore::search(const std::vector<float> &query, size_t k,
+                    Metric metric) const {
+  checkDimension(query.size());
+  return search(query.data(), k, metric);
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::search(const float *query, size_t k, Metric metric) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::Search));
+
+  return cachedSearch(
+      StoreOperation::Search, static_cast<int>(metric), k, 0, query, nullptr,
+      [&]() -> std::vector<SearchResult> {
+        std::vector<float> buffer;
+        const float *prepared = prepareQueries(query, 1, metric, buffer);
+
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+
+        const size_t rows = embeddings_.rowCount();
+        k = std::min(k, slots_.size());
+        if (k == 0) {
+          return {};
+        }
+
+        // Each worker keeps its own bounded heap over a contiguous block of
+        // rows; the heaps are merged once all workers are done.
+        const size_t workers = scanWorkerCount(rows);
+        std::vector<TopK> heaps(workers, TopK(k));
+        forEachRowRange(rows, workers,
+                        [&](size_t begin, size_t end, size_t worker) {
+                          scanRange(prepared, metric, begin, end,
+                                    heaps[worker]);
+                        });
+        metrics_.recordDistances(slots_.size());
+        for (size_t t = 1; t < workers; ++t) {
+          heaps[0].merge(heaps[t]);
+        }
+
+        return toResults(heaps[0].takeSorted(), metric);
+      });
+}
+
+std::vector<std::vector<VectorStore::SearchResult>>
+VectorStore::searchBatch(const float *queries, size_t numQueries, size_t k,
+                         Metric metric) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SearchBatch));
+
+  if (numQueries == 0) {
+    return {};
+  }
+  std::vector<float> buffer;
+  queries = prepareQueries(queries, numQueries, metric, buffer);
+
+  // Query norms are needed by the L2 and cosine rewrites of the dot product
+  std::vector<float> queryNorms(numQueries, 0.0f);
+  if (metric != Metric::DotProduct) {
+    for (size_t q = 0; q < numQueries; ++q) {
+      const float *query = queries + q * dimension_;
+      queryNorms[q] = VectorOps::dotProduct(query, query, dimension_);
+      if (metric == Metric::Cosine) {
+        queryNorms[q] = std::sqrt(queryNorms[q]);
+      }
+    }
+  }
+
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+
+  const size_t rows = embeddings_.rowCount();
+  k = std::min(k, slots_.size());
+  std::vector<std::vector<SearchResult>> results(numQueries);
+  if (k == 0) {
+    return results;
+  }
+
+  const size_t workers = scanWorkerCount(rows);
+  std::vector<std::vector<TopK>> heaps(workers,
+                                       std::vector<TopK>(numQueries, TopK(k)));
+  forEachRowRange(rows, workers,
+                  [&](size_t begin, size_t end, size_t worker) {
+                    scanBatchRange(queries, numQueries, queryNorms, metric,
+                                   begin, end, heaps[worker]);
+                  });
+
+  for (size_t q = 0; q < numQueries; ++q) {
+    for (size_t t = 1; t < workers; ++t) {
+      heaps[0][q].merge(heaps[t][q]);
+    }
+    results[q] = toResults(heaps[0][q].takeSorted(), metric);
+    metrics_.recordDistances(slots_.size());
+  }
+  return results;
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::search(const std::vector<float> &query, size_t k, Metric metric,
+                    const Filter &filter) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::Search));
 
-  std::vector<std::shared_ptr<VectorRecord>> result;
-  result.reserve(vectors_.size());
+  checkDimension(query.size());
 
-  for (const auto &pair : vectors_) {
-    result.emplace_back(pair.second);
+  return cachedSearch(
+      StoreOperation::Search, static_cast<int>(metric), k, 0, query.data(),
+      &filter,
+      [&]() -> std::vector<SearchResult> {
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+        return scanMatches(query, k, metric, attributes_.evaluate(filter));
+      });
+}
+
+size_t VectorStore::count(const Filter &filter) const {
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  return attributes_.evaluate(filter).cardinality();
+}
+
+void VectorStore::enableHnswIndex(const HnswParams &params) {
+  // Built under the write lock only: readers keep going and see the index
+  // once it is published
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+
+  HnswParams sized = params;
+  sized.initialCapacity = std::max(params.initialCapacity, slots_.size());
+  auto index =
+      std::make_unique<HnswIndex>(dimension_, sized, &arena_source_);
+  std::vector<uint32_t> live;
+  live.reserve(slots_.size());
+  for (size_t slot = 0; slot < embeddings_.rowCount(); ++slot) {
+    if (occupied_[slot]) {
+      live.push_back(static_cast<uint32_t>(slot));
+    }
+  }
+  insertIntoHnsw(*index, live);
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  hnsw_ = std::move(index);
+  bumpVersion();
+}
+
+bool VectorStore::hasHnswIndex() const {
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  return hnsw_ != nullptr;
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::searchHnsw(const std::vector<float> &query, size_t k,
+                        size_t efSearch) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SearchHnsw));
+
+  checkDimension(query.size());
+
+  return cachedSearch(
+      StoreOperation::SearchHnsw, -1, k, efSearch, query.data(), nullptr,
+      [&]() -> std::vector<SearchResult> {
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+
+        if (!hnsw_) {
+          throw std::logic_error("HNSW index is not enabled");
+        }
+
+        SearchStats stats;
+        std::vector<Neighbor> neighbors =
+            hnsw_->search(query.data(), k, efSearch, LabelFilter(), &stats);
+        metrics_.recordSearch(stats);
+        return toResults(std::move(neighbors), hnsw_->getParams().metric);
+      });
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::searchHnsw(const std::vector<float> &query, size_t k,
+                        const Filter &filter, size_t efSearch) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SearchHnsw));
+
+  checkDimension(query.size());
+
+  return cachedSearch(
+      StoreOperation::SearchHnsw, -1, k, efSearch, query.data(), &filter,
+      [&]() -> std::vector<SearchResult> {
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+
+        if (!hnsw_) {
+          throw std::logic_error("HNSW index is not enabled");
+        }
+
+        const Metric metric = hnsw_->getParams().metric;
+        Bitmap matches = attributes_.evaluate(filter);
+        if (preferFilteredScan(matches.cardinality())) {
+          return scanMatches(query, k, metric, matches);
+        }
+        SearchStats stats;
+        std::vector<Neighbor> neighbors = hnsw_->search(
+            query.data(), k, efSearch,
+            [&matches](uint32_t label) { return matches.contains(label); },
+            &stats);
+        metrics_.recordSearch(stats);
+        return toResults(std::move(neighbors), metric);
+      });
+}
+
+void VectorStore::buildIvfIndex(const IvfParams &params) {
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+
+  if (slots_.size() < params.numLists) {
+    throw std::logic_error("IVF training needs at least " +
+                           std::to_string(params.numLists) +
+                           " stored vectors");
+  }
+
+  IvfParams trainParams = params;
+  trainParams.kmeans.pool = threadPool();
+  auto index = std::make_unique<IvfIndex>(dimension_, trainParams);
+  size_t sampleSize = 0;
+  std::vector<float> sample =
+      sampleLiveRows(params.trainingSampleSize, sampleSize);
+  index->train(sample.data(), sampleSize, dimension_);
+  std::vector<float> buffer = rowBuffer();
+  for (size_t slot = 0; slot < embeddings_.rowCount(); ++slot) {
+    if (occupied_[slot]) {
+      index->add(static_cast<uint32_t>(slot),
+                 embeddings_.load(static_cast<uint32_t>(slot), buffer.data()));
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  ivf_ = std::move(index);
+  bumpVersion();
+}
+
+bool VectorStore::hasIvfIndex() const {
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  return ivf_ != nullptr;
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::searchIvf(const std::vector<float> &query, size_t k,
+                       size_t nprobe) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SearchIvf));
+
+  checkDimension(query.size());
+
+  return cachedSearch(
+      StoreOperation::SearchIvf, -1, k, nprobe, query.data(), nullptr,
+      [&]() -> std::vector<SearchResult> {
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+
+        if (!ivf_) {
+          throw std::logic_error("IVF index is not built");
+        }
+
+        SearchStats stats;
+        std::vector<Neighbor> neighbors =
+            ivf_->search(query.data(), k, nprobe, LabelFilter(), &stats);
+        metrics_.recordSearch(stats);
+        return toResults(std::move(neighbors), ivf_->getParams().metric);
+      });
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::searchIvf(const std::vector<float> &query, size_t k,
+                       const Filter &filter, size_t nprobe) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SearchIvf));
+
+  checkDimension(query.size());
+
+  return cachedSearch(
+      StoreOperation::SearchIvf, -1, k, nprobe, query.data(), &filter,
+      [&]() -> std::vector<SearchResult> {
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+
+        if (!ivf_) {
+          throw std::logic_error("IVF index is not built");
+        }
+
+        const Metric metric = ivf_->getParams().metric;
+        Bitmap matches = attributes_.evaluate(filter);
+        if (preferFilteredScan(matches.cardinality())) {
+          return scanMatches(query, k, metric, matches);
+        }
+        SearchStats stats;
+        std::vector<Neighbor> neighbors = ivf_->search(
+            query.data(), k, nprobe,
+            [&matches](uint32_t label) { return matches.contains(label); },
+            &stats);
+        metrics_.recordSearch(stats);
+        return toResults(std::move(neighbors), metric);
+      });
+}
+
+void VectorStore::enableScalarQuantization(size_t trainingSampleSize) {
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+
+  if (slots_.empty()) {
+    throw std::logic_error("Cannot train a quantizer on an empty store");
+  }
+
+  size_t sampleSize = 0;
+  std::vector<float> sample = sampleLiveRows(trainingSampleSize, sampleSize);
+
+  auto quantizer = std::make_unique<ScalarQuantizer>(dimension_);
+  quantizer->train(sample.data(), sampleSize, dimension_);
+
+  // Encoded under the write lock only; readers see the codes once published
+  const size_t rows = embeddings_.rowCount();
+  const size_t capacity = embeddings_.capacity();
+  std::vector<int8_t> codes(capacity * dimension_);
+  std::vector<ScalarQuantizer::RowFactors> factors(capacity);
+  std::vector<float> norms(capacity);
+  forEachRowRange(rows, scanWorkerCount(rows), [&](size_t begin, size_t end,
+                                                   size_t) {
+    std::vector<float> buffer = rowBuffer();
+    for (size_t slot = begin; slot < end; ++slot) {
+      if (occupied_[slot]) {
+        const float *row = embeddings_.load(slot, buffer.data());
+        factors[slot] =
+            quantizer->encode(row, codes.data() + slot * dimension_);
+        norms[slot] = std::sqrt(VectorOps::dotProduct(row, row, dimension_));
+      }
+    }
+  });
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  quantizer_ = std::move(quantizer);
+  quantized_codes_ = std::move(codes);
+  quantized_factors_ = std::move(factors);
+  quantized_norms_ = std::move(norms);
+  bumpVersion();
+}
+
+bool VectorStore::hasScalarQuantization() const {
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  return quantizer_ != nullptr;
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::searchQuantized(const std::vector<float> &query, size_t k,
+                             Metric metric, size_t rescoreFactor) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SearchQuantized));
+
+  checkDimension(query.size());
+
+  return cachedSearch(
+      StoreOperation::SearchQuantized, static_cast<int>(metric), k,
+      rescoreFactor, query.data(), nullptr,
+      [&]() -> std::vector<SearchResult> {
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+
+        if (!quantizer_) {
+          throw std::logic_error("Scalar quantization is not enabled");
+        }
+
+        k = std::min(k, slots_.size());
+        if (k == 0) {
+          return {};
+        }
+
+        // Stage 1: approximate scan over the int8 codes
+        const size_t shortlist =
+            std::min(slots_.size(), k * std::max<size_t>(rescoreFactor, 1));
+        const ScalarQuantizer::Query prepared =
+            quantizer_->prepareQuery(query.data());
+        const size_t rows = embeddings_.rowCount();
+        const size_t workers = scanWorkerCount(rows);
+        std::vector<TopK> heaps(workers, TopK(shortlist));
+        forEachRowRange(rows, workers,
+                        [&](size_t begin, size_t end, size_t worker) {
+                          scanQuantizedRange(prepared, metric, begin, end,
+                                             heaps[worker]);
+                        });
+        for (size_t t = 1; t < workers; ++t) {
+          heaps[0].merge(heaps[t]);
+        }
+
+        // Stage 2: exact rescoring of the shortlist
+        metrics_.recordDistances(slots_.size() + shortlist);
+        return rescore(query.data(), metric, heaps[0].takeSorted(), k);
+      });
+}
+
+void VectorStore::enablePqIndex(const PqParams &params) {
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+
+  if (slots_.size() < ProductQuantizer::kCodebookSize) {
+    throw std::logic_error("PQ training needs at least " +
+                           std::to_string(ProductQuantizer::kCodebookSize) +
+                           " stored vectors");
   }
 
-  return result;
+  PqParams trainParams = params;
+  trainParams.kmeans.pool = threadPool();
+  auto pq = std::make_unique<ProductQuantizer>(dimension_, trainParams);
+  size_t sampleSize = 0;
+  std::vector<float> sample =
+      sampleLiveRows(params.trainingSampleSize, sampleSize);
+  pq->train(sample.data(), sampleSize, dimension_);
+
+  // Encoding costs numSubspaces x 256 sub-distances per row, so like
+  // enableHnswIndex it runs under the write lock only and readers keep going
+  // until the codes are published
+  const size_t codeSize = pq->codeSize();
+  const size_t rows = embeddings_.rowCount();
+  std::vector<uint8_t> codes(embeddings_.capacity() * codeSize);
+  forEachRowRange(rows, scanWorkerCount(rows), [&](size_t begin, size_t end,
+                                                   size_t) {
+    std::vector<float> buffer = rowBuffer();
+    for (size_t slot = begin; slot < end; ++slot) {
+      if (occupied_[slot]) {
+        pq->encode(embeddings_.load(slot, buffer.data()),
+                   codes.data() + slot * codeSize);
+      }
+    }
+  });
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  pq_ = std::move(pq);
+  pq_codes_ = std::move(codes);
+  bumpVersion();
+}
+
+bool VectorStore::hasPqIndex() const {
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  return pq_ != nullptr;
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::searchPq(const std::vector<float> &query, size_t k,
+                      size_t rerankFactor) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SearchPq));
+
+  checkDimension(query.size());
+
+  return cachedSearch(
+      StoreOperation::SearchPq, -1, k, rerankFactor, query.data(), nullptr,
+      [&]() -> std::vector<SearchResult> {
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+
+        if (!pq_) {
+          throw std::logic_error("PQ index is not enabled");
+        }
+
+        k = std::min(k, slots_.size());
+        if (k == 0) {
+          return {};
+        }
+
+        const Metric metric = pq_->getParams().metric;
+        const size_t codeSize = pq_->codeSize();
+        std::vector<float> table(codeSize * ProductQuantizer::kCodebookSize);
+        pq_->computeDistanceTable(query.data(), table.data());
+
+        const size_t candidates =
+            rerankFactor == 0 ? k : std::min(slots_.size(), k * rerankFactor);
+        const size_t rows = embeddings_.rowCount();
+        const size_t workers = scanWorkerCount(rows);
+        std::vector<TopK> heaps(workers, TopK(candidates));
+        forEachRowRange(rows, workers,
+                        [&](size_t begin, size_t end, size_t worker) {
+                          const uint8_t *codes = pq_codes_.data();
+                          for (size_t slot = begin; slot < end; ++slot) {
+                            if (occupied_[slot]) {
+                              heaps[worker].push(
+                                  pq_->adcDistance(table.data(),
+                                                   codes + slot * codeSize),
+                                  static_cast<uint32_t>(slot));
+                            }
+                          }
+                        });
+        for (size_t t = 1; t < workers; ++t) {
+          heaps[0].merge(heaps[t]);
+        }
+
+        metrics_.recordDistances(slots_.size() +
+                                 (rerankFactor == 0 ? 0 : candidates));
+        if (rerankFactor == 0) {
+          return toResults(heaps[0].takeSorted(), metric);
+        }
+        return rescore(query.data(), metric, heaps[0].takeSorted(), k);
+      });
+}
+
+void VectorStore::enableBinaryQuantization(size_t trainingSampleSize) {
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+
+  if (slots_.empty()) {
+    throw std::logic_error("Cannot train a quantizer on an empty store");
+  }
+
+  size_t sampleSize = 0;
+  std::vector<float> sample = sampleLiveRows(trainingSampleSize, sampleSize);
+
+  auto quantizer = std::make_unique<BinaryQuantizer>(dimension_);
+  quantizer->train(sample.data(), sampleSize, dimension_);
+
+  // Encoded under the write lock only; readers see the codes once published
+  const size_t codeWords = quantizer->codeWords();
+  const size_t rows = embeddings_.rowCount();
+  std::vector<uint64_t> codes(embeddings_.capacity() * codeWords);
+  forEachRowRange(rows, scanWorkerCount(rows), [&](size_t begin, size_t end,
+                                                   size_t) {
+    std::vector<float> buffer = rowBuffer();
+    for (size_t slot = begin; slot < end; ++slot) {
+      if (occupied_[slot]) {
+        quantizer->encode(embeddings_.load(slot, buffer.data()),
+                          codes.data() + slot * codeWords);
+      }
+    }
+  });
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  binary_quantizer_ = std::move(quantizer);
+  binary_codes_ = std::move(codes);
+  bumpVersion();
+}
+
+bool VectorStore::hasBinaryQuantization() const {
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  return binary_quantizer_ != nullptr;
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::searchBinary(const std::vector<float> &query, size_t k,
+                          Metric metric, size_t rescoreFactor) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SearchBinary));
+
+  checkDimension(query.size());
+
+  return cachedSearch(
+      StoreOperation::SearchBinary, static_cast<int>(metric), k,
+      rescoreFactor, query.data(), nullptr,
+      [&]() -> std::vector<SearchResult> {
+        std::shared_lock<std::shared_mutex> lock = lockShared();
+
+        if (!binary_quantizer_) {
+          throw std::logic_error("Binary quantization is not enabled");
+        }
+
+        k = std::min(k, slots_.size());
+        if (k == 0) {
+          return {};
+        }
+
+        // Stage 1: Hamming scan over the binary codes
+        const size_t shortlist =
+            std::min(slots_.size(), k * std::max<size_t>(rescoreFactor, 1));
+        std::vector<uint64_t> code(binary_quantizer_->codeWords());
+        binary_quantizer_->encode(query.data(), code.data());
+        const size_t rows = embeddings_.rowCount();
+        const size_t workers = scanWorkerCount(rows);
+        std::vector<TopK> heaps(workers, TopK(shortlist));
+        forEachRowRange(rows, workers,
+                        [&](size_t begin, size_t end, size_t worker) {
+                          scanBinaryRange(code.data(), begin, end,
+                                          heaps[worker]);
+                        });
+        for (size_t t = 1; t < workers; ++t) {
+          heaps[0].merge(heaps[t]);
+        }
+
+        // Stage 2: exact rescoring of the shortlist
+        metrics_.recordDistances(slots_.size() + shortlist);
+        return rescore(query.data(), metric, heaps[0].takeSorted(), k);
+      });
 }
 
 size_t VectorStore::size() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return vectors_.size();
+  return live_count_.load(std::memory_order_relaxed);
 }
 
 size_t VectorStore::getDimension() const { return dimension_; }
 
+std::optional<Metric> VectorStore::getMetric() const { return metric_; }
+
+ElementType VectorStore::getElementType() const {
+  return embeddings_.elementType();
+}
+
+StoreMetricsSnapshot VectorStore::getMetrics() const {
+  StoreMetricsSnapshot snapshot = metrics_.snapshot();
+  snapshot.vectors = size();
+  snapshot.queryCache = getQueryCacheStats();
+  return snapshot;
+}
+
+std::string VectorStore::getMetricsText() const {
+  return getMetrics().toPrometheus();
+}
+
+void VectorStore::resetMetrics() { metrics_.reset(); }
+
+void VectorStore::enableQueryCache(const QueryCacheOptions &options) {
+  std::atomic_store(&query_cache_, std::make_shared<QueryCache>(options));
+}
+
+void VectorStore::disableQueryCache() {
+  std::atomic_store(&query_cache_, std::shared_ptr<QueryCache>());
+}
+
+QueryCacheStats VectorStore::getQueryCacheStats() const {
+  std::shared_ptr<QueryCache> cache = std::atomic_load(&query_cache_);
+  return cache ? cache->stats() : QueryCacheStats();
+}
+
 void VectorStore::clear() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  vectors_.clear();
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+  const uint64_t lsn = logMutation(WriteAheadLog::Op::Clear, std::string(), {},
+                                   std::string(), std::string());
+
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  detachCursors();
+  slots_.clear();
+  live_count_.store(0, std::memory_order_relaxed);
+  ids_.clear();
+  document_codes_.clear();
+  documents_.clear();
+  metadata_.clear();
+  occupied_.clear();
+  norms_.clear();
+  attributes_.clear();
+  embeddings_.clear();
+  quantized_codes_.clear();
+  quantized_factors_.clear();
+  quantized_norms_.clear();
+  pq_codes_.clear();
+  binary_codes_.clear();
+  if (hnsw_) {
+    hnsw_->clear();
+  }
+  if (ivf_) {
+    ivf_->clear();
+  }
+
+  lock.unlock();
+  bumpVersion();
+  // Every entry is stale now; free them rather than wait for eviction
+  if (std::shared_ptr<QueryCache> cache = std::atomic_load(&query_cache_)) {
+    cache->clear();
+  }
+  writeLock.unlock();
+  waitForLog(lsn);
+}
+
+double VectorStore::deletedFraction() const {
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  double fraction = 0.0;
+  deletedCount(fraction);
+  return fraction;
+}
+
+size_t VectorStore::deletedCount(double &fraction) const {
+  const size_t rows = embeddings_.rowCount();
+  size_t dead = rows - slots_.size();
+  fraction = rows == 0 ? 0.0 : static_cast<double>(dead) / rows;
+  if (hnsw_) {
+    const size_t retired = hnsw_->deletedCount();
+    const size_t nodes = retired + hnsw_->size();
+    if (nodes > 0) {
+      fraction = std::max(fraction, static_cast<double>(retired) / nodes);
+    }
+    dead = std::max(dead, retired);
+  }
+  return dead;
+}
+
+void VectorStore::compact() {
+  ScopedTimer timer(metrics_.latency(StoreOperation::Compact));
+
+  // Writers are held off for the duration; the new tables are built from
+  // the current ones while readers keep using them
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+
+  const size_t rows = embeddings_.rowCount();
+  std::vector<uint32_t> slotMap(rows, 0);
+  std::vector<uint32_t> live;
+  live.reserve(slots_.size());
+  for (size_t slot = 0; slot < rows; ++slot) {
+    if (occupied_[slot]) {
+      slotMap[slot] = static_cast<uint32_t>(live.size());
+      live.push_back(static_cast<uint32_t>(slot));
+    }
+  }
+  const size_t count = live.size();
+
+  EmbeddingArena embeddings(dimension_, embeddings_.elementType());
+  embeddings.reserve(count);
+  std::vector<std::string> ids(count);
+  std::vector<uint32_t> documentCodes(count);
+  StringDictionary documents;
+  std::vector<std::string> metadata(count);
+  std::vector<uint8_t> occupied(count, 1);
+  std::vector<float> norms(norms_.empty() ? 0 : count);
+  IdTable slots;
+  slots.reserve(count);
+  AttributeIndex attributes;
+
+  const size_t codeSize = pq_ ? pq_->codeSize() : 0;
+  std::vector<int8_t> quantizedCodes(quantizer_ ? count * dimension_ : 0);
+  std::vector<ScalarQuantizer::RowFactors> quantizedFactors(
+      quantizer_ ? count : 0);
+  std::vector<float> quantizedNorms(quantizer_ ? count : 0);
+  std::vector<uint8_t> pqCodes(count * codeSize);
+  const size_t codeWords =
+      binary_quantizer_ ? binary_quantizer_->codeWords() : 0;
+  std::vector<uint64_t> binaryCodes(count * codeWords);
+
+  for (uint32_t slot = 0; slot < count; ++slot) {
+    const uint32_t old = live[slot];
+    embeddings.allocateRow();
+    ids[slot] = ids_[old];
+    // A fresh dictionary, so the old tables keep theirs intact for cursors
+    // that still read them
+    const std::string &documentId = documents_.get(document_codes_[old]);
+    documentCodes[slot] = documents.intern(documentId);
+    metadata[slot] = metadata_[old];
+    slots.insert(slot, ids);
+    attributes.add(slot, documentId, metadata[slot]);
+  }
+
+  // Rows and codes are plain copies into distinct slots, so they are moved
+  // in parallel
+  forEachRowRange(count, scanWorkerCount(count), [&](size_t begin, size_t end,
+                                                     size_t) {
+    for (size_t slot = begin; slot < end; ++slot) {
+      const uint32_t old = live[slot];
+      std::memcpy(embeddings.rowData(static_cast<uint32_t>(slot)),
+                  embeddings_.rowData(old), embeddings_.rowBytes());
+      if (!norms.empty()) {
+        norms[slot] = norms_[old];
+      }
+      if (quantizer_) {
+        std::copy(quantized_codes_.begin() + old * dimension_,
+                  quantized_codes_.begin() + (old + 1) * dimension_,
+                  quantizedCodes.begin() + slot * dimension_);
+        quantizedFactors[slot] = quantized_factors_[old];
+        quantizedNorms[slot] = quantized_norms_[old];
+      }
+      if (pq_) {
+        std::copy(pq_codes_.begin() + old * codeSize,
+                  pq_codes_.begin() + (old + 1) * codeSize,
+                  pqCodes.begin() + slot * codeSize);
+      }
+      if (binary_quantizer_) {
+        std::copy(binary_codes_.begin() + old * codeWords,
+                  binary_codes_.begin() + (old + 1) * codeWords,
+                  binaryCodes.begin() + slot * codeWords);
+      }
+    }
+  });
+
+  std::unique_ptr<HnswIndex> hnsw = hnsw_ ? hnsw_->compacted(slotMap) : nullptr;
+  std::unique_ptr<IvfIndex> ivf = ivf_ ? ivf_->relabeled(slotMap) : nullptr;
+
+  // Publish; the old tables are freed after the lock is released, or by the
+  // last open cursor still reading them
+  std::unique_lock<std::shared_mutex> lock = lockExclusive();
+  detachCursors();
+  embeddings_.swap(embeddings);
+  ids_.swap(ids);
+  document_codes_.swap(documentCodes);
+  std::swap(documents_, documents);
+  metadata_.swap(metadata);
+  occupied_.swap(occupied);
+  norms_.swap(norms);
+  slots_.swap(slots);
+  std::swap(attributes_, attributes);
+  quantized_codes_.swap(quantizedCodes);
+  quantized_factors_.swap(quantizedFactors);
+  quantized_norms_.swap(quantizedNorms);
+  pq_codes_.swap(pqCodes);
+  binary_codes_.swap(binaryCodes);
+  hnsw_.swap(hnsw);
+  ivf_.swap(ivf);
+  lock.unlock();
+  bumpVersion();
+}
+
+void VectorStore::enableBackgroundCompaction(
+    const CompactionOptions &options) {
+  std::lock_guard<std::mutex> guard(compactor_mutex_);
+  compaction_options_ = options;
+  if (!compactor_.joinable()) {
+    compactor_stop_ = false;
+    compactor_ = std::thread(&VectorStore::runCompactor, this);
+  }
+}
+
+void VectorStore::disableBackgroundCompaction() {
+  {
+    std::lock_guard<std::mutex> guard(compactor_mutex_);
+    if (!compactor_.joinable()) {
+      return;
+    }
+    compactor_stop_ = true;
+  }
+  compactor_wakeup_.notify_one();
+  compactor_.join();
+}
+
+void VectorStore::runCompactor() {
+  std::unique_lock<std::mutex> guard(compactor_mutex_);
+  while (!compactor_stop_) {
+    const CompactionOptions options = compaction_options_;
+    guard.unlock();
+
+    double fraction = 0.0;
+    size_t dead = 0;
+    {
+      std::shared_lock<std::shared_mutex> lock = lockShared();
+      dead = deletedCount(fraction);
+      // Compacting now would leave the open cursors holding the old tables
+      // alongside the new ones; wait for them to close instead
+      std::lock_guard<std::mutex> cursorsGuard(cursors_mutex_);
+      if (!cursors_.empty()) {
+        dead = 0;
+      }
+    }
+    if (dead > 0 && dead >= options.minDeleted &&
+        fraction >= options.deletedFraction) {
+      try {
+        compact();
+      } catch (const std::exception &) {
+        // Out of memory or similar: the store is untouched; retry later
+      }
+    }
+
+    guard.lock();
+    compactor_wakeup_.wait_for(guard, options.interval,
+                               [this] { return compactor_stop_; });
+  }
+}
+
+void VectorStore::enableWriteAheadLog(const std::string &path,
+                                      const WalOptions &options) {
+  if (hasWriteAheadLog()) {
+    throw std::logic_error("Write-ahead log is already enabled");
+  }
+
+  // Replay through the public mutators before the log is attached, so the
+  // replayed records are not logged a second time. An add may find its id
+  // already present when the snapshot was taken after it was logged.
+  auto log = std::make_unique<WriteAheadLog>(
+      path, options, [this](const WriteAheadLog::Record &record) {
+        switch (record.op) {
+        case WriteAheadLog::Op::Add:
+          if (!addVector(record.id, record.embedding, record.document_id,
+                         record.metadata)) {
+            updateVector(record.id, record.embedding, record.document_id,
+                         record.metadata);
+          }
+          break;
+        case WriteAheadLog::Op::Update:
+          updateVector(record.id, record.embedding, record.document_id,
+                       record.metadata);
+          break;
+        case WriteAheadLog::Op::Delete:
+          deleteVector(record.id);
+          break;
+        case WriteAheadLog::Op::Clear:
+          clear();
+          break;
+        }
+      });
+
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+  wal_ = std::move(log);
+}
+
+bool VectorStore::hasWriteAheadLog() const {
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+  return wal_ != nullptr;
+}
+
+std::shared_ptr<VectorStore::VectorRecord>
+VectorStore::makeRecord(uint32_t slot) const {
+  auto record = std::make_shared<VectorRecord>();
+  fillRecord(slot, CursorOptions(), *record);
+  return record;
+}
+
+void VectorStore::scanRange(const float *query, Metric metric, size_t begin,
+                            size_t end, TopK &topK) const {
+  if (metric == Metric::Euclidean && metric_ == Metric::Euclidean) {
+    // ||q - x||^2 = ||q||^2 + ||x||^2 - 2 q.x with ||x||^2 cached
+    const float queryNorm = VectorOps::dotProduct(query, query, dimension_);
+    for (size_t slot = begin; slot < end; ++slot) {
+      if (!occupied_[slot]) {
+        continue;
+      }
+      float dot = embeddings_.dot(query, static_cast<uint32_t>(slot));
+      topK.push(std::max(0.0f, queryNorm + norms_[slot] - 2.0f * dot),
+                static_cast<uint32_t>(slot));
+    }
+    return;
+  }
+
+  std::vector<float> buffer = rowBuffer();
+  for (size_t slot = begin; slot < end; ++slot) {
+    if (!occupied_[slot]) {
+      continue;
+    }
+    const uint32_t row = static_cast<uint32_t>(slot);
+    // Dot products read half-precision rows directly; other metrics work on
+    // the widened row
+    float distance =
+        metric == Metric::DotProduct
+            ? -embeddings_.dot(query, row)
+            : VectorOps::distance(metric, query,
+                                  embeddings_.load(row, buffer.data()),
+                                  dimension_);
+    topK.push(distance, row);
+  }
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::scanMatches(const std::vector<float> &query, size_t k,
+                         Metric metric, const Bitmap &matches) const {
+  std::vector<float> buffer;
+  const float *q = prepareQueries(query.data(), 1, metric, buffer);
+  const std::vector<uint32_t> slots = matches.toVector();
+  k = std::min(k, slots.size());
+  if (k == 0) {
+    return {};
+  }
+
+  const bool cachedNorms =
+      metric == Metric::Euclidean && metric_ == Metric::Euclidean;
+  const float queryNorm =
+      cachedNorms ? VectorOps::dotProduct(q, q, dimension_) : 0.0f;
+
+  const size_t workers = scanWorkerCount(slots.size());
+  std::vector<TopK> heaps(workers, TopK(k));
+  forEachRowRange(
+      slots.size(), workers, [&](size_t begin, size_t end, size_t worker) {
+        std::vector<float> buffer = rowBuffer();
+        for (size_t n = begin; n < end; ++n) {
+          float distance;
+          if (cachedNorms) {
+            distance = std::max(0.0f, queryNorm + norms_[slots[n]] -
+                                          2.0f * embeddings_.dot(q, slots[n]));
+          } else if (metric == Metric::DotProduct) {
+            distance = -embeddings_.dot(q, slots[n]);
+          } else {
+            distance = VectorOps::distance(
+                metric, q, embeddings_.load(slots[n], buffer.data()),
+                dimension_);
+          }
+          heaps[worker].push(distance, slots[n]);
+        }
+      });
+  for (size_t t = 1; t < workers; ++t) {
+    heaps[0].merge(heaps[t]);
+  }
+  metrics_.recordDistances(slots.size());
+  return toResults(heaps[0].takeSorted(), metric);
+}
+
+bool VectorStore::preferFilteredScan(size_t matches) const {
+  return matches <= kMinFilteredScanRows ||
+         static_cast<double>(matches) <=
+             kFilteredScanFraction * static_cast<double>(slots_.size());
+}
+
+std::vector<float> VectorStore::sampleLiveRows(size_t sampleSize,
+                                               size_t &count) const {
+  std::vector<uint32_t> live;
+  live.reserve(slots_.size());
+  for (size_t slot = 0; slot < embeddings_.rowCount(); ++slot) {
+    if (occupied_[slot]) {
+      live.push_back(static_cast<uint32_t>(slot));
+    }
+  }
+
+  count = sampleSize == 0 ? live.size() : std::min(sampleSize, live.size());
+  std::vector<float> sample(count * dimension_);
+  std::vector<float> buffer = rowBuffer();
+  for (size_t i = 0; i < count; ++i) {
+    const float *row =
+        embeddings_.load(live[i * live.size() / count], buffer.data());
+    std::copy(row, row + dimension_, sample.begin() + i * dimension_);
+  }
+  return sample;
+}
+
+uint64_t VectorStore::logMutation(WriteAheadLog::Op op, const std::string &id,
+                                  const std::vector<float> &embedding,
+                                  const std::string &document_id,
+                                  const std::string &metadata) {
+  if (!wal_) {
+    return 0;
+  }
+
+  WriteAheadLog::Record record;
+  record.op = op;
+  record.id = id;
+  record.embedding = embedding;
+  record.document_id = document_id;
+  record.metadata = metadata;
+  return wal_->append(record);
+}
+
+std::unique_lock<std::mutex> VectorStore::lockWriter() const {
+  return metrics_.acquire<std::unique_lock<std::mutex>>(write_mutex_,
+                                                        StoreLock::Writer);
+}
+
+std::unique_lock<std::shared_mutex> VectorStore::lockExclusive() const {
+  return metrics_.acquire<std::unique_lock<std::shared_mutex>>(
+      mutex_, StoreLock::Exclusive);
+}
+
+std::shared_lock<std::shared_mutex> VectorStore::lockShared() const {
+  return metrics_.acquire<std::shared_lock<std::shared_mutex>>(
+      mutex_, StoreLock::Shared);
+}
+
+void VectorStore::bumpVersion() {
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+std::vector<VectorStore::SearchResult> VectorStore::cachedSearch(
+    StoreOperation operation, int metric, size_t k, size_t parameter,
+    const float *query, const Filter *filter,
+    const std::function<std::vector<SearchResult>()> &search) const {
+  std::shared_ptr<QueryCache> cache = std::atomic_load(&query_cache_);
+  if (!cache) {
+    return search();
+  }
+
+  // Read before searching, so an entry may reflect writes newer than its
+  // version but never older ones
+  const uint64_t version = version_.load(std::memory_order_acquire);
+  std::string key =
+      cache->makeKey(static_cast<uint32_t>(operation), metric, k, parameter,
+                     query, dimension_, filter);
+  std::vector<SearchResult> results;
+  if (cache->lookup(key, version, results)) {
+    return results;
+  }
+  results = search();
+  cache->insert(std::move(key), version, results);
+  return results;
+}
+
+void VectorStore::waitForLog(uint64_t lsn) const {
+  // wal_ is set once and never replaced, so it is safe to use unlocked here
+  if (lsn != 0) {
+    ScopedTimer timer(metrics_.latency(StoreOperation::WalSync));
+    wal_->waitDurable(lsn);
+  }
+}
+
+void VectorStore::insertIntoHnsw(HnswIndex &index,
+                                 const std::vector<uint32_t> &slots) const {
+  const size_t workers = std::max<size_t>(
+      1, std::min(kInsertChunksPerThread * threadPool()->concurrency(),
+                  slots.size() / kMinInsertsPerThread));
+  forEachRowRange(slots.size(), workers,
+                  [&](size_t begin, size_t end, size_t) {
+                    std::vector<float> buffer = rowBuffer();
+                    for (size_t n = begin; n < end; ++n) {
+                      index.add(slots[n],
+                                embeddings_.load(slots[n], buffer.data()));
+                    }
+                  });
+}
+
+void VectorStore::reserveCodes() {
+  const size_t rows = embeddings_.capacity();
+  if (quantizer_ && quantized_factors_.size() < rows) {
+    quantized_codes_.resize(rows * dimension_);
+    quantized_factors_.resize(rows);
+    quantized_norms_.resize(rows);
+  }
+  if (pq_ && pq_codes_.size() < rows * pq_->codeSize()) {
+    pq_codes_.resize(rows * pq_->codeSize());
+  }
+  if (binary_quantizer_ &&
+      binary_codes_.size() < rows * binary_quantizer_->codeWords()) {
+    binary_codes_.resize(rows * binary_quantizer_->codeWords());
+  }
+}
+
+void VectorStore::encodeSlot(uint32_t slot) {
+  if (quantized_factors_.size() <= slot) {
+    size_t rows = std::max<size_t>(slot + 1, embeddings_.capacity());
+    quantized_codes_.resize(rows * dimension_);
+    quantized_factors_.resize(rows);
+    quantized_norms_.resize(rows);
+  }
+
+  std::vector<float> buffer = rowBuffer();
+  const float *row = embeddings_.load(slot, buffer.data());
+  quantized_factors_[slot] = quantizer_->encode(
+      row, quantized_codes_.data() + static_cast<size_t>(slot) * dimension_);
+  quantized_norms_[slot] =
+      std::sqrt(VectorOps::dotProduct(row, row, dimension_));
+}
+
+void VectorStore::encodePqSlot(uint32_t slot) {
+  const size_t codeSize = pq_->codeSize();
+  if (pq_codes_.size() < (static_cast<size_t>(slot) + 1) * codeSize) {
+    size_t rows = std::max<size_t>(slot + 1, embeddings_.capacity());
+    pq_codes_.resize(rows * codeSize);
+  }
+  std::vector<float> buffer = rowBuffer();
+  pq_->encode(embeddings_.load(slot, buffer.data()),
+              pq_codes_.data() + slot * codeSize);
+}
+
+void VectorStore::encodeBinarySlot(uint32_t slot) {
+  const size_t codeWords = binary_quantizer_->codeWords();
+  if (binary_codes_.size() < (static_cast<size_t>(slot) + 1) * codeWords) {
+    size_t rows = std::max<size_t>(slot + 1, embeddings_.capacity());
+    binary_codes_.resize(rows * codeWords);
+  }
+  std::vector<float> buffer = rowBuffer();
+  binary_quantizer_->encode(embeddings_.load(slot, buffer.data()),
+                            binary_codes_.data() + slot * codeWords);
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::rescore(const float *query, Metric metric,
+                     std::vector<Neighbor> candidates, size_t k) const {
+  TopK topK(k);
+  std::vector<float> buffer = rowBuffer();
+  for (const Neighbor &candidate : candidates) {
+    topK.push(VectorOps::distance(
+                  metric, query,
+                  embeddings_.load(candidate.label, buffer.data()), dimension_),
+              candidate.label);
+  }
+  return toResults(topK.takeSorted(), metric);
+}
+
+void VectorStore::scanQuantizedRange(const ScalarQuantizer::Query &query,
+                                     Metric metric, size_t begin, size_t end,
+                                     TopK &topK) const {
+  for (size_t slot = begin; slot < end; ++slot) {
+    if (!occupied_[slot]) {
+      continue;
+    }
+    float distance = quantizer_->distance(
+        metric, query, quantized_codes_.data() + slot * dimension_,
+        quantized_factors_[slot], quantized_norms_[slot]);
+    topK.push(distance, static_cast<uint32_t>(slot));
+  }
+}
+
+void VectorStore::scanBinaryRange(const uint64_t *code, size_t begin,
+                                  size_t end, TopK &topK) const {
+  // Distances are computed a block of codes at a time so the popcount kernel
+  // streams through contiguous memory
+  constexpr size_t kBlockRows = 256;
+  const size_t codeWords = binary_quantizer_->codeWords();
+  uint32_t distances[kBlockRows];
+  for (size_t block = begin; block < end; block += kBlockRows) {
+    const size_t count = std::min(kBlockRows, end - block);
+    VectorOps::hammingDistances(code, binary_codes_.data() + block * codeWords,
+                                codeWords, count, distances);
+    for (size_t i = 0; i < count; ++i) {
+      if (occupied_[block + i]) {
+        topK.push(static_cast<float>(distances[i]),
+                  static_cast<uint32_t>(block + i));
+      }
+    }
+  }
+}
+
+void VectorStore::scanBatchRange(const float *queries, size_t numQueries,
+                                 const std::vector<float> &queryNorms,
+                                 Metric metric, size_t begin, size_t end,
+                                 std::vector<TopK> &heaps) const {
+  const size_t stride = embeddings_.stride();
+  const size_t blockRows =
+      std::max<size_t>(16, kBatchBlockBytes / (stride * sizeof(float)));
+  std::vector<float> scores(numQueries * blockRows);
+  std::vector<float> rowNorms(blockRows, 0.0f);
+  // Half-precision blocks are widened once and then reused by every query
+  const bool widen = embeddings_.elementType() != ElementType::Float32;
+  std::vector<float> widened(widen ? blockRows * stride : 0);
+
+  for (size_t blockBegin = begin; blockBegin < end; blockBegin += blockRows) {
+    const size_t numRows = std::min(blockRows, end - blockBegin);
+    const float *block;
+    if (widen) {
+      embeddings_.loadBlock(static_cast<uint32_t>(blockBegin), numRows,
+                            widened.data());
+      block = widened.data();
+    } else {
+      block = embeddings_.row(static_cast<uint32_t>(blockBegin));
+    }
+
+    VectorOps::dotProductBlock(queries, numQueries, dimension_, block, numRows,
+                               stride, dimension_, scores.data());
+
+    if (metric != Metric::DotProduct) {
+      for (size_t r = 0; r < numRows; ++r) {
+        const float *row = block + r * stride;
+        rowNorms[r] = metric_ == Metric::Euclidean
+                          ? norms_[blockBegin + r]
+                          : VectorOps::dotProduct(row, row, dimension_);
+        if (metric == Metric::Cosine) {
+          rowNorms[r] = std::sqrt(rowNorms[r]);
+        }
+      }
+    }
+
+    for (size_t q = 0; q < numQueries; ++q) {
+      const float *queryScores = scores.data() + q * numRows;
+      for (size_t r = 0; r < numRows; ++r) {
+        if (!occupied_[blockBegin + r]) {
+          continue;
+        }
+        float distance;
+        switch (metric) {
+        case Metric::DotProduct:
+          distance = -queryScores[r];
+          break;
+        case Metric::Euclidean:
+          // ||q - x||^2 = ||q||^2 + ||x||^2 - 2 q.x
+          distance = std::max(
+              0.0f, queryNorms[q] + rowNorms[r] - 2.0f * queryScores[r]);
+          break;
+        default: {
+          float denominator = queryNorms[q] * rowNorms[r];
+          distance =
+              denominator == 0.0f ? 0.0f : -queryScores[r] / denominator;
+          break;
+        }
+        }
+        heaps[q].push(distance, static_cast<uint32_t>(blockBegin + r));
+      }
+    }
+  }
+}
+
+size_t VectorStore::scanWorkerCount(size_t rows) const {
+  return std::max<size_t>(
+      1, std::min<size_t>(
+             threadPool()->concurrency(),
+             (rows + kMinRowsPerScanThread - 1) / kMinRowsPerScanThread));
+}
+
+void VectorStore::forEachRowRange(
+    size_t rows, size_t workers,
+    const std::function<void(size_t, size_t, size_t)> &fn) const {
+  if (workers <= 1) {
+    fn(0, rows, 0);
+    return;
+  }
+  threadPool()->parallelFor(rows, workers, fn);
+}
+
+void VectorStore::setThreadPool(std::shared_ptr<ThreadPool> pool) {
+  std::atomic_store(&pool_, pool ? std::move(pool) : ThreadPool::shared());
+}
+
+std::shared_ptr<ThreadPool> VectorStore::threadPool() const {
+  return std::atomic_load(&pool_);
+}
+
+std::vector<VectorStore::SearchResult>
+VectorStore::toResults(std::vector<Neighbor> neighbors, Metric metric) const {
+  std::vector<SearchResult> results;
+  results.reserve(neighbors.size());
+  for (const Neighbor &n : neighbors) {
+    results.push_back(
+        {ids_[n.label], VectorOps::distanceToScore(metric, n.distance)});
+  }
+  return results;
+}
+
+void VectorStore::storeRow(uint32_t slot, const float *embedding) {
+  const bool half = embeddings_.elementType() != ElementType::Float32;
+  if (half) {
+    // Writers are serialized, so one buffer serves every insert and update
+    store_scratch_.resize(dimension_);
+  }
+  if (metric_ == Metric::Cosine && half) {
+    // Normalize before rounding, so rows stay as close to unit length as the
+    // storage type allows
+    std::copy(embedding, embedding + dimension_, store_scratch_.begin());
+    VectorOps::normalize(store_scratch_.data(), dimension_);
+    embeddings_.store(slot, store_scratch_.data());
+    return;
+  }
+
+  embeddings_.store(slot, embedding);
+  if (metric_ == Metric::Cosine) {
+    VectorOps::normalize(embeddings_.row(slot), dimension_);
+  } else if (metric_ == Metric::Euclidean) {
+    if (norms_.size() <= slot) {
+      norms_.resize(std::max<size_t>(slot + 1, embeddings_.capacity()));
+    }
+    // The norm of the stored values, which is what searches score against
+    const float *row = embeddings_.load(slot, store_scratch_.data());
+    norms_[slot] = VectorOps::dotProduct(row, row, dimension_);
+  }
+}
+
+std::vector<float> VectorStore::rowBuffer() const {
+  return std::vector<float>(
+      embeddings_.elementType() == ElementType::Float32 ? 0 : dimension_);
+}
+
+const float *VectorStore::prepareQueries(const float *queries,
+                                         size_t numQueries, Metric &metric,
+                                         std::vector<float> &buffer) const {
+  if (metric != Metric::Cosine || metric_ != Metric::Cosine) {
+    return queries;
+  }
+  buffer.assign(queries, queries + numQueries * dimension_);
+  for (size_t q = 0; q < numQueries; ++q) {
+    VectorOps::normalize(buffer.data() + q * dimension_, dimension_);
+  }
+  metric = Metric::DotProduct;
+  return buffer.data();
+}
+
+void VectorStore::checkDimension(size_t dimension) const {
+  if (dimension != dimension_) {
+    throw std::invalid_argument(
+        "Embedding dimension (" + std::to_string(dimension) +
+        ") doesn't match store dimension (" + std::to_string(dimension_) + ")");
+  }
 }
 
-} // namespace vectorsearch
\ No newline at end of file
+} // namespace vectorsearch
@@ -1,15 +1,63 @@
 // src/engine/vector_store.h
 #pragma once
 
+#include "ann/binary_quantizer.h"
+#include "ann/hnsw_index.h"
+#include "ann/ivf_index.h"
+#include "ann/product_quantizer.h"
+#include "ann/scalar_quantizer.h"
+#include "ann/top_k.h"
+#include "ann/vector_ops.h"
+#include "attribute_index.h"
+#include "common/id_table.h"
+#include "common/string_dictionary.h"
+#include "common/thread_pool.h"
+#include "embedding_arena.h"
+#include "query_cache.h"
+#include "store_metrics.h"
+#include "storage/write_ahead_log.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace vectorsearch {
 
+struct CompactionOptions {
+  // Compact once deletedFraction() reaches this share...
+  double deletedFraction = 0.2;
+  // ...and at least this many rows or graph nodes are dead, so small stores
+  // are not rewritten for a handful of deletes.
+  size_t minDeleted = 1024;
+  // How often the background task checks.
+  std::chrono::milliseconds interval{1000};
+};
+
+struct CursorOptions {
+  // Records returned by each Cursor::next().
+  size_t pageSize = 1024;
+  // Fields to copy; the others are left empty, so an id-only export never
+  // touches the embeddings.
+  bool ids = true;
+  bool embeddings = true;
+  bool documentIds = true;
+  bool metadata = true;
+  // Memory the cursor may spend on copies of records that writers change or
+  // delete before it reads them. Past it the cursor expires and next()
+  // throws, rather than letting a stalled reader grow without bound.
+  size_t maxPreimageBytes = size_t(256) << 20;
+};
+
 class VectorStore {
 public:
   struct VectorRecord {
@@ -19,8 +67,26 @@ public:
     std::string metadata;
   };
 
+  using SearchResult = vectorsearch::SearchResult;
+
   explicit VectorStore(size_t dimension);
 
+  // A store created for one metric prepares rows for it at insert time.
+  // Cosine stores keep unit-length copies of every embedding (getVector()
+  // returns the normalized vector), so cosine search is a dot product.
+  // Euclidean stores cache squared norms, so exact search is scored as
+  // ||q||^2 + ||x||^2 - 2 q.x with the dot-product kernel. Searches with
+  // another metric still work, on the stored vectors.
+  VectorStore(size_t dimension, Metric metric);
+
+  // Stores rows as `elementType`, converting on insert. Half-precision
+  // storage halves the embedding memory and scan bandwidth; searches keep
+  // fp32 queries and accumulate in fp32 on the widened rows, and getVector()
+  // returns the rounded values. Cosine rows are normalized before rounding
+  // and Euclidean norms are cached from the rounded values.
+  VectorStore(size_t dimension, std::optional<Metric> metric,
+              ElementType elementType);
+
   ~VectorStore();
 
   bool addVector(const std::string &id, const std::vector<float> &embedding,
@@ -31,24 +97,543 @@ public:
                     const std::string &document_id = "",
                     const std::string &metadata = "");
 
+  // Adds `count` vectors stored row-major in `embeddings` (count x
+  // dimension) under ids[i], with document_ids[i] and metadata[i] when those
+  // are non-empty. Storage is reserved once for the whole batch and attached
+  // indexes are updated by several threads. Ids that already exist, or repeat
+  // within the batch, are skipped. Returns the number of vectors added;
+  // throws std::invalid_argument if an array has the wrong length.
+  size_t addVectors(const float *embeddings, size_t count,
+                    const std::vector<std::string> &ids,
+                    const std::vector<std::string> &document_ids = {},
+                    const std::vector<std::string> &metadata = {});
+
+  // Returns a copy of the stored record, or nullptr if the id is unknown.
+  // Later updates never show through a returned record.
   std::shared_ptr<VectorRecord> getVector(const std::string &id) const;
 
   bool deleteVector(const std::string &id);
 
+  // Copies every record out through a cursor, so writers are held off for
+  // one page at a time rather than for the whole copy. Large stores are
+  // better streamed with openCursor().
   std::vector<std::shared_ptr<VectorRecord>> getAllVectors() const;
 
+  class Cursor;
+
+  // Opens a cursor over the records stored now, returned page by page in
+  // slot order with the fields selected by `options`. Each page is read
+  // under a brief shared lock, and the cursor keeps a consistent view in
+  // between: later adds are never returned, and before a writer updates or
+  // deletes a record the cursor has not reached yet, the cursor keeps a copy
+  // of it as it was, up to options.maxPreimageBytes. clear() and compact()
+  // copy nothing: they hand the tables they replace to the open cursors,
+  // which keep reading them until the last one closes, so the memory of the
+  // old tables is held until then. Background compaction waits until no
+  // cursor is open. Throws std::invalid_argument if options.pageSize is 0.
+  std::unique_ptr<Cursor>
+  openCursor(const CursorOptions &options = CursorOptions()) const;
+
+  // Exact top-k search over every stored vector, best match first. `score`
+  // is the dot product, euclidean distance or cosine similarity depending on
+  // the metric. Large stores are scanned by several threads.
+  std::vector<SearchResult> search(const std::vector<float> &query, size_t k,
+                                   Metric metric = Metric::Cosine) const;
+
+  // Same as above for a query of dimension floats read in place, e.g. from a
+  // caller-owned buffer that must not be copied.
+  std::vector<SearchResult> search(const float *query, size_t k,
+                                   Metric metric = Metric::Cosine) const;
+
+  // Exact top-k search for a batch of queries stored row-major in `queries`
+  // (numQueries x dimension). Stored vectors are scored block by block against
+  // every query while the block is still in cache, so the store is streamed
+  // from memory once per batch rather than once per query. Returns one result
+  // list per query.
+  std::vector<std::vector<SearchResult>>
+  searchBatch(const float *queries, size_t numQueries, size_t k,
+              Metric metric = Metric::Cosine) const;
+
+  // Exact top-k among the vectors matching `filter` (see filter.h). The
+  // filter is resolved to a bitmap from the attribute index and only the
+  // matching rows are scored.
+  std::vector<SearchResult> search(const std::vector<float> &query, size_t k,
+                                   Metric metric, const Filter &filter) const;
+
+  // Number of vectors matching `filter`.
+  size_t count(const Filter &filter) const;
+
+  // Builds an HNSW index over the current contents. Later adds, updates and
+  // deletes are applied to the index as they happen. The graph scores
+  // candidates against the arena rows by slot, so it adds its links to the
+  // store's memory but not another fp32 copy of the embeddings; only nodes
+  // retired by a delete or update keep a copy, until compaction drops them.
+  void enableHnswIndex(const HnswParams &params = HnswParams());
+
+  bool hasHnswIndex() const;
+
+  // Approximate top-k search through the HNSW index, using the metric the
+  // index was built with. `efSearch` of 0 uses the index default. Throws
+  // std::logic_error if no index has been enabled.
+  std::vector<SearchResult> searchHnsw(const std::vector<float> &query,
+                                       size_t k, size_t efSearch = 0) const;
+
+  // Filtered HNSW search: non-matching vectors still route the graph walk
+  // but are never returned. Very selective filters are answered by an exact
+  // scan of the matches instead.
+  std::vector<SearchResult> searchHnsw(const std::vector<float> &query,
+                                       size_t k, const Filter &filter,
+                                       size_t efSearch = 0) const;
+
+  // Trains IVF centroids on a sample of the stored vectors and assigns every
+  // embedding to its list. Later adds, updates and deletes are applied to the
+  // index as they happen. Each list keeps its own contiguous fp32 copy of
+  // its rows (dimension * 4 bytes per vector, whatever the storage type),
+  // so a probe is a sequential scan rather than random arena reads. Throws
+  // std::logic_error if the store holds fewer vectors than params.numLists.
+  void buildIvfIndex(const IvfParams &params = IvfParams());
+
+  bool hasIvfIndex() const;
+
+  // Approximate top-k search scanning the `nprobe` lists closest to the
+  // query, using the metric the index was built with. `nprobe` of 0 uses the
+  // index default. Throws std::logic_error if no index has been built.
+  std::vector<SearchResult> searchIvf(const std::vector<float> &query,
+                                      size_t k, size_t nprobe = 0) const;
+
+  // Filtered IVF search: non-matching vectors are skipped while the probed
+  // lists are scanned. Very selective filters are answered by an exact scan
+  // of the matches instead.
+  std::vector<SearchResult> searchIvf(const std::vector<float> &query,
+                                      size_t k, const Filter &filter,
+                                      size_t nprobe = 0) const;
+
+  // Trains an int8 scalar quantizer on the stored vectors (or on an evenly
+  // spaced sample of `trainingSampleSize` of them) and keeps an encoded copy
+  // of every embedding, refreshed by later adds and updates. Throws
+  // std::logic_error if the store is empty.
+  void enableScalarQuantization(size_t trainingSampleSize = 0);
+
+  bool hasScalarQuantization() const;
+
+  // Two-stage search: scans the int8 codes for the k * rescoreFactor best
+  // candidates, then rescores that shortlist with the exact float vectors.
+  // Throws std::logic_error if quantization has not been enabled.
+  std::vector<SearchResult> searchQuantized(const std::vector<float> &query,
+                                            size_t k,
+                                            Metric metric = Metric::Cosine,
+                                            size_t rescoreFactor = 4) const;
+
+  // Trains a product quantizer on a sample of the stored vectors and keeps
+  // a numSubspaces-byte code for every embedding, refreshed by later adds and
+  // updates. Throws std::logic_error if the store holds fewer than 256
+  // vectors.
+  void enablePqIndex(const PqParams &params = PqParams());
+
+  bool hasPqIndex() const;
+
+  // Scans the PQ codes using per-query ADC lookup tables, ranking by the
+  // metric the quantizer was trained for. With rerankFactor > 0 the best
+  // k * rerankFactor candidates are rescored with the exact float vectors.
+  // Throws std::logic_error if no PQ index has been enabled.
+  std::vector<SearchResult> searchPq(const std::vector<float> &query, size_t k,
+                                     size_t rerankFactor = 0) const;
+
+  // Trains a sign-bit quantizer on the stored vectors (or on an evenly
+  // spaced sample of `trainingSampleSize` of them) and keeps a dimension/8
+  // byte binary code for every embedding, refreshed by later adds and
+  // updates. Throws std::logic_error if the store is empty.
+  void enableBinaryQuantization(size_t trainingSampleSize = 0);
+
+  bool hasBinaryQuantization() const;
+
+  // Two-stage search: a popcount Hamming scan over the binary codes picks
+  // the k * rescoreFactor closest candidates, which are then rescored with
+  // the exact float vectors. One bit per dimension ranks coarsely, so the
+  // factor needs to be larger than for searchQuantized, and codes carry no
+  // norms, so dot-product recall drops when row norms vary widely. Throws
+  // std::logic_error if binary quantization has not been enabled.
+  std::vector<SearchResult> searchBinary(const std::vector<float> &query,
+                                         size_t k,
+                                         Metric metric = Metric::Cosine,
+                                         size_t rescoreFactor = 16) const;
+
+  // Number of live vectors; lock-free.
   size_t size() const;
 
   size_t getDimension() const;
 
+  // The metric given at construction, if any.
+  std::optional<Metric> getMetric() const;
+
+  ElementType getElementType() const;
+
+  // Operation latencies, lock waits and per-query search work recorded
+  // since the store was created (or since resetMetrics()).
+  StoreMetricsSnapshot getMetrics() const;
+
+  // getMetrics() in the Prometheus text exposition format.
+  std::string getMetricsText() const;
+
+  void resetMetrics();
+
+  // Caches the results of single-query searches (search, searchHnsw,
+  // searchIvf, searchQuantized, searchPq, searchBinary and their filtered
+  // forms; not searchBatch) keyed on the quantized query, k, metric, search
+  // parameter and filter. Every add, update, delete, clear, index build and
+  // compaction bumps a store version that invalidates all earlier entries. A
+  // hit returns the results of the cached query, which may differ from the
+  // new query in the bits dropped by options.mantissaBits. Replaces any
+  // existing cache.
+  void enableQueryCache(const QueryCacheOptions &options = QueryCacheOptions());
+
+  void disableQueryCache();
+
+  // Zeroes while no cache is enabled.
+  QueryCacheStats getQueryCacheStats() const;
+
   void clear();
 
+  // Runs parallel scans, batch searches, index builds and compaction on
+  // `pool` instead of ThreadPool::shared(), which every store starts with;
+  // nullptr switches back to the shared pool.
+  void setThreadPool(std::shared_ptr<ThreadPool> pool);
+
+  std::shared_ptr<ThreadPool> threadPool() const;
+
+  // Writes a versioned binary snapshot of the store: the embedding matrix in
+  // its arena layout, the id/document_id/metadata tables and every enabled
+  // index and quantizer. The file is written beside `path` and renamed into
+  // place, so a crash never leaves a half-written snapshot under that name.
+  // Throws std::runtime_error on I/O failure.
+  void saveSnapshot(const std::string &path) const;
+
+  // Opens a snapshot written by saveSnapshot(). The embedding matrix is
+  // served straight from a private memory mapping of the file, so startup is
+  // bounded by page faults rather than parsing or copying; side tables and
+  // indexes are bulk-copied from their serialized arrays. With verifyChecksum
+  // the whole file is checksummed first. Throws std::runtime_error if the
+  // file is missing, truncated or corrupt.
+  static std::unique_ptr<VectorStore>
+  loadSnapshot(const std::string &path, bool verifyChecksum = true);
+
+  // Replays the records already in the log at `path` and then logs every
+  // later add, update, delete and clear before acknowledging it: mutators
+  // return only once their record is on disk, with concurrent writers
+  // sharing one fsync per group commit. To recover after a crash, load the
+  // last snapshot (or start empty) and enable the log again. Call before the
+  // store is shared between threads. Throws std::logic_error if a log is
+  // already enabled and std::runtime_error on I/O failure.
+  void enableWriteAheadLog(const std::string &path,
+                           const WalOptions &options = WalOptions());
+
+  bool hasWriteAheadLog() const;
+
+  // Saves a snapshot and empties the write-ahead log, whose records the
+  // snapshot now covers. Writers are blocked for the duration. Without a log
+  // this is saveSnapshot().
+  void checkpoint(const std::string &snapshotPath);
+
+  // Share of storage held by deleted vectors: the larger of the fraction of
+  // arena rows that are free and the fraction of HNSW nodes that are
+  // retired. Deletes and updates take effect in searches immediately, but
+  // their rows stay allocated (free rows are only refilled by later adds)
+  // and their graph nodes keep routing HNSW searches until compaction.
+  double deletedFraction() const;
+
+  // Rewrites the store densely: live rows are packed to the front of a new
+  // arena with their side tables and quantized codes, retired HNSW nodes are
+  // dropped with their neighbourhoods repaired, and IVF lists are relabelled.
+  // The new tables are built while readers keep searching the old ones and
+  // are swapped in under a brief exclusive lock; writers wait for the
+  // duration. Open cursors keep the old record tables alive until they
+  // close.
+  void compact();
+
+  // Starts a background thread that runs compact() whenever the deleted
+  // share passes the thresholds in `options` and no cursor is open. A
+  // running task picks up new options after its current interval.
+  void enableBackgroundCompaction(
+      const CompactionOptions &options = CompactionOptions());
+
+  // Stops the background task; returns once it has exited.
+  void disableBackgroundCompaction();
+
 private:
+  // Record tables replaced by clear() or compact(). They are never written
+  // again, and are freed when the last cursor reading them closes.
+  struct RecordTables {
+    RecordTables(size_t dimension, ElementType elementType)
+        : embeddings(dimension, elementType) {}
+
+    EmbeddingArena embeddings;
+    std::vector<std::string> ids;
+    std::vector<uint32_t> document_codes;
+    StringDictionary documents;
+    std::vector<std::string> metadata;
+    std::vector<uint8_t> occupied;
+  };
+
+  // What a cursor has left to read: slots [position, end), where rows
+  // changed or deleted since it opened are read from `preimages` and slots
+  // filled since then are `hidden`. Other rows come from the live tables,
+  // or from `detached` once clear() or compact() has replaced them. An
+  // expired cursor has dropped its preimages and reads nothing.
+  struct CursorState {
+    CursorOptions options;
+    size_t position = 0;
+    size_t end = 0;
+    std::unordered_map<uint32_t, VectorRecord> preimages;
+    size_t preimage_bytes = 0;
+    std::unordered_set<uint32_t> hidden;
+    std::shared_ptr<const RecordTables> detached;
+    bool expired = false;
+  };
+
+  // Serves arena rows to the HNSW index, whose labels are slots
+  class ArenaSource : public VectorSource {
+  public:
+    explicit ArenaSource(const VectorStore &store) : store_(store) {}
+
+    const float *load(uint32_t label, float *buffer) const override {
+      return store_.embeddings_.load(label, buffer);
+    }
+
+    bool unitLength() const override {
+      return store_.metric_ == Metric::Cosine;
+    }
+
+    void prefetch(uint32_t label) const override {
+      __builtin_prefetch(store_.embeddings_.rowData(label));
+    }
+
+  private:
+    const VectorStore &store_;
+  };
+
+  std::shared_ptr<VectorRecord> makeRecord(uint32_t slot) const;
+
+  // Copies the fields of `slot` selected by `options` into `record`,
+  // reusing its buffers; unselected fields are cleared.
+  void fillRecord(uint32_t slot, const CursorOptions &options,
+                  VectorRecord &record) const;
+
+  // Keep open cursors consistent; the caller holds mutex_ exclusively.
+  // preserveForCursors() runs before a live row is updated or deleted,
+  // hideFromCursors() after a row is allocated, and detachCursors() before
+  // clear() or compact() invalidates every slot: it moves the record tables
+  // into a RecordTables the cursors share, leaving the live ones empty.
+  void preserveForCursors(uint32_t slot);
+  void hideFromCursors(uint32_t slot);
+  void detachCursors();
+
+  void scanRange(const float *query, Metric metric, size_t begin, size_t end,
+                 TopK &topK) const;
+
+  // Exact top-k over the rows in `matches`; the caller holds mutex_.
+  std::vector<SearchResult> scanMatches(const std::vector<float> &query,
+                                        size_t k, Metric metric,
+                                        const Bitmap &matches) const;
+
+  // Whether a filtered index search should scan its matches instead.
+  bool preferFilteredScan(size_t matches) const;
+
+  // Copies an evenly spaced sample of live rows into a contiguous buffer;
+  // sampleSize of 0 takes every live row.
+  std::vector<float> sampleLiveRows(size_t sampleSize, size_t &count) const;
+
+  // Appends a mutation to the write-ahead log (if any) while the caller
+  // holds write_mutex_, so log order matches apply order; returns its
+  // sequence number, or 0 without a log. waitForLog() is called after unlocking.
+  uint64_t logMutation(WriteAheadLog::Op op, const std::string &id,
+                       const std::vector<float> &embedding,
+                       const std::string &document_id,
+                       const std::string &metadata);
+
+  void waitForLog(uint64_t lsn) const;
+
+  // Called by writers, still holding write_mutex_, once a change is visible
+  // to readers.
+  void bumpVersion();
+
+  // Serves a search from query_cache_ when enabled, else runs `search` and
+  // caches its results. `metric` is -1 for index searches.
+  std::vector<SearchResult>
+  cachedSearch(StoreOperation operation, int metric, size_t k,
+               size_t parameter, const float *query, const Filter *filter,
+               const std::function<std::vector<SearchResult>()> &search) const;
+
+  // Lock acquisition through metrics_, which records the wait.
+  std::unique_lock<std::mutex> lockWriter() const;
+  std::unique_lock<std::shared_mutex> lockExclusive() const;
+  std::shared_lock<std::shared_mutex> lockShared() const;
+
+  void writeSnapshot(const std::string &path) const;
+
+  // Dead rows or nodes, and the deleted share; the caller holds mutex_.
+  size_t deletedCount(double &fraction) const;
+
+  void runCompactor();
+
+  // Inserts `slots` into `index`, spread over several threads for large
+  // batches. The index synchronizes concurrent inserts itself.
+  void insertIntoHnsw(HnswIndex &index,
+                      const std::vector<uint32_t> &slots) const;
+
+  // Sizes the quantized code tables to the arena capacity, so encodeSlot()
+  // and encodePqSlot() can run concurrently for distinct slots.
+  void reserveCodes();
+
+  void encodeSlot(uint32_t slot);
+
+  void encodePqSlot(uint32_t slot);
+
+  void encodeBinarySlot(uint32_t slot);
+
+  std::vector<SearchResult> rescore(const float *query, Metric metric,
+                                    std::vector<Neighbor> candidates,
+                                    size_t k) const;
+
+  void scanQuantizedRange(const ScalarQuantizer::Query &query, Metric metric,
+                          size_t begin, size_t end, TopK &topK) const;
+
+  void scanBinaryRange(const uint64_t *code, size_t begin, size_t end,
+                       TopK &topK) const;
+
+  void scanBatchRange(const float *queries, size_t numQueries,
+                      const std::vector<float> &queryNorms, Metric metric,
+                      size_t begin, size_t end, std::vector<TopK> &heaps) const;
+
+  // Splits [0, rows) into `workers` contiguous ranges and runs
+  // fn(begin, end, range) for each on the thread pool; scanWorkerCount()
+  // only asks for more than one range when the store is large enough.
+  size_t scanWorkerCount(size_t rows) const;
+  void forEachRowRange(
+      size_t rows, size_t workers,
+      const std::function<void(size_t, size_t, size_t)> &fn) const;
+
+  std::vector<SearchResult> toResults(std::vector<Neighbor> neighbors,
+                                      Metric metric) const;
+
+  void checkDimension(size_t dimension) const;
+
+  // Writes an embedding to `slot` in the storage type, applying the store
+  // metric: normalizes it or caches its squared norm.
+  void storeRow(uint32_t slot, const float *embedding);
+
+  // Scratch for EmbeddingArena::load(); empty for Float32 stores, whose rows
+  // are read in place.
+  std::vector<float> rowBuffer() const;
+
+  // Returns the queries to scan with. Cosine queries against a cosine store
+  // are normalized into `buffer` and `metric` becomes DotProduct, which
+  // then yields the cosine similarity directly.
+  const float *prepareQueries(const float *queries, size_t numQueries,
+                              Metric &metric,
+                              std::vector<float> &buffer) const;
+
   size_t dimension_;
+  std::optional<Metric> metric_;
+
+  // Embeddings live in one aligned row-major matrix; everything else is kept
+  // in side tables indexed by the same slot. Slots are the internal ids:
+  // indexes, quantizer codes and search paths only see them, and string ids
+  // are resolved through slots_ at the API boundary.
+  EmbeddingArena embeddings_;
+  std::vector<std::string> ids_;
+  // Codes into documents_, which holds each distinct document id once
+  std::vector<uint32_t> document_codes_;
+  StringDictionary documents_;
+  std::vector<std::string> metadata_;
+  std::vector<uint8_t> occupied_;
+  // Squared row norms, kept only by Euclidean stores
+  std::vector<float> norms_;
+  // storeRow() scratch for half-precision stores; guarded by write_mutex_
+  std::vector<float> store_scratch_;
+
+  // ids_[slot] -> slot, keyed through ids_ itself
+  IdTable slots_;
+
+  // Document ids and parsed metadata attributes, for filtered search
+  AttributeIndex attributes_;
+
+  // HNSW reads its vectors through arena_source_; IVF keeps its own
+  ArenaSource arena_source_{*this};
+  std::unique_ptr<HnswIndex> hnsw_;
+  std::unique_ptr<IvfIndex> ivf_;
+
+  // Optional int8 copy of the arena: codes, plus per-slot scale and
+  // correction terms and exact norms used by ScalarQuantizer::distance
+  std::unique_ptr<ScalarQuantizer> quantizer_;
+  std::vector<int8_t> quantized_codes_;
+  std::vector<ScalarQuantizer::RowFactors> quantized_factors_;
+  std::vector<float> quantized_norms_;
+
+  // Optional product-quantized copy of the arena
+  std::unique_ptr<ProductQuantizer> pq_;
+  std::vector<uint8_t> pq_codes_;
+
+  // Optional sign-bit copy of the arena, codeWords() words per slot
+  std::unique_ptr<BinaryQuantizer> binary_quantizer_;
+  std::vector<uint64_t> binary_codes_;
+
+  std::unique_ptr<WriteAheadLog> wal_;
+
+  // Swapped with std::atomic_load/atomic_store
+  std::shared_ptr<ThreadPool> pool_ = ThreadPool::shared();
+
+  // Locking: writers (mutations, index builds, snapshots) are serialized by
+  // write_mutex_ and take mutex_ exclusively only while they change the
+  // tables, so slow work such as HNSW insertion or index training runs while
+  // readers hold mutex_ shared. Lock order is write_mutex_, then mutex_.
+  mutable std::mutex write_mutex_;
+  mutable std::shared_mutex mutex_;
+  std::atomic<size_t> live_count_{0};
+
+  // Open cursors. They register and deregister holding mutex_ shared and
+  // cursors_mutex_, so writers holding mutex_ exclusively walk the list
+  // without cursors_mutex_. Lock order is mutex_, then cursors_mutex_.
+  mutable std::mutex cursors_mutex_;
+  mutable std::vector<CursorState *> cursors_;
+
+  mutable StoreMetrics metrics_;
+
+  // Bumped by every change to the searchable contents; tags cache entries.
+  // The cache pointer is swapped with std::atomic_load/atomic_store.
+  std::atomic<uint64_t> version_{0};
+  std::shared_ptr<QueryCache> query_cache_;
+
+  // Background compaction; compactor_mutex_ guards the options and flag
+  std::thread compactor_;
+  std::mutex compactor_mutex_;
+  std::condition_variable compactor_wakeup_;
+  CompactionOptions compaction_options_;
+  bool compactor_stop_ = false;
+};
+
+// Pages through a store; see VectorStore::openCursor(). A cursor is not
+// thread-safe, and the store must outlive it.
+class VectorStore::Cursor {
+public:
+  ~Cursor();
+
+  Cursor(const Cursor &) = delete;
+  Cursor &operator=(const Cursor &) = delete;
+
+  // Replaces the contents of `page` with the next records, at most
+  // options.pageSize of them, reusing the buffers of the records already in
+  // it. Returns false once every record has been returned. Throws
+  // std::runtime_error if the cursor expired after passing
+  // options.maxPreimageBytes.
+  bool next(std::vector<VectorRecord> &page);
+
+private:
+  friend class VectorStore;
 
-  std::unordered_map<std::string, std::shared_ptr<VectorRecord>> vectors_;
+  Cursor(const VectorStore &store, const CursorOptions &options);
 
-  mutable std::mutex mutex_;
+  const VectorStore &store_;
+  CursorState state_;
 };
 
 } // namespace vectorsearch
\ No newline at end of file
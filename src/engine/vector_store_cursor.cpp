@@ -0,0 +1,216 @@
+// src/engine/vector_store_cursor.cpp
+// Paging cursors for VectorStore; see VectorStore::openCursor().
+#include "vector_store.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+using VectorRecord = vectorsearch::VectorStore::VectorRecord;
+
+// Copies the fields selected by `options` into `record`, reusing its
+// buffers; unselected fields are cleared
+void copyFields(const vectorsearch::EmbeddingArena &embeddings,
+                size_t dimension, uint32_t slot, const std::string &id,
+                const std::string &documentId, const std::string &metadata,
+                const vectorsearch::CursorOptions &options,
+                VectorRecord &record) {
+  if (options.ids) {
+    record.id = id;
+  } else {
+    record.id.clear();
+  }
+  if (options.embeddings) {
+    record.embedding.resize(dimension);
+    const float *row = embeddings.load(slot, record.embedding.data());
+    if (row != record.embedding.data()) {
+      std::copy(row, row + dimension, record.embedding.begin());
+    }
+  } else {
+    record.embedding.clear();
+  }
+  if (options.documentIds) {
+    record.document_id = documentId;
+  } else {
+    record.document_id.clear();
+  }
+  if (options.metadata) {
+    record.metadata = metadata;
+  } else {
+    record.metadata.clear();
+  }
+}
+
+// Heap held by a preimage, counted against CursorOptions::maxPreimageBytes
+size_t recordBytes(const VectorRecord &record) {
+  return sizeof(VectorRecord) + record.embedding.capacity() * sizeof(float) +
+         record.id.capacity() + record.document_id.capacity() +
+         record.metadata.capacity();
+}
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+std::unique_ptr<VectorStore::Cursor>
+VectorStore::openCursor(const CursorOptions &options) const {
+  if (options.pageSize == 0) {
+    throw std::invalid_argument("Cursor page size must be positive");
+  }
+  return std::unique_ptr<Cursor>(new Cursor(*this, options));
+}
+
+std::vector<std::shared_ptr<VectorStore::VectorRecord>>
+VectorStore::getAllVectors() const {
+  std::vector<std::shared_ptr<VectorRecord>> result;
+  result.reserve(size());
+
+  // The result holds every record anyway, so preimages are not capped
+  CursorOptions options;
+  options.maxPreimageBytes = std::numeric_limits<size_t>::max();
+  std::unique_ptr<Cursor> cursor = openCursor(options);
+  std::vector<VectorRecord> page;
+  while (cursor->next(page)) {
+    for (VectorRecord &record : page) {
+      result.push_back(std::make_shared<VectorRecord>(std::move(record)));
+    }
+  }
+  return result;
+}
+
+VectorStore::Cursor::Cursor(const VectorStore &store,
+                            const CursorOptions &options)
+    : store_(store) {
+  state_.options = options;
+
+  // Rows allocated after this point are never returned, so the cursor
+  // stops at the current row count
+  std::shared_lock<std::shared_mutex> lock = store_.lockShared();
+  state_.end = store_.embeddings_.rowCount();
+  std::lock_guard<std::mutex> guard(store_.cursors_mutex_);
+  store_.cursors_.push_back(&state_);
+}
+
+VectorStore::Cursor::~Cursor() {
+  std::shared_lock<std::shared_mutex> lock = store_.lockShared();
+  std::lock_guard<std::mutex> guard(store_.cursors_mutex_);
+  auto &cursors = store_.cursors_;
+  cursors.erase(std::find(cursors.begin(), cursors.end(), &state_));
+}
+
+bool VectorStore::Cursor::next(std::vector<VectorRecord> &page) {
+  size_t filled = 0;
+  auto nextRecord = [&]() -> VectorRecord & {
+    if (filled == page.size()) {
+      page.emplace_back();
+    }
+    return page[filled++];
+  };
+
+  std::shared_lock<std::shared_mutex> lock = store_.lockShared();
+  if (state_.expired) {
+    throw std::runtime_error(
+        "Cursor expired: records changed before it read them passed "
+        "maxPreimageBytes");
+  }
+  while (filled < state_.options.pageSize && state_.position < state_.end) {
+    const uint32_t slot = static_cast<uint32_t>(state_.position++);
+
+    auto preimage = state_.preimages.find(slot);
+    if (preimage != state_.preimages.end()) {
+      state_.preimage_bytes -= recordBytes(preimage->second);
+      nextRecord() = std::move(preimage->second);
+      state_.preimages.erase(preimage);
+      continue;
+    }
+    if (state_.hidden.erase(slot) > 0) {
+      continue;
+    }
+    // After clear() or compact() the live tables no longer line up with
+    // the slots this cursor opened on; the tables they replaced do
+    if (const RecordTables *tables = state_.detached.get()) {
+      if (slot < tables->occupied.size() && tables->occupied[slot]) {
+        copyFields(tables->embeddings, store_.dimension_, slot,
+                   tables->ids[slot],
+                   tables->documents.get(tables->document_codes[slot]),
+                   tables->metadata[slot], state_.options, nextRecord());
+      }
+      continue;
+    }
+    if (slot < store_.occupied_.size() && store_.occupied_[slot]) {
+      store_.fillRecord(slot, state_.options, nextRecord());
+    }
+  }
+  lock.unlock();
+
+  page.resize(filled);
+  return filled > 0;
+}
+
+void VectorStore::fillRecord(uint32_t slot, const CursorOptions &options,
+                             VectorRecord &record) const {
+  copyFields(embeddings_, dimension_, slot, ids_[slot],
+             documents_.get(document_codes_[slot]), metadata_[slot], options,
+             record);
+}
+
+void VectorStore::preserveForCursors(uint32_t slot) {
+  for (CursorState *cursor : cursors_) {
+    if (cursor->detached || cursor->expired || slot < cursor->position ||
+        slot >= cursor->end || cursor->hidden.count(slot) > 0) {
+      continue;
+    }
+    // Only the first change matters: the preimage is the row as it was
+    // when the cursor opened
+    auto [preimage, inserted] = cursor->preimages.try_emplace(slot);
+    if (!inserted) {
+      continue;
+    }
+    fillRecord(slot, cursor->options, preimage->second);
+    cursor->preimage_bytes += recordBytes(preimage->second);
+    if (cursor->preimage_bytes > cursor->options.maxPreimageBytes) {
+      // Too far behind the writers: give the memory back and fail the
+      // cursor's next read
+      std::unordered_map<uint32_t, VectorRecord>().swap(cursor->preimages);
+      std::unordered_set<uint32_t>().swap(cursor->hidden);
+      cursor->preimage_bytes = 0;
+      cursor->expired = true;
+    }
+  }
+}
+
+void VectorStore::hideFromCursors(uint32_t slot) {
+  for (CursorState *cursor : cursors_) {
+    // A slot with a preimage was live at open; the preimage is returned
+    // in place of whatever now fills it
+    if (!cursor->detached && !cursor->expired && slot >= cursor->position &&
+        slot < cursor->end && cursor->preimages.count(slot) == 0) {
+      cursor->hidden.insert(slot);
+    }
+  }
+}
+
+void VectorStore::detachCursors() {
+  // One set of tables serves every cursor, and only moving them costs
+  // anything under the lock
+  std::shared_ptr<RecordTables> tables;
+  for (CursorState *cursor : cursors_) {
+    if (cursor->detached || cursor->expired) {
+      continue;
+    }
+    if (!tables) {
+      tables = std::make_shared<RecordTables>(dimension_,
+                                              embeddings_.elementType());
+      tables->embeddings.swap(embeddings_);
+      tables->ids.swap(ids_);
+      tables->document_codes.swap(document_codes_);
+      std::swap(tables->documents, documents_);
+      tables->metadata.swap(metadata_);
+      tables->occupied.swap(occupied_);
+    }
+    cursor->detached = tables;
+  }
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,399 @@
+// src/engine/vector_store_snapshot.cpp
+// Snapshot save/load for VectorStore; see storage/snapshot_format.h for the
+// file layout.
+#include "common/binary_io.h"
+#include "common/crc32c.h"
+#include "storage/mapped_file.h"
+#include "storage/snapshot_format.h"
+#include "vector_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+using vectorsearch::BinaryReader;
+using vectorsearch::BinaryWriter;
+using vectorsearch::snapshot::SectionTag;
+using vectorsearch::snapshot::SectionType;
+
+void beginSection(BinaryWriter &out, SectionType type) {
+  out.align(vectorsearch::snapshot::kSectionAlignment);
+  out.write(SectionTag{static_cast<uint32_t>(type), 0});
+}
+
+// Writes the first `count` elements of a per-slot table. Tables may be
+// shorter than the row count when trailing slots were never encoded; the
+// loader pads them back out.
+template <typename T>
+void writePrefix(BinaryWriter &out, const std::vector<T> &values,
+                 size_t count) {
+  out.writeArray(values.data(), std::min(count, values.size()));
+}
+
+template <typename T>
+std::vector<T> readPrefix(BinaryReader &in, size_t count) {
+  std::vector<T> values = in.readArray<T>();
+  if (values.size() > count) {
+    BinaryReader::fail("per-slot table is longer than the row count");
+  }
+  values.resize(count);
+  return values;
+}
+
+// fsync on macOS stops at the drive cache; F_FULLFSYNC flushes through it.
+int fullSync(int fd) {
+#ifdef __APPLE__
+  return ::fcntl(fd, F_FULLFSYNC);
+#else
+  return ::fsync(fd);
+#endif
+}
+
+void syncFile(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0 || fullSync(fd) != 0) {
+    int error = errno;
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    throw std::runtime_error("Cannot sync " + path + ": " +
+                             std::strerror(error));
+  }
+  ::close(fd);
+}
+
+// Makes a rename into `path` durable: the new directory entry only survives
+// a power loss once the parent directory itself has been synced.
+void syncParentDirectory(const std::string &path) {
+  const size_t slash = path.find_last_of('/');
+  std::string directory = ".";
+  if (slash != std::string::npos) {
+    directory = slash == 0 ? "/" : path.substr(0, slash);
+  }
+  int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0 || fullSync(fd) != 0) {
+    int error = errno;
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    throw std::runtime_error("Cannot sync directory " + directory + ": " +
+                             std::strerror(error));
+  }
+  ::close(fd);
+}
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+void VectorStore::saveSnapshot(const std::string &path) const {
+  ScopedTimer timer(metrics_.latency(StoreOperation::SaveSnapshot));
+
+  // Writers are paused for the duration; readers carry on
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  writeSnapshot(path);
+}
+
+void VectorStore::checkpoint(const std::string &snapshotPath) {
+  ScopedTimer timer(metrics_.latency(StoreOperation::Checkpoint));
+  std::unique_lock<std::mutex> writeLock = lockWriter();
+  std::shared_lock<std::shared_mutex> lock = lockShared();
+  writeSnapshot(snapshotPath);
+  if (wal_) {
+    wal_->reset();
+  }
+}
+
+void VectorStore::writeSnapshot(const std::string &path) const {
+  const std::string tempPath = path + ".tmp";
+  std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Cannot create " + tempPath);
+  }
+
+  const size_t rows = embeddings_.rowCount();
+  snapshot::Header header{};
+  std::memcpy(header.magic, snapshot::kMagic, sizeof(header.magic));
+  header.version = snapshot::kVersion;
+  header.dimension = dimension_;
+  header.rowCount = rows;
+  header.liveCount = slots_.size();
+  header.metric = metric_ ? static_cast<uint32_t>(*metric_) + 1 : 0;
+  header.elementType = static_cast<uint32_t>(embeddings_.elementType());
+
+  // Placeholder; the checksum and size are only known at the end. The header
+  // is 64 bytes, so offsets in the body keep their 64-byte alignment in the
+  // file.
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  BinaryWriter out(file);
+
+  beginSection(out, SectionType::Embeddings);
+  out.write<uint64_t>(rows);
+  out.write<uint64_t>(embeddings_.stride());
+  out.align(EmbeddingArena::kAlignment);
+  out.writeBytes(embeddings_.data(), rows * embeddings_.rowBytes());
+
+  beginSection(out, SectionType::Records);
+  out.writeArray(occupied_.data(), rows);
+  out.writeStrings(ids_.data(), rows);
+  out.writeStrings(documents_.strings().data(), documents_.strings().size());
+  out.writeArray(document_codes_.data(), rows);
+  out.writeStrings(metadata_.data(), rows);
+
+  if (metric_ == Metric::Euclidean) {
+    beginSection(out, SectionType::Norms);
+    writePrefix(out, norms_, rows);
+  }
+  if (quantizer_) {
+    beginSection(out, SectionType::ScalarQuantizer);
+    quantizer_->save(out);
+    writePrefix(out, quantized_codes_, rows * dimension_);
+    writePrefix(out, quantized_factors_, rows);
+    writePrefix(out, quantized_norms_, rows);
+  }
+  if (pq_) {
+    beginSection(out, SectionType::ProductQuantizer);
+    pq_->save(out);
+    writePrefix(out, pq_codes_, rows * pq_->codeSize());
+  }
+  if (binary_quantizer_) {
+    beginSection(out, SectionType::BinaryQuantizer);
+    binary_quantizer_->save(out);
+    writePrefix(out, binary_codes_, rows * binary_quantizer_->codeWords());
+  }
+  if (hnsw_) {
+    beginSection(out, SectionType::Hnsw);
+    hnsw_->save(out);
+  }
+  if (ivf_) {
+    beginSection(out, SectionType::Ivf);
+    ivf_->save(out);
+  }
+  beginSection(out, SectionType::End);
+
+  header.checksum = out.checksum();
+  header.fileSize = sizeof(header) + out.offset();
+  file.seekp(0);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.close();
+  if (!file) {
+    throw std::runtime_error("Failed to write " + tempPath);
+  }
+
+  syncFile(tempPath);
+  if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("Cannot rename " + tempPath + " to " + path +
+                             ": " + std::strerror(errno));
+  }
+  // checkpoint() truncates the log next, so the rename must be on disk first
+  syncParentDirectory(path);
+}
+
+std::unique_ptr<VectorStore>
+VectorStore::loadSnapshot(const std::string &path, bool verifyChecksum) {
+  auto start = std::chrono::steady_clock::now();
+  std::shared_ptr<MappedFile> file = MappedFile::open(path);
+
+  snapshot::Header header;
+  if (file->size() < sizeof(header)) {
+    throw std::runtime_error("Snapshot " + path + " is truncated");
+  }
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (std::memcmp(header.magic, snapshot::kMagic, sizeof(header.magic)) != 0) {
+    throw std::runtime_error(path + " is not a vector store snapshot");
+  }
+  if (header.version != snapshot::kVersion) {
+    throw std::runtime_error("Unsupported snapshot version " +
+                             std::to_string(header.version) + " in " + path);
+  }
+  if (header.fileSize != file->size()) {
+    throw std::runtime_error("Snapshot " + path + " is truncated (" +
+                             std::to_string(file->size()) + " of " +
+                             std::to_string(header.fileSize) + " bytes)");
+  }
+
+  const uint8_t *body = file->data() + sizeof(header);
+  const size_t bodySize = file->size() - sizeof(header);
+  if (verifyChecksum && crc32c(body, bodySize) != header.checksum) {
+    throw std::runtime_error("Snapshot " + path + " failed its checksum");
+  }
+  if (header.dimension == 0) {
+    BinaryReader::fail("zero dimension");
+  }
+  if (header.metric > static_cast<uint32_t>(Metric::Cosine) + 1) {
+    BinaryReader::fail("unknown metric " + std::to_string(header.metric));
+  }
+  if (header.elementType > static_cast<uint32_t>(ElementType::BFloat16)) {
+    BinaryReader::fail("unknown element type " +
+                       std::to_string(header.elementType));
+  }
+
+  auto store = std::make_unique<VectorStore>(
+      header.dimension,
+      header.metric == 0
+          ? std::nullopt
+          : std::optional<Metric>(static_cast<Metric>(header.metric - 1)),
+      static_cast<ElementType>(header.elementType));
+  const size_t dimension = store->dimension_;
+  const size_t rows = header.rowCount;
+  const uint8_t *embeddings = nullptr;
+  bool hasRecords = false;
+  std::vector<std::string> documentStrings;
+  bool hasNorms = false;
+
+  BinaryReader in(body, bodySize);
+  for (bool done = false; !done;) {
+    in.align(snapshot::kSectionAlignment);
+    SectionTag tag = in.read<SectionTag>();
+    switch (static_cast<SectionType>(tag.type)) {
+    case SectionType::End:
+      done = true;
+      break;
+
+    case SectionType::Embeddings: {
+      uint64_t sectionRows = in.read<uint64_t>();
+      uint64_t stride = in.read<uint64_t>();
+      if (sectionRows != rows || stride != store->embeddings_.stride()) {
+        BinaryReader::fail("embedding matrix does not match the header");
+      }
+      in.align(EmbeddingArena::kAlignment);
+      const size_t rowBytes = store->embeddings_.rowBytes();
+      if (rows > in.remaining() / rowBytes) {
+        BinaryReader::fail("embedding matrix runs past the end of the file");
+      }
+      embeddings = in.readBytes(rows * rowBytes);
+      break;
+    }
+
+    case SectionType::Records:
+      store->occupied_ = in.readArray<uint8_t>();
+      store->ids_ = in.readStrings();
+      documentStrings = in.readStrings();
+      store->document_codes_ = in.readArray<uint32_t>();
+      store->metadata_ = in.readStrings();
+      if (store->occupied_.size() != rows || store->ids_.size() != rows ||
+          store->document_codes_.size() != rows ||
+          store->metadata_.size() != rows) {
+        BinaryReader::fail("record tables do not match the row count");
+      }
+      hasRecords = true;
+      break;
+
+    case SectionType::Norms:
+      store->norms_ = readPrefix<float>(in, rows);
+      hasNorms = true;
+      break;
+
+    case SectionType::ScalarQuantizer:
+      store->quantizer_ = ScalarQuantizer::load(in);
+      if (store->quantizer_->getDimension() != dimension) {
+        BinaryReader::fail("scalar quantizer dimension mismatch");
+      }
+      store->quantized_codes_ = readPrefix<int8_t>(in, rows * dimension);
+      store->quantized_factors_ =
+          readPrefix<ScalarQuantizer::RowFactors>(in, rows);
+      store->quantized_norms_ = readPrefix<float>(in, rows);
+      break;
+
+    case SectionType::ProductQuantizer:
+      store->pq_ = ProductQuantizer::load(in);
+      if (store->pq_->getDimension() != dimension) {
+        BinaryReader::fail("product quantizer dimension mismatch");
+      }
+      store->pq_codes_ = readPrefix<uint8_t>(in, rows * store->pq_->codeSize());
+      break;
+
+    case SectionType::BinaryQuantizer:
+      store->binary_quantizer_ = BinaryQuantizer::load(in);
+      if (store->binary_quantizer_->getDimension() != dimension) {
+        BinaryReader::fail("binary quantizer dimension mismatch");
+      }
+      store->binary_codes_ = readPrefix<uint64_t>(
+          in, rows * store->binary_quantizer_->codeWords());
+      break;
+
+    case SectionType::Hnsw:
+      store->hnsw_ = HnswIndex::load(in, &store->arena_source_);
+      if (store->hnsw_->getDimension() != dimension) {
+        BinaryReader::fail("HNSW dimension mismatch");
+      }
+      break;
+
+    case SectionType::Ivf:
+      store->ivf_ = IvfIndex::load(in);
+      if (store->ivf_->getDimension() != dimension) {
+        BinaryReader::fail("IVF dimension mismatch");
+      }
+      break;
+
+    default:
+      BinaryReader::fail("unknown section type " + std::to_string(tag.type));
+    }
+  }
+  if (!embeddings || !hasRecords) {
+    BinaryReader::fail("missing embedding or record section");
+  }
+  if (hasNorms != (store->metric_ == Metric::Euclidean)) {
+    BinaryReader::fail("norm section does not match the store metric");
+  }
+
+  // Restore the document dictionary; freed rows hold no reference
+  for (size_t slot = 0; slot < rows; ++slot) {
+    if (!store->occupied_[slot]) {
+      store->document_codes_[slot] = StringDictionary::kEmpty;
+    }
+  }
+  try {
+    store->documents_.restore(std::move(documentStrings),
+                              store->document_codes_);
+  } catch (const std::invalid_argument &error) {
+    BinaryReader::fail(error.what());
+  }
+
+  // Rebuild the id map, the attribute index and the free list; released
+  // slots are pushed highest first so the lowest is reused first
+  std::vector<uint32_t> freeSlots;
+  store->slots_.reserve(header.liveCount);
+  for (size_t slot = rows; slot-- > 0;) {
+    if (!store->occupied_[slot]) {
+      freeSlots.push_back(static_cast<uint32_t>(slot));
+      continue;
+    }
+    if (store->slots_.find(store->ids_[slot], store->ids_) !=
+        IdTable::kNotFound) {
+      BinaryReader::fail("duplicate id " + store->ids_[slot]);
+    }
+    store->slots_.insert(static_cast<uint32_t>(slot), store->ids_);
+    store->attributes_.add(
+        static_cast<uint32_t>(slot),
+        store->documents_.get(store->document_codes_[slot]),
+        store->metadata_[slot]);
+  }
+  if (store->slots_.size() != header.liveCount) {
+    BinaryReader::fail("live vector count does not match the header");
+  }
+  store->live_count_.store(header.liveCount, std::memory_order_relaxed);
+
+  if (rows > 0) {
+    // The mapping is private and writable, so later updates copy the
+    // touched pages instead of modifying the file
+    store->embeddings_.adopt(file, const_cast<uint8_t *>(embeddings), rows,
+                             std::move(freeSlots));
+  }
+  store->metrics_.latency(StoreOperation::LoadSnapshot)
+      .record(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count()));
+  return store;
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,53 @@
+// src/storage/mapped_file.cpp
+#include "mapped_file.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace vectorsearch {
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open " + path + ": " +
+                             std::strerror(errno));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::runtime_error("Cannot stat " + path + ": " +
+                             std::strerror(error));
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  if (size == 0) {
+    ::close(fd);
+    throw std::runtime_error("Cannot map empty file " + path);
+  }
+
+  // A private mapping of a read-only descriptor may still be written: dirty
+  // pages become anonymous copies
+  void *data =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  int error = errno;
+  // The mapping keeps the file referenced after the descriptor is closed
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Cannot map " + path + ": " +
+                             std::strerror(error));
+  }
+
+  return std::shared_ptr<MappedFile>(
+      new MappedFile(static_cast<uint8_t *>(data), size));
+}
+
+MappedFile::MappedFile(uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+MappedFile::~MappedFile() { ::munmap(data_, size_); }
+
+} // namespace vectorsearch
@@ -0,0 +1,36 @@
+// src/storage/mapped_file.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace vectorsearch {
+
+// Read/write, copy-on-write (MAP_PRIVATE) mapping of a whole file. The
+// process may modify the mapped pages freely; changes are never written back
+// to the file. Shared ownership lets loaded structures keep the mapping alive
+// for as long as they point into it.
+class MappedFile {
+public:
+  // Throws std::runtime_error if the file cannot be opened or mapped.
+  static std::shared_ptr<MappedFile> open(const std::string &path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  uint8_t *data() const { return data_; }
+
+  size_t size() const { return size_; }
+
+private:
+  MappedFile(uint8_t *data, size_t size);
+
+  uint8_t *data_;
+  size_t size_;
+};
+
+} // namespace vectorsearch
@@ -0,0 +1,61 @@
+// src/storage/snapshot_format.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vectorsearch {
+namespace snapshot {
+
+// On-disk layout of a VectorStore snapshot (native byte order):
+//
+//   Header (64 bytes)
+//   Section*   each starts on a 64-byte boundary with a SectionTag, followed
+//              by a payload written by the owning component
+//   End        a SectionTag of type End
+//
+// The embedding payload keeps the arena layout (rows padded to the arena
+// stride, first row 64-byte aligned in the file), so a mapped snapshot can be
+// used as the arena without copying. The header checksum is the CRC-32C of
+// every byte after the header.
+
+constexpr char kMagic[8] = {'V', 'S', 'S', 'N', 'A', 'P', '\r', '\n'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kSectionAlignment = 64;
+
+enum class SectionType : uint32_t {
+  End = 0,
+  Embeddings = 1,
+  Records = 2,
+  Hnsw = 3,
+  Ivf = 4,
+  ScalarQuantizer = 5,
+  ProductQuantizer = 6,
+  Norms = 7,
+  BinaryQuantizer = 8,
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t checksum;
+  uint64_t fileSize;
+  uint64_t dimension;
+  uint64_t rowCount;
+  uint64_t liveCount;
+  // Store metric: 0 for none, otherwise the Metric value plus one
+  uint32_t metric;
+  // ElementType of the embedding rows; 0 (Float32) in older snapshots
+  uint32_t elementType;
+  uint8_t reserved[8];
+};
+
+static_assert(sizeof(Header) == 64, "snapshot header must be 64 bytes");
+
+struct SectionTag {
+  uint32_t type;
+  uint32_t reserved;
+};
+
+} // namespace snapshot
+} // namespace vectorsearch
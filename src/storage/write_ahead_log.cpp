@@ -0,0 +1,225 @@
+// src/storage/write_ahead_log.cpp
+#include "write_ahead_log.h"
+#include "common/binary_io.h"
+#include "common/crc32c.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+// Upper bound on one record; anything larger in the length field is taken
+// as a torn or corrupt tail
+constexpr uint32_t kMaxRecordBytes = 256u << 20;
+
+struct FrameHeader {
+  uint32_t length;
+  uint32_t checksum;
+};
+
+std::runtime_error systemError(const std::string &what,
+                               const std::string &path) {
+  return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+// Flushes written data to stable storage. macOS has no fdatasync, and its
+// fsync only reaches the drive cache; F_FULLFSYNC is the durable equivalent.
+int syncData(int fd) {
+#ifdef __APPLE__
+  return ::fcntl(fd, F_FULLFSYNC);
+#else
+  return ::fdatasync(fd);
+#endif
+}
+
+} // anonymous namespace
+
+namespace vectorsearch {
+
+WriteAheadLog::WriteAheadLog(const std::string &path,
+                             const WalOptions &options,
+                             const std::function<void(const Record &)> &replay)
+    : path_(path), options_(options) {
+  // Replay the intact prefix and remember where it ends
+  off_t validBytes = 0;
+  {
+    std::ifstream in(path, std::ios::binary);
+    std::string payload;
+    FrameHeader frame;
+    while (in.read(reinterpret_cast<char *>(&frame), sizeof(frame))) {
+      if (frame.length > kMaxRecordBytes) {
+        break;
+      }
+      payload.resize(frame.length);
+      if (!in.read(&payload[0], frame.length) ||
+          crc32c(payload.data(), payload.size()) != frame.checksum) {
+        break;
+      }
+
+      BinaryReader reader(reinterpret_cast<const uint8_t *>(payload.data()),
+                          payload.size());
+      Record record;
+      uint8_t op = reader.read<uint8_t>();
+      if (op < static_cast<uint8_t>(Op::Add) ||
+          op > static_cast<uint8_t>(Op::Clear)) {
+        break;
+      }
+      record.op = static_cast<Op>(op);
+      record.id = reader.readString();
+      record.embedding = reader.readArray<float>();
+      record.document_id = reader.readString();
+      record.metadata = reader.readString();
+      replay(record);
+
+      validBytes += static_cast<off_t>(sizeof(frame) + frame.length);
+    }
+  }
+
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    throw systemError("Cannot open write-ahead log", path);
+  }
+  if (::ftruncate(fd_, validBytes) != 0 ||
+      ::lseek(fd_, validBytes, SEEK_SET) < 0) {
+    int error = errno;
+    ::close(fd_);
+    errno = error;
+    throw systemError("Cannot truncate write-ahead log", path);
+  }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+  // Writers that never waited still get their records out
+  std::unique_lock<std::mutex> lock(mutex_);
+  flushed_.wait(lock, [this]() { return !flushing_; });
+  if (!pending_.empty() && error_.empty()) {
+    try {
+      writeAll(pending_);
+      if (options_.syncOnCommit) {
+        syncData(fd_);
+      }
+    } catch (const std::runtime_error &) {
+      // Nothing left to report the failure to
+    }
+  }
+  ::close(fd_);
+}
+
+uint64_t WriteAheadLog::append(const Record &record) {
+  std::string frame = encode(record);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!error_.empty()) {
+    throw std::runtime_error(error_);
+  }
+  pending_ += frame;
+  return ++last_lsn_;
+}
+
+void WriteAheadLog::waitDurable(uint64_t lsn) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (durable_lsn_ < lsn) {
+    if (!error_.empty()) {
+      throw std::runtime_error(error_);
+    }
+    if (flushing_) {
+      flushed_.wait(lock);
+      continue;
+    }
+
+    // Lead a group commit covering everything queued so far
+    flushing_ = true;
+    std::string batch;
+    batch.swap(pending_);
+    const uint64_t batchLsn = last_lsn_;
+    lock.unlock();
+
+    std::string error;
+    try {
+      writeAll(batch);
+      if (options_.syncOnCommit && syncData(fd_) != 0) {
+        throw systemError("Cannot sync write-ahead log", path_);
+      }
+    } catch (const std::runtime_error &e) {
+      error = e.what();
+    }
+
+    lock.lock();
+    flushing_ = false;
+    if (error.empty()) {
+      durable_lsn_ = std::max(durable_lsn_, batchLsn);
+      ++commit_count_;
+    } else {
+      error_ = error;
+    }
+    flushed_.notify_all();
+  }
+}
+
+void WriteAheadLog::reset() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  flushed_.wait(lock, [this]() { return !flushing_; });
+
+  pending_.clear();
+  if (::ftruncate(fd_, 0) != 0 || ::lseek(fd_, 0, SEEK_SET) < 0) {
+    error_ = systemError("Cannot truncate write-ahead log", path_).what();
+    flushed_.notify_all();
+    throw std::runtime_error(error_);
+  }
+  // Everything appended so far is covered by the caller's snapshot
+  durable_lsn_ = last_lsn_;
+  flushed_.notify_all();
+}
+
+uint64_t WriteAheadLog::commitCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return commit_count_;
+}
+
+uint64_t WriteAheadLog::recordCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return last_lsn_;
+}
+
+std::string WriteAheadLog::encode(const Record &record) {
+  std::ostringstream payloadStream;
+  BinaryWriter writer(payloadStream);
+  writer.write<uint8_t>(static_cast<uint8_t>(record.op));
+  writer.writeString(record.id);
+  writer.writeArray(record.embedding);
+  writer.writeString(record.document_id);
+  writer.writeString(record.metadata);
+  std::string payload = payloadStream.str();
+  if (payload.size() > kMaxRecordBytes) {
+    throw std::invalid_argument("Write-ahead log record is too large");
+  }
+
+  FrameHeader frame{static_cast<uint32_t>(payload.size()),
+                    writer.checksum()};
+  std::string bytes(sizeof(frame), '\0');
+  std::memcpy(&bytes[0], &frame, sizeof(frame));
+  return bytes + payload;
+}
+
+void WriteAheadLog::writeAll(const std::string &bytes) {
+  const char *p = bytes.data();
+  size_t remaining = bytes.size();
+  while (remaining > 0) {
+    ssize_t written = ::write(fd_, p, remaining);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw systemError("Cannot write write-ahead log", path_);
+    }
+    p += written;
+    remaining -= static_cast<size_t>(written);
+  }
+}
+
+} // namespace vectorsearch
@@ -0,0 +1,90 @@
+// src/storage/write_ahead_log.h
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vectorsearch {
+
+struct WalOptions {
+  // fdatasync every commit group. Disabling it keeps the log crash-safe
+  // against process crashes but not against power loss.
+  bool syncOnCommit = true;
+};
+
+// Append-only log of store mutations with group commit.
+//
+// Records are framed as [u32 payload length][u32 CRC-32C][payload]. Writers
+// first append() a record, which only queues it in memory, and then block in
+// waitDurable() until it is on disk. Whichever waiting writer finds no flush
+// in progress becomes the leader: it writes everything queued so far with a
+// single write + fdatasync and wakes every writer the batch covered, so under
+// concurrent load one sync is shared by many records.
+class WriteAheadLog {
+public:
+  enum class Op : uint8_t { Add = 1, Update = 2, Delete = 3, Clear = 4 };
+
+  struct Record {
+    Op op = Op::Add;
+    std::string id;
+    std::vector<float> embedding;
+    std::string document_id;
+    std::string metadata;
+  };
+
+  // Opens or creates the log at `path`. Every intact record already in the
+  // file is passed to `replay` in order; a torn record at the tail (a crash
+  // mid-write) and anything after it is cut off. Throws std::runtime_error if
+  // the file cannot be opened.
+  WriteAheadLog(const std::string &path, const WalOptions &options,
+                const std::function<void(const Record &)> &replay);
+
+  ~WriteAheadLog();
+
+  WriteAheadLog(const WriteAheadLog &) = delete;
+  WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+  // Queues a record and returns its sequence number. Records are written in
+  // the order they are appended.
+  uint64_t append(const Record &record);
+
+  // Blocks until record `lsn` is durable, leading a group commit if no other
+  // writer is flushing. Throws std::runtime_error if the log failed to write;
+  // a failed log rejects every later call.
+  void waitDurable(uint64_t lsn);
+
+  // Drops every record, queued or written, once the caller has persisted the
+  // state they describe (a snapshot). Waits for an in-flight flush first.
+  void reset();
+
+  // Number of group commits (write + sync) performed so far.
+  uint64_t commitCount() const;
+
+  // Number of records appended since the log was opened.
+  uint64_t recordCount() const;
+
+private:
+  static std::string encode(const Record &record);
+
+  void writeAll(const std::string &bytes);
+
+  std::string path_;
+  WalOptions options_;
+  int fd_ = -1;
+
+  mutable std::mutex mutex_;
+  std::condition_variable flushed_;
+  std::string pending_;
+  uint64_t last_lsn_ = 0;
+  uint64_t durable_lsn_ = 0;
+  uint64_t commit_count_ = 0;
+  bool flushing_ = false;
+  std::string error_;
+};
+
+} // namespace vectorsearch
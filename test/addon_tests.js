@@ -0,0 +1,127 @@
+// test/addon_tests.js
+//
+// Exercises the Node.js addon (build it first with `npm install` or
+// `npx node-gyp rebuild`). Run with `npm test`.
+'use strict';
+
+const { VectorStore } = require('../bindings');
+
+let allPassed = true;
+
+function testResult(name, actual, expected) {
+  const passed = actual === expected;
+  console.log(`${(name + ':').padEnd(50)}${passed ? 'PASSED' : 'FAILED'}` +
+              (passed ? '' : ` (expected ${expected}, got ${actual})`));
+  allPassed = allPassed && passed;
+  return passed;
+}
+
+function randomRows(count, dimension, seed) {
+  // xorshift32 so runs are reproducible
+  let state = seed;
+  const rows = new Float32Array(count * dimension);
+  for (let i = 0; i < rows.length; ++i) {
+    state ^= state << 13;
+    state ^= state >>> 17;
+    state ^= state << 5;
+    rows[i] = (state >>> 0) / 2147483648 - 1;
+  }
+  return rows;
+}
+
+async function rejects(promiseFn) {
+  try {
+    await promiseFn();
+  } catch (error) {
+    return true;
+  }
+  return false;
+}
+
+async function testAddAndSearch() {
+  console.log('\n[Testing add and search]');
+
+  const dimension = 16;
+  const store = new VectorStore(dimension, { metric: 'euclidean' });
+  testResult('Dimension', store.dimension, dimension);
+
+  const rows = randomRows(200, dimension, 1);
+  const ids = Array.from({ length: 200 }, (_, i) => `v${i}`);
+  testResult('Batch added', await store.addBatch(ids, rows), 200);
+  testResult('Single add',
+             await store.add('extra', rows.subarray(0, dimension),
+                             { documentId: 'doc', metadata: '{}' }),
+             true);
+  testResult('Duplicate id rejected',
+             await store.add('v0', rows.subarray(0, dimension)), false);
+  testResult('Size', store.size, 201);
+
+  // A stored vector is its own nearest neighbour
+  const query = rows.slice(5 * dimension, 6 * dimension);
+  const results = await store.search(query, 3);
+  testResult('Nearest neighbour', results[0].id, 'v5');
+  testResult('Exact match distance', results[0].score < 1e-3, true);
+  testResult('k results', results.length, 3);
+
+  const batch = rows.slice(0, 4 * dimension);
+  const batchResults = await store.searchBatch(batch, 2, { metric: 'dot' });
+  testResult('One result list per query', batchResults.length, 4);
+  testResult('Batch results', batchResults.every((r) => r.length === 2), true);
+}
+
+async function testConcurrentSearches() {
+  console.log('\n[Testing concurrent searches]');
+
+  const dimension = 32;
+  const store =
+      new VectorStore(dimension, { metric: 'cosine', storage: 'fp16' });
+  const rows = randomRows(2000, dimension, 7);
+  await store.addBatch(Array.from({ length: 2000 }, (_, i) => `v${i}`), rows);
+
+  // Every search is in flight at once on the thread pool
+  const searches = [];
+  for (let q = 0; q < 64; ++q) {
+    const query = rows.subarray(q * dimension, (q + 1) * dimension);
+    searches.push(store.search(query, 5));
+  }
+  const results = await Promise.all(searches);
+
+  testResult('All searches resolved', results.length, 64);
+  testResult('Each query finds itself',
+             results.every((r, q) => r[0].id === `v${q}`), true);
+}
+
+async function testArgumentErrors() {
+  console.log('\n[Testing argument errors]');
+
+  const store = new VectorStore(4);
+  testResult('Plain array rejected',
+             await rejects(() => store.search([1, 2, 3, 4], 1)), true);
+  testResult('Wrong length rejected',
+             await rejects(() => store.search(new Float32Array(3), 1)), true);
+  testResult('Bad k rejected',
+             await rejects(() => store.search(new Float32Array(4), 0)), true);
+  testResult('Unknown metric rejected',
+             await rejects(() => store.search(new Float32Array(4), 1,
+                                              { metric: 'l1' })),
+             true);
+  testResult('Mismatched metadata rejects',
+             await rejects(() => store.addBatch(['a', 'b'], new Float32Array(8),
+                                                { metadata: ['x'] })),
+             true);
+  let threw = false;
+  try {
+    new VectorStore(4, { storage: 'fp8' });
+  } catch (error) {
+    threw = error instanceof TypeError;
+  }
+  testResult('Unknown storage type', threw, true);
+}
+
+(async () => {
+  await testAddAndSearch();
+  await testConcurrentSearches();
+  await testArgumentErrors();
+  console.log(allPassed ? '\nAll tests passed!' : '\nSome tests failed!');
+  process.exit(allPassed ? 0 : 1);
+})();
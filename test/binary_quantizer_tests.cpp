@@ -0,0 +1,271 @@
+// test/binary_quantizer_tests.cpp
+#include "ann/binary_quantizer.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <set>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+namespace {
+
+const std::string kSnapshotPath = "binary_quantizer_tests.snap";
+
+// Rows scattered around a few shared directions, offset from the origin so
+// the trained thresholds matter
+std::vector<float> clusteredMatrix(size_t rows, size_t dimension,
+                                   std::mt19937 &rng) {
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  std::vector<float> centers(16 * dimension);
+  for (float &x : centers) {
+    x = dist(rng);
+  }
+  std::vector<float> data(rows * dimension);
+  for (size_t i = 0; i < rows; ++i) {
+    const float *center = centers.data() + (i % 16) * dimension;
+    for (size_t d = 0; d < dimension; ++d) {
+      data[i * dimension + d] = 2.0f + center[d] + 0.6f * dist(rng);
+    }
+  }
+  return data;
+}
+
+std::vector<float> rowOf(const std::vector<float> &data, size_t i,
+                         size_t dimension) {
+  return std::vector<float>(data.begin() + i * dimension,
+                            data.begin() + (i + 1) * dimension);
+}
+
+} // anonymous namespace
+
+bool testHammingKernels() {
+  logOutput("\n[Testing Hamming distance kernels]\n");
+
+  const SimdLevel original = VectorOps::simdLevel();
+  std::mt19937_64 rng(3);
+
+  bool passed = true;
+  const std::vector<size_t> wordCounts = {1, 2, 3, 7, 8, 9, 12, 17, 48};
+  for (SimdLevel level :
+       {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+    if (!VectorOps::setSimdLevel(level)) {
+      continue;
+    }
+
+    bool levelPassed = true;
+    for (size_t words : wordCounts) {
+      const size_t count = 33;
+      std::vector<uint64_t> query(words);
+      std::vector<uint64_t> codes(count * words);
+      for (uint64_t &w : query) {
+        w = rng();
+      }
+      for (uint64_t &w : codes) {
+        w = rng();
+      }
+
+      std::vector<uint32_t> distances(count);
+      VectorOps::hammingDistances(query.data(), codes.data(), words, count,
+                                  distances.data());
+      for (size_t r = 0; r < count; ++r) {
+        uint32_t expected = 0;
+        for (size_t w = 0; w < words; ++w) {
+          uint64_t diff = query[w] ^ codes[r * words + w];
+          for (; diff; diff &= diff - 1) {
+            ++expected;
+          }
+        }
+        levelPassed &= distances[r] == expected;
+        levelPassed &=
+            VectorOps::hammingDistance(query.data(), codes.data() + r * words,
+                                       words) == expected;
+      }
+    }
+    passed &= testResult(std::string("Hamming distances exact (") +
+                             VectorOps::simdLevelName(level) + ")",
+                         levelPassed, true);
+  }
+
+  VectorOps::setSimdLevel(original);
+  return passed;
+}
+
+bool testEncode() {
+  logOutput("\n[Testing sign-bit encoding]\n");
+
+  const size_t dimension = 70;
+  BinaryQuantizer quantizer(dimension);
+  bool passed = testResult("Code words", quantizer.codeWords(), size_t(2));
+
+  // Two rows whose mean is 1.0 in every dimension
+  std::vector<float> training(2 * dimension);
+  for (size_t d = 0; d < dimension; ++d) {
+    training[d] = 0.0f;
+    training[dimension + d] = 2.0f;
+  }
+  quantizer.train(training.data(), 2, dimension);
+  passed &= testResult("Trained", quantizer.isTrained(), true);
+  passed &= testResult("Thresholds are the mean",
+                       quantizer.getThresholds()[5], 1.0f);
+
+  std::vector<float> vector(dimension, 0.5f);
+  vector[0] = 1.5f;
+  vector[63] = 1.5f;
+  vector[64] = 1.5f;
+  vector[69] = 1.5f;
+  std::vector<uint64_t> code(quantizer.codeWords());
+  quantizer.encode(vector.data(), code.data());
+  passed &= testResult("Low word bits", code[0],
+                       (uint64_t(1) << 63) | uint64_t(1));
+  passed &= testResult("High word bits, padding clear", code[1],
+                       (uint64_t(1) << 5) | uint64_t(1));
+
+  std::vector<uint64_t> allSet(quantizer.codeWords());
+  std::vector<float> high(dimension, 3.0f);
+  quantizer.encode(high.data(), allSet.data());
+  passed &= testResult("Hamming distance counts differing dimensions",
+                       VectorOps::hammingDistance(code.data(), allSet.data(),
+                                                  quantizer.codeWords()),
+                       uint32_t(dimension - 4));
+  return passed;
+}
+
+bool testBinarySearch() {
+  logOutput("\n[Testing binary search with rescoring]\n");
+
+  const size_t dimension = 128;
+  const size_t numVectors = 4000;
+  const size_t numQueries = 50;
+  const size_t k = 10;
+  std::mt19937 rng(21);
+  auto data = clusteredMatrix(numVectors + numQueries, dimension, rng);
+
+  VectorStore store(dimension);
+  bool threw = false;
+  try {
+    store.enableBinaryQuantization();
+  } catch (const std::logic_error &) {
+    threw = true;
+  }
+  bool passed = testResult("Empty store cannot be quantized", threw, true);
+
+  threw = false;
+  try {
+    store.searchBinary(rowOf(data, 0, dimension), k);
+  } catch (const std::logic_error &) {
+    threw = true;
+  }
+  passed &= testResult("Search needs quantization", threw, true);
+
+  // Half of the vectors arrive after training and are encoded incrementally
+  for (size_t i = 0; i < numVectors / 2; ++i) {
+    store.addVector("v" + std::to_string(i), rowOf(data, i, dimension));
+  }
+  store.enableBinaryQuantization(1000);
+  std::vector<float> batch(data.begin() + numVectors / 2 * dimension,
+                           data.begin() + numVectors * dimension);
+  std::vector<std::string> ids;
+  for (size_t i = numVectors / 2; i < numVectors; ++i) {
+    ids.push_back("v" + std::to_string(i));
+  }
+  store.addVectors(batch.data(), ids.size(), ids);
+  passed &= testResult("Quantization enabled", store.hasBinaryQuantization(),
+                       true);
+
+  // Codes carry no norms, so the shortlist is only dependable for metrics
+  // that rank by angle or by distance between similar-norm rows
+  for (Metric metric : {Metric::Euclidean, Metric::Cosine}) {
+    size_t hits = 0;
+    bool scoresExact = true;
+    for (size_t q = 0; q < numQueries; ++q) {
+      std::vector<float> query = rowOf(data, numVectors + q, dimension);
+      auto exact = store.search(query, k, metric);
+      auto approx = store.searchBinary(query, k, metric);
+      std::set<std::string> truth;
+      for (const auto &r : exact) {
+        truth.insert(r.id);
+      }
+      for (const auto &r : approx) {
+        hits += truth.count(r.id);
+      }
+      if (!approx.empty() && !exact.empty() && approx[0].id == exact[0].id) {
+        scoresExact &= isApproxEqual(approx[0].score, exact[0].score);
+      }
+    }
+    double recall = static_cast<double>(hits) / (numQueries * k);
+    std::ostringstream ss;
+    ss << "  metric " << static_cast<int>(metric) << " recall@" << k << "="
+       << recall << "\n";
+    logOutput(ss.str());
+    passed &= testResult("Recall above 0.8 (metric " +
+                             std::to_string(static_cast<int>(metric)) + ")",
+                         recall >= 0.8, true);
+    passed &= testResult("Rescored scores are exact (metric " +
+                             std::to_string(static_cast<int>(metric)) + ")",
+                         scoresExact, true);
+  }
+
+  // Updates re-encode, deletes drop out of the scan
+  std::vector<float> moved = rowOf(data, numVectors, dimension);
+  store.updateVector("v7", moved);
+  passed &= testResult("Updated vector found",
+                       store.searchBinary(moved, 1, Metric::Euclidean)[0].id,
+                       std::string("v7"));
+  store.deleteVector("v7");
+  passed &= testResult("Deleted vector gone",
+                       store.searchBinary(moved, 1, Metric::Euclidean)[0].id !=
+                           "v7",
+                       true);
+
+  // Codes follow rows through compaction and snapshots
+  for (size_t i = 0; i < numVectors; i += 2) {
+    store.deleteVector("v" + std::to_string(i));
+  }
+  std::vector<float> query = rowOf(data, 11, dimension);
+  auto before = store.searchBinary(query, k, Metric::Euclidean);
+  store.compact();
+  auto compacted = store.searchBinary(query, k, Metric::Euclidean);
+  bool same = before.size() == compacted.size();
+  for (size_t i = 0; same && i < before.size(); ++i) {
+    same &= before[i].id == compacted[i].id;
+  }
+  passed &= testResult("Compaction keeps codes", same, true);
+
+  store.saveSnapshot(kSnapshotPath);
+  auto loaded = VectorStore::loadSnapshot(kSnapshotPath);
+  passed &= testResult("Snapshot keeps quantization",
+                       loaded->hasBinaryQuantization(), true);
+  auto restored = loaded->searchBinary(query, k, Metric::Euclidean);
+  same = before.size() == restored.size();
+  for (size_t i = 0; same && i < before.size(); ++i) {
+    same &= before[i].id == restored[i].id;
+  }
+  passed &= testResult("Snapshot keeps codes", same, true);
+  std::remove(kSnapshotPath.c_str());
+
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("binary_quantizer_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Binary Quantizer Tests - " + std::string(std::ctime(&now)) +
+            "\n");
+
+  bool allPassed = vectorsearch::testHammingKernels() &
+                   vectorsearch::testEncode() &
+                   vectorsearch::testBinarySearch();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
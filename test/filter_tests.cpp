@@ -0,0 +1,320 @@
+// test/filter_tests.cpp
+#include "common/bitmap.h"
+#include "engine/attribute_index.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <set>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+namespace {
+
+std::vector<uint32_t> toVector(const std::set<uint32_t> &s) {
+  return std::vector<uint32_t>(s.begin(), s.end());
+}
+
+// Reference answer: exact search over the whole store, then keep matches
+std::vector<VectorStore::SearchResult>
+filteredTruth(const VectorStore &store, const std::vector<float> &query,
+              size_t k, Metric metric,
+              const std::function<bool(const VectorStore::VectorRecord &)>
+                  &predicate) {
+  std::vector<VectorStore::SearchResult> truth;
+  for (const auto &r : store.search(query, store.size(), metric)) {
+    if (predicate(*store.getVector(r.id))) {
+      truth.push_back(r);
+      if (truth.size() == k) {
+        break;
+      }
+    }
+  }
+  return truth;
+}
+
+double recallAt(const std::vector<VectorStore::SearchResult> &approx,
+                const std::vector<VectorStore::SearchResult> &exact) {
+  std::set<std::string> ids;
+  for (const auto &r : exact) {
+    ids.insert(r.id);
+  }
+  size_t hits = 0;
+  for (const auto &r : approx) {
+    hits += ids.count(r.id);
+  }
+  return exact.empty() ? 1.0 : static_cast<double>(hits) / exact.size();
+}
+
+} // anonymous namespace
+
+bool testBitmap() {
+  logOutput("\n[Testing compressed bitmap]\n");
+
+  // Mix sparse and dense containers so every container pairing is hit
+  std::mt19937 rng(1);
+  Bitmap a;
+  Bitmap b;
+  std::set<uint32_t> setA;
+  std::set<uint32_t> setB;
+  for (int i = 0; i < 20000; ++i) {
+    uint32_t dense = rng() % 12000;          // container 0 turns dense
+    uint32_t sparse = 65536 + rng() % 60000; // container 1 stays sparse
+    a.add(dense);
+    setA.insert(dense);
+    if (i % 4 == 0) {
+      a.add(sparse);
+      setA.insert(sparse);
+    }
+    uint32_t other = rng() % 200000;
+    b.add(other);
+    setB.insert(other);
+  }
+
+  bool passed = testResult("Cardinality", a.cardinality(), setA.size());
+  passed &= testResult("Contents", a.toVector() == toVector(setA), true);
+  passed &= testResult("Contains", a.contains(*setA.begin()) &&
+                                       !a.contains(199999) &&
+                                       setA.count(199999) == 0,
+                       true);
+  passed &= testResult("Duplicate add ignored", a.add(*setA.begin()), false);
+
+  std::set<uint32_t> expected;
+  Bitmap u = a;
+  u |= b;
+  std::set_union(setA.begin(), setA.end(), setB.begin(), setB.end(),
+                 std::inserter(expected, expected.end()));
+  passed &= testResult("Union", u.toVector() == toVector(expected), true);
+
+  expected.clear();
+  Bitmap n = a;
+  n &= b;
+  std::set_intersection(setA.begin(), setA.end(), setB.begin(), setB.end(),
+                        std::inserter(expected, expected.end()));
+  passed &= testResult("Intersection", n.toVector() == toVector(expected),
+                       true);
+
+  expected.clear();
+  Bitmap d = a;
+  d -= b;
+  std::set_difference(setA.begin(), setA.end(), setB.begin(), setB.end(),
+                      std::inserter(expected, expected.end()));
+  passed &= testResult("Difference", d.toVector() == toVector(expected), true);
+
+  // Removing values shrinks a dense container back to an array
+  for (uint32_t v : std::vector<uint32_t>(setA.begin(), setA.end())) {
+    if (v < 11000) {
+      a.remove(v);
+      setA.erase(v);
+    }
+  }
+  passed &= testResult("Remove", a.toVector() == toVector(setA), true);
+  passed &= testResult("Remove missing", a.remove(5), false);
+  return passed;
+}
+
+bool testAttributeParsing() {
+  logOutput("\n[Testing metadata attribute parsing]\n");
+
+  auto attributes = AttributeIndex::parse(
+      R"({"tenant": "acme", "year": 2024, "score": -1.5e1, "public": true,)"
+      R"( "tags": ["a", "bé", 3], "nested": {"x": [1, {"y": null}]},)"
+      R"( "none": null, "esc": "q\"\\"})");
+  bool passed = testResult("Attribute count", attributes.size(), size_t(8));
+  bool values =
+      attributes.size() == 8 && attributes[0].first == "tenant" &&
+      attributes[0].second == AttributeValue("acme") &&
+      attributes[1].second == AttributeValue(2024) &&
+      attributes[2].second == AttributeValue(-15.0) &&
+      attributes[3].second == AttributeValue(true) &&
+      attributes[4].first == "tags" &&
+      attributes[5].second == AttributeValue("b\xc3\xa9") &&
+      attributes[6].second == AttributeValue(3) &&
+      attributes[7].second == AttributeValue("q\"\\");
+  passed &= testResult("Typed values", values, true);
+
+  passed &= testResult("Plain text ignored",
+                       AttributeIndex::parse("updated").size(), size_t(0));
+  passed &= testResult("Malformed JSON ignored",
+                       AttributeIndex::parse(R"({"a": 1,})").size() +
+                           AttributeIndex::parse(R"({"a": 01})").size() +
+                           AttributeIndex::parse(R"({"a": "x"} trailing)")
+                               .size(),
+                       size_t(0));
+  return passed;
+}
+
+bool testFilteredSearch() {
+  logOutput("\n[Testing filtered search]\n");
+
+  const size_t dimension = 16;
+  const size_t numVectors = 6000;
+  const size_t k = 10;
+  std::mt19937 rng(77);
+
+  VectorStore store(dimension);
+  for (size_t i = 0; i < numVectors; ++i) {
+    // tenant: 3 large tenants and a rare one; year spread over 10 values
+    std::string tenant = i % 100 == 0 ? "rare" : "t" + std::to_string(i % 3);
+    std::string metadata = "{\"tenant\":\"" + tenant + "\",\"year\":" +
+                           std::to_string(2015 + i % 10) + "}";
+    store.addVector("v" + std::to_string(i), randomVector(dimension, rng),
+                    "doc" + std::to_string(i % 500), metadata);
+  }
+  HnswParams hnswParams;
+  hnswParams.metric = Metric::Euclidean;
+  store.enableHnswIndex(hnswParams);
+  IvfParams ivfParams;
+  ivfParams.numLists = 32;
+  ivfParams.metric = Metric::Euclidean;
+  store.buildIvfIndex(ivfParams);
+
+  auto tenantIs = [](const std::string &t) {
+    return [t](const VectorStore::VectorRecord &r) {
+      return r.metadata.find("\"tenant\":\"" + t + "\"") != std::string::npos;
+    };
+  };
+
+  Filter broad = Filter::allOf(
+      {Filter::in("tenant", {"t0", "t1"}), Filter::range("year", 2016, 2022)});
+  auto broadPredicate = [](const VectorStore::VectorRecord &r) {
+    bool tenant = r.metadata.find("\"t0\"") != std::string::npos ||
+                  r.metadata.find("\"t1\"") != std::string::npos;
+    int year = std::stoi(r.metadata.substr(r.metadata.find("year") + 6));
+    return tenant && year >= 2016 && year <= 2022;
+  };
+  Filter rare = Filter::equals("tenant", "rare");
+  Filter documents = Filter::documentIn({"doc7", "doc8"});
+
+  bool passed = testResult("Count broad filter", store.count(broad),
+                           size_t(2800));
+  passed &= testResult("Count rare filter", store.count(rare), size_t(60));
+  passed &= testResult("Count document filter", store.count(documents),
+                       size_t(24));
+  passed &= testResult("Count negation",
+                       store.count(Filter::negate(rare)), numVectors - 60);
+
+  bool exactMatches = true;
+  double hnswRecall = 0.0;
+  double ivfRecall = 0.0;
+  bool rareExact = true;
+  bool allMatch = true;
+  const int numQueries = 30;
+  for (int q = 0; q < numQueries; ++q) {
+    auto query = randomVector(dimension, rng);
+
+    auto truth = filteredTruth(store, query, k, Metric::Euclidean,
+                               broadPredicate);
+    auto exact = store.search(query, k, Metric::Euclidean, broad);
+    exactMatches &= recallAt(exact, truth) == 1.0;
+
+    auto hnsw = store.searchHnsw(query, k, broad, 100);
+    auto ivf = store.searchIvf(query, k, broad, 8);
+    hnswRecall += recallAt(hnsw, truth);
+    ivfRecall += recallAt(ivf, truth);
+    for (const auto &r : hnsw) {
+      allMatch &= broadPredicate(*store.getVector(r.id));
+    }
+    allMatch &= hnsw.size() == k && ivf.size() == k;
+
+    // The rare tenant is answered by the exact fallback
+    auto rareTruth =
+        filteredTruth(store, query, k, Metric::Euclidean, tenantIs("rare"));
+    rareExact &= recallAt(store.searchHnsw(query, k, rare), rareTruth) == 1.0;
+    rareExact &= recallAt(store.searchIvf(query, k, rare), rareTruth) == 1.0;
+  }
+  hnswRecall /= numQueries;
+  ivfRecall /= numQueries;
+  std::ostringstream ss;
+  ss << "  filtered recall@" << k << ": hnsw=" << hnswRecall
+     << " ivf=" << ivfRecall << "\n";
+  logOutput(ss.str());
+
+  passed &= testResult("Exact filtered search", exactMatches, true);
+  passed &= testResult("Filtered results all match", allMatch, true);
+  passed &= testResult("Filtered HNSW recall", hnswRecall >= 0.9, true);
+  passed &= testResult("Filtered IVF recall", ivfRecall >= 0.8, true);
+  passed &= testResult("Selective filter is exact", rareExact, true);
+  return passed;
+}
+
+bool testAttributeMaintenance() {
+  logOutput("\n[Testing attribute index maintenance]\n");
+
+  const size_t dimension = 4;
+  std::mt19937 rng(5);
+  const std::string path = "filter_tests.snap";
+
+  VectorStore store(dimension);
+  store.addVector("a", randomVector(dimension, rng), "d1",
+                  R"({"color": "red", "size": 3})");
+  store.addVector("b", randomVector(dimension, rng), "d1",
+                  R"({"color": "blue", "size": 5})");
+  store.addVector("c", randomVector(dimension, rng), "d2", "not json");
+  std::vector<std::string> ids = {"d", "e"};
+  std::vector<float> bulk;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    auto v = randomVector(dimension, rng);
+    bulk.insert(bulk.end(), v.begin(), v.end());
+  }
+  store.addVectors(bulk.data(), ids.size(), ids, {"d3", "d3"},
+                   {R"({"color": "red"})", R"({"color": "green"})"});
+
+  Filter red = Filter::equals("color", "red");
+  bool passed = testResult("Inserts indexed", store.count(red), size_t(2));
+  passed &= testResult("Bulk inserts indexed",
+                       store.count(Filter::documentIn({"d3"})), size_t(2));
+
+  store.updateVector("a", {}, "", R"({"color": "blue", "size": 3})");
+  passed &= testResult("Update moves attribute", store.count(red), size_t(1));
+  passed &= testResult("Update keeps document id",
+                       store.count(Filter::documentIn({"d1"})), size_t(2));
+  store.updateVector("b", {}, "d9");
+  passed &= testResult("Update moves document id",
+                       store.count(Filter::documentIn({"d9"})), size_t(1));
+
+  store.deleteVector("d");
+  passed &= testResult("Delete unindexes", store.count(red), size_t(0));
+
+  store.saveSnapshot(path);
+  auto loaded = VectorStore::loadSnapshot(path);
+  passed &= testResult(
+      "Attributes rebuilt on load",
+      loaded->count(Filter::equals("color", "blue")) == 2 &&
+          loaded->count(Filter::range("size", 3, 4)) == 1 &&
+          loaded->count(Filter::documentIn({"d2"})) == 1,
+      true);
+  std::remove(path.c_str());
+
+  store.clear();
+  passed &= testResult("Clear unindexes",
+                       store.count(Filter::negate(Filter::anyOf({}))),
+                       size_t(0));
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("filter_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Filter Tests - " + std::string(std::ctime(&now)) + "\n");
+
+  bool allPassed = vectorsearch::testBitmap() &
+                   vectorsearch::testAttributeParsing() &
+                   vectorsearch::testFilteredSearch() &
+                   vectorsearch::testAttributeMaintenance();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
@@ -0,0 +1,385 @@
+// test/hnsw_index_tests.cpp
+#include "ann/hnsw_index.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <ctime>
+#include <random>
+#include <set>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+namespace {
+
+double recallAt(const std::vector<VectorStore::SearchResult> &approx,
+                const std::vector<VectorStore::SearchResult> &exact) {
+  std::set<std::string> truth;
+  for (const auto &r : exact) {
+    truth.insert(r.id);
+  }
+  size_t hits = 0;
+  for (const auto &r : approx) {
+    hits += truth.count(r.id);
+  }
+  return exact.empty() ? 1.0 : static_cast<double>(hits) / exact.size();
+}
+
+// Serves caller-owned rows of arbitrary length, the way a store serves its
+// arena
+class RowSource : public VectorSource {
+public:
+  explicit RowSource(const std::vector<std::vector<float>> &rows)
+      : rows_(rows) {}
+
+  const float *load(uint32_t label, float *) const override {
+    return rows_[label].data();
+  }
+
+  bool unitLength() const override { return false; }
+
+private:
+  const std::vector<std::vector<float>> &rows_;
+};
+
+} // anonymous namespace
+
+bool testRecallVsEfSearch() {
+  logOutput("\n[Testing HNSW recall against exact search]\n");
+
+  const size_t dimension = 32;
+  const size_t numVectors = 5000;
+  const size_t numQueries = 100;
+  const size_t k = 10;
+  std::mt19937 rng(1234);
+
+  VectorStore store(dimension);
+  HnswParams params;
+  params.M = 16;
+  params.efConstruction = 100;
+  params.metric = Metric::Euclidean;
+  // Enable the index first so every vector goes through incremental insertion
+  store.enableHnswIndex(params);
+
+  auto data = clusteredData(numVectors, dimension, 50, rng);
+  for (size_t i = 0; i < numVectors; ++i) {
+    store.addVector("v" + std::to_string(i), data[i]);
+  }
+  auto queries = clusteredData(numQueries, dimension, 50, rng);
+
+  std::vector<std::vector<VectorStore::SearchResult>> truth;
+  for (const auto &q : queries) {
+    truth.push_back(store.search(q, k, Metric::Euclidean));
+  }
+
+  bool passed = true;
+  double previous = 0.0;
+  double best = 0.0;
+  for (size_t ef : {10, 20, 50, 100, 200}) {
+    double total = 0.0;
+    for (size_t i = 0; i < numQueries; ++i) {
+      total += recallAt(store.searchHnsw(queries[i], k, ef), truth[i]);
+    }
+    double recall = total / numQueries;
+    std::ostringstream ss;
+    ss << "  efSearch=" << ef << " recall@" << k << "=" << recall << "\n";
+    logOutput(ss.str());
+
+    // Larger candidate lists should never hurt noticeably
+    passed &= recall + 0.02 >= previous;
+    previous = recall;
+    best = recall;
+  }
+
+  bool result = testResult("Recall does not drop as efSearch grows", passed,
+                           true);
+  result &= testResult("Recall@10 at efSearch=200 above 0.95", best >= 0.95,
+                       true);
+  return result;
+}
+
+bool testDeletesAndUpdates() {
+  logOutput("\n[Testing HNSW deletes and updates]\n");
+
+  const size_t dimension = 8;
+  std::mt19937 rng(99);
+  auto data = clusteredData(500, dimension, 10, rng);
+
+  HnswParams params;
+  params.metric = Metric::Euclidean;
+  HnswIndex index(dimension, params);
+  for (size_t i = 0; i < data.size(); ++i) {
+    index.add(static_cast<uint32_t>(i), data[i].data());
+  }
+  bool passed = testResult("Index size", index.size(), data.size());
+
+  auto before = index.search(data[42].data(), 1);
+  passed &= testResult("Finds exact match",
+                       !before.empty() && before[0].label == 42, true);
+
+  passed &= testResult("Remove existing label", index.remove(42), true);
+  passed &= testResult("Remove unknown label", index.remove(42), false);
+  auto after = index.search(data[42].data(), 10);
+  bool found = false;
+  for (const auto &n : after) {
+    found |= n.label == 42;
+  }
+  passed &= testResult("Deleted label not returned", found, false);
+  passed &= testResult("Size after remove", index.size(), data.size() - 1);
+
+  // Re-adding a label moves it to the new vector
+  index.add(7, data[100].data());
+  auto moved = index.search(data[100].data(), 2);
+  bool hasMoved = false;
+  for (const auto &n : moved) {
+    hasMoved |= n.label == 7;
+  }
+  passed &= testResult("Re-added label found at new position", hasMoved, true);
+  passed &= testResult("Size unchanged by re-add", index.size(),
+                       data.size() - 1);
+
+  // The store keeps its index in sync with mutations
+  VectorStore store(dimension);
+  store.enableHnswIndex(params);
+  store.addVector("a", data[0]);
+  store.addVector("b", data[1]);
+  store.deleteVector("a");
+  auto results = store.searchHnsw(data[0], 1);
+  passed &= testResult("Store delete reaches index",
+                       results.size() == 1 && results[0].id == "b", true);
+  store.updateVector("b", data[2]);
+  results = store.searchHnsw(data[2], 1);
+  passed &= testResult("Store update reaches index",
+                       results.size() == 1 && results[0].score < 1e-3f, true);
+
+  return passed;
+}
+
+bool testCompaction() {
+  logOutput("\n[Testing HNSW compaction]\n");
+
+  const size_t dimension = 16;
+  const size_t count = 3000;
+  std::mt19937 rng(5);
+  auto data = clusteredData(count, dimension, 30, rng);
+
+  HnswParams params;
+  params.metric = Metric::Euclidean;
+  HnswIndex index(dimension, params);
+  for (size_t i = 0; i < count; ++i) {
+    index.add(static_cast<uint32_t>(i), data[i].data());
+  }
+
+  // Retire 40% of the nodes: half by delete, half by moving the label
+  std::vector<bool> live(count, true);
+  for (size_t i = 0; i < count; i += 5) {
+    index.remove(static_cast<uint32_t>(i));
+    live[i] = false;
+    index.add(static_cast<uint32_t>(i + 1), data[i + 1].data());
+  }
+  bool passed = testResult("Retired nodes counted", index.deletedCount(),
+                           count / 5 * 2);
+
+  auto recall = [&](const HnswIndex &searched,
+                    const std::vector<uint32_t> &labelMap) {
+    const size_t k = 10;
+    size_t hits = 0;
+    size_t total = 0;
+    for (size_t q = 0; q < 100; ++q) {
+      const float *query = data[(q * 37) % count].data();
+      TopK exact(k);
+      for (size_t i = 0; i < count; ++i) {
+        if (live[i]) {
+          exact.push(VectorOps::distance(Metric::Euclidean, query,
+                                         data[i].data(), dimension),
+                     static_cast<uint32_t>(i));
+        }
+      }
+      std::set<uint32_t> truth;
+      for (const Neighbor &n : exact.takeSorted()) {
+        truth.insert(labelMap.empty() ? n.label : labelMap[n.label]);
+      }
+      for (const Neighbor &n : searched.search(query, k, 64)) {
+        hits += truth.count(n.label);
+      }
+      total += truth.size();
+    }
+    return static_cast<double>(hits) / total;
+  };
+
+  const double before = recall(index, {});
+  auto compacted = index.compacted();
+  const double after = recall(*compacted, {});
+  logOutput("Recall@10 before " + std::to_string(before) + ", after " +
+            std::to_string(after) + "\n");
+  passed &= testResult("No retired nodes left", compacted->deletedCount(),
+                       size_t(0));
+  passed &= testResult("Live nodes kept", compacted->size(), index.size());
+  passed &= testResult("Recall kept", after >= 0.9 && after >= before - 0.02,
+                       true);
+
+  // Labels can be renamed on the way
+  std::vector<uint32_t> labelMap(count);
+  for (size_t i = 0; i < count; ++i) {
+    labelMap[i] = static_cast<uint32_t>(count - 1 - i);
+  }
+  auto renamed = index.compacted(labelMap);
+  auto found = renamed->search(data[3].data(), 1);
+  passed &= testResult("Labels renamed",
+                       !found.empty() && found[0].label == labelMap[3], true);
+  passed &= testResult("Renamed recall", recall(*renamed, labelMap) >= 0.9,
+                       true);
+  return passed;
+}
+
+bool testVectorSource() {
+  logOutput("\n[Testing HNSW over a vector source]\n");
+
+  const size_t dimension = 32;
+  const size_t count = 3000;
+  const size_t k = 10;
+  std::mt19937 rng(77);
+  auto data = clusteredData(count, dimension, 30, rng);
+  // Unnormalized rows, so cosine cannot fall back to a dot product
+  for (size_t i = 0; i < count; ++i) {
+    for (float &x : data[i]) {
+      x *= 1.0f + static_cast<float>(i % 7);
+    }
+  }
+  RowSource source(data);
+
+  HnswParams params;
+  params.metric = Metric::Cosine;
+  HnswIndex index(dimension, params, &source);
+  for (size_t i = 0; i < count; ++i) {
+    index.add(static_cast<uint32_t>(i), data[i].data());
+  }
+  for (size_t i = 0; i < count; i += 10) {
+    index.remove(static_cast<uint32_t>(i));
+  }
+
+  auto recall = [&](const HnswIndex &searched, bool &exactScores) {
+    size_t hits = 0;
+    for (size_t q = 0; q < 100; ++q) {
+      const float *query = data[(q * 31 + 1) % count].data();
+      TopK exact(k);
+      for (size_t i = 0; i < count; ++i) {
+        if (i % 10 != 0) {
+          exact.push(VectorOps::distance(Metric::Cosine, query,
+                                         data[i].data(), dimension),
+                     static_cast<uint32_t>(i));
+        }
+      }
+      std::set<uint32_t> truth;
+      for (const Neighbor &n : exact.takeSorted()) {
+        truth.insert(n.label);
+      }
+      for (const Neighbor &n : searched.search(query, k, 100)) {
+        hits += truth.count(n.label);
+        exactScores &= isApproxEqual(
+            n.distance, VectorOps::distance(Metric::Cosine, query,
+                                            data[n.label].data(), dimension));
+      }
+    }
+    return static_cast<double>(hits) / (100 * k);
+  };
+
+  bool exactScores = true;
+  const double before = recall(index, exactScores);
+  auto compacted = index.compacted();
+  const double after = recall(*compacted, exactScores);
+  logOutput("Recall@10 before compaction " + std::to_string(before) +
+            ", after " + std::to_string(after) + "\n");
+  bool passed = testResult("Source-backed recall above 0.95", before >= 0.95,
+                           true);
+  passed &= testResult("Compacted recall above 0.95", after >= 0.95, true);
+  passed &= testResult("Distances are cosine on the source rows", exactScores,
+                       true);
+
+  // A half-precision store serves its rounded rows to the graph
+  VectorStore store(dimension, Metric::Cosine, ElementType::Float16);
+  store.enableHnswIndex(params);
+  for (size_t i = 0; i < count; ++i) {
+    store.addVector("v" + std::to_string(i), data[i]);
+  }
+  double total = 0.0;
+  for (size_t q = 0; q < 100; ++q) {
+    const std::vector<float> &query = data[(q * 31 + 1) % count];
+    total += recallAt(store.searchHnsw(query, k, 100),
+                      store.search(query, k, Metric::Cosine));
+  }
+  passed &= testResult("Half-precision store recall above 0.95",
+                       total / 100 >= 0.95, true);
+  return passed;
+}
+
+bool testChurn() {
+  logOutput("\n[Testing HNSW recall under delete and update churn]\n");
+
+  // Deleted slots are refilled by unrelated vectors and updates rewrite
+  // rows in place, while the retired graph nodes of both keep routing
+  const size_t dimension = 32;
+  const size_t count = 4000;
+  const size_t k = 10;
+  std::mt19937 rng(4242);
+  auto data = clusteredData(count, dimension, 40, rng);
+  auto fresh = clusteredData(count, dimension, 40, rng);
+
+  VectorStore store(dimension);
+  HnswParams params;
+  params.metric = Metric::Euclidean;
+  params.efConstruction = 100;
+  store.enableHnswIndex(params);
+  for (size_t i = 0; i < count; ++i) {
+    store.addVector("v" + std::to_string(i), data[i]);
+  }
+
+  std::uniform_int_distribution<size_t> pick(0, count - 1);
+  size_t next = 0;
+  for (size_t round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < count / 4; ++i) {
+      if (store.deleteVector("v" + std::to_string(pick(rng)))) {
+        store.addVector("n" + std::to_string(next), fresh[next % count]);
+        ++next;
+      }
+    }
+    for (size_t i = 0; i < count / 4; ++i) {
+      store.updateVector("v" + std::to_string(pick(rng)),
+                         fresh[pick(rng)]);
+    }
+  }
+  bool passed = testResult("Retired nodes left to route",
+                           store.deletedFraction() > 0.3, true);
+
+  double total = 0.0;
+  auto queries = clusteredData(100, dimension, 40, rng);
+  for (const auto &q : queries) {
+    total += recallAt(store.searchHnsw(q, k, 100),
+                      store.search(q, k, Metric::Euclidean));
+  }
+  const double recall = total / queries.size();
+  logOutput("Recall@10 after churn " + std::to_string(recall) + "\n");
+  passed &= testResult("Recall after churn above 0.95", recall >= 0.95, true);
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("hnsw_index_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("HNSW Index Tests - " + std::string(std::ctime(&now)) + "\n");
+
+  bool allPassed = vectorsearch::testRecallVsEfSearch() &
+                   vectorsearch::testDeletesAndUpdates() &
+                   vectorsearch::testCompaction() &
+                   vectorsearch::testVectorSource() &
+                   vectorsearch::testChurn();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
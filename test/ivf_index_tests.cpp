@@ -0,0 +1,213 @@
+// test/ivf_index_tests.cpp
+#include "ann/ivf_index.h"
+#include "common/thread_pool.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <ctime>
+#include <numeric>
+#include <random>
+#include <set>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+namespace {
+
+double recallAt(const std::vector<VectorStore::SearchResult> &approx,
+                const std::vector<VectorStore::SearchResult> &exact) {
+  std::set<std::string> truth;
+  for (const auto &r : exact) {
+    truth.insert(r.id);
+  }
+  size_t hits = 0;
+  for (const auto &r : approx) {
+    hits += truth.count(r.id);
+  }
+  return exact.empty() ? 1.0 : static_cast<double>(hits) / exact.size();
+}
+
+} // anonymous namespace
+
+bool testRecallVsNprobe() {
+  logOutput("\n[Testing IVF recall against exact search]\n");
+
+  const size_t dimension = 32;
+  const size_t numVectors = 5000;
+  const size_t numQueries = 100;
+  const size_t k = 10;
+  std::mt19937 rng(4321);
+
+  VectorStore store(dimension);
+  auto data = clusteredData(numVectors, dimension, 50, rng);
+  // Train on the first half; the rest is assigned incrementally
+  for (size_t i = 0; i < numVectors / 2; ++i) {
+    store.addVector("v" + std::to_string(i), data[i]);
+  }
+  IvfParams params;
+  params.numLists = 64;
+  params.metric = Metric::Cosine;
+  store.buildIvfIndex(params);
+  for (size_t i = numVectors / 2; i < numVectors; ++i) {
+    store.addVector("v" + std::to_string(i), data[i]);
+  }
+  bool result = testResult("IVF index built", store.hasIvfIndex(), true);
+
+  auto queries = clusteredData(numQueries, dimension, 50, rng);
+  std::vector<std::vector<VectorStore::SearchResult>> truth;
+  for (const auto &q : queries) {
+    truth.push_back(store.search(q, k, Metric::Cosine));
+  }
+
+  bool monotonic = true;
+  double previous = 0.0;
+  double best = 0.0;
+  for (size_t nprobe : {1, 4, 16, 64}) {
+    double total = 0.0;
+    for (size_t i = 0; i < numQueries; ++i) {
+      total += recallAt(store.searchIvf(queries[i], k, nprobe), truth[i]);
+    }
+    double recall = total / numQueries;
+    std::ostringstream ss;
+    ss << "  nprobe=" << nprobe << " recall@" << k << "=" << recall << "\n";
+    logOutput(ss.str());
+
+    monotonic &= recall + 1e-9 >= previous;
+    previous = recall;
+    best = recall;
+  }
+
+  result &= testResult("Recall does not drop as nprobe grows", monotonic,
+                       true);
+  // Probing every list is an exhaustive scan
+  result &= testResult("Probing all lists is exact", best >= 0.999, true);
+  return result;
+}
+
+bool testDeletesAndUpdates() {
+  logOutput("\n[Testing IVF deletes and updates]\n");
+
+  const size_t dimension = 8;
+  std::mt19937 rng(7);
+  auto data = clusteredData(500, dimension, 10, rng);
+
+  IvfParams params;
+  params.numLists = 16;
+  params.metric = Metric::Euclidean;
+  IvfIndex index(dimension, params);
+
+  bool threw = false;
+  try {
+    index.add(0, data[0].data());
+  } catch (const std::logic_error &) {
+    threw = true;
+  }
+  bool passed = testResult("Add before training throws", threw, true);
+
+  std::vector<float> flat;
+  for (const auto &v : data) {
+    flat.insert(flat.end(), v.begin(), v.end());
+  }
+  index.train(flat.data(), data.size(), dimension);
+  for (size_t i = 0; i < data.size(); ++i) {
+    index.add(static_cast<uint32_t>(i), data[i].data());
+  }
+  passed &= testResult("Index size", index.size(), data.size());
+  auto sizes = index.listSizes();
+  passed &= testResult("List sizes sum to index size",
+                       std::accumulate(sizes.begin(), sizes.end(), size_t(0)),
+                       data.size());
+
+  auto before = index.search(data[42].data(), 1, params.numLists);
+  passed &= testResult("Finds exact match",
+                       !before.empty() && before[0].label == 42, true);
+
+  passed &= testResult("Remove existing label", index.remove(42), true);
+  passed &= testResult("Remove unknown label", index.remove(42), false);
+  auto after = index.search(data[42].data(), 10, params.numLists);
+  bool found = false;
+  for (const auto &n : after) {
+    found |= n.label == 42;
+  }
+  passed &= testResult("Deleted label not returned", found, false);
+
+  // Re-adding a label moves it to the new vector
+  index.add(7, data[100].data());
+  auto moved = index.search(data[100].data(), 2, params.numLists);
+  bool hasMoved = false;
+  for (const auto &n : moved) {
+    hasMoved |= n.label == 7;
+  }
+  passed &= testResult("Re-added label found at new position", hasMoved, true);
+  passed &= testResult("Size unchanged by re-add", index.size(),
+                       data.size() - 1);
+
+  // The store keeps its index in sync with mutations
+  VectorStore store(dimension);
+  for (size_t i = 0; i < 100; ++i) {
+    store.addVector("v" + std::to_string(i), data[i]);
+  }
+  store.buildIvfIndex(params);
+  store.deleteVector("v0");
+  auto results = store.searchIvf(data[0], 1, params.numLists);
+  passed &= testResult("Store delete reaches index",
+                       results.size() == 1 && results[0].id != "v0", true);
+  store.updateVector("v1", data[200]);
+  results = store.searchIvf(data[200], 1, params.numLists);
+  passed &= testResult("Store update reaches index",
+                       results.size() == 1 && results[0].id == "v1" &&
+                           results[0].score < 1e-3f,
+                       true);
+
+  return passed;
+}
+
+bool testTrainingPool() {
+  logOutput("\n[Testing IVF training on a dedicated pool]\n");
+
+  const size_t dimension = 8;
+  std::mt19937 rng(11);
+  auto data = clusteredData(4096, dimension, 16, rng);
+  std::vector<float> flat;
+  for (const auto &v : data) {
+    flat.insert(flat.end(), v.begin(), v.end());
+  }
+
+  // Enough rows for k-means to split the work across the pool's threads
+  IvfParams params;
+  params.numLists = 16;
+  IvfIndex shared(dimension, params);
+  shared.train(flat.data(), data.size(), dimension);
+
+  ThreadPoolOptions options;
+  options.numThreads = 3;
+  params.kmeans.pool = std::make_shared<ThreadPool>(options);
+  IvfIndex pooled(dimension, params);
+  pooled.train(flat.data(), data.size(), dimension);
+
+  for (size_t i = 0; i < data.size(); ++i) {
+    shared.add(static_cast<uint32_t>(i), data[i].data());
+    pooled.add(static_cast<uint32_t>(i), data[i].data());
+  }
+  return testResult("Same partition as the shared pool",
+                    pooled.listSizes() == shared.listSizes(), true);
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("ivf_index_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("IVF Index Tests - " + std::string(std::ctime(&now)) + "\n");
+
+  bool allPassed = vectorsearch::testRecallVsNprobe() &
+                   vectorsearch::testDeletesAndUpdates() &
+                   vectorsearch::testTrainingPool();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
@@ -0,0 +1,259 @@
+// test/metrics_tests.cpp
+#include "common/histogram.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <thread>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+namespace {
+
+bool contains(const std::string &text, const std::string &needle) {
+  return text.find(needle) != std::string::npos;
+}
+
+} // anonymous namespace
+
+bool testHistogramBuckets() {
+  logOutput("\n[Testing histogram buckets]\n");
+
+  bool ordered = true;
+  bool roundTrips = true;
+  for (size_t i = 0; i < Histogram::kBucketCount; ++i) {
+    uint64_t lower = Histogram::bucketLowerBound(i);
+    uint64_t upper = Histogram::bucketUpperBound(i);
+    ordered &= lower <= upper;
+    if (i + 1 < Histogram::kBucketCount) {
+      ordered &= Histogram::bucketLowerBound(i + 1) == upper + 1;
+      roundTrips &= Histogram::bucketIndex(lower) == i &&
+                    Histogram::bucketIndex(upper) == i;
+    }
+  }
+  bool passed = testResult("Buckets are contiguous", ordered, true);
+  passed &= testResult("Bounds map back to their bucket", roundTrips, true);
+
+  // Relative bucket width bounds the error of any reported value
+  bool bounded = true;
+  for (size_t i = Histogram::kSubBuckets; i + 1 < Histogram::kBucketCount;
+       ++i) {
+    uint64_t lower = Histogram::bucketLowerBound(i);
+    uint64_t width = Histogram::bucketUpperBound(i) - lower + 1;
+    bounded &= width * Histogram::kSubBuckets <= lower;
+  }
+  passed &= testResult("Relative error bounded", bounded, true);
+  passed &= testResult("Huge values clamp to last bucket",
+                       Histogram::bucketIndex(~uint64_t(0)),
+                       Histogram::kBucketCount - 1);
+  return passed;
+}
+
+bool testHistogramPercentiles() {
+  logOutput("\n[Testing histogram percentiles]\n");
+
+  Histogram histogram;
+  bool passed = testResult("Empty percentile",
+                           histogram.snapshot().percentile(0.5), uint64_t(0));
+
+  for (uint64_t v = 1; v <= 10000; ++v) {
+    histogram.record(v);
+  }
+  HistogramSnapshot snapshot = histogram.snapshot();
+  passed &= testResult("Count", snapshot.count, uint64_t(10000));
+  passed &= testResult("Sum", snapshot.sum, uint64_t(10000) * 10001 / 2);
+  passed &= testResult("Mean", static_cast<float>(snapshot.mean()), 5000.5f);
+
+  // Reported quantiles overestimate by at most one bucket width
+  auto within = [](uint64_t actual, uint64_t expected) {
+    return actual >= expected &&
+           actual <= expected + expected / Histogram::kSubBuckets;
+  };
+  passed &= testResult("p50", within(snapshot.percentile(0.50), 5000), true);
+  passed &= testResult("p99", within(snapshot.percentile(0.99), 9900), true);
+  passed &= testResult("p100", within(snapshot.percentile(1.0), 10000), true);
+  passed &= testResult("Small values exact", snapshot.countAtMost(7),
+                       uint64_t(7));
+
+  histogram.reset();
+  passed &= testResult("Reset", histogram.snapshot().count, uint64_t(0));
+  return passed;
+}
+
+bool testHistogramConcurrency() {
+  logOutput("\n[Testing concurrent histogram recording]\n");
+
+  Histogram histogram;
+  const size_t threads = 8;
+  const size_t perThread = 20000;
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&histogram, t]() {
+      for (size_t i = 0; i < perThread; ++i) {
+        histogram.record(t * perThread + i);
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  HistogramSnapshot snapshot = histogram.snapshot();
+  const uint64_t n = threads * perThread;
+  bool passed = testResult("No lost records", snapshot.count, n);
+  passed &= testResult("Sum", snapshot.sum, n * (n - 1) / 2);
+  uint64_t bucketTotal = 0;
+  for (uint64_t count : snapshot.buckets) {
+    bucketTotal += count;
+  }
+  passed &= testResult("Buckets add up", bucketTotal, n);
+  return passed;
+}
+
+bool testStoreMetrics() {
+  logOutput("\n[Testing store operation metrics]\n");
+
+  const size_t dimension = 16;
+  std::mt19937 rng(11);
+  VectorStore store(dimension, Metric::Euclidean);
+  for (int i = 0; i < 300; ++i) {
+    store.addVector("v" + std::to_string(i), randomVector(dimension, rng));
+  }
+  store.updateVector("v1", randomVector(dimension, rng));
+  store.deleteVector("v2");
+  store.getVector("v3");
+  store.getVector("missing");
+
+  std::vector<float> query = randomVector(dimension, rng);
+  for (int i = 0; i < 5; ++i) {
+    store.search(query, 10, Metric::Euclidean);
+  }
+  HnswParams hnsw;
+  hnsw.metric = Metric::Euclidean;
+  store.enableHnswIndex(hnsw);
+  store.searchHnsw(query, 10);
+  IvfParams ivf;
+  ivf.metric = Metric::Euclidean;
+  ivf.numLists = 8;
+  ivf.nprobe = 2;
+  store.buildIvfIndex(ivf);
+  store.searchIvf(query, 10);
+
+  StoreMetricsSnapshot metrics = store.getMetrics();
+  bool passed = testResult("Adds counted", metrics[StoreOperation::Add].count,
+                           uint64_t(300));
+  passed &= testResult("Update counted",
+                       metrics[StoreOperation::Update].count, uint64_t(1));
+  passed &= testResult("Delete counted",
+                       metrics[StoreOperation::Delete].count, uint64_t(1));
+  passed &= testResult("Gets counted", metrics[StoreOperation::Get].count,
+                       uint64_t(2));
+  passed &= testResult("Searches counted",
+                       metrics[StoreOperation::Search].count, uint64_t(5));
+  passed &= testResult("Latency recorded",
+                       metrics[StoreOperation::Search].sum > 0, true);
+  passed &= testResult("Vectors gauge", metrics.vectors, size_t(299));
+
+  // Five flat scans of 299 rows, then the index searches
+  passed &= testResult("Distance samples",
+                       metrics.distanceComputations.count, uint64_t(7));
+  passed &= testResult("Nodes visited samples", metrics.nodesVisited.count,
+                       uint64_t(2));
+  passed &= testResult("Flat scan distances",
+                       metrics.distanceComputations.sum >= 5 * 299, true);
+  passed &= testResult("Lock acquisitions counted",
+                       metrics[StoreLock::Shared].count >= 8 &&
+                           metrics[StoreLock::Writer].count >= 302,
+                       true);
+
+  store.resetMetrics();
+  passed &= testResult("Reset", store.getMetrics()[StoreOperation::Add].count,
+                       uint64_t(0));
+  return passed;
+}
+
+bool testPersistenceMetrics() {
+  logOutput("\n[Testing persistence metrics]\n");
+
+  const std::string path = "metrics_tests.snap";
+  const size_t dimension = 8;
+  std::mt19937 rng(5);
+  VectorStore store(dimension);
+  for (int i = 0; i < 20; ++i) {
+    store.addVector("v" + std::to_string(i), randomVector(dimension, rng));
+  }
+  store.saveSnapshot(path);
+  auto loaded = VectorStore::loadSnapshot(path);
+  std::remove(path.c_str());
+
+  bool passed = testResult(
+      "Save counted", store.getMetrics()[StoreOperation::SaveSnapshot].count,
+      uint64_t(1));
+  passed &= testResult(
+      "Load counted",
+      loaded->getMetrics()[StoreOperation::LoadSnapshot].count, uint64_t(1));
+  return passed;
+}
+
+bool testPrometheusText() {
+  logOutput("\n[Testing Prometheus output]\n");
+
+  std::mt19937 rng(2);
+  VectorStore store(4);
+  store.addVector("a", randomVector(4, rng));
+  store.addVector("b", randomVector(4, rng));
+  store.search(randomVector(4, rng), 1);
+  std::string text = store.getMetricsText();
+
+  bool passed = testResult(
+      "Type line",
+      contains(text,
+               "# TYPE vectorsearch_operation_duration_seconds histogram\n"),
+      true);
+  passed &= testResult(
+      "Add count series",
+      contains(text, "vectorsearch_operation_duration_seconds_count"
+                     "{operation=\"add\"} 2\n"),
+      true);
+  passed &= testResult(
+      "Infinite bucket",
+      contains(text, "vectorsearch_operation_duration_seconds_bucket"
+                     "{operation=\"search\",le=\"+Inf\"} 1\n"),
+      true);
+  passed &= testResult("Lock series",
+                       contains(text, "vectorsearch_lock_wait_seconds_count"
+                                      "{lock=\"shared\"}"),
+                       true);
+  passed &= testResult("Distance series",
+                       contains(text, "vectorsearch_search_distance_"
+                                      "computations_sum 2\n"),
+                       true);
+  passed &= testResult("Gauge", contains(text, "vectorsearch_vectors 2\n"),
+                       true);
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("metrics_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Metrics Tests - " + std::string(std::ctime(&now)) + "\n");
+
+  bool allPassed = vectorsearch::testHistogramBuckets() &
+                   vectorsearch::testHistogramPercentiles() &
+                   vectorsearch::testHistogramConcurrency() &
+                   vectorsearch::testStoreMetrics() &
+                   vectorsearch::testPersistenceMetrics() &
+                   vectorsearch::testPrometheusText();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
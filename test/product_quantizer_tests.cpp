@@ -0,0 +1,179 @@
+// test/product_quantizer_tests.cpp
+#include "ann/product_quantizer.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <ctime>
+#include <random>
+#include <set>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+bool testEncodeAndAdc() {
+  logOutput("\n[Testing PQ encoding and ADC tables]\n");
+
+  const size_t dimension = 32;
+  const size_t rows = 1000;
+  std::mt19937 rng(3);
+  auto data = randomMatrix(rows, dimension, rng);
+
+  bool threw = false;
+  try {
+    PqParams bad;
+    bad.numSubspaces = 5;
+    ProductQuantizer invalid(dimension, bad);
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  bool passed = testResult("Subspaces must divide dimension", threw, true);
+
+  for (Metric metric :
+       {Metric::DotProduct, Metric::Euclidean, Metric::Cosine}) {
+    PqParams params;
+    params.metric = metric;
+    ProductQuantizer pq(dimension, params);
+    pq.train(data.data(), rows, dimension);
+    passed &= testResult("Trained", pq.isTrained(), true);
+
+    // ADC must equal the exact distance to the decoded reconstruction
+    std::vector<float> table(pq.codeSize() * ProductQuantizer::kCodebookSize);
+    const float *query = data.data();
+    pq.computeDistanceTable(query, table.data());
+    std::vector<float> normalizedQuery(query, query + dimension);
+    if (metric == Metric::Cosine) {
+      float norm = std::sqrt(VectorOps::dotProduct(query, query, dimension));
+      for (float &x : normalizedQuery) {
+        x /= norm;
+      }
+    }
+
+    std::vector<uint8_t> codes(pq.codeSize());
+    std::vector<float> decoded(dimension);
+    bool consistent = true;
+    for (size_t i = 1; i < 100; ++i) {
+      pq.encode(data.data() + i * dimension, codes.data());
+      pq.decode(codes.data(), decoded.data());
+      Metric exactMetric =
+          metric == Metric::Cosine ? Metric::DotProduct : metric;
+      float expected = VectorOps::distance(exactMetric, normalizedQuery.data(),
+                                           decoded.data(), dimension);
+      float adc = pq.adcDistance(table.data(), codes.data());
+      consistent &= std::fabs(expected - adc) < 1e-4f * (1.0f + std::fabs(adc));
+    }
+    passed &= testResult("ADC matches decoded distance (metric " +
+                             std::to_string(static_cast<int>(metric)) + ")",
+                         consistent, true);
+  }
+
+  return passed;
+}
+
+bool testPqSearch() {
+  logOutput("\n[Testing PQ search with reranking]\n");
+
+  const size_t dimension = 64;
+  const size_t numVectors = 4000;
+  const size_t numQueries = 50;
+  const size_t k = 10;
+  std::mt19937 rng(23);
+  auto data = randomMatrix(numVectors, dimension, rng);
+  auto queries = randomMatrix(numQueries, dimension, rng);
+
+  VectorStore store(dimension);
+  for (size_t i = 0; i < 100; ++i) {
+    store.addVector("v" + std::to_string(i),
+                    std::vector<float>(data.begin() + i * dimension,
+                                       data.begin() + (i + 1) * dimension));
+  }
+  bool threw = false;
+  try {
+    store.enablePqIndex();
+  } catch (const std::logic_error &) {
+    threw = true;
+  }
+  bool passed = testResult("Too few vectors to train", threw, true);
+
+  // Half of the vectors arrive after training and are encoded incrementally
+  for (size_t i = 100; i < numVectors / 2; ++i) {
+    store.addVector("v" + std::to_string(i),
+                    std::vector<float>(data.begin() + i * dimension,
+                                       data.begin() + (i + 1) * dimension));
+  }
+  PqParams params;
+  params.numSubspaces = 16;
+  params.metric = Metric::Euclidean;
+  store.enablePqIndex(params);
+  for (size_t i = numVectors / 2; i < numVectors; ++i) {
+    store.addVector("v" + std::to_string(i),
+                    std::vector<float>(data.begin() + i * dimension,
+                                       data.begin() + (i + 1) * dimension));
+  }
+  passed &= testResult("PQ index enabled", store.hasPqIndex(), true);
+
+  size_t rawHits = 0;
+  size_t rerankedHits = 0;
+  bool scoresExact = true;
+  for (size_t q = 0; q < numQueries; ++q) {
+    std::vector<float> query(queries.begin() + q * dimension,
+                             queries.begin() + (q + 1) * dimension);
+    auto exact = store.search(query, k, Metric::Euclidean);
+    auto raw = store.searchPq(query, k);
+    auto reranked = store.searchPq(query, k, 10);
+    std::set<std::string> truth;
+    for (const auto &r : exact) {
+      truth.insert(r.id);
+    }
+    for (const auto &r : raw) {
+      rawHits += truth.count(r.id);
+    }
+    for (const auto &r : reranked) {
+      rerankedHits += truth.count(r.id);
+    }
+    if (!reranked.empty() && reranked[0].id == exact[0].id) {
+      scoresExact &= isApproxEqual(reranked[0].score, exact[0].score);
+    }
+  }
+  double rawRecall = static_cast<double>(rawHits) / (numQueries * k);
+  double rerankedRecall = static_cast<double>(rerankedHits) / (numQueries * k);
+  std::ostringstream ss;
+  ss << "  recall@" << k << " ADC only=" << rawRecall
+     << " reranked x10=" << rerankedRecall << "\n";
+  logOutput(ss.str());
+  passed &= testResult("Reranking improves recall", rerankedRecall > rawRecall,
+                       true);
+  passed &= testResult("Reranked recall above 0.9", rerankedRecall >= 0.9,
+                       true);
+  passed &= testResult("Reranked scores are exact", scoresExact, true);
+
+  // Deleted vectors never come back
+  store.deleteVector("v0");
+  auto results = store.searchPq(
+      std::vector<float>(data.begin(), data.begin() + dimension), 5, 4);
+  bool deletedAbsent = true;
+  for (const auto &r : results) {
+    deletedAbsent &= r.id != "v0";
+  }
+  passed &= testResult("Deleted vector not returned", deletedAbsent, true);
+
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("product_quantizer_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Product Quantizer Tests - " + std::string(std::ctime(&now)) +
+            "\n");
+
+  bool allPassed =
+      vectorsearch::testEncodeAndAdc() & vectorsearch::testPqSearch();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
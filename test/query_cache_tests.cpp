@@ -0,0 +1,298 @@
+// test/query_cache_tests.cpp
+#include "engine/query_cache.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <atomic>
+#include <ctime>
+#include <random>
+#include <thread>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+namespace {
+
+bool sameResults(const std::vector<SearchResult> &a,
+                 const std::vector<SearchResult> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].id != b[i].id || a[i].score != b[i].score) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string makeKey(const QueryCache &cache, const std::vector<float> &query,
+                    size_t k = 10, const Filter *filter = nullptr) {
+  return cache.makeKey(0, 0, k, 0, query.data(), query.size(), filter);
+}
+
+} // anonymous namespace
+
+bool testCacheKeys() {
+  logOutput("\n[Testing cache keys]\n");
+
+  QueryCache cache;
+  std::vector<float> query = {0.5f, -1.25f, 3.0f, 0.0f};
+  std::vector<float> nudged = query;
+  for (float &x : nudged) {
+    x *= 1.0f + 1e-6f;
+  }
+  std::vector<float> moved = query;
+  moved[1] = -1.3f;
+  std::vector<float> negativeZero = query;
+  negativeZero[3] = -0.0f;
+
+  bool passed = testResult("Nearly equal queries share a key",
+                           makeKey(cache, query) == makeKey(cache, nudged),
+                           true);
+  passed &= testResult("Different queries differ",
+                       makeKey(cache, query) == makeKey(cache, moved), false);
+  passed &= testResult("Signed zeros share a key",
+                       makeKey(cache, query) == makeKey(cache, negativeZero),
+                       true);
+  passed &= testResult("k is part of the key",
+                       makeKey(cache, query, 10) == makeKey(cache, query, 11),
+                       false);
+  passed &= testResult("Metric is part of the key",
+                       cache.makeKey(0, 0, 10, 0, query.data(), 4, nullptr) ==
+                           cache.makeKey(0, 1, 10, 0, query.data(), 4,
+                                         nullptr),
+                       false);
+
+  Filter tenant = Filter::equals("tenant", "acme");
+  Filter other = Filter::equals("tenant", "other");
+  Filter numeric = Filter::equals("tenant", 1);
+  passed &= testResult("Filter is part of the key",
+                       makeKey(cache, query, 10, &tenant) ==
+                           makeKey(cache, query),
+                       false);
+  passed &= testResult("Equal filters share a key",
+                       makeKey(cache, query, 10, &tenant) ==
+                           makeKey(cache, query, 10, &tenant),
+                       true);
+  passed &= testResult("Filter values are compared",
+                       makeKey(cache, query, 10, &tenant) ==
+                           makeKey(cache, query, 10, &other),
+                       false);
+  passed &= testResult("Filter value types are compared",
+                       makeKey(cache, query, 10, &tenant) ==
+                           makeKey(cache, query, 10, &numeric),
+                       false);
+
+  QueryCacheOptions exact;
+  exact.mantissaBits = 23;
+  QueryCache exactCache(exact);
+  passed &= testResult("Full precision keys are exact",
+                       makeKey(exactCache, query) ==
+                           makeKey(exactCache, nudged),
+                       false);
+  return passed;
+}
+
+bool testCacheBounds() {
+  logOutput("\n[Testing cache bounds and versions]\n");
+
+  QueryCacheOptions options;
+  options.maxEntries = 4;
+  QueryCache cache(options);
+
+  std::mt19937 rng(3);
+  std::vector<std::vector<float>> queries;
+  for (int i = 0; i < 6; ++i) {
+    queries.push_back(randomVector(8, rng));
+  }
+  const std::vector<SearchResult> results = {{"a", 1.0f}, {"b", 0.5f}};
+
+  std::vector<SearchResult> found;
+  bool passed = testResult("Empty cache misses",
+                           cache.lookup(makeKey(cache, queries[0]), 1, found),
+                           false);
+  cache.insert(makeKey(cache, queries[0]), 1, results);
+  passed &= testResult("Inserted entry hits",
+                       cache.lookup(makeKey(cache, queries[0]), 1, found),
+                       true);
+  passed &= testResult("Hit returns the results", sameResults(found, results),
+                       true);
+  passed &= testResult("Newer version misses",
+                       cache.lookup(makeKey(cache, queries[0]), 2, found),
+                       false);
+  passed &= testResult("Stale entry is dropped", cache.stats().entries,
+                       size_t(0));
+
+  for (const std::vector<float> &query : queries) {
+    cache.insert(makeKey(cache, query), 2, results);
+  }
+  QueryCacheStats stats = cache.stats();
+  passed &= testResult("Entry bound holds", stats.entries <= 4, true);
+  passed &= testResult("Evictions counted", stats.evictions >= 2, true);
+  passed &= testResult("Memory reported", stats.bytes > 0, true);
+  passed &= testResult("Hit rate", static_cast<float>(stats.hitRate()),
+                       1.0f / 3.0f);
+
+  QueryCacheOptions tiny;
+  tiny.maxBytes = 64;
+  QueryCache small(tiny);
+  small.insert(makeKey(small, queries[0]), 1, results);
+  passed &= testResult("Oversized entries are not cached",
+                       small.stats().entries, size_t(0));
+
+  cache.clear();
+  passed &= testResult("Clear empties the cache", cache.stats().entries,
+                       size_t(0));
+  return passed;
+}
+
+bool testStoreCache() {
+  logOutput("\n[Testing cached store searches]\n");
+
+  const size_t dimension = 16;
+  VectorStore store(dimension, Metric::Cosine);
+  std::mt19937 rng(11);
+  for (int i = 0; i < 200; ++i) {
+    store.addVector("v" + std::to_string(i), randomVector(dimension, rng), "",
+                    "{\"group\": " + std::to_string(i % 4) + "}");
+  }
+  std::vector<float> query = randomVector(dimension, rng);
+
+  std::vector<SearchResult> uncached = store.search(query, 5);
+  store.enableQueryCache();
+  std::vector<SearchResult> first = store.search(query, 5);
+  std::vector<SearchResult> second = store.search(query, 5);
+  QueryCacheStats stats = store.getQueryCacheStats();
+  bool passed = testResult("Cached results match", sameResults(first, uncached),
+                           true);
+  passed &= testResult("Repeat is served from the cache",
+                       sameResults(second, first), true);
+  passed &= testResult("One miss, one hit",
+                       stats.misses == 1 && stats.hits == 1, true);
+
+  Filter group = Filter::equals("group", 2);
+  std::vector<SearchResult> filtered =
+      store.search(query, 5, Metric::Cosine, group);
+  bool allMatch = true;
+  for (const SearchResult &result : filtered) {
+    allMatch &= std::stoi(result.id.substr(1)) % 4 == 2;
+  }
+  passed &= testResult("Filtered search is keyed apart", allMatch, true);
+  store.search(query, 5, Metric::Euclidean);
+  passed &= testResult("Metric is keyed apart",
+                       store.getQueryCacheStats().misses, uint64_t(3));
+
+  // A new best match must show up right after it is added
+  std::vector<float> twin = query;
+  store.addVector("twin", twin);
+  passed &= testResult("Add invalidates", store.search(query, 5)[0].id,
+                       std::string("twin"));
+  twin[0] += 10.0f;
+  store.updateVector("twin", twin);
+  passed &= testResult("Update invalidates",
+                       store.search(query, 5)[0].id != "twin", true);
+  store.deleteVector(uncached[0].id);
+  passed &= testResult("Delete invalidates",
+                       store.search(query, 5)[0].id != uncached[0].id, true);
+
+  store.enableHnswIndex();
+  std::vector<SearchResult> hnsw = store.searchHnsw(query, 5, 64);
+  passed &= testResult("HNSW repeat hits",
+                       sameResults(store.searchHnsw(query, 5, 64), hnsw),
+                       true);
+  const uint64_t hits = store.getQueryCacheStats().hits;
+  store.searchHnsw(query, 5, 32);
+  passed &= testResult("efSearch is keyed apart",
+                       store.getQueryCacheStats().hits, hits);
+
+  passed &= testResult(
+      "Prometheus reports the cache",
+      store.getMetricsText().find("vectorsearch_query_cache_hits_total " +
+                                  std::to_string(hits)) != std::string::npos,
+      true);
+
+  store.clear();
+  passed &= testResult("Clear invalidates", store.search(query, 5).empty(),
+                       true);
+  passed &= testResult("Clear frees entries",
+                       store.getQueryCacheStats().entries <= 1, true);
+
+  store.disableQueryCache();
+  passed &= testResult("Disabled cache reports nothing",
+                       store.getQueryCacheStats().entries, size_t(0));
+  return passed;
+}
+
+bool testConcurrentLookups() {
+  logOutput("\n[Testing concurrent lookups]\n");
+
+  const size_t dimension = 16;
+  VectorStore store(dimension, Metric::Euclidean);
+  std::mt19937 rng(5);
+  std::vector<std::vector<float>> rows;
+  for (int i = 0; i < 500; ++i) {
+    rows.push_back(randomVector(dimension, rng));
+    store.addVector("v" + std::to_string(i), rows.back());
+  }
+  QueryCacheOptions options;
+  options.maxEntries = 16;
+  store.enableQueryCache(options);
+
+  // Readers search their own rows, which must always come back first, while
+  // a writer keeps bumping the version
+  std::atomic<bool> correct{true};
+  std::atomic<bool> stop{false};
+  std::thread writer([&]() {
+    std::mt19937 writerRng(9);
+    for (int i = 0; !stop.load(); ++i) {
+      store.addVector("w" + std::to_string(i),
+                      randomVector(dimension, writerRng));
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t]() {
+      for (int i = 0; i < 400; ++i) {
+        const int row = (t * 400 + i) % 32;
+        std::vector<SearchResult> results = store.search(rows[row], 1,
+                                                         Metric::Euclidean);
+        if (results.empty() || results[0].id != "v" + std::to_string(row)) {
+          correct = false;
+        }
+      }
+    });
+  }
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  stop = true;
+  writer.join();
+
+  QueryCacheStats stats = store.getQueryCacheStats();
+  bool passed = testResult("Concurrent results correct", correct.load(), true);
+  passed &= testResult("Every lookup counted", stats.hits + stats.misses,
+                       uint64_t(1600));
+  passed &= testResult("Entry bound holds", stats.entries <= 16, true);
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("query_cache_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Query Cache Tests - " + std::string(std::ctime(&now)) + "\n");
+
+  bool allPassed = vectorsearch::testCacheKeys() &
+                   vectorsearch::testCacheBounds() &
+                   vectorsearch::testStoreCache() &
+                   vectorsearch::testConcurrentLookups();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
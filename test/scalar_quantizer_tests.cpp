@@ -0,0 +1,210 @@
+// test/scalar_quantizer_tests.cpp
+#include "ann/scalar_quantizer.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <ctime>
+#include <random>
+#include <set>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+bool testEncodeDecode() {
+  logOutput("\n[Testing int8 encode/decode]\n");
+
+  const size_t dimension = 24;
+  const size_t rows = 200;
+  std::mt19937 rng(5);
+  auto data = randomMatrix(rows, dimension, rng);
+
+  ScalarQuantizer quantizer(dimension);
+  quantizer.train(data.data(), rows, dimension);
+  bool passed = testResult("Trained", quantizer.isTrained(), true);
+
+  // Every value must come back within half of its vector's step
+  bool withinStep = true;
+  std::vector<int8_t> codes(dimension);
+  std::vector<float> decoded(dimension);
+  for (size_t i = 0; i < rows; ++i) {
+    auto factors = quantizer.encode(data.data() + i * dimension, codes.data());
+    quantizer.decode(codes.data(), factors, decoded.data());
+    for (size_t d = 0; d < dimension; ++d) {
+      withinStep &= std::fabs(decoded[d] - data[i * dimension + d]) <=
+                    0.5f * factors.scale + 1e-6f;
+    }
+  }
+  passed &= testResult("Reconstruction error within half a step", withinStep,
+                       true);
+
+  // Approximate distances track the exact ones
+  auto query = quantizer.prepareQuery(data.data());
+  bool close = true;
+  for (size_t i = 1; i < rows; ++i) {
+    const float *row = data.data() + i * dimension;
+    auto factors = quantizer.encode(row, codes.data());
+    float norm = std::sqrt(VectorOps::dotProduct(row, row, dimension));
+    for (Metric metric :
+         {Metric::DotProduct, Metric::Euclidean, Metric::Cosine}) {
+      float exact = VectorOps::distance(metric, data.data(), row, dimension);
+      float approx =
+          quantizer.distance(metric, query, codes.data(), factors, norm);
+      close &= std::fabs(exact - approx) < 0.05f * (1.0f + std::fabs(exact));
+    }
+  }
+  passed &= testResult("Approximate distances close to exact", close, true);
+
+  return passed;
+}
+
+bool testQuantizedSearch() {
+  logOutput("\n[Testing quantized search with rescoring]\n");
+
+  const size_t dimension = 64;
+  const size_t numVectors = 4000;
+  const size_t numQueries = 50;
+  const size_t k = 10;
+  std::mt19937 rng(17);
+  auto data = randomMatrix(numVectors, dimension, rng);
+  auto queries = randomMatrix(numQueries, dimension, rng);
+
+  VectorStore store(dimension);
+  bool threw = false;
+  try {
+    store.enableScalarQuantization();
+  } catch (const std::logic_error &) {
+    threw = true;
+  }
+  bool passed = testResult("Empty store cannot be quantized", threw, true);
+
+  // Half of the vectors arrive after training and are encoded incrementally
+  for (size_t i = 0; i < numVectors / 2; ++i) {
+    store.addVector("v" + std::to_string(i),
+                    std::vector<float>(data.begin() + i * dimension,
+                                       data.begin() + (i + 1) * dimension));
+  }
+  store.enableScalarQuantization(1000);
+  for (size_t i = numVectors / 2; i < numVectors; ++i) {
+    store.addVector("v" + std::to_string(i),
+                    std::vector<float>(data.begin() + i * dimension,
+                                       data.begin() + (i + 1) * dimension));
+  }
+  passed &= testResult("Quantization enabled", store.hasScalarQuantization(),
+                       true);
+
+  for (Metric metric :
+       {Metric::DotProduct, Metric::Euclidean, Metric::Cosine}) {
+    size_t hits = 0;
+    bool scoresExact = true;
+    for (size_t q = 0; q < numQueries; ++q) {
+      std::vector<float> query(queries.begin() + q * dimension,
+                               queries.begin() + (q + 1) * dimension);
+      auto exact = store.search(query, k, metric);
+      auto approx = store.searchQuantized(query, k, metric, 4);
+      std::set<std::string> truth;
+      for (const auto &r : exact) {
+        truth.insert(r.id);
+      }
+      for (const auto &r : approx) {
+        hits += truth.count(r.id);
+      }
+      // Rescored results carry exact scores
+      if (!approx.empty() && !exact.empty() && approx[0].id == exact[0].id) {
+        scoresExact &= isApproxEqual(approx[0].score, exact[0].score);
+      }
+    }
+    double recall = static_cast<double>(hits) / (numQueries * k);
+    std::ostringstream ss;
+    ss << "  metric " << static_cast<int>(metric) << " recall@" << k << "="
+       << recall << "\n";
+    logOutput(ss.str());
+    passed &= testResult("Recall above 0.9 (metric " +
+                             std::to_string(static_cast<int>(metric)) + ")",
+                         recall >= 0.9, true);
+    passed &= testResult("Rescored scores are exact (metric " +
+                             std::to_string(static_cast<int>(metric)) + ")",
+                         scoresExact, true);
+  }
+
+  return passed;
+}
+
+bool testOutlierDimension() {
+  logOutput("\n[Testing quantized recall with an outlier dimension]\n");
+
+  // Embedding models often have a dimension that occasionally takes very
+  // large values. A step size sized for those rows would leave every other
+  // row with only a few int8 levels per dimension.
+  const size_t dimension = 64;
+  const size_t numVectors = 4000;
+  const size_t numQueries = 50;
+  const size_t k = 10;
+  const size_t outlier = 7;
+  std::mt19937 rng(29);
+  std::bernoulli_distribution rare(0.02);
+  auto withOutliers = [&](size_t rows) {
+    auto data = randomMatrix(rows, dimension, rng, 1.0f);
+    for (size_t i = 0; i < rows; ++i) {
+      if (rare(rng)) {
+        data[i * dimension + outlier] *= 40.0f;
+      }
+    }
+    return data;
+  };
+  auto data = withOutliers(numVectors);
+  auto queries = withOutliers(numQueries);
+
+  VectorStore store(dimension);
+  for (size_t i = 0; i < numVectors; ++i) {
+    store.addVector("v" + std::to_string(i),
+                    std::vector<float>(data.begin() + i * dimension,
+                                       data.begin() + (i + 1) * dimension));
+  }
+  store.enableScalarQuantization();
+
+  bool passed = true;
+  for (Metric metric : {Metric::DotProduct, Metric::Euclidean}) {
+    // No rescoring, so the ranking comes from the int8 codes alone
+    size_t hits = 0;
+    for (size_t q = 0; q < numQueries; ++q) {
+      std::vector<float> query(queries.begin() + q * dimension,
+                               queries.begin() + (q + 1) * dimension);
+      std::set<std::string> truth;
+      for (const auto &r : store.search(query, k, metric)) {
+        truth.insert(r.id);
+      }
+      for (const auto &r : store.searchQuantized(query, k, metric, 1)) {
+        hits += truth.count(r.id);
+      }
+    }
+    double recall = static_cast<double>(hits) / (numQueries * k);
+    std::ostringstream ss;
+    ss << "  metric " << static_cast<int>(metric) << " recall@" << k << "="
+       << recall << "\n";
+    logOutput(ss.str());
+    passed &= testResult("Unrescored recall above 0.9 (metric " +
+                             std::to_string(static_cast<int>(metric)) + ")",
+                         recall >= 0.9, true);
+  }
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("scalar_quantizer_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Scalar Quantizer Tests - " + std::string(std::ctime(&now)) +
+            "\n");
+
+  bool allPassed = vectorsearch::testEncodeDecode() &
+                   vectorsearch::testQuantizedSearch() &
+                   vectorsearch::testOutlierDimension();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
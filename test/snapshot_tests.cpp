@@ -0,0 +1,260 @@
+// test/snapshot_tests.cpp
+#include "common/crc32c.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <cstdio>
+#include <ctime>
+#include <random>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+namespace {
+
+const std::string kSnapshotPath = "snapshot_tests.snap";
+
+bool sameResults(const std::vector<VectorStore::SearchResult> &a,
+                 const std::vector<VectorStore::SearchResult> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].id != b[i].id || !isApproxEqual(a[i].score, b[i].score)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string readFile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+void writeFile(const std::string &path, const std::string &contents) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+bool loadFails(const std::string &path) {
+  try {
+    VectorStore::loadSnapshot(path);
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+bool testCrc32c() {
+  logOutput("\n[Testing CRC-32C]\n");
+
+  // Standard check value for "123456789"
+  const std::string check = "123456789";
+  bool passed = testResult("Check value", crc32c(check.data(), check.size()),
+                           0xE3069283u);
+  uint32_t split = crc32c(check.data() + 4, check.size() - 4,
+                          crc32c(check.data(), 4));
+  passed &= testResult("Incremental matches one-shot", split, 0xE3069283u);
+  return passed;
+}
+
+bool testRoundTrip() {
+  logOutput("\n[Testing snapshot round trip]\n");
+
+  const size_t dimension = 24;
+  const size_t numVectors = 600;
+  std::mt19937 rng(11);
+
+  VectorStore store(dimension);
+  for (size_t i = 0; i < numVectors; ++i) {
+    store.addVector("v" + std::to_string(i), randomVector(dimension, rng),
+                    "doc" + std::to_string(i % 7),
+                    i % 3 == 0 ? "" : "{\"n\":" + std::to_string(i) + "}");
+  }
+  store.deleteVector("v5");
+  store.deleteVector("v77");
+
+  HnswParams hnswParams;
+  hnswParams.metric = Metric::Euclidean;
+  store.enableHnswIndex(hnswParams);
+  IvfParams ivfParams;
+  ivfParams.numLists = 16;
+  store.buildIvfIndex(ivfParams);
+  store.enableScalarQuantization();
+  PqParams pqParams;
+  pqParams.numSubspaces = 6;
+  store.enablePqIndex(pqParams);
+  // Retired graph nodes whose rows were reused keep their own vectors
+  store.deleteVector("v11");
+  store.addVector("late", randomVector(dimension, rng));
+  store.updateVector("v12", randomVector(dimension, rng));
+
+  store.saveSnapshot(kSnapshotPath);
+  auto loaded = VectorStore::loadSnapshot(kSnapshotPath);
+
+  bool passed = testResult("Size preserved", loaded->size(), store.size());
+  passed &= testResult("Dimension preserved", loaded->getDimension(),
+                       dimension);
+  passed &= testResult("Deleted vector stays deleted",
+                       loaded->getVector("v5") == nullptr, true);
+
+  auto original = store.getVector("v42");
+  auto restored = loaded->getVector("v42");
+  passed &= testResult("Record restored",
+                       restored && restored->embedding == original->embedding &&
+                           restored->document_id == original->document_id &&
+                           restored->metadata == original->metadata,
+                       true);
+
+  passed &= testResult("Indexes restored",
+                       loaded->hasHnswIndex() && loaded->hasIvfIndex() &&
+                           loaded->hasScalarQuantization() &&
+                           loaded->hasPqIndex(),
+                       true);
+
+  bool sameSearch = true;
+  for (int q = 0; q < 10; ++q) {
+    auto query = randomVector(dimension, rng);
+    sameSearch &= sameResults(store.search(query, 10, Metric::Euclidean),
+                              loaded->search(query, 10, Metric::Euclidean));
+    sameSearch &= sameResults(store.searchHnsw(query, 10),
+                              loaded->searchHnsw(query, 10));
+    sameSearch &= sameResults(store.searchIvf(query, 10, 4),
+                              loaded->searchIvf(query, 10, 4));
+    sameSearch &= sameResults(store.searchQuantized(query, 10),
+                              loaded->searchQuantized(query, 10));
+    sameSearch &= sameResults(store.searchPq(query, 10),
+                              loaded->searchPq(query, 10));
+  }
+  passed &= testResult("Searches match the original store", sameSearch, true);
+
+  // The mapped store stays fully writable: updates touch private pages,
+  // adds reuse freed slots and then grow the arena onto the heap
+  auto replacement = randomVector(dimension, rng);
+  loaded->updateVector("v0", replacement);
+  for (size_t i = 0; i < 100; ++i) {
+    loaded->addVector("new" + std::to_string(i), randomVector(dimension, rng));
+  }
+  passed &= testResult("Writes after load", loaded->size(),
+                       store.size() + 100);
+  passed &= testResult("Update visible",
+                       loaded->getVector("v0")->embedding == replacement, true);
+  passed &= testResult("Pre-existing rows survive growth",
+                       loaded->getVector("v42")->embedding ==
+                           original->embedding,
+                       true);
+
+  auto reloaded = VectorStore::loadSnapshot(kSnapshotPath);
+  passed &= testResult("Snapshot file untouched by writes",
+                       reloaded->getVector("v0")->embedding ==
+                           store.getVector("v0")->embedding,
+                       true);
+
+  // The store metric and the cached norms of a Euclidean store survive
+  VectorStore euclidean(dimension, Metric::Euclidean);
+  for (size_t i = 0; i < 50; ++i) {
+    euclidean.addVector("e" + std::to_string(i), randomVector(dimension, rng));
+  }
+  euclidean.saveSnapshot(kSnapshotPath);
+  auto loadedEuclidean = VectorStore::loadSnapshot(kSnapshotPath);
+  auto query = randomVector(dimension, rng);
+  passed &= testResult("Store metric restored",
+                       loadedEuclidean->getMetric() == Metric::Euclidean &&
+                           sameResults(
+                               euclidean.search(query, 5, Metric::Euclidean),
+                               loadedEuclidean->search(query, 5,
+                                                       Metric::Euclidean)),
+                       true);
+
+  // Half-precision rows are written and mapped in their stored type
+  VectorStore bf16(dimension, Metric::Cosine, ElementType::BFloat16);
+  for (size_t i = 0; i < 50; ++i) {
+    bf16.addVector("h" + std::to_string(i), randomVector(dimension, rng));
+  }
+  bf16.saveSnapshot(kSnapshotPath);
+  auto loadedBf16 = VectorStore::loadSnapshot(kSnapshotPath);
+  passed &= testResult(
+      "Element type restored",
+      loadedBf16->getElementType() == ElementType::BFloat16 &&
+          loadedBf16->getVector("h7")->embedding ==
+              bf16.getVector("h7")->embedding &&
+          sameResults(bf16.search(query, 5, Metric::Cosine),
+                      loadedBf16->search(query, 5, Metric::Cosine)),
+      true);
+
+  // An empty store round-trips too
+  VectorStore empty(dimension);
+  empty.saveSnapshot(kSnapshotPath);
+  auto loadedEmpty = VectorStore::loadSnapshot(kSnapshotPath);
+  passed &= testResult("Empty store round trip", loadedEmpty->size(),
+                       size_t(0));
+  loadedEmpty->addVector("a", randomVector(dimension, rng));
+  passed &= testResult("Empty store writable", loadedEmpty->size(), size_t(1));
+
+  std::remove(kSnapshotPath.c_str());
+  return passed;
+}
+
+bool testCorruptionDetected() {
+  logOutput("\n[Testing truncated and corrupt snapshots]\n");
+
+  const size_t dimension = 16;
+  std::mt19937 rng(21);
+  VectorStore store(dimension);
+  for (size_t i = 0; i < 200; ++i) {
+    store.addVector("v" + std::to_string(i), randomVector(dimension, rng));
+  }
+  store.enableHnswIndex();
+  store.saveSnapshot(kSnapshotPath);
+  const std::string contents = readFile(kSnapshotPath);
+
+  bool passed = testResult("Missing file rejected",
+                           loadFails("does_not_exist.snap"), true);
+
+  writeFile(kSnapshotPath, contents.substr(0, contents.size() / 2));
+  passed &= testResult("Truncated file rejected", loadFails(kSnapshotPath),
+                       true);
+
+  writeFile(kSnapshotPath, contents.substr(0, 10));
+  passed &= testResult("Truncated header rejected", loadFails(kSnapshotPath),
+                       true);
+
+  std::string flipped = contents;
+  flipped[contents.size() / 2] ^= 0x40;
+  writeFile(kSnapshotPath, flipped);
+  passed &= testResult("Flipped byte fails checksum",
+                       loadFails(kSnapshotPath), true);
+
+  std::string badMagic = contents;
+  badMagic[0] = 'X';
+  writeFile(kSnapshotPath, badMagic);
+  passed &= testResult("Bad magic rejected", loadFails(kSnapshotPath), true);
+
+  writeFile(kSnapshotPath, contents);
+  passed &= testResult("Intact file loads", !loadFails(kSnapshotPath), true);
+
+  std::remove(kSnapshotPath.c_str());
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("snapshot_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Snapshot Tests - " + std::string(std::ctime(&now)) + "\n");
+
+  bool allPassed = vectorsearch::testCrc32c() &
+                   vectorsearch::testRoundTrip() &
+                   vectorsearch::testCorruptionDetected();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -43,6 +44,50 @@ inline std::string vecToString(const std::vector<float> &v) {
   return ss.str();
 }
 
+// Random data generators
+inline std::vector<float> randomVector(size_t dimension, std::mt19937 &rng,
+                                       float stddev = 1.0f) {
+  std::normal_distribution<float> dist(0.0f, stddev);
+  std::vector<float> v(dimension);
+  for (float &x : v) {
+    x = dist(rng);
+  }
+  return v;
+}
+
+// Row-major rows x dimension matrix of small Gaussian values.
+inline std::vector<float> randomMatrix(size_t rows, size_t dimension,
+                                       std::mt19937 &rng,
+                                       float stddev = 0.3f) {
+  return randomVector(rows * dimension, rng, stddev);
+}
+
+// Gaussian blobs around random centres, closer to real embeddings than
+// uniform noise.
+inline std::vector<std::vector<float>>
+clusteredData(size_t count, size_t dimension, size_t clusters,
+              std::mt19937 &rng) {
+  std::uniform_real_distribution<float> centre(-1.0f, 1.0f);
+  std::normal_distribution<float> noise(0.0f, 0.15f);
+
+  std::vector<std::vector<float>> centres(clusters,
+                                          std::vector<float>(dimension));
+  for (auto &c : centres) {
+    for (float &x : c) {
+      x = centre(rng);
+    }
+  }
+
+  std::vector<std::vector<float>> data(count, std::vector<float>(dimension));
+  for (size_t i = 0; i < count; ++i) {
+    const auto &c = centres[rng() % clusters];
+    for (size_t d = 0; d < dimension; ++d) {
+      data[i][d] = c[d] + noise(rng);
+    }
+  }
+  return data;
+}
+
 // Logging utilities
 inline void logOutput(const std::string &message) {
   std::cout << message;
@@ -0,0 +1,227 @@
+// test/thread_pool_tests.cpp
+#include "common/thread_pool.h"
+#include "engine/vector_store.h"
+#include "test_utils.h"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+bool testTasks() {
+  logOutput("\n[Testing task submission]\n");
+
+  ThreadPoolOptions options;
+  options.numThreads = 3;
+  ThreadPool pool(options);
+  bool passed = testResult("Configured size", pool.size(), size_t(3));
+
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit([i]() { return i * i; }));
+  }
+  bool values = true;
+  for (int i = 0; i < 100; ++i) {
+    values &= futures[i].get() == i * i;
+  }
+  passed &= testResult("Futures yield results", values, true);
+
+  std::future<void> failing =
+      pool.submit([]() { throw std::runtime_error("task failed"); });
+  bool threw = false;
+  try {
+    failing.get();
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  passed &= testResult("Futures rethrow exceptions", threw, true);
+
+  // Queued work still runs when the pool is destroyed
+  std::atomic<int> ran{0};
+  {
+    ThreadPool shortLived(options);
+    for (int i = 0; i < 50; ++i) {
+      shortLived.submit([&ran]() { ++ran; });
+    }
+  }
+  passed &= testResult("Destruction drains the queues", ran.load(), 50);
+  return passed;
+}
+
+bool testParallelFor() {
+  logOutput("\n[Testing parallelFor]\n");
+
+  ThreadPoolOptions options;
+  options.numThreads = 4;
+  ThreadPool pool(options);
+
+  const size_t count = 10007;
+  std::vector<std::atomic<int>> visits(count);
+  std::vector<std::atomic<int>> chunkRuns(64);
+  pool.parallelFor(count, 64, [&](size_t begin, size_t end, size_t chunk) {
+    ++chunkRuns[chunk];
+    for (size_t i = begin; i < end; ++i) {
+      ++visits[i];
+    }
+  });
+  bool once = true;
+  for (const auto &v : visits) {
+    once &= v.load() == 1;
+  }
+  bool everyChunk = true;
+  for (const auto &c : chunkRuns) {
+    everyChunk &= c.load() == 1;
+  }
+  bool passed = testResult("Every index visited once", once, true);
+  passed &= testResult("Every chunk run once", everyChunk, true);
+
+  std::atomic<size_t> calls{0};
+  pool.parallelFor(5, 100, [&](size_t begin, size_t end, size_t) {
+    calls += end - begin;
+  });
+  passed &= testResult("Chunks capped at the count", calls.load(), size_t(5));
+
+  bool threw = false;
+  try {
+    pool.parallelFor(1000, 100, [&](size_t begin, size_t, size_t) {
+      if (begin == 0) {
+        throw std::invalid_argument("chunk failed");
+      }
+    });
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  passed &= testResult("Exceptions reach the caller", threw, true);
+
+  // Nested loops inside pool tasks finish even when every worker is busy
+  ThreadPoolOptions small;
+  small.numThreads = 2;
+  ThreadPool busy(small);
+  std::atomic<size_t> total{0};
+  std::vector<std::future<void>> outer;
+  for (int t = 0; t < 8; ++t) {
+    outer.push_back(busy.submit([&]() {
+      busy.parallelFor(1000, 16, [&](size_t begin, size_t end, size_t) {
+        busy.parallelFor(end - begin, 4, [&](size_t b, size_t e, size_t) {
+          total += e - b;
+        });
+      });
+    }));
+  }
+  for (auto &f : outer) {
+    f.get();
+  }
+  passed &= testResult("Nested parallelFor completes", total.load(),
+                       size_t(8000));
+  return passed;
+}
+
+bool testWorkStealing() {
+  logOutput("\n[Testing work stealing]\n");
+
+  ThreadPoolOptions options;
+  options.numThreads = 4;
+  options.pinThreads = true;
+  ThreadPool pool(options);
+
+  // Subtasks posted from a worker land in its own deque; while it waits for
+  // them they can only run if other workers steal them
+  std::future<bool> result = pool.submit([&pool]() {
+    std::atomic<int> done{0};
+    std::mutex mutex;
+    std::condition_variable allDone;
+    for (int i = 0; i < 3; ++i) {
+      pool.submit([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++done;
+        allDone.notify_all();
+      });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    return allDone.wait_for(lock, std::chrono::seconds(10),
+                            [&]() { return done.load() == 3; });
+  });
+  return testResult("Idle workers steal queued tasks", result.get(), true);
+}
+
+bool testStorePool() {
+  logOutput("\n[Testing store searches on a pool]\n");
+
+  const size_t dimension = 32;
+  VectorStore store(dimension, Metric::Euclidean);
+  std::mt19937 rng(7);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  std::vector<std::vector<float>> rows(40000, std::vector<float>(dimension));
+  for (size_t i = 0; i < rows.size(); ++i) {
+    for (float &x : rows[i]) {
+      x = dist(rng);
+    }
+    store.addVector("v" + std::to_string(i), rows[i]);
+  }
+
+  bool passed = testResult("Stores start on the shared pool",
+                           store.threadPool() == ThreadPool::shared(), true);
+
+  ThreadPoolOptions options;
+  options.numThreads = 4;
+  auto pool = std::make_shared<ThreadPool>(options);
+  store.setThreadPool(pool);
+  passed &= testResult("Store uses the given pool",
+                       store.threadPool() == pool, true);
+
+  // Several clients scanning at once share the pool's four workers
+  std::atomic<bool> correct{true};
+  std::vector<std::thread> clients;
+  for (int t = 0; t < 4; ++t) {
+    clients.emplace_back([&, t]() {
+      for (int i = 0; i < 10; ++i) {
+        const size_t row = static_cast<size_t>(t * 1000 + i * 37);
+        auto results = store.search(rows[row], 1, Metric::Euclidean);
+        if (results.empty() || results[0].id != "v" + std::to_string(row)) {
+          correct = false;
+        }
+      }
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  passed &= testResult("Concurrent pooled scans correct", correct.load(),
+                       true);
+
+  store.setThreadPool(nullptr);
+  passed &= testResult("nullptr restores the shared pool",
+                       store.threadPool() == ThreadPool::shared(), true);
+
+  ThreadPoolOptions resized;
+  resized.numThreads = 2;
+  ThreadPool::configureShared(resized);
+  passed &= testResult("Shared pool reconfigured",
+                       ThreadPool::shared()->size(), size_t(2));
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("thread_pool_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Thread Pool Tests - " + std::string(std::ctime(&now)) + "\n");
+
+  bool allPassed = vectorsearch::testTasks() &
+                   vectorsearch::testParallelFor() &
+                   vectorsearch::testWorkStealing() &
+                   vectorsearch::testStorePool();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}
@@ -4,6 +4,8 @@
 #include <cmath>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <random>
 #include <vector>
 
 std::ofstream test_utils::logfile;
@@ -68,7 +70,297 @@ bool testNormalize() {
                     {1.0f / norm, 2.0f / norm, 3.0f / norm}) &
          testResult("Zero vector normalization",
                     VectorOps::normalize({0.0f, 0.0f, 0.0f}),
-                    {0.0f, 0.0f, 0.0f});
+                    {0.0f, 0.0f, 0.0f}) &
+         testResult("In-place normalization",
+                    [&]() {
+                      std::vector<float> v = v1;
+                      VectorOps::normalize(v.data(), v.size());
+                      return v;
+                    }(),
+                    {1.0f / norm, 2.0f / norm, 3.0f / norm});
+}
+
+bool testSimdKernels() {
+  logOutput("\n[Testing SIMD kernels against scalar]\n");
+  logOutput(std::string("Active kernel set: ") +
+            VectorOps::simdLevelName(VectorOps::simdLevel()) + "\n");
+
+  const SimdLevel original = VectorOps::simdLevel();
+  // Odd sizes exercise the remainder/masked tails of every kernel.
+  const std::vector<size_t> dimensions = {1, 3, 7, 8, 15, 16, 17, 31, 33,
+                                          100, 128, 384, 1536};
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+  bool passed = true;
+  for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512}) {
+    if (!VectorOps::isSimdLevelSupported(level)) {
+      logOutput(std::string("Skipping unsupported level: ") +
+                VectorOps::simdLevelName(level) + "\n");
+      continue;
+    }
+
+    bool levelPassed = true;
+    for (size_t dim : dimensions) {
+      std::vector<float> a(dim);
+      std::vector<float> b(dim);
+      for (size_t i = 0; i < dim; ++i) {
+        a[i] = dist(rng);
+        b[i] = dist(rng);
+      }
+
+      VectorOps::setSimdLevel(SimdLevel::Scalar);
+      float dotRef = VectorOps::dotProduct(a.data(), b.data(), dim);
+      float l2Ref = VectorOps::euclideanDistance(a.data(), b.data(), dim);
+      float cosRef = VectorOps::cosineSimilarity(a.data(), b.data(), dim);
+      std::vector<int8_t> ia(dim);
+      std::vector<int8_t> ib(dim);
+      for (size_t i = 0; i < dim; ++i) {
+        ia[i] = static_cast<int8_t>(a[i] * 127.0f);
+        ib[i] = static_cast<int8_t>(b[i] * 127.0f);
+      }
+      int32_t dotInt8Ref = VectorOps::dotProductInt8(ia.data(), ib.data(), dim);
+
+      VectorOps::setSimdLevel(level);
+      // Summation order differs between kernels, so allow a tolerance that
+      // grows with the dimension.
+      float tolerance = 1e-5f * static_cast<float>(dim) + 1e-5f;
+      levelPassed &= isApproxEqual(
+          VectorOps::dotProduct(a.data(), b.data(), dim), dotRef, tolerance);
+      levelPassed &= isApproxEqual(
+          VectorOps::euclideanDistance(a.data(), b.data(), dim), l2Ref,
+          tolerance);
+      levelPassed &= isApproxEqual(
+          VectorOps::cosineSimilarity(a.data(), b.data(), dim), cosRef,
+          tolerance);
+      // The integer kernel must match exactly
+      levelPassed &=
+          VectorOps::dotProductInt8(ia.data(), ib.data(), dim) == dotInt8Ref;
+    }
+
+    // Block kernel: uneven query/row counts hit every edge of the tiling
+    const size_t dim = 37;
+    const size_t numQueries = 7;
+    const size_t numRows = 11;
+    const size_t rowStride = 48;
+    std::vector<float> queries(numQueries * dim);
+    std::vector<float> rows(numRows * rowStride);
+    for (float &x : queries) {
+      x = dist(rng);
+    }
+    for (float &x : rows) {
+      x = dist(rng);
+    }
+    std::vector<float> scores(numQueries * numRows);
+    VectorOps::dotProductBlock(queries.data(), numQueries, dim, rows.data(),
+                               numRows, rowStride, dim, scores.data());
+    VectorOps::setSimdLevel(SimdLevel::Scalar);
+    for (size_t q = 0; q < numQueries; ++q) {
+      for (size_t r = 0; r < numRows; ++r) {
+        float expected = VectorOps::dotProduct(queries.data() + q * dim,
+                                               rows.data() + r * rowStride, dim);
+        levelPassed &= isApproxEqual(scores[q * numRows + r], expected, 1e-4f);
+      }
+    }
+
+    passed &= testResult(std::string("Kernels match scalar (") +
+                             VectorOps::simdLevelName(level) + ")",
+                         levelPassed, true);
+  }
+
+  VectorOps::setSimdLevel(original);
+  return passed;
+}
+
+bool testHalfPrecision() {
+  logOutput("\n[Testing half-precision conversions and kernels]\n");
+
+  const SimdLevel original = VectorOps::simdLevel();
+  VectorOps::setSimdLevel(SimdLevel::Scalar);
+
+  // Known encodings: rounding, overflow and the subnormal range
+  const std::vector<float> values = {
+      1.0f, -2.0f, 65504.0f, 65520.0f, 1.0f / 16777216.0f, 0.1f,
+      1.0f + 1.0f / 2048.0f};
+  const std::vector<uint16_t> expectedHalf = {0x3C00, 0xC000, 0x7BFF, 0x7C00,
+                                              0x0001, 0x2E66, 0x3C00};
+  std::vector<uint16_t> half(values.size());
+  VectorOps::toFloat16(values.data(), half.data(), values.size());
+  bool passed = testResult("fp16 encodings", half == expectedHalf, true);
+
+  const std::vector<float> bfValues = {1.0f, 0.1f, -3.0f,
+                                       1.0f + 1.0f / 256.0f};
+  const std::vector<uint16_t> expectedBf = {0x3F80, 0x3DCD, 0xC040, 0x3F80};
+  std::vector<uint16_t> bf(bfValues.size());
+  VectorOps::toBFloat16(bfValues.data(), bf.data(), bfValues.size());
+  passed &= testResult("bf16 encodings", bf == expectedBf, true);
+
+  // Every non-NaN fp16 value survives a round trip through fp32
+  std::vector<uint16_t> all;
+  for (uint32_t bits = 0; bits <= 0xFFFF; ++bits) {
+    if ((bits & 0x7C00) != 0x7C00 || (bits & 0x3FF) == 0) {
+      all.push_back(static_cast<uint16_t>(bits));
+    }
+  }
+  std::vector<float> widened(all.size());
+  std::vector<uint16_t> narrowed(all.size());
+  VectorOps::fromFloat16(all.data(), widened.data(), all.size());
+  VectorOps::toFloat16(widened.data(), narrowed.data(), all.size());
+  passed &= testResult("fp16 round trip", narrowed == all, true);
+
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> samples(1000);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    // Include magnitudes down in the fp16 subnormal range
+    samples[i] = dist(rng) * std::ldexp(1.0f, -static_cast<int>(i % 28));
+  }
+  std::vector<uint16_t> scalarHalf(samples.size());
+  VectorOps::toFloat16(samples.data(), scalarHalf.data(), samples.size());
+
+  const std::vector<size_t> dimensions = {1, 7, 8, 15, 16, 17, 33, 100, 384};
+  for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512}) {
+    if (!VectorOps::isSimdLevelSupported(level)) {
+      continue;
+    }
+
+    bool levelPassed = true;
+    VectorOps::setSimdLevel(level);
+    std::vector<uint16_t> simdHalf(samples.size());
+    VectorOps::toFloat16(samples.data(), simdHalf.data(), samples.size());
+    levelPassed &= simdHalf == scalarHalf;
+    std::vector<float> simdWidened(all.size());
+    VectorOps::fromFloat16(all.data(), simdWidened.data(), all.size());
+    levelPassed &= simdWidened == widened;
+
+    for (size_t dim : dimensions) {
+      std::vector<float> query(dim);
+      std::vector<float> row(dim);
+      for (size_t i = 0; i < dim; ++i) {
+        query[i] = dist(rng);
+        row[i] = dist(rng);
+      }
+      std::vector<uint16_t> rowHalf(dim);
+      std::vector<uint16_t> rowBf(dim);
+      VectorOps::setSimdLevel(SimdLevel::Scalar);
+      VectorOps::toFloat16(row.data(), rowHalf.data(), dim);
+      VectorOps::toBFloat16(row.data(), rowBf.data(), dim);
+      float halfRef = VectorOps::dotProductFloat16(query.data(),
+                                                   rowHalf.data(), dim);
+      float bfRef =
+          VectorOps::dotProductBFloat16(query.data(), rowBf.data(), dim);
+
+      VectorOps::setSimdLevel(level);
+      float tolerance = 1e-5f * static_cast<float>(dim) + 1e-5f;
+      levelPassed &= isApproxEqual(
+          VectorOps::dotProductFloat16(query.data(), rowHalf.data(), dim),
+          halfRef, tolerance);
+      levelPassed &= isApproxEqual(
+          VectorOps::dotProductBFloat16(query.data(), rowBf.data(), dim),
+          bfRef, tolerance);
+    }
+
+    passed &= testResult(std::string("Half kernels match scalar (") +
+                             VectorOps::simdLevelName(level) + ")",
+                         levelPassed, true);
+  }
+
+  // Widened rows stay close to the fp32 dot product
+  const size_t dim = 256;
+  std::vector<float> query(dim);
+  std::vector<float> row(dim);
+  for (size_t i = 0; i < dim; ++i) {
+    query[i] = dist(rng);
+    row[i] = dist(rng);
+  }
+  std::vector<uint16_t> rowHalf(dim);
+  std::vector<uint16_t> rowBf(dim);
+  VectorOps::toFloat16(row.data(), rowHalf.data(), dim);
+  VectorOps::toBFloat16(row.data(), rowBf.data(), dim);
+  float exact = VectorOps::dotProduct(query.data(), row.data(), dim);
+  passed &= testResult(
+      "fp16 dot close to fp32",
+      isApproxEqual(VectorOps::dotProductFloat16(query.data(), rowHalf.data(),
+                                                 dim),
+                    exact, 1e-2f),
+      true);
+  passed &= testResult(
+      "bf16 dot close to fp32",
+      isApproxEqual(VectorOps::dotProductBFloat16(query.data(), rowBf.data(),
+                                                  dim),
+                    exact, 1e-1f),
+      true);
+
+  VectorOps::setSimdLevel(original);
+  return passed;
+}
+
+bool testSpecializedKernels() {
+  logOutput("\n[Testing dimension-specialized kernels]\n");
+
+  const SimdLevel original = VectorOps::simdLevel();
+  std::mt19937 rng(13);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+  std::vector<size_t> dimensions(std::begin(VectorOps::kSpecializedDimensions),
+                                 std::end(VectorOps::kSpecializedDimensions));
+  dimensions.push_back(100); // generic fallback
+  bool passed = testResult("Other dimensions fall back",
+                           VectorOps::hasSpecializedKernels(100), false);
+
+  for (SimdLevel level :
+       {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+    if (!VectorOps::isSimdLevelSupported(level)) {
+      continue;
+    }
+    VectorOps::setSimdLevel(level);
+
+    bool levelPassed = true;
+    for (size_t dim : dimensions) {
+      std::vector<float> a(dim);
+      std::vector<float> b(dim);
+      for (size_t i = 0; i < dim; ++i) {
+        a[i] = dist(rng);
+        b[i] = dist(rng);
+      }
+      std::vector<uint16_t> bHalf(dim);
+      std::vector<uint16_t> bBf(dim);
+      VectorOps::toFloat16(b.data(), bHalf.data(), dim);
+      VectorOps::toBFloat16(b.data(), bBf.data(), dim);
+
+      const float tolerance = 1e-5f * static_cast<float>(dim) + 1e-5f;
+      for (Metric metric :
+           {Metric::DotProduct, Metric::Euclidean, Metric::Cosine}) {
+        levelPassed &= isApproxEqual(
+            VectorOps::distanceKernel(metric, dim)(a.data(), b.data(), dim),
+            VectorOps::distance(metric, a.data(), b.data(), dim), tolerance);
+      }
+      levelPassed &= isApproxEqual(
+          VectorOps::rowDotKernel(ElementType::Float32, dim)(a.data(), b.data(),
+                                                             dim),
+          VectorOps::dotProduct(a.data(), b.data(), dim), tolerance);
+      levelPassed &= isApproxEqual(
+          VectorOps::rowDotKernel(ElementType::Float16, dim)(
+              a.data(), bHalf.data(), dim),
+          VectorOps::dotProductFloat16(a.data(), bHalf.data(), dim),
+          tolerance);
+      levelPassed &= isApproxEqual(
+          VectorOps::rowDotKernel(ElementType::BFloat16, dim)(
+              a.data(), bBf.data(), dim),
+          VectorOps::dotProductBFloat16(a.data(), bBf.data(), dim), tolerance);
+    }
+
+    passed &= testResult(std::string("Specialized kernels match generic (") +
+                             VectorOps::simdLevelName(level) + ")",
+                         levelPassed, true);
+    passed &= testResult(std::string("768 is specialized (") +
+                             VectorOps::simdLevelName(level) + ")",
+                         VectorOps::hasSpecializedKernels(768),
+                         level != SimdLevel::Scalar);
+  }
+
+  VectorOps::setSimdLevel(original);
+  return passed;
 }
 
 } // namespace vectorsearch
@@ -82,7 +374,9 @@ int main() {
 
   bool allPassed =
       vectorsearch::testDotProduct() & vectorsearch::testEuclideanDistance() &
-      vectorsearch::testCosineSimilarity() & vectorsearch::testNormalize();
+      vectorsearch::testCosineSimilarity() & vectorsearch::testNormalize() &
+      vectorsearch::testSimdKernels() & vectorsearch::testHalfPrecision() &
+      vectorsearch::testSpecializedKernels();
 
   logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
   logfile.close();
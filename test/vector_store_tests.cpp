@@ -1,8 +1,15 @@
 // test/vector_store_tests.cpp
+#include "engine/embedding_arena.h"
 #include "engine/vector_store.h"
 #include "test_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <ctime>
+#include <random>
+#include <stdexcept>
 #include <thread>
+#include <unordered_map>
 
 std::ofstream test_utils::logfile;
 
@@ -145,6 +152,235 @@ bool testMultipleVectors() {
   return passed;
 }
 
+bool testArenaStorage() {
+  logOutput("\n[Testing arena-backed storage]\n");
+
+  const size_t dimension = 5;
+  VectorStore store(dimension);
+
+  // Enough vectors to force the arena to grow several times
+  const size_t numVectors = 1000;
+  for (size_t i = 0; i < numVectors; ++i) {
+    store.addVector("vec" + std::to_string(i),
+                    std::vector<float>(dimension, static_cast<float>(i)));
+  }
+
+  bool intact = true;
+  for (size_t i = 0; i < numVectors; ++i) {
+    auto vector = store.getVector("vec" + std::to_string(i));
+    intact &= vector != nullptr &&
+              vector->embedding ==
+                  std::vector<float>(dimension, static_cast<float>(i));
+  }
+  bool passed = testResult("Embeddings intact after growth", intact, true);
+
+  // Deleting and re-adding reuses freed slots without disturbing neighbours
+  for (size_t i = 0; i < numVectors; i += 2) {
+    store.deleteVector("vec" + std::to_string(i));
+  }
+  for (size_t i = 0; i < numVectors / 2; ++i) {
+    store.addVector("new" + std::to_string(i),
+                    std::vector<float>(dimension, -static_cast<float>(i)),
+                    "doc" + std::to_string(i));
+  }
+  passed &= testResult("Size after delete and re-add", store.size(), numVectors);
+
+  intact = true;
+  for (size_t i = 1; i < numVectors; i += 2) {
+    auto vector = store.getVector("vec" + std::to_string(i));
+    intact &= vector != nullptr &&
+              vector->embedding ==
+                  std::vector<float>(dimension, static_cast<float>(i));
+  }
+  for (size_t i = 0; i < numVectors / 2; ++i) {
+    auto vector = store.getVector("new" + std::to_string(i));
+    intact &= vector != nullptr &&
+              vector->embedding ==
+                  std::vector<float>(dimension, -static_cast<float>(i)) &&
+              vector->document_id == "doc" + std::to_string(i) &&
+              vector->metadata.empty();
+  }
+  passed &= testResult("Records intact after slot reuse", intact, true);
+
+  // Clearing an arena that serves adopted rows lets go of their owner, and
+  // later rows go to the heap rather than into the adopted buffer
+  EmbeddingArena arena(dimension);
+  auto owner = std::make_shared<std::vector<float>>(4 * arena.stride() +
+                                                    EmbeddingArena::kAlignment);
+  void *rows = owner->data();
+  size_t space = owner->size() * sizeof(float);
+  std::align(EmbeddingArena::kAlignment, 4 * arena.rowBytes(), rows, space);
+  arena.adopt(owner, rows, 4, {});
+  arena.clear();
+  passed &= testResult("Clear releases adopted rows",
+                       owner.use_count() == 1 && arena.capacity() == 0,
+                       true);
+  const std::vector<float> values(dimension, 3.0f);
+  uint32_t slot = arena.allocateRow();
+  arena.store(slot, values.data());
+  passed &= testResult("Rows after clear live on the heap",
+                       arena.rowData(slot) != rows &&
+                           std::equal(values.begin(), values.end(),
+                                      arena.row(slot)),
+                       true);
+
+  return passed;
+}
+
+bool testSearch() {
+  logOutput("\n[Testing exact top-k search]\n");
+
+  const size_t dimension = 2;
+  VectorStore store(dimension);
+  store.addVector("east", {1.0f, 0.0f});
+  store.addVector("north", {0.0f, 1.0f});
+  store.addVector("far_east", {10.0f, 0.0f});
+  store.addVector("west", {-1.0f, 0.0f});
+
+  const std::vector<float> query = {2.0f, 0.1f};
+
+  auto dot = store.search(query, 2, Metric::DotProduct);
+  bool passed = testResult("Dot product result count", dot.size(),
+                           static_cast<size_t>(2));
+  if (dot.size() == 2) {
+    passed &= testResult("Dot product best match", dot[0].id,
+                         std::string("far_east"));
+    passed &= testResult("Dot product best score", dot[0].score, 20.0f);
+    passed &= testResult("Dot product second match", dot[1].id,
+                         std::string("east"));
+  }
+
+  auto l2 = store.search(query, 1, Metric::Euclidean);
+  if (!l2.empty()) {
+    passed &= testResult("Euclidean best match", l2[0].id, std::string("east"));
+    passed &= testResult("Euclidean best score", l2[0].score,
+                         std::sqrt(1.0f + 0.01f));
+  }
+
+  auto cosine = store.search(query, 4, Metric::Cosine);
+  passed &= testResult("Cosine returns all vectors", cosine.size(),
+                       static_cast<size_t>(4));
+  if (cosine.size() == 4) {
+    passed &= testResult("Cosine worst match", cosine[3].id,
+                         std::string("west"));
+  }
+
+  passed &= testResult("k larger than store is clamped",
+                       store.search(query, 10).size(), static_cast<size_t>(4));
+  passed &= testResult("k of zero returns nothing",
+                       store.search(query, 0).size(), static_cast<size_t>(0));
+
+  auto inPlace = store.search(query.data(), 2, Metric::DotProduct);
+  passed &= testResult("Pointer query matches vector query",
+                       inPlace.size() == dot.size() &&
+                           std::equal(inPlace.begin(), inPlace.end(),
+                                      dot.begin(),
+                                      [](const auto &a, const auto &b) {
+                                        return a.id == b.id &&
+                                               a.score == b.score;
+                                      }),
+                       true);
+
+  // A store big enough to be split across worker threads must agree with a
+  // straightforward brute-force ranking.
+  const size_t bigDimension = 16;
+  const size_t numVectors = 50000;
+  const size_t k = 10;
+  VectorStore big(bigDimension);
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<std::vector<float>> embeddings(numVectors);
+  for (size_t i = 0; i < numVectors; ++i) {
+    embeddings[i].resize(bigDimension);
+    for (float &x : embeddings[i]) {
+      x = dist(rng);
+    }
+    big.addVector("v" + std::to_string(i), embeddings[i]);
+  }
+  std::vector<float> bigQuery(bigDimension);
+  for (float &x : bigQuery) {
+    x = dist(rng);
+  }
+
+  std::vector<std::pair<float, size_t>> expected;
+  for (size_t i = 0; i < numVectors; ++i) {
+    expected.emplace_back(VectorOps::euclideanDistance(bigQuery, embeddings[i]),
+                          i);
+  }
+  std::partial_sort(expected.begin(), expected.begin() + k, expected.end());
+
+  auto results = big.search(bigQuery, k, Metric::Euclidean);
+  bool matches = results.size() == k;
+  for (size_t i = 0; matches && i < k; ++i) {
+    matches = results[i].id == "v" + std::to_string(expected[i].second);
+  }
+  passed &= testResult("Parallel search matches brute force", matches, true);
+
+  bool wrongDimension = false;
+  try {
+    big.search({1.0f}, k);
+  } catch (const std::invalid_argument &) {
+    wrongDimension = true;
+  }
+  passed &= testResult("Exception on wrong query dimension", wrongDimension,
+                       true);
+
+  return passed;
+}
+
+bool testBatchSearch() {
+  logOutput("\n[Testing batched search]\n");
+
+  const size_t dimension = 37;
+  const size_t numVectors = 3000;
+  const size_t numQueries = 9;
+  const size_t k = 5;
+  VectorStore store(dimension);
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (size_t i = 0; i < numVectors; ++i) {
+    std::vector<float> embedding(dimension);
+    for (float &x : embedding) {
+      x = dist(rng);
+    }
+    store.addVector("v" + std::to_string(i), embedding);
+  }
+  // Free a few rows so the batch path has to skip them
+  for (size_t i = 0; i < numVectors; i += 97) {
+    store.deleteVector("v" + std::to_string(i));
+  }
+
+  std::vector<float> queries(numQueries * dimension);
+  for (float &x : queries) {
+    x = dist(rng);
+  }
+
+  bool passed = true;
+  for (Metric metric :
+       {Metric::DotProduct, Metric::Euclidean, Metric::Cosine}) {
+    auto batch = store.searchBatch(queries.data(), numQueries, k, metric);
+    bool matches = batch.size() == numQueries;
+    for (size_t q = 0; matches && q < numQueries; ++q) {
+      std::vector<float> query(queries.begin() + q * dimension,
+                               queries.begin() + (q + 1) * dimension);
+      auto single = store.search(query, k, metric);
+      matches = batch[q].size() == single.size();
+      for (size_t i = 0; matches && i < single.size(); ++i) {
+        matches = batch[q][i].id == single[i].id &&
+                  isApproxEqual(batch[q][i].score, single[i].score, 1e-3f);
+      }
+    }
+    passed &= testResult("Batch matches single-query search (metric " +
+                             std::to_string(static_cast<int>(metric)) + ")",
+                         matches, true);
+  }
+
+  passed &= testResult("Empty batch returns nothing",
+                       store.searchBatch(queries.data(), 0, k).size(),
+                       static_cast<size_t>(0));
+  return passed;
+}
+
 bool testDimensionCheck() {
   logOutput("\n[Testing dimension validation]\n");
 
@@ -203,6 +439,820 @@ bool testThreadSafety() {
   return passed;
 }
 
+bool testConcurrentReadsDuringWrites() {
+  logOutput("\n[Testing reads concurrent with writes]\n");
+
+  // Every embedding is constant, so a reader that observed a half-written
+  // row would see mixed components
+  const size_t dimension = 16;
+  const int numKeys = 200;
+  VectorStore store(dimension);
+  for (int i = 0; i < numKeys; ++i) {
+    store.addVector("key" + std::to_string(i),
+                    std::vector<float>(dimension, static_cast<float>(i)));
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> torn{0};
+  std::atomic<size_t> lookups{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t]() {
+      std::mt19937 rng(t);
+      std::vector<float> query(dimension, 1.0f);
+      while (!stop.load()) {
+        auto record = store.getVector("key" + std::to_string(rng() % numKeys));
+        if (record) {
+          const auto &e = record->embedding;
+          if (e.size() != dimension ||
+              std::count(e.begin(), e.end(), e[0]) !=
+                  static_cast<long>(dimension)) {
+            ++torn;
+          }
+        }
+        if (rng() % 16 == 0) {
+          store.search(query, 5, Metric::Euclidean);
+        }
+        ++lookups;
+      }
+    });
+  }
+
+  while (lookups.load() == 0) {
+    std::this_thread::yield();
+  }
+
+  // Updates rewrite rows in place; delete/re-add cycles recycle slots
+  std::mt19937 rng(99);
+  for (int round = 0; round < 2000; ++round) {
+    std::string id = "key" + std::to_string(rng() % numKeys);
+    std::vector<float> embedding(dimension, static_cast<float>(round));
+    if (round % 3 == 0) {
+      store.deleteVector(id);
+      store.addVector(id, embedding);
+    } else {
+      store.updateVector(id, embedding);
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  std::ostringstream ss;
+  ss << "  " << lookups.load() << " lookups during 2000 writes\n";
+  logOutput(ss.str());
+
+  bool passed = testResult("No torn records observed", torn.load(), size_t(0));
+  passed &= testResult("Size after concurrent writes", store.size(),
+                       static_cast<size_t>(numKeys));
+  return passed;
+}
+
+bool testBulkAdd() {
+  logOutput("\n[Testing bulk add]\n");
+
+  const size_t dimension = 8;
+  const size_t count = 2000;
+  std::mt19937 rng(17);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  std::vector<float> data(count * dimension);
+  for (float &x : data) {
+    x = dist(rng);
+  }
+  std::vector<std::string> ids(count);
+  std::vector<std::string> documentIds(count);
+  for (size_t i = 0; i < count; ++i) {
+    ids[i] = "bulk" + std::to_string(i);
+    documentIds[i] = "doc" + std::to_string(i % 10);
+  }
+
+  // Attached indexes are filled by the bulk path too
+  VectorStore store(dimension);
+  store.addVector("bulk0", std::vector<float>(dimension, 1.0f));
+  store.enableHnswIndex();
+  store.enableScalarQuantization();
+  ids[5] = ids[4]; // repeated within the batch
+
+  size_t added = store.addVectors(data.data(), count, ids, documentIds);
+  bool passed = testResult("Existing and repeated ids skipped", added,
+                           count - 2);
+  passed &= testResult("Size after bulk add", store.size(), count - 1);
+
+  auto record = store.getVector("bulk7");
+  passed &= testResult("Bulk record stored",
+                       record && record->document_id == "doc7" &&
+                           std::equal(record->embedding.begin(),
+                                      record->embedding.end(),
+                                      data.begin() + 7 * dimension),
+                       true);
+  record = store.getVector("bulk0");
+  passed &= testResult("Existing record kept",
+                       record && record->embedding[0] == 1.0f, true);
+
+  std::vector<float> query(data.begin() + 42 * dimension,
+                           data.begin() + 43 * dimension);
+  auto hnsw = store.searchHnsw(query, 1);
+  passed &= testResult("HNSW finds bulk-added vector",
+                       !hnsw.empty() && hnsw[0].id == "bulk42", true);
+  auto quantized = store.searchQuantized(query, 1);
+  passed &= testResult("Quantized search finds bulk-added vector",
+                       !quantized.empty() && quantized[0].id == "bulk42", true);
+
+  bool threw = false;
+  try {
+    store.addVectors(data.data(), 2, {"only-one"});
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  passed &= testResult("Mismatched id count throws", threw, true);
+  return passed;
+}
+
+bool testStoreMetric() {
+  logOutput("\n[Testing store-level metric]\n");
+
+  const size_t dimension = 20;
+  std::mt19937 rng(23);
+  std::normal_distribution<float> dist(0.0f, 3.0f);
+  auto randomVector = [&]() {
+    std::vector<float> v(dimension);
+    for (float &x : v) {
+      x = dist(rng);
+    }
+    return v;
+  };
+
+  VectorStore plain(dimension);
+  VectorStore cosine(dimension, Metric::Cosine);
+  VectorStore euclidean(dimension, Metric::Euclidean);
+  for (int i = 0; i < 300; ++i) {
+    auto v = randomVector();
+    std::string id = "v" + std::to_string(i);
+    plain.addVector(id, v);
+    cosine.addVector(id, v);
+    euclidean.addVector(id, v);
+  }
+  // Updates are prepared like inserts
+  auto replacement = randomVector();
+  plain.updateVector("v3", replacement);
+  cosine.updateVector("v3", replacement);
+  euclidean.updateVector("v3", replacement);
+
+  bool passed = testResult("Metric reported",
+                           !plain.getMetric() &&
+                               cosine.getMetric() == Metric::Cosine,
+                           true);
+  auto stored = cosine.getVector("v3")->embedding;
+  passed &= testResult("Cosine store keeps unit vectors",
+                       VectorOps::dotProduct(stored, stored), 1.0f);
+
+  auto sameResults = [](const std::vector<VectorStore::SearchResult> &a,
+                        const std::vector<VectorStore::SearchResult> &b) {
+    bool same = a.size() == b.size();
+    for (size_t i = 0; same && i < a.size(); ++i) {
+      same = a[i].id == b[i].id &&
+             std::fabs(a[i].score - b[i].score) <= 1e-3f * (1.0f + std::fabs(b[i].score));
+    }
+    return same;
+  };
+
+  bool cosineMatches = true;
+  bool euclideanMatches = true;
+  std::vector<float> batch;
+  for (int q = 0; q < 20; ++q) {
+    auto query = randomVector();
+    batch.insert(batch.end(), query.begin(), query.end());
+    cosineMatches &= sameResults(cosine.search(query, 10, Metric::Cosine),
+                                 plain.search(query, 10, Metric::Cosine));
+    euclideanMatches &=
+        sameResults(euclidean.search(query, 10, Metric::Euclidean),
+                    plain.search(query, 10, Metric::Euclidean));
+  }
+  auto cosineBatch = cosine.searchBatch(batch.data(), 20, 10, Metric::Cosine);
+  auto euclideanBatch =
+      euclidean.searchBatch(batch.data(), 20, 10, Metric::Euclidean);
+  for (int q = 0; q < 20; ++q) {
+    std::vector<float> query(batch.begin() + q * dimension,
+                             batch.begin() + (q + 1) * dimension);
+    cosineMatches &= sameResults(cosineBatch[q],
+                                 plain.search(query, 10, Metric::Cosine));
+    euclideanMatches &= sameResults(euclideanBatch[q],
+                                    plain.search(query, 10, Metric::Euclidean));
+  }
+  passed &= testResult("Cosine store matches cosine search", cosineMatches,
+                       true);
+  passed &= testResult("Cached norms match euclidean search", euclideanMatches,
+                       true);
+  return passed;
+}
+
+bool testCompaction() {
+  logOutput("\n[Testing compaction]\n");
+
+  const size_t dimension = 16;
+  const int count = 3000;
+  std::mt19937 rng(31);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  auto randomVector = [&]() {
+    std::vector<float> v(dimension);
+    for (float &x : v) {
+      x = dist(rng);
+    }
+    return v;
+  };
+
+  VectorStore store(dimension, Metric::Euclidean);
+  for (int i = 0; i < count; ++i) {
+    store.addVector("v" + std::to_string(i), randomVector(),
+                    "doc" + std::to_string(i % 50),
+                    "{\"group\": " + std::to_string(i % 5) + "}");
+  }
+  HnswParams hnsw;
+  hnsw.metric = Metric::Euclidean;
+  store.enableHnswIndex(hnsw);
+  IvfParams ivf;
+  ivf.metric = Metric::Euclidean;
+  ivf.numLists = 16;
+  ivf.nprobe = 16;
+  store.buildIvfIndex(ivf);
+  store.enableScalarQuantization();
+  PqParams pq;
+  pq.metric = Metric::Euclidean;
+  pq.numSubspaces = 4;
+  store.enablePqIndex(pq);
+
+  // Deletes free rows; updates retire graph nodes
+  for (int i = 0; i < count; i += 3) {
+    store.deleteVector("v" + std::to_string(i));
+  }
+  for (int i = 1; i < count; i += 7) {
+    store.updateVector("v" + std::to_string(i), randomVector());
+  }
+  bool passed = testResult("Deleted share reported",
+                           store.deletedFraction() > 0.3, true);
+
+  std::vector<std::vector<float>> queries;
+  std::vector<std::vector<VectorStore::SearchResult>> before;
+  for (int q = 0; q < 10; ++q) {
+    queries.push_back(randomVector());
+    before.push_back(store.search(queries.back(), 10, Metric::Euclidean));
+  }
+  const Filter filter = Filter::equals("group", 2);
+  const size_t matching = store.count(filter);
+  auto record = store.getVector("v8");
+
+  store.compact();
+  passed &= testResult("Nothing left to reclaim", store.deletedFraction(),
+                       0.0f);
+  passed &= testResult("Size kept", store.size(),
+                       static_cast<size_t>(count - count / 3));
+
+  bool sameResults = true;
+  bool hnswRecall = true;
+  for (int q = 0; q < 10; ++q) {
+    auto after = store.search(queries[q], 10, Metric::Euclidean);
+    for (size_t i = 0; i < after.size(); ++i) {
+      sameResults &= after[i].id == before[q][i].id;
+    }
+    sameResults &= after.size() == before[q].size();
+    auto approx = store.searchHnsw(queries[q], 10, 100);
+    size_t hits = 0;
+    for (const auto &a : approx) {
+      for (const auto &b : after) {
+        hits += a.id == b.id;
+      }
+    }
+    hnswRecall &= hits >= 8;
+  }
+  passed &= testResult("Exact results unchanged", sameResults, true);
+  passed &= testResult("HNSW still finds neighbours", hnswRecall, true);
+
+  auto moved = store.getVector("v8");
+  passed &= testResult("Records moved intact",
+                       moved && moved->embedding == record->embedding &&
+                           moved->document_id == record->document_id &&
+                           moved->metadata == record->metadata,
+                       true);
+  passed &= testResult("Deleted stays deleted", !store.getVector("v9"), true);
+  passed &= testResult("Filters rebuilt", store.count(filter), matching);
+
+  auto self = record->embedding;
+  auto top = [](const std::vector<VectorStore::SearchResult> &results) {
+    return results.empty() ? std::string() : results[0].id;
+  };
+  passed &= testResult("IVF relabelled", top(store.searchIvf(self, 1)),
+                       std::string("v8"));
+  passed &= testResult("SQ codes moved", top(store.searchQuantized(
+                                             self, 1, Metric::Euclidean)),
+                       std::string("v8"));
+  passed &= testResult("PQ codes moved", top(store.searchPq(self, 1, 10)),
+                       std::string("v8"));
+
+  // The compacted store keeps accepting writes
+  auto fresh = randomVector();
+  store.addVector("fresh", fresh);
+  passed &= testResult("Add after compaction",
+                       top(store.searchHnsw(fresh, 1)), std::string("fresh"));
+  return passed;
+}
+
+bool testBackgroundCompaction() {
+  logOutput("\n[Testing background compaction]\n");
+
+  const size_t dimension = 8;
+  const int count = 2000;
+  std::mt19937 rng(37);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  std::vector<std::vector<float>> data(count, std::vector<float>(dimension));
+  VectorStore store(dimension);
+  for (int i = 0; i < count; ++i) {
+    for (float &x : data[i]) {
+      x = dist(rng);
+    }
+    store.addVector("v" + std::to_string(i), data[i]);
+  }
+  store.enableHnswIndex();
+
+  CompactionOptions options;
+  options.deletedFraction = 0.1;
+  options.minDeleted = 100;
+  options.interval = std::chrono::milliseconds(5);
+  store.enableBackgroundCompaction(options);
+
+  // Readers keep finding the surviving vectors while compaction runs
+  std::atomic<bool> stop{false};
+  std::atomic<int> misses{0};
+  std::thread reader([&]() {
+    for (int i = 1; !stop; i = (i + 2) % count) {
+      auto results = store.search(data[i], 1);
+      if (results.empty() || results[0].id != "v" + std::to_string(i)) {
+        ++misses;
+      }
+    }
+  });
+
+  for (int i = 0; i < count; i += 2) {
+    store.deleteVector("v" + std::to_string(i));
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (store.deletedFraction() > 0.0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  stop = true;
+  reader.join();
+  store.disableBackgroundCompaction();
+
+  bool passed = testResult("Background task compacted",
+                           store.deletedFraction(), 0.0f);
+  passed &= testResult("Compaction recorded",
+                       store.getMetrics()[StoreOperation::Compact].count > 0,
+                       true);
+  passed &= testResult("Readers unaffected", misses.load(), 0);
+  passed &= testResult("Size after deletes", store.size(),
+                       static_cast<size_t>(count / 2));
+  return passed;
+}
+
+bool testHalfPrecisionStorage() {
+  logOutput("\n[Testing half-precision storage]\n");
+
+  const size_t dimension = 40;
+  std::mt19937 rng(37);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  auto randomVector = [&]() {
+    std::vector<float> v(dimension);
+    for (float &x : v) {
+      x = dist(rng);
+    }
+    return v;
+  };
+  const size_t count = 500;
+  std::vector<std::string> ids;
+  std::vector<float> rows;
+  for (size_t i = 0; i < count; ++i) {
+    auto v = randomVector();
+    ids.push_back("v" + std::to_string(i));
+    rows.insert(rows.end(), v.begin(), v.end());
+  }
+  const int numQueries = 20;
+  std::vector<float> queries;
+  for (int q = 0; q < numQueries; ++q) {
+    auto v = randomVector();
+    queries.insert(queries.end(), v.begin(), v.end());
+  }
+  auto query = [&](int q) {
+    return std::vector<float>(queries.begin() + q * dimension,
+                              queries.begin() + (q + 1) * dimension);
+  };
+  auto overlap = [](const std::vector<VectorStore::SearchResult> &a,
+                    const std::vector<VectorStore::SearchResult> &b) {
+    size_t shared = 0;
+    for (const auto &x : a) {
+      for (const auto &y : b) {
+        shared += x.id == y.id;
+      }
+    }
+    return shared;
+  };
+
+  bool passed = true;
+  for (ElementType type : {ElementType::Float16, ElementType::BFloat16}) {
+    const float tolerance = type == ElementType::Float16 ? 1e-3f : 1e-2f;
+    for (Metric metric :
+         {Metric::DotProduct, Metric::Cosine, Metric::Euclidean}) {
+      VectorStore reference(dimension, metric);
+      VectorStore half(dimension, metric, type);
+      reference.addVectors(rows.data(), count, ids);
+      half.addVectors(rows.data(), count, ids);
+
+      // Stored values are the input rounded to the element type
+      bool rounded = half.getElementType() == type;
+      for (size_t i = 0; i < count; i += 25) {
+        auto expected = reference.getVector(ids[i])->embedding;
+        auto stored = half.getVector(ids[i])->embedding;
+        for (size_t d = 0; d < dimension; ++d) {
+          rounded &= std::fabs(stored[d] - expected[d]) <=
+                     tolerance * std::fabs(expected[d]) + 1e-6f;
+        }
+      }
+
+      // Rounding may swap near-ties, but rankings stay essentially intact
+      size_t shared = 0;
+      bool batchMatches = true;
+      auto batch = half.searchBatch(queries.data(), numQueries, 10, metric);
+      for (int q = 0; q < numQueries; ++q) {
+        auto results = half.search(query(q), 10, metric);
+        shared += overlap(results, reference.search(query(q), 10, metric));
+        batchMatches &= overlap(results, batch[q]) == results.size();
+      }
+
+      const std::string label =
+          std::string(VectorOps::elementTypeName(type)) + ", metric " +
+          std::to_string(static_cast<int>(metric));
+      passed &= testResult("Rows rounded (" + label + ")", rounded, true);
+      passed &= testResult("Search agrees with fp32 (" + label + ")",
+                           shared >= numQueries * 9, true);
+      passed &= testResult("Batch matches single search (" + label + ")",
+                           batchMatches, true);
+    }
+  }
+
+  // Indexes are built from the widened rows, and compaction moves rows
+  // without converting them again
+  VectorStore half(dimension, Metric::Euclidean, ElementType::Float16);
+  half.addVectors(rows.data(), count, ids);
+  HnswParams hnsw;
+  hnsw.metric = Metric::Euclidean;
+  half.enableHnswIndex(hnsw);
+  size_t shared = 0;
+  for (int q = 0; q < numQueries; ++q) {
+    shared += overlap(half.searchHnsw(query(q), 10),
+                      half.search(query(q), 10, Metric::Euclidean));
+  }
+  passed &= testResult("HNSW over fp16 rows", shared >= numQueries * 9, true);
+
+  half.deleteVector("v0");
+  auto before = half.getVector("v1")->embedding;
+  half.compact();
+  passed &= testResult("Compaction keeps fp16 rows",
+                       half.size() == count - 1 &&
+                           half.getVector("v1")->embedding == before,
+                       true);
+  return passed;
+}
+
+bool testIdTable() {
+  logOutput("\n[Testing id table]\n");
+
+  // Random inserts and erases checked against std::unordered_map, with
+  // enough keys to force several rehashes and long probe runs
+  std::mt19937 rng(17);
+  std::vector<std::string> keys;
+  std::unordered_map<std::string, uint32_t> reference;
+  IdTable table;
+  bool consistent = true;
+  for (int step = 0; step < 20000; ++step) {
+    const std::string key = "k" + std::to_string(rng() % 4000);
+    auto it = reference.find(key);
+    if (it == reference.end()) {
+      keys.push_back(key);
+      const uint32_t slot = static_cast<uint32_t>(keys.size() - 1);
+      consistent &= table.find(key, keys) == IdTable::kNotFound;
+      table.insert(slot, keys);
+      reference.emplace(key, slot);
+    } else {
+      consistent &= table.find(key, keys) == it->second;
+      if (rng() % 2 == 0) {
+        consistent &= table.erase(it->second, keys);
+        consistent &= table.find(key, keys) == IdTable::kNotFound;
+        reference.erase(it);
+      }
+    }
+  }
+  bool allFound = table.size() == reference.size();
+  for (const auto &entry : reference) {
+    allFound &= table.find(entry.first, keys) == entry.second;
+  }
+
+  bool passed = testResult("Matches unordered_map", consistent, true);
+  passed &= testResult("Every key found after churn", allFound, true);
+  passed &= testResult("Missing key", table.find("absent", keys),
+                       IdTable::kNotFound);
+  keys.push_back("never inserted");
+  const uint32_t absent = static_cast<uint32_t>(keys.size() - 1);
+  passed &= testResult("Erase of absent slot", table.erase(absent, keys),
+                       false);
+  // A node-based map spends over 40 bytes per key before the key itself
+  passed &= testResult("Compact buckets",
+                       table.memoryBytes() <= 32 * reference.size(), true);
+
+  StringDictionary dictionary;
+  const uint32_t a = dictionary.intern("doc-a");
+  const uint32_t again = dictionary.intern("doc-a");
+  const uint32_t b = dictionary.intern("doc-b");
+  passed &= testResult("Interned once", a == again && a != b, true);
+  passed &= testResult("Empty string is code 0", dictionary.intern(""),
+                       StringDictionary::kEmpty);
+  dictionary.release(a);
+  passed &= testResult("Kept while referenced", dictionary.get(a),
+                       std::string("doc-a"));
+  dictionary.release(a);
+  passed &= testResult("Freed with its last reference",
+                       dictionary.find("doc-a"), IdTable::kNotFound);
+  passed &= testResult("Freed code reused", dictionary.intern("doc-c"), a);
+  passed &= testResult("Distinct strings", dictionary.size(), size_t(2));
+  return passed;
+}
+
+bool testInternedDocumentIds() {
+  logOutput("\n[Testing interned document ids]\n");
+
+  const size_t dimension = 8;
+  VectorStore store(dimension);
+  std::mt19937 rng(23);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  auto randomVector = [&]() {
+    std::vector<float> v(dimension);
+    for (float &x : v) {
+      x = dist(rng);
+    }
+    return v;
+  };
+
+  // Ten chunks per document
+  for (int i = 0; i < 100; ++i) {
+    store.addVector("chunk" + std::to_string(i), randomVector(),
+                    "doc" + std::to_string(i / 10));
+  }
+  bool passed = testResult("Chunks keep their document",
+                           store.getVector("chunk57")->document_id,
+                           std::string("doc5"));
+  passed &= testResult("Document filter",
+                       store.count(Filter::documentIn({"doc3", "doc9"})),
+                       size_t(20));
+
+  store.updateVector("chunk57", {}, "doc-moved");
+  passed &= testResult("Update moves the chunk",
+                       store.count(Filter::documentIn({"doc5"})), size_t(9));
+  passed &= testResult("Updated document id",
+                       store.getVector("chunk57")->document_id,
+                       std::string("doc-moved"));
+
+  for (int i = 0; i < 10; ++i) {
+    store.deleteVector("chunk" + std::to_string(i));
+  }
+  store.addVector("late", randomVector(), "doc0");
+  passed &= testResult("Released document id is reusable",
+                       store.count(Filter::documentIn({"doc0"})), size_t(1));
+
+  store.compact();
+  passed &= testResult("Compaction keeps document ids",
+                       store.getVector("chunk99")->document_id == "doc9" &&
+                           store.getVector("late")->document_id == "doc0" &&
+                           store.count(Filter::documentIn({"doc9"})) == 10,
+                       true);
+  passed &= testResult("Ids still resolve after compaction",
+                       store.getVector("chunk0") == nullptr &&
+                           store.getVector("chunk10") != nullptr &&
+                           store.getAllVectors().size() == store.size(),
+                       true);
+  return passed;
+}
+
+namespace {
+
+// Reads a cursor to the end, checking every page is full but the last
+std::vector<VectorStore::VectorRecord> drain(VectorStore::Cursor &cursor,
+                                             size_t pageSize, bool &paged) {
+  std::vector<VectorStore::VectorRecord> records;
+  std::vector<VectorStore::VectorRecord> page;
+  paged = true;
+  bool last = false;
+  while (cursor.next(page)) {
+    paged &= !last && page.size() <= pageSize && !page.empty();
+    last = page.size() < pageSize;
+    records.insert(records.end(), page.begin(), page.end());
+  }
+  return records;
+}
+
+std::vector<std::string> idsOf(
+    const std::vector<VectorStore::VectorRecord> &records) {
+  std::vector<std::string> ids;
+  for (const auto &record : records) {
+    ids.push_back(record.id);
+  }
+  return ids;
+}
+
+std::vector<std::string> expectedIds(int begin, int end) {
+  std::vector<std::string> ids;
+  for (int i = begin; i < end; ++i) {
+    ids.push_back("v" + std::to_string(i));
+  }
+  return ids;
+}
+
+} // anonymous namespace
+
+bool testCursor() {
+  logOutput("\n[Testing cursors]\n");
+
+  const size_t dimension = 4;
+  const int count = 100;
+  VectorStore store(dimension);
+  auto rowOf = [](int i) {
+    return std::vector<float>{static_cast<float>(i), 1.0f, 2.0f, 3.0f};
+  };
+  for (int i = 0; i < count; ++i) {
+    store.addVector("v" + std::to_string(i), rowOf(i),
+                    "doc" + std::to_string(i % 5), "m" + std::to_string(i));
+  }
+
+  bool threw = false;
+  try {
+    CursorOptions empty;
+    empty.pageSize = 0;
+    store.openCursor(empty);
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  bool passed = testResult("Zero page size rejected", threw, true);
+
+  CursorOptions options;
+  options.pageSize = 30;
+  bool paged = false;
+  auto records = drain(*store.openCursor(options), 30, paged);
+  passed &= testResult("Pages are full but the last", paged, true);
+  passed &= testResult("Every record in slot order",
+                       idsOf(records) == expectedIds(0, count), true);
+  passed &= testResult("Fields copied",
+                       records[42].embedding == rowOf(42) &&
+                           records[42].document_id == "doc2" &&
+                           records[42].metadata == "m42",
+                       true);
+
+  CursorOptions idsOnly;
+  idsOnly.embeddings = false;
+  idsOnly.documentIds = false;
+  idsOnly.metadata = false;
+  records = drain(*store.openCursor(idsOnly), idsOnly.pageSize, paged);
+  passed &= testResult("Projection keeps ids",
+                       idsOf(records) == expectedIds(0, count), true);
+  passed &= testResult("Projection drops other fields",
+                       records[7].embedding.empty() &&
+                           records[7].document_id.empty() &&
+                           records[7].metadata.empty(),
+                       true);
+
+  // Writes after the cursor opens never show through: changed rows it has
+  // not reached keep their old values, deleted rows are still returned and
+  // new rows are not, even when they reuse a freed slot
+  options.pageSize = 10;
+  auto cursor = store.openCursor(options);
+  std::vector<VectorStore::VectorRecord> page;
+  cursor->next(page);
+  store.updateVector("v50", rowOf(-1), "", "changed");
+  store.deleteVector("v60");
+  store.deleteVector("v5");
+  store.addVector("new0", rowOf(-2));
+  store.addVector("new1", rowOf(-3));
+  store.addVector("new2", rowOf(-4));
+  store.updateVector("new0", rowOf(-5));
+  records = drain(*cursor, 10, paged);
+  passed &= testResult("Snapshot ids unchanged by writes",
+                       idsOf(records) == expectedIds(10, count), true);
+  passed &= testResult("Updated record read as it was",
+                       records[40].embedding == rowOf(50) &&
+                           records[40].metadata == "m50",
+                       true);
+  passed &= testResult("Live store sees the writes",
+                       store.getVector("v50")->metadata == "changed" &&
+                           store.getVector("v60") == nullptr &&
+                           store.getVector("new2") != nullptr,
+                       true);
+  cursor.reset();
+
+  // clear() and compact() hand open cursors their unread records
+  cursor = store.openCursor(options);
+  cursor->next(page);
+  const std::vector<std::string> firstPage = idsOf(page);
+  std::vector<std::string> remaining;
+  for (const auto &record : drain(*store.openCursor(options), 10, paged)) {
+    remaining.push_back(record.id);
+  }
+  remaining.erase(remaining.begin(), remaining.begin() + firstPage.size());
+  for (int i = 0; i < count; i += 3) {
+    store.deleteVector("v" + std::to_string(i));
+  }
+  store.compact();
+  store.deleteVector("v99");
+  passed &= testResult("Compaction keeps cursor snapshot",
+                       idsOf(drain(*cursor, 10, paged)) == remaining, true);
+  cursor.reset();
+
+  const size_t before = store.size();
+  cursor = store.openCursor(options);
+  store.clear();
+  store.addVector("after", rowOf(0));
+  passed &= testResult("Clear keeps cursor snapshot",
+                       drain(*cursor, 10, paged).size(), before);
+  cursor.reset();
+
+  // The replaced tables stay readable as they were, whatever the live store
+  // does with its new ones
+  store.clear();
+  for (int i = 0; i < 20; ++i) {
+    store.addVector("v" + std::to_string(i), rowOf(i),
+                    "doc" + std::to_string(i % 5), "m" + std::to_string(i));
+  }
+  store.deleteVector("v0");
+  cursor = store.openCursor(options);
+  store.compact();
+  for (int i = 1; i < 20; ++i) {
+    store.updateVector("v" + std::to_string(i), rowOf(-i), "other", "x");
+  }
+  store.compact();
+  records = drain(*cursor, 10, paged);
+  passed &= testResult("Replaced tables read as they were",
+                       records.size() == 19 && records[0].id == "v1" &&
+                           records[0].embedding == rowOf(1) &&
+                           records[0].document_id == "doc1" &&
+                           records[18].metadata == "m19",
+                       true);
+  cursor.reset();
+
+  // A cursor that falls too far behind the writers expires
+  CursorOptions capped = options;
+  capped.maxPreimageBytes = 2048;
+  cursor = store.openCursor(capped);
+  for (int i = 1; i < 20; ++i) {
+    store.updateVector("v" + std::to_string(i), rowOf(i));
+  }
+  threw = false;
+  try {
+    cursor->next(page);
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  passed &= testResult("Cursor past its preimage cap expires", threw, true);
+  cursor.reset();
+  passed &= testResult("getAllVectors is not capped",
+                       store.getAllVectors().size(), size_t(19));
+  store.clear();
+
+  // The background compactor waits for open cursors
+  for (int i = 0; i < count; ++i) {
+    store.addVector("v" + std::to_string(i), rowOf(i));
+  }
+  for (int i = 0; i < count; i += 2) {
+    store.deleteVector("v" + std::to_string(i));
+  }
+  cursor = store.openCursor(options);
+  CompactionOptions compaction;
+  compaction.deletedFraction = 0.1;
+  compaction.minDeleted = 10;
+  compaction.interval = std::chrono::milliseconds(5);
+  store.enableBackgroundCompaction(compaction);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  passed &= testResult("Compaction deferred while a cursor is open",
+                       store.deletedFraction() > 0.0, true);
+  cursor.reset();
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (store.deletedFraction() > 0.0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  store.disableBackgroundCompaction();
+  passed &= testResult("Compaction runs once cursors close",
+                       store.deletedFraction(), 0.0f);
+  passed &= testResult("getAllVectors after compaction",
+                       store.getAllVectors().size(), store.size());
+  return passed;
+}
+
 } // namespace vectorsearch
 
 int main() {
@@ -213,8 +1263,20 @@ int main() {
 
   bool allPassed = vectorsearch::testBasicOperations() &
                    vectorsearch::testMultipleVectors() &
+                   vectorsearch::testArenaStorage() &
+                   vectorsearch::testSearch() &
+                   vectorsearch::testBatchSearch() &
                    vectorsearch::testDimensionCheck() &
-                   vectorsearch::testThreadSafety();
+                   vectorsearch::testThreadSafety() &
+                   vectorsearch::testConcurrentReadsDuringWrites() &
+                   vectorsearch::testBulkAdd() &
+                   vectorsearch::testStoreMetric() &
+                   vectorsearch::testCompaction() &
+                   vectorsearch::testBackgroundCompaction() &
+                   vectorsearch::testHalfPrecisionStorage() &
+                   vectorsearch::testIdTable() &
+                   vectorsearch::testInternedDocumentIds() &
+                   vectorsearch::testCursor();
 
   logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
   logfile.close();
@@ -0,0 +1,229 @@
+// test/write_ahead_log_tests.cpp
+#include "engine/vector_store.h"
+#include "storage/write_ahead_log.h"
+#include "test_utils.h"
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <thread>
+
+std::ofstream test_utils::logfile;
+
+using namespace test_utils;
+
+namespace vectorsearch {
+
+namespace {
+
+const std::string kLogPath = "write_ahead_log_tests.wal";
+const std::string kSnapshotPath = "write_ahead_log_tests.snap";
+
+bool sameRecord(const VectorStore &a, const VectorStore &b,
+                const std::string &id) {
+  auto ra = a.getVector(id);
+  auto rb = b.getVector(id);
+  if (!ra || !rb) {
+    return !ra && !rb;
+  }
+  return ra->embedding == rb->embedding &&
+         ra->document_id == rb->document_id && ra->metadata == rb->metadata;
+}
+
+size_t fileSize(const std::string &path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  return in ? static_cast<size_t>(in.tellg()) : 0;
+}
+
+} // anonymous namespace
+
+bool testReplay() {
+  logOutput("\n[Testing write-ahead log replay]\n");
+  std::remove(kLogPath.c_str());
+
+  const size_t dimension = 8;
+  std::mt19937 rng(3);
+
+  VectorStore original(dimension);
+  original.enableWriteAheadLog(kLogPath);
+  for (int i = 0; i < 50; ++i) {
+    std::string metadata = "{\"i\":" + std::to_string(i) + "}";
+    original.addVector("v" + std::to_string(i), randomVector(dimension, rng),
+                       "doc" + std::to_string(i), metadata);
+  }
+  original.updateVector("v3", randomVector(dimension, rng), "", "updated");
+  original.updateVector("v4", {}, "moved");
+  original.deleteVector("v5");
+  original.addVector("v5", randomVector(dimension, rng));
+  original.deleteVector("v6");
+  // Failed mutations are not logged
+  auto duplicate = randomVector(dimension, rng);
+  bool passed = testResult("Duplicate add rejected",
+                           original.addVector("v7", duplicate), false);
+
+  VectorStore replayed(dimension);
+  replayed.enableWriteAheadLog(kLogPath);
+
+  passed &= testResult("Replayed size", replayed.size(), original.size());
+  bool same = true;
+  for (int i = 0; i < 50; ++i) {
+    same &= sameRecord(original, replayed, "v" + std::to_string(i));
+  }
+  passed &= testResult("Replayed records match", same, true);
+
+  // Clear is logged as well
+  replayed.clear();
+  replayed.addVector("after-clear", randomVector(dimension, rng));
+  VectorStore replayedAgain(dimension);
+  replayedAgain.enableWriteAheadLog(kLogPath);
+  passed &= testResult("Clear replayed", replayedAgain.size(), size_t(1));
+
+  bool threw = false;
+  try {
+    replayedAgain.enableWriteAheadLog(kLogPath);
+  } catch (const std::logic_error &) {
+    threw = true;
+  }
+  passed &= testResult("Second log rejected", threw, true);
+
+  std::remove(kLogPath.c_str());
+  return passed;
+}
+
+bool testTornTail() {
+  logOutput("\n[Testing torn log tail]\n");
+  std::remove(kLogPath.c_str());
+
+  const size_t dimension = 8;
+  std::mt19937 rng(5);
+  {
+    VectorStore store(dimension);
+    store.enableWriteAheadLog(kLogPath);
+    for (int i = 0; i < 10; ++i) {
+      store.addVector("v" + std::to_string(i), randomVector(dimension, rng));
+    }
+  }
+
+  // Simulate a crash halfway through writing one more record
+  size_t intact = fileSize(kLogPath);
+  {
+    std::ofstream out(kLogPath, std::ios::binary | std::ios::app);
+    const char partial[] = {0x40, 0x00, 0x00, 0x00, 0x12, 0x34};
+    out.write(partial, sizeof(partial));
+  }
+
+  VectorStore recovered(dimension);
+  recovered.enableWriteAheadLog(kLogPath);
+  bool passed = testResult("Intact records replayed", recovered.size(),
+                           size_t(10));
+  passed &= testResult("Torn tail cut off", fileSize(kLogPath), intact);
+
+  // New records land after the intact prefix and replay cleanly
+  recovered.addVector("late", randomVector(dimension, rng));
+  VectorStore reopened(dimension);
+  reopened.enableWriteAheadLog(kLogPath);
+  passed &= testResult("Appends after torn tail replay", reopened.size(),
+                       size_t(11));
+
+  std::remove(kLogPath.c_str());
+  return passed;
+}
+
+bool testGroupCommit() {
+  logOutput("\n[Testing group commit]\n");
+  std::remove(kLogPath.c_str());
+
+  const int numThreads = 8;
+  const int perThread = 200;
+  size_t replayedCount = 0;
+  uint64_t commits = 0;
+  {
+    WriteAheadLog log(kLogPath, WalOptions(),
+                      [](const WriteAheadLog::Record &) {});
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+      threads.emplace_back([&log, t]() {
+        for (int i = 0; i < perThread; ++i) {
+          WriteAheadLog::Record record;
+          record.id = std::to_string(t) + ":" + std::to_string(i);
+          record.embedding = {1.0f, 2.0f, 3.0f};
+          log.waitDurable(log.append(record));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    commits = log.commitCount();
+    std::ostringstream ss;
+    ss << "  " << log.recordCount() << " records in " << commits
+       << " commits\n";
+    logOutput(ss.str());
+  }
+
+  WriteAheadLog reopened(kLogPath, WalOptions(),
+                         [&](const WriteAheadLog::Record &record) {
+                           replayedCount +=
+                               record.embedding.size() == 3 ? 1 : 0;
+                         });
+  bool passed = testResult("Every record durable", replayedCount,
+                           size_t(numThreads * perThread));
+  passed &= testResult("Concurrent writers share commits",
+                       commits < static_cast<uint64_t>(numThreads * perThread),
+                       true);
+
+  std::remove(kLogPath.c_str());
+  return passed;
+}
+
+bool testCheckpoint() {
+  logOutput("\n[Testing checkpoint and recovery]\n");
+  std::remove(kLogPath.c_str());
+
+  const size_t dimension = 8;
+  std::mt19937 rng(9);
+
+  VectorStore store(dimension);
+  store.enableWriteAheadLog(kLogPath);
+  for (int i = 0; i < 20; ++i) {
+    store.addVector("v" + std::to_string(i), randomVector(dimension, rng));
+  }
+  store.checkpoint(kSnapshotPath);
+  bool passed = testResult("Log emptied by checkpoint", fileSize(kLogPath),
+                           size_t(0));
+
+  store.deleteVector("v0");
+  store.addVector("v20", randomVector(dimension, rng));
+  store.updateVector("v1", randomVector(dimension, rng));
+
+  // Recovery: last snapshot plus the log written since
+  auto recovered = VectorStore::loadSnapshot(kSnapshotPath);
+  recovered->enableWriteAheadLog(kLogPath);
+  passed &= testResult("Recovered size", recovered->size(), store.size());
+  bool same = true;
+  for (int i = 0; i <= 20; ++i) {
+    same &= sameRecord(store, *recovered, "v" + std::to_string(i));
+  }
+  passed &= testResult("Recovered records match", same, true);
+
+  std::remove(kLogPath.c_str());
+  std::remove(kSnapshotPath.c_str());
+  return passed;
+}
+
+} // namespace vectorsearch
+
+int main() {
+  logfile.open("write_ahead_log_tests.log");
+
+  std::time_t now = std::time(nullptr);
+  logOutput("Write-Ahead Log Tests - " + std::string(std::ctime(&now)) +
+            "\n");
+
+  bool allPassed = vectorsearch::testReplay() & vectorsearch::testTornTail() &
+                   vectorsearch::testGroupCommit() &
+                   vectorsearch::testCheckpoint();
+
+  logOutput(allPassed ? "\nAll tests passed!\n" : "\nSome tests failed!\n");
+  logfile.close();
+  return !allPassed;
+}